@@ -481,20 +481,13 @@ void loop() {
     AudioSample sample = audio.next();
     if (sample.isValid()) {
         // Update sound meter
-        soundMeter.processBlock(sample.pcm());
+        soundMeter.processStats(sample.stats());
         
         // Get audio levels
         float rms = sample.rms() / 32768.0f;
         
-        // Calculate peak
-        int32_t maxSample = 0;
-        for (size_t i = 0; i < sample.pcm().size(); i++) {
-            int32_t absSample = fabsf(sample.pcm()[i]);
-            if (absSample > maxSample) {
-                maxSample = absSample;
-            }
-        }
-        float peak = float(maxSample) / 32768.0f;
+        // Peak was measured along with the rms
+        float peak = float(sample.stats().peak) / 32768.0f;
         peakLevel = peakLevel * 0.9f + peak * 0.1f;  // Smooth peak
         
         // Update auto gain
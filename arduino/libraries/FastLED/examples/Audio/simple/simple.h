@@ -178,7 +178,7 @@ void loop() {
         float fade = audioFadeTracker(sample.pcm().data(), sample.pcm().size());
         shiftUp();
         // FASTLED_WARN("Audio sample size: " << sample.pcm().size());
-        soundLevelMeter.processBlock(sample.pcm());
+        soundLevelMeter.processStats(sample.stats());
         // FASTLED_WARN("")
         auto dbfs = soundLevelMeter.getDBFS();
         FASTLED_UNUSED(dbfs);
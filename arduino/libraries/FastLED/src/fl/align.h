@@ -16,3 +16,13 @@
 #define FL_ALIGN
 #define FL_ALIGN_AS(T)
 #endif
+
+// Cache line size used to keep data that different cores write apart, so
+// they do not keep invalidating each other's copy of the line.
+#ifndef FL_CACHE_LINE_SIZE
+#if defined(ESP32) || defined(__arm__)
+#define FL_CACHE_LINE_SIZE 32
+#else
+#define FL_CACHE_LINE_SIZE 64
+#endif
+#endif
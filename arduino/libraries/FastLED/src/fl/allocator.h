@@ -176,142 +176,414 @@ template <typename T> class allocator_psram {
 
 
 
+namespace slab_detail {
+
+constexpr fl::size round_up(fl::size value, fl::size multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+constexpr fl::size max_size(fl::size a, fl::size b) { return a > b ? a : b; }
+
+// Smallest k with 2^k >= n.
+constexpr fl::size ceil_log2(fl::size n) {
+    return n <= 1 ? 0 : 1 + ceil_log2((n + 1) / 2);
+}
+
+} // namespace slab_detail
+
+// Lock policy for SlabAllocator that does nothing. Used on single threaded
+// targets and whenever the owner already serializes access. See
+// SlabAllocatorThreadSafe in fl/mutex.h for a locking variant.
+struct SlabNoLock {
+    void lock() {}
+    void unlock() {}
+};
+
+// Usage statistics reported by SlabAllocator::getStats(). Block counts are in
+// units of one T.
+struct SlabAllocatorStats {
+    fl::size liveAllocations = 0;  // outstanding allocations served by slabs
+    fl::size liveBlocks = 0;       // blocks requested by those allocations
+    fl::size peakLiveBlocks = 0;   // high-water mark of liveBlocks
+    fl::size reservedBlocks = 0;   // liveBlocks plus size-class rounding
+    fl::size freeBlocks = 0;       // blocks ready to be handed out
+    fl::size slabCount = 0;
+    fl::size peakSlabCount = 0;
+    fl::size capacityBlocks = 0;   // slabCount * blocks per slab
+    fl::size largeAllocations = 0; // outstanding allocations too big for a
+                                   // slab, served by malloc
+    fl::size releasedSlabs = 0;    // slabs handed back to the heap by trim()
+    fl::size merges = 0;           // passes that joined neighbouring free runs
+
+    // Percentage of slab capacity that does not hold requested objects,
+    // either because it is free or because it was lost to size-class
+    // rounding.
+    u8 fragmentationPercent() const {
+        if (capacityBlocks == 0) {
+            return 0;
+        }
+        return static_cast<u8>((capacityBlocks - liveBlocks) * 100 /
+                               capacityBlocks);
+    }
+};
+
 // Slab allocator for fixed-size objects
-// Optimized for frequent allocation/deallocation of objects of the same size
-// Uses pre-allocated memory slabs with free lists to reduce fragmentation
-template <typename T, fl::size SLAB_SIZE = FASTLED_DEFAULT_SLAB_SIZE>
+// Optimized for frequent allocation/deallocation of objects of the same size.
+//
+// Requests of n <= SLAB_SIZE objects are rounded up to a power of two size
+// class (capped at SLAB_SIZE) and served from an intrusive free list per
+// class, so allocate() and deallocate() cost the same no matter how many
+// slabs are live. When a class list is empty the run is carved from the
+// newest slab, or split off a larger free run, before a new slab is made.
+// Larger requests go straight to malloc. deallocate() must be given the same
+// n that was passed to allocate().
+//
+// Freed runs are not joined on deallocate(). Before a new slab is made,
+// neighbouring free runs are merged and filed again as the largest power of
+// two runs, so free space split into small runs can serve larger requests
+// again. A merge that does not help doubles the number of frees needed
+// before the next one, so a heap that cannot be defragmented does not pay
+// for a merge on every new slab. Fully free slabs are only handed back to the heap by an explicit
+// trim(), which keeps one empty slab. Neither merging nor trim() allocates.
+template <typename T, fl::size SLAB_SIZE = FASTLED_DEFAULT_SLAB_SIZE,
+          typename Lock = SlabNoLock>
 class SlabAllocator {
 private:
+    static_assert(SLAB_SIZE > 0, "SlabAllocator needs at least one block per slab");
 
-
-    static constexpr fl::size SLAB_BLOCK_SIZE = sizeof(T) > sizeof(void*) ? sizeof(T) : sizeof(void*);
+    // A free block stores the free list link, so it must fit and align a
+    // pointer.
+    static constexpr fl::size SLAB_BLOCK_SIZE = slab_detail::round_up(
+        slab_detail::max_size(sizeof(T), sizeof(void*)), alignof(void*));
     static constexpr fl::size BLOCKS_PER_SLAB = SLAB_SIZE;
     static constexpr fl::size SLAB_MEMORY_SIZE = SLAB_BLOCK_SIZE * BLOCKS_PER_SLAB;
+    static constexpr fl::size NUM_CLASSES = slab_detail::ceil_log2(BLOCKS_PER_SLAB) + 1;
+    static constexpr fl::size RETAINED_EMPTY_SLABS = 1;
 
+    // Header at the front of each slab allocation, the blocks follow it.
     struct Slab {
         Slab* next;
-        u8* memory;
-        fl::size allocated_count;
-        fl::bitset_fixed<BLOCKS_PER_SLAB> allocated_blocks;  // Track which blocks are allocated
-        
-        Slab() : next(nullptr), memory(nullptr), allocated_count(0) {}
-        
-        ~Slab() {
-            if (memory) {
-                free(memory);
-            }
-        }
+    };
+    static constexpr fl::size SLAB_HEADER_SIZE = slab_detail::round_up(sizeof(Slab), 16);
+
+    // Link stored in the first block of a free run.
+    struct FreeRun {
+        FreeRun* next;
+    };
+
+    struct Guard {
+        explicit Guard(Lock& lock) : lock_(lock) { lock_.lock(); }
+        ~Guard() { lock_.unlock(); }
+        Lock& lock_;
     };
 
     Slab* slabs_;
+    fl::size carved_;  // blocks handed out from the front of slabs_
+    FreeRun* free_lists_[NUM_CLASSES];
     fl::size total_allocated_;
     fl::size total_deallocated_;
+    fl::size frees_since_merge_;
+    fl::size merge_after_frees_;  // frees before allocation tries a merge
+    SlabAllocatorStats stats_;
+    mutable Lock lock_;
+
+    static fl::size sizeClass(fl::size n) {
+        fl::size k = 0;
+        while ((fl::size(1) << k) < n) {
+            ++k;
+        }
+        return k;
+    }
 
-    Slab* createSlab() {
-        Slab* slab = static_cast<Slab*>(malloc(sizeof(Slab)));
-        if (!slab) {
-            return nullptr;
+    static fl::size runBlocks(fl::size size_class) {
+        fl::size blocks = fl::size(1) << size_class;
+        return blocks < BLOCKS_PER_SLAB ? blocks : BLOCKS_PER_SLAB;
+    }
+
+    static u8* blocksOf(Slab* slab) {
+        return static_cast<u8*>(static_cast<void*>(slab)) + SLAB_HEADER_SIZE;
+    }
+
+    void pushRun(fl::size size_class, void* ptr) {
+        free_lists_[size_class] = new (ptr) FreeRun{free_lists_[size_class]};
+    }
+
+    void* popRun(fl::size size_class) {
+        FreeRun* run = free_lists_[size_class];
+        if (run) {
+            free_lists_[size_class] = run->next;
         }
-        
-        // Use placement new to properly initialize the Slab
-        new(slab) Slab();
-        
-        slab->memory = static_cast<u8*>(malloc(SLAB_MEMORY_SIZE));
-        if (!slab->memory) {
-            slab->~Slab();
-            free(slab);
+        return run;
+    }
+
+    // Splits `count` blocks into power of two runs and files them under their
+    // size class.
+    void pushBlocks(u8* ptr, fl::size count) {
+        while (count > 0) {
+            fl::size size_class = sizeClass(count + 1) - 1;
+            fl::size blocks = fl::size(1) << size_class;
+            pushRun(size_class, ptr);
+            ptr += blocks * SLAB_BLOCK_SIZE;
+            count -= blocks;
+        }
+    }
+
+    void* carve(fl::size blocks) {
+        if (!slabs_ || carved_ + blocks > BLOCKS_PER_SLAB) {
             return nullptr;
         }
-        
-        // Initialize all blocks in the slab as free
-        slab->allocated_blocks.reset(); // All blocks start as free
-        
-        // Add slab to the slab list
-        slab->next = slabs_;
+        void* ptr = blocksOf(slabs_) + carved_ * SLAB_BLOCK_SIZE;
+        carved_ += blocks;
+        return ptr;
+    }
+
+    // Moves whatever is left of the newest slab onto the free lists.
+    void retireCurrentSlab() {
+        if (slabs_ && carved_ < BLOCKS_PER_SLAB) {
+            pushBlocks(blocksOf(slabs_) + carved_ * SLAB_BLOCK_SIZE,
+                       BLOCKS_PER_SLAB - carved_);
+        }
+        carved_ = BLOCKS_PER_SLAB;
+    }
+
+    void* splitLargerRun(fl::size size_class) {
+        for (fl::size larger = size_class + 1; larger < NUM_CLASSES; ++larger) {
+            u8* run = static_cast<u8*>(popRun(larger));
+            if (run) {
+                fl::size blocks = runBlocks(size_class);
+                pushBlocks(run + blocks * SLAB_BLOCK_SIZE,
+                           runBlocks(larger) - blocks);
+                return run;
+            }
+        }
+        return nullptr;
+    }
+
+    bool createSlab() {
+        void* memory = malloc(SLAB_HEADER_SIZE + SLAB_MEMORY_SIZE);
+        if (!memory) {
+            return false;
+        }
+        retireCurrentSlab();
+        Slab* slab = new (memory) Slab{slabs_};
         slabs_ = slab;
-        
-        return slab;
+        carved_ = 0;
+        ++stats_.slabCount;
+        if (stats_.slabCount > stats_.peakSlabCount) {
+            stats_.peakSlabCount = stats_.slabCount;
+        }
+        stats_.capacityBlocks += BLOCKS_PER_SLAB;
+        stats_.freeBlocks += BLOCKS_PER_SLAB;
+        return true;
     }
 
-    void* allocateFromSlab(fl::size n = 1) {
-        // Try to find n contiguous free blocks in existing slabs
-        for (Slab* slab = slabs_; slab; slab = slab->next) {
-            void* ptr = findContiguousBlocks(slab, n);
+    void* allocateFromSlab(fl::size n) {
+        fl::size size_class = sizeClass(n);
+        fl::size blocks = runBlocks(size_class);
+        void* ptr = popRun(size_class);
+        if (!ptr) {
+            ptr = carve(blocks);
+        }
+        if (!ptr) {
+            ptr = splitLargerRun(size_class);
+        }
+        if (!ptr && frees_since_merge_ >= merge_after_frees_ &&
+            stats_.freeBlocks >= blocks) {
+            // Enough is free, but split up: join neighbours before making a
+            // new slab.
+            mergeFreeRuns(ALL_SLABS);
+            ptr = popRun(size_class);
+            if (!ptr) {
+                ptr = splitLargerRun(size_class);
+            }
             if (ptr) {
-                return ptr;
+                merge_after_frees_ = 1;
+            } else if (merge_after_frees_ < stats_.capacityBlocks) {
+                merge_after_frees_ *= 2;
             }
         }
-        
-        // No contiguous blocks found, create new slab if n fits
-        if (n <= BLOCKS_PER_SLAB) {
+        if (!ptr) {
             if (!createSlab()) {
                 return nullptr; // Out of memory
             }
-            
-            // Try again with the new slab
-            return findContiguousBlocks(slabs_, n);
+            ptr = carve(blocks);
         }
-        
-        // Request too large for slab, fall back to malloc
-        return nullptr;
+        total_allocated_ += n;
+        ++stats_.liveAllocations;
+        stats_.liveBlocks += n;
+        if (stats_.liveBlocks > stats_.peakLiveBlocks) {
+            stats_.peakLiveBlocks = stats_.liveBlocks;
+        }
+        stats_.reservedBlocks += blocks;
+        stats_.freeBlocks -= blocks;
+        return ptr;
     }
-    
 
-    
-    void* findContiguousBlocks(Slab* slab, fl::size n) {
-        // Check if allocation is too large for this slab
-        if (n > BLOCKS_PER_SLAB) {
-            return nullptr;
+    void deallocateToSlab(void* ptr, fl::size n) {
+        fl::size size_class = sizeClass(n);
+        fl::size blocks = runBlocks(size_class);
+        pushRun(size_class, ptr);
+        total_deallocated_ += n;
+        --stats_.liveAllocations;
+        stats_.liveBlocks -= n;
+        stats_.reservedBlocks -= blocks;
+        stats_.freeBlocks += blocks;
+        ++frees_since_merge_;
+    }
+
+    static bool addressBefore(const void* a, const void* b) {
+        return reinterpret_cast<fl::uptr>(a) < reinterpret_cast<fl::uptr>(b);
+    }
+
+    // Merge sort of an intrusive list by address; recursion depth is
+    // log2 of the length and nothing is allocated.
+    template <typename Node>
+    static Node* sortByAddress(Node* head) {
+        if (!head || !head->next) {
+            return head;
         }
-        
-        // Use bitset's find_run to find n contiguous free blocks (false = free)
-        fl::i32 start = slab->allocated_blocks.find_run(false, static_cast<fl::u32>(n));
-        if (start >= 0) {
-            // Mark blocks as allocated
-            for (fl::size i = 0; i < n; ++i) {
-                slab->allocated_blocks.set(static_cast<fl::u32>(start + i), true);
+        Node* middle = head;
+        for (Node* fast = head->next; fast && fast->next; fast = fast->next->next) {
+            middle = middle->next;
+        }
+        Node* second = middle->next;
+        middle->next = nullptr;
+        Node* a = sortByAddress(head);
+        Node* b = sortByAddress(second);
+        Node* merged = nullptr;
+        Node** tail = &merged;
+        while (a && b) {
+            if (addressBefore(b, a)) {
+                *tail = b;
+                b = b->next;
+            } else {
+                *tail = a;
+                a = a->next;
             }
-            slab->allocated_count += n;
-            total_allocated_ += n;
-            
-            // Return pointer to the first block
-            return slab->memory + static_cast<fl::size>(start) * SLAB_BLOCK_SIZE;
+            tail = &(*tail)->next;
         }
-        
-        return nullptr;
+        *tail = a ? a : b;
+        return merged;
     }
 
-    void deallocateToSlab(void* ptr, fl::size n = 1) {
-        if (!ptr) {
-            return;
+    static u8* slabEnd(Slab* slab) {
+        return blocksOf(slab) + SLAB_MEMORY_SIZE;
+    }
+
+    static constexpr fl::size ALL_SLABS = ~fl::size(0);
+
+    // Walks every free run in address order, joins neighbours within a slab
+    // and files the result again. A slab that turns out to be entirely free
+    // is released once `retain_empty` of them have been kept. Returns the
+    // number of slabs released.
+    fl::size mergeFreeRuns(fl::size retain_empty) {
+        frees_since_merge_ = 0;
+        ++stats_.merges;
+        // With the rest of the newest slab on the free lists, the lists
+        // describe every free block.
+        retireCurrentSlab();
+        slabs_ = sortByAddress(slabs_);
+        FreeRun* heads[NUM_CLASSES];
+        for (fl::size size_class = 0; size_class < NUM_CLASSES; ++size_class) {
+            heads[size_class] = sortByAddress(free_lists_[size_class]);
+            free_lists_[size_class] = nullptr;
         }
-        
-        // Find which slab this block belongs to
-        for (Slab* slab = slabs_; slab; slab = slab->next) {
-            u8* slab_start = slab->memory;
-            u8* slab_end = slab_start + SLAB_MEMORY_SIZE;
-            u8* block_ptr = fl::bit_cast_ptr<u8>(ptr);
-            
-            if (block_ptr >= slab_start && block_ptr < slab_end) {
-                fl::size block_index = (block_ptr - slab_start) / SLAB_BLOCK_SIZE;
-                
-                // Mark blocks as free in the bitset
-                for (fl::size i = 0; i < n; ++i) {
-                    if (block_index + i < BLOCKS_PER_SLAB) {
-                        slab->allocated_blocks.set(block_index + i, false);
-                    }
+
+        // The slab holding `pending`; slabs before it have been passed.
+        Slab** slab = &slabs_;
+        u8* pending = nullptr;
+        fl::size pending_blocks = 0;
+        fl::size retained = 0;
+        fl::size released = 0;
+        while (true) {
+            fl::size lowest = NUM_CLASSES;
+            for (fl::size size_class = 0; size_class < NUM_CLASSES; ++size_class) {
+                if (heads[size_class] &&
+                    (lowest == NUM_CLASSES || addressBefore(heads[size_class], heads[lowest]))) {
+                    lowest = size_class;
+                }
+            }
+            u8* run = nullptr;
+            if (lowest < NUM_CLASSES) {
+                run = reinterpret_cast<u8*>(heads[lowest]);
+                heads[lowest] = heads[lowest]->next;
+            }
+            u8* pending_end = pending + pending_blocks * SLAB_BLOCK_SIZE;
+            if (run && pending && run == pending_end && pending_end < slabEnd(*slab)) {
+                pending_blocks += runBlocks(lowest);
+                continue;
+            }
+            if (pending) {
+                // Every run of the pending range has been unlinked, so its
+                // blocks can be written or freed.
+                if (pending_blocks == BLOCKS_PER_SLAB && retained >= retain_empty) {
+                    Slab* empty = *slab;
+                    *slab = empty->next;
+                    free(empty);
+                    ++released;
+                } else {
+                    retained += pending_blocks == BLOCKS_PER_SLAB ? 1 : 0;
+                    pushBlocks(pending, pending_blocks);
                 }
-                
-                slab->allocated_count -= n;
-                total_deallocated_ += n;
+            }
+            if (!run) {
                 break;
             }
+            while (!addressBefore(run, slabEnd(*slab))) {
+                slab = &(*slab)->next;
+            }
+            pending = run;
+            pending_blocks = runBlocks(lowest);
+        }
+
+        stats_.slabCount -= released;
+        stats_.capacityBlocks -= released * BLOCKS_PER_SLAB;
+        stats_.freeBlocks -= released * BLOCKS_PER_SLAB;
+        stats_.releasedSlabs += released;
+        return released;
+    }
+
+    void resetState() {
+        slabs_ = nullptr;
+        carved_ = BLOCKS_PER_SLAB;
+        for (fl::size i = 0; i < NUM_CLASSES; ++i) {
+            free_lists_[i] = nullptr;
+        }
+        total_allocated_ = 0;
+        total_deallocated_ = 0;
+        frees_since_merge_ = 0;
+        merge_after_frees_ = 1;
+        stats_ = SlabAllocatorStats();
+    }
+
+    void takeFrom(SlabAllocator& other) {
+        slabs_ = other.slabs_;
+        carved_ = other.carved_;
+        for (fl::size i = 0; i < NUM_CLASSES; ++i) {
+            free_lists_[i] = other.free_lists_[i];
+        }
+        total_allocated_ = other.total_allocated_;
+        total_deallocated_ = other.total_deallocated_;
+        frees_since_merge_ = other.frees_since_merge_;
+        merge_after_frees_ = other.merge_after_frees_;
+        stats_ = other.stats_;
+        other.resetState();
+    }
+
+    void cleanupLocked() {
+        while (slabs_) {
+            Slab* next = slabs_->next;
+            free(slabs_);
+            slabs_ = next;
         }
+        fl::size released = stats_.releasedSlabs;
+        resetState();
+        stats_.releasedSlabs = released;
     }
 
 public:
     // Constructor
-    SlabAllocator() : slabs_(nullptr), total_allocated_(0), total_deallocated_(0) {}
+    SlabAllocator() { resetState(); }
     
     // Destructor
     ~SlabAllocator() {
@@ -323,22 +595,17 @@ public:
     SlabAllocator& operator=(const SlabAllocator&) = delete;
     
     // Movable
-    SlabAllocator(SlabAllocator&& other) noexcept 
-        : slabs_(other.slabs_), total_allocated_(other.total_allocated_), total_deallocated_(other.total_deallocated_) {
-        other.slabs_ = nullptr;
-        other.total_allocated_ = 0;
-        other.total_deallocated_ = 0;
+    SlabAllocator(SlabAllocator&& other) noexcept {
+        Guard guard(other.lock_);
+        takeFrom(other);
     }
     
     SlabAllocator& operator=(SlabAllocator&& other) noexcept {
         if (this != &other) {
-            cleanup();
-            slabs_ = other.slabs_;
-            total_allocated_ = other.total_allocated_;
-            total_deallocated_ = other.total_deallocated_;
-            other.slabs_ = nullptr;
-            other.total_allocated_ = 0;
-            other.total_deallocated_ = 0;
+            Guard guard(lock_);
+            Guard other_guard(other.lock_);
+            cleanupLocked();
+            takeFrom(other);
         }
         return *this;
     }
@@ -347,16 +614,19 @@ public:
         if (n == 0) {
             return nullptr;
         }
-        
-        // Try to allocate from slab first
-        void* ptr = allocateFromSlab(n);
-        if (ptr) {
-            fl::memfill(ptr, 0, sizeof(T) * n);
-            return static_cast<T*>(ptr);
+
+        void* ptr = nullptr;
+        if (n <= BLOCKS_PER_SLAB) {
+            Guard guard(lock_);
+            ptr = allocateFromSlab(n);
+        } else {
+            // Fall back to regular malloc for large allocations
+            ptr = malloc(sizeof(T) * n);
+            if (ptr) {
+                Guard guard(lock_);
+                ++stats_.largeAllocations;
+            }
         }
-        
-        // Fall back to regular malloc for large allocations
-        ptr = malloc(sizeof(T) * n);
         if (ptr) {
             fl::memfill(ptr, 0, sizeof(T) * n);
         }
@@ -367,56 +637,61 @@ public:
         if (!ptr) {
             return;
         }
-        
-        // Try to deallocate from slab first
-        bool found_in_slab = false;
-        for (Slab* slab = slabs_; slab; slab = slab->next) {
-            u8* slab_start = slab->memory;
-            u8* slab_end = slab_start + SLAB_MEMORY_SIZE;
-            u8* block_ptr = fl::bit_cast_ptr<u8>(static_cast<void*>(ptr));
-            
-            if (block_ptr >= slab_start && block_ptr < slab_end) {
-                deallocateToSlab(ptr, n);
-                found_in_slab = true;
-                break;
-            }
-        }
-        
-        if (!found_in_slab) {
+        if (n > BLOCKS_PER_SLAB) {
             // This was allocated with regular malloc
             free(ptr);
+            Guard guard(lock_);
+            if (stats_.largeAllocations > 0) {
+                --stats_.largeAllocations;
+            }
+            return;
         }
+        Guard guard(lock_);
+        deallocateToSlab(ptr, n);
+    }
+
+    // Merges free runs and hands fully free slabs back to the heap, keeping
+    // one empty slab around. Returns the number of slabs released.
+    fl::size trim() {
+        Guard guard(lock_);
+        return mergeFreeRuns(RETAINED_EMPTY_SLABS);
     }
 
     // Get allocation statistics
-    fl::size getTotalAllocated() const { return total_allocated_; }
-    fl::size getTotalDeallocated() const { return total_deallocated_; }
-    fl::size getActiveAllocations() const { return total_allocated_ - total_deallocated_; }
+    fl::size getTotalAllocated() const {
+        Guard guard(lock_);
+        return total_allocated_;
+    }
+    fl::size getTotalDeallocated() const {
+        Guard guard(lock_);
+        return total_deallocated_;
+    }
+    fl::size getActiveAllocations() const {
+        Guard guard(lock_);
+        return total_allocated_ - total_deallocated_;
+    }
+    SlabAllocatorStats getStats() const {
+        Guard guard(lock_);
+        return stats_;
+    }
     
     // Get number of slabs
     fl::size getSlabCount() const {
-        fl::size count = 0;
-        for (Slab* slab = slabs_; slab; slab = slab->next) {
-            ++count;
-        }
-        return count;
+        Guard guard(lock_);
+        return stats_.slabCount;
     }
 
-    // Cleanup all slabs
+    // Cleanup all slabs. Every pointer handed out by the slabs becomes
+    // invalid.
     void cleanup() {
-        while (slabs_) {
-            Slab* next = slabs_->next;
-            slabs_->~Slab();
-            free(slabs_);
-            slabs_ = next;
-        }
-        total_allocated_ = 0;
-        total_deallocated_ = 0;
+        Guard guard(lock_);
+        cleanupLocked();
     }
 };
 
 // STL-compatible slab allocator
-template <typename T, fl::size SLAB_SIZE = FASTLED_DEFAULT_SLAB_SIZE>
+template <typename T, fl::size SLAB_SIZE = FASTLED_DEFAULT_SLAB_SIZE,
+          typename Lock = SlabNoLock>
 class allocator_slab {
 public:
     // Type definitions required by STL
@@ -433,8 +708,8 @@ public:
     struct rebind {
         using other = typename fl::conditional<
             fl::is_same<U, void>::value,
-            allocator_slab<char, SLAB_SIZE>,
-            allocator_slab<U, SLAB_SIZE>
+            allocator_slab<char, SLAB_SIZE, Lock>,
+            allocator_slab<U, SLAB_SIZE, Lock>
         >::type;
     };
 
@@ -454,7 +729,7 @@ public:
 
     // Template copy constructor
     template <typename U>
-    allocator_slab(const allocator_slab<U, SLAB_SIZE>& other) noexcept {
+    allocator_slab(const allocator_slab<U, SLAB_SIZE, Lock>& other) noexcept {
         FASTLED_UNUSED(other);
     }
 
@@ -463,8 +738,8 @@ public:
 
 private:
     // Get the shared static allocator instance
-    static SlabAllocator<T, SLAB_SIZE>& get_allocator() {
-        static SlabAllocator<T, SLAB_SIZE> allocator;
+    static SlabAllocator<T, SLAB_SIZE, Lock>& get_allocator() {
+        static SlabAllocator<T, SLAB_SIZE, Lock> allocator;
         return allocator;
     }
 
@@ -472,15 +747,13 @@ public:
     // Allocate memory for n objects of type T
     T* allocate(fl::size n) {
         // Use a static allocator instance per type/size combination
-        SlabAllocator<T, SLAB_SIZE>& allocator = get_allocator();
-        return allocator.allocate(n);
+        return get_allocator().allocate(n);
     }
 
     // Deallocate memory for n objects of type T
     void deallocate(T* p, fl::size n) {
         // Use the same static allocator instance
-        SlabAllocator<T, SLAB_SIZE>& allocator = get_allocator();
-        allocator.deallocate(p, n);
+        get_allocator().deallocate(p, n);
     }
 
     // Construct an object at the specified address
@@ -497,11 +770,20 @@ public:
         p->~U();
     }
 
-    // Cleanup method to clean up the static slab allocator
-    void cleanup() {
-        // Access the same static allocator instance and clean it up
-        static SlabAllocator<T, SLAB_SIZE> allocator;
-        allocator.cleanup();
+    // The slab allocator is shared by every container of this type, so one
+    // container going away must not release or reorganize it. trim() hands
+    // empty slabs back to the heap when the caller chooses.
+    void cleanup() {}
+
+    // Merges free runs of the shared allocator and releases its empty
+    // slabs, see SlabAllocator::trim().
+    static fl::size trim() {
+        return get_allocator().trim();
+    }
+
+    // Statistics of the shared allocator.
+    static SlabAllocatorStats stats() {
+        return get_allocator().getStats();
     }
 
     // Equality comparison
@@ -93,103 +93,182 @@ Scheduler& Scheduler::instance() {
 }
 
 int Scheduler::add_task(task t) {
-    if (t.get_impl()) {
-        t.get_impl()->mTaskId = mNextTaskId++;
-        int task_id = t.get_impl()->mTaskId;
-        mTasks.push_back(fl::move(t));
-        return task_id;
+    TaskImpl* impl = t.get_impl().get();
+    if (!impl) {
+        return 0; // Invalid task
     }
-    return 0; // Invalid task
+    if (impl->mSlot >= 0) {
+        return impl->mTaskId; // Already registered
+    }
+    impl->mTaskId = mNextTaskId++;
+    if (impl->is_canceled()) {
+        return impl->mTaskId;
+    }
+
+    fl::u32 slot;
+    if (!mFreeSlots.empty()) {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    } else {
+        slot = static_cast<fl::u32>(mSlots.size());
+        mSlots.push_back(Slot());
+    }
+    impl->mSlot = static_cast<int>(slot);
+    mSlots[slot].t = fl::move(t);
+
+    switch (impl->type()) {
+    case TaskType::kBeforeFrame:
+        mBeforeFrame.push_back(issue(slot));
+        break;
+    case TaskType::kAfterFrame:
+        mAfterFrame.push_back(issue(slot));
+        break;
+    default:
+        schedule(slot);
+        break;
+    }
+    return impl->mTaskId;
 }
 
 void Scheduler::update() {
-    uint32_t current_time = fl::time();
-    
-    // Use index-based iteration to avoid iterator invalidation issues
-    for (fl::size i = 0; i < mTasks.size();) {
-        task& t = mTasks[i];
-        auto impl = t.get_impl();
-        
-        if (!impl || impl->is_canceled()) {
-            // erase() returns bool in HeapVector, not iterator
-            mTasks.erase(mTasks.begin() + i);
-            // Don't increment i since we just removed an element
+    const fl::u32 current_time = fl::time();
+    mUpdating = true;
+    while (!mTimers.empty()) {
+        const TimerEntry top = mTimers.top();
+        if (!is_live(top.ticket)) {
+            mTimers.pop(); // cancelled or rescheduled since it was queued
+            continue;
+        }
+        if (static_cast<fl::i32>(top.due - current_time) > 0) {
+            break; // nothing else is due yet
+        }
+        mTimers.pop();
+
+        // Keep the task alive while it runs, its callback may cancel it.
+        shared_ptr<TaskImpl> impl = mSlots[top.ticket.slot].t.get_impl();
+        impl->mLastRunTime = current_time;
+        if (impl->type() == TaskType::kAfterMs) {
+            release(top.ticket.slot); // one-shot
         } else {
-            // Check if task is ready to run (frame tasks will return false here)
-            bool should_run = impl->ready_to_run(current_time);
-
-            if (should_run) {
-                // Update last run time for recurring tasks
-                impl->set_last_run_time(current_time);
-                
-                // Execute the task
-                if (impl->has_then()) {
-                    impl->execute_then();
-                } else {
-                    warn_no_then(impl->id(), impl->trace_label());
-                }
-                
-                // Remove one-shot tasks, keep recurring ones
-                bool is_recurring = (impl->type() == TaskType::kEveryMs || impl->type() == TaskType::kAtFramerate);
-                if (is_recurring) {
-                    ++i; // Keep recurring tasks
-                } else {
-                    // erase() returns bool in HeapVector, not iterator
-                    mTasks.erase(mTasks.begin() + i);
-                    // Don't increment i since we just removed an element
-                }
-            } else {
-                ++i;
-            }
+            // Scheduling it again also invalidates any other heap entry for
+            // this slot.
+            schedule(top.ticket.slot);
         }
+        execute(*impl);
     }
+    mUpdating = false;
+
+    for (const Ticket& ticket : mDeferred) {
+        if (!is_live(ticket)) {
+            continue;
+        }
+        const TaskImpl& impl = *mSlots[ticket.slot].t.get_impl();
+        mTimers.push(TimerEntry{next_due(impl, current_time), ticket});
+    }
+    mDeferred.clear();
 }
 
 void Scheduler::update_before_frame_tasks() {
-    update_tasks_of_type(TaskType::kBeforeFrame);
+    run_frame_tasks(mBeforeFrame);
 }
 
 void Scheduler::update_after_frame_tasks() {
-    update_tasks_of_type(TaskType::kAfterFrame);
+    run_frame_tasks(mAfterFrame);
 }
 
-void Scheduler::update_tasks_of_type(TaskType task_type) {
-    uint32_t current_time = fl::time();
-    
-    // Use index-based iteration to avoid iterator invalidation issues
-    for (fl::size i = 0; i < mTasks.size();) {
-        task& t = mTasks[i];
-        auto impl = t.get_impl();
-        
-        if (!impl || impl->is_canceled()) {
-            // erase() returns bool in HeapVector, not iterator
-            mTasks.erase(mTasks.begin() + i);
-            // Don't increment i since we just removed an element
-        } else if (impl->type() == task_type) {
-            // This is a frame task of the type we're looking for
-            bool should_run = impl->ready_to_run_frame_task(current_time);
-
-            if (should_run) {
-                // Update last run time for frame tasks (though they don't use it)
-                impl->set_last_run_time(current_time);
-                
-                // Execute the task
-                if (impl->has_then()) {
-                    impl->execute_then();
-                } else {
-                    warn_no_then(impl->id(), impl->trace_label());
-                }
-                
-                // Frame tasks are always one-shot, so remove them after execution
-                mTasks.erase(mTasks.begin() + i);
-                // Don't increment i since we just removed an element
-            } else {
-                ++i;
-            }
-        } else {
-            ++i; // Not the task type we're looking for
+void Scheduler::clear_all_tasks() {
+    for (Slot& s : mSlots) {
+        if (TaskImpl* impl = s.t.get_impl().get()) {
+            impl->mSlot = -1;
         }
     }
+    mSlots.clear();
+    mFreeSlots.clear();
+    mTimers = fl::PriorityQueue<TimerEntry, DueLater>();
+    mDeferred.clear();
+    mBeforeFrame.clear();
+    mAfterFrame.clear();
+    mNextTaskId = 1;
+}
+
+void Scheduler::run_frame_tasks(fl::vector<Ticket>& queue) {
+    const fl::u32 current_time = fl::time();
+    // Tasks queued by these callbacks go into the now empty queue and run
+    // with the next frame.
+    fl::vector<Ticket> batch;
+    batch.swap(queue);
+    for (const Ticket& ticket : batch) {
+        if (!is_live(ticket)) {
+            continue;
+        }
+        shared_ptr<TaskImpl> impl = mSlots[ticket.slot].t.get_impl();
+        release(ticket.slot); // frame tasks are one-shot
+        impl->mLastRunTime = current_time;
+        execute(*impl);
+    }
+    if (queue.empty()) {
+        batch.clear();
+        queue.swap(batch); // keep the allocation for the next frame
+    }
+}
+
+Scheduler::Ticket Scheduler::issue(fl::u32 slot) {
+    fl::u32 stamp = mNextStamp++;
+    if (stamp == 0) {
+        stamp = mNextStamp++; // 0 marks a free slot
+    }
+    mSlots[slot].stamp = stamp;
+    return Ticket{stamp, slot};
+}
+
+void Scheduler::schedule(fl::u32 slot) {
+    const Ticket ticket = issue(slot);
+    if (mUpdating) {
+        mDeferred.push_back(ticket);
+        return;
+    }
+    const TaskImpl& impl = *mSlots[slot].t.get_impl();
+    mTimers.push(TimerEntry{next_due(impl, fl::time()), ticket});
+}
+
+fl::u32 Scheduler::next_due(const TaskImpl& impl, fl::u32 current_time) {
+    // Same rule as TaskImpl::ready_to_run(): never run or no interval means
+    // due now, otherwise one interval after the last run.
+    if (impl.mIntervalMs <= 0 || impl.mLastRunTime == UINT32_MAX) {
+        return current_time;
+    }
+    return impl.mLastRunTime + static_cast<fl::u32>(impl.mIntervalMs);
+}
+
+void Scheduler::release(fl::u32 slot) {
+    Slot& s = mSlots[slot];
+    if (TaskImpl* impl = s.t.get_impl().get()) {
+        impl->mSlot = -1;
+    }
+    s.t = task();
+    s.stamp = 0;
+    mFreeSlots.push_back(slot);
+}
+
+void Scheduler::execute(TaskImpl& impl) {
+    if (impl.has_then()) {
+        impl.execute_then();
+    } else {
+        warn_no_then(impl.id(), impl.trace_label());
+    }
+}
+
+void Scheduler::on_canceled(TaskImpl& impl) {
+    if (impl.mSlot >= 0) {
+        release(static_cast<fl::u32>(impl.mSlot));
+    }
+}
+
+void Scheduler::on_last_run_time_changed(TaskImpl& impl) {
+    const bool timed = impl.type() != TaskType::kBeforeFrame && impl.type() != TaskType::kAfterFrame;
+    if (impl.mSlot >= 0 && timed) {
+        schedule(static_cast<fl::u32>(impl.mSlot));
+    }
 }
 
 void Scheduler::warn_no_then(int task_id, const fl::string& trace_label) {
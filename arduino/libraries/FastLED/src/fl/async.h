@@ -50,6 +50,8 @@
 #include "fl/promise.h"
 #include "fl/promise_result.h"
 #include "fl/singleton.h"
+#include "fl/priority_queue.h"
+#include "fl/int.h"
 #include "fl/thread_local.h"
 
 #include "fl/task.h"
@@ -229,6 +231,13 @@ fl::result<T> await_top_level(fl::promise<T> promise) {
     }
 }
 
+/// @brief Runs fl::task callbacks.
+///
+/// Timed tasks (every_ms, at_framerate, after_ms) wait in a min-heap ordered by the
+/// time they next come due, so update() only touches tasks that actually
+/// run. Frame tasks are kept in one queue per event. Registered tasks live
+/// in a slot table; cancelling one frees its slot right away and any heap
+/// entry still pointing at the slot is skipped when it reaches the top.
 class Scheduler {
 public:
     static Scheduler& instance();
@@ -239,22 +248,72 @@ public:
     // New methods for frame task handling
     void update_before_frame_tasks();
     void update_after_frame_tasks();
+
+    // Number of registered tasks that have not finished or been cancelled.
+    fl::size task_count() const { return mSlots.size() - mFreeSlots.size(); }
     
     // For testing: clear all tasks
-    void clear_all_tasks() { mTasks.clear(); mNextTaskId = 1; }
+    void clear_all_tasks();
 
 private:
     friend class fl::Singleton<Scheduler>;
-    Scheduler() : mTasks() {}
+    friend class TaskImpl;
+    Scheduler() = default;
+
+    // Refers to a registered task. Slots are reused, so a ticket is only
+    // valid while its stamp matches the slot's.
+    struct Ticket {
+        fl::u32 stamp;
+        fl::u32 slot;
+    };
+    struct TimerEntry {
+        fl::u32 due;
+        Ticket ticket;
+    };
+    // Orders the heap so the entry due first is on top. Times are compared
+    // through their signed difference so the millisecond clock may wrap.
+    struct DueLater {
+        bool operator()(const TimerEntry& a, const TimerEntry& b) const {
+            const fl::i32 d = static_cast<fl::i32>(a.due - b.due);
+            if (d != 0) {
+                return d > 0;
+            }
+            return static_cast<fl::i32>(a.ticket.stamp - b.ticket.stamp) > 0;
+        }
+    };
+    struct Slot {
+        task t;
+        fl::u32 stamp = 0; // 0 while the slot is free
+    };
 
     void warn_no_then(int task_id, const fl::string& trace_label);
     void warn_no_catch(int task_id, const fl::string& trace_label, const Error& error);
-    
-    // Helper method for running specific task types
-    void update_tasks_of_type(TaskType task_type);
 
-    fl::vector<task> mTasks;
+    bool is_live(const Ticket& ticket) const {
+        return ticket.slot < mSlots.size() && mSlots[ticket.slot].stamp == ticket.stamp;
+    }
+    Ticket issue(fl::u32 slot);
+    void schedule(fl::u32 slot);
+    static fl::u32 next_due(const TaskImpl& impl, fl::u32 current_time);
+    void release(fl::u32 slot);
+    void execute(TaskImpl& impl);
+    void run_frame_tasks(fl::vector<Ticket>& queue);
+
+    // Called by TaskImpl for registered tasks.
+    void on_canceled(TaskImpl& impl);
+    void on_last_run_time_changed(TaskImpl& impl);
+
+    fl::vector<Slot> mSlots;
+    fl::vector<fl::u32> mFreeSlots;
+    fl::PriorityQueue<TimerEntry, DueLater> mTimers;
+    // Timed tasks scheduled while update() runs. They join the heap once it
+    // is done, so a task runs at most once per update.
+    fl::vector<Ticket> mDeferred;
+    fl::vector<Ticket> mBeforeFrame;
+    fl::vector<Ticket> mAfterFrame;
+    fl::u32 mNextStamp = 1;
     int mNextTaskId = 1;
+    bool mUpdating = false;
 };
 
 } // namespace fl 
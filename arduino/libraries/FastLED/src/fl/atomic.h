@@ -3,24 +3,63 @@
 #include "fl/thread.h"
 #include "fl/int.h"
 #include "fl/align.h"
+#include "fl/has_include.h"
 
-#if FASTLED_MULTITHREADED
-#include <atomic>
+#if FASTLED_MULTITHREADED && FL_HAS_INCLUDE(<atomic>)
+#define FL_ATOMIC_USE_STD 1
+#include <atomic>  // ok include
+#else
+#define FL_ATOMIC_USE_STD 0
 #endif
 
-namespace fl {
+// GCC and Clang provide __atomic builtins on every target FastLED builds
+// for, including the dual core ESP32 parts.
+#ifndef FL_HAS_ATOMIC_BUILTINS
+#if defined(__GNUC__) || defined(__clang__)
+#define FL_HAS_ATOMIC_BUILTINS 1
+#else
+#define FL_HAS_ATOMIC_BUILTINS 0
+#endif
+#endif
 
+namespace fl {
 
+template <typename T> class AtomicFake;
+template <typename T> class AtomicBuiltin;
 
-#if FASTLED_MULTITHREADED
+// fl::atomic is a real atomic when FASTLED_MULTITHREADED is set and a no-op
+// wrapper otherwise. Data shared with another core or an ISR on builds that
+// are not FASTLED_MULTITHREADED should use AtomicBuiltin directly.
+#if FL_ATOMIC_USE_STD
 template <typename T>
 using atomic = std::atomic<T>;
+#elif FASTLED_MULTITHREADED && FL_HAS_ATOMIC_BUILTINS
+template <typename T>
+using atomic = AtomicBuiltin<T>;
 #else
-template <typename T> class AtomicFake;
 template <typename T>
 using atomic = AtomicFake<T>;
 #endif
 
+// Memory orders usable with fl::atomic, AtomicBuiltin and AtomicFake alike.
+#if FL_ATOMIC_USE_STD
+using memory_order = std::memory_order;
+constexpr memory_order memory_order_relaxed = std::memory_order_relaxed;
+constexpr memory_order memory_order_acquire = std::memory_order_acquire;
+constexpr memory_order memory_order_release = std::memory_order_release;
+constexpr memory_order memory_order_acq_rel = std::memory_order_acq_rel;
+constexpr memory_order memory_order_seq_cst = std::memory_order_seq_cst;
+#else
+// Same values as the std enumerators and the __ATOMIC_* constants.
+enum memory_order {
+    memory_order_relaxed = 0,
+    memory_order_acquire = 2,
+    memory_order_release = 3,
+    memory_order_acq_rel = 4,
+    memory_order_seq_cst = 5
+};
+#endif
+
 using atomic_bool = atomic<bool>;
 using atomic_int = atomic<int>;
 using atomic_uint = atomic<unsigned int>;
@@ -41,21 +80,26 @@ template <typename T> class AtomicFake {
     AtomicFake& operator=(AtomicFake&&) = delete;
     
     // Basic atomic operations - fake implementation (not actually atomic)
-    T load() const {
+    T load(memory_order order = memory_order_seq_cst) const {
+        (void)order;
         return mValue;
     }
     
-    void store(T value) {
+    void store(T value, memory_order order = memory_order_seq_cst) {
+        (void)order;
         mValue = value;
     }
     
-    T exchange(T value) {
+    T exchange(T value, memory_order order = memory_order_seq_cst) {
+        (void)order;
         T old = mValue;
         mValue = value;
         return old;
     }
     
-    bool compare_exchange_weak(T& expected, T desired) {
+    bool compare_exchange_weak(T& expected, T desired,
+                               memory_order order = memory_order_seq_cst) {
+        (void)order;
         if (mValue == expected) {
             mValue = desired;
             return true;
@@ -65,8 +109,9 @@ template <typename T> class AtomicFake {
         }
     }
     
-    bool compare_exchange_strong(T& expected, T desired) {
-        return compare_exchange_weak(expected, desired);
+    bool compare_exchange_strong(T& expected, T desired,
+                                 memory_order order = memory_order_seq_cst) {
+        return compare_exchange_weak(expected, desired, order);
     }
     
     // Assignment operator
@@ -123,13 +168,15 @@ template <typename T> class AtomicFake {
     }
     
     // Fetch operations
-    T fetch_add(T value) {
+    T fetch_add(T value, memory_order order = memory_order_seq_cst) {
+        (void)order;
         T old = mValue;
         mValue += value;
         return old;
     }
     
-    T fetch_sub(T value) {
+    T fetch_sub(T value, memory_order order = memory_order_seq_cst) {
+        (void)order;
         T old = mValue;
         mValue -= value;
         return old;
@@ -157,4 +204,101 @@ template <typename T> class AtomicFake {
     FL_ALIGN_AS(T) T mValue;
 };
 
+#if FL_HAS_ATOMIC_BUILTINS
+
+// Atomic on the compiler's __atomic builtins. Unlike fl::atomic it is
+// always real, whatever FASTLED_MULTITHREADED says, so it is what lock-free
+// structures shared between cores use. T must be a bool, integer, enum or
+// pointer no wider than 8 bytes; wider types may fall back to a libatomic
+// call on some targets.
+template <typename T> class AtomicBuiltin {
+  public:
+    AtomicBuiltin() : mValue{} {}
+    explicit AtomicBuiltin(T value) : mValue(value) {}
+
+    AtomicBuiltin(const AtomicBuiltin&) = delete;
+    AtomicBuiltin& operator=(const AtomicBuiltin&) = delete;
+
+    T load(memory_order order = memory_order_seq_cst) const {
+        return __atomic_load_n(&mValue, static_cast<int>(order));
+    }
+
+    void store(T value, memory_order order = memory_order_seq_cst) {
+        __atomic_store_n(&mValue, value, static_cast<int>(order));
+    }
+
+    T exchange(T value, memory_order order = memory_order_seq_cst) {
+        return __atomic_exchange_n(&mValue, value, static_cast<int>(order));
+    }
+
+    bool compare_exchange_weak(T& expected, T desired,
+                               memory_order order = memory_order_seq_cst) {
+        return __atomic_compare_exchange_n(&mValue, &expected, desired, true,
+                                           static_cast<int>(order),
+                                           failure_order(order));
+    }
+
+    bool compare_exchange_strong(T& expected, T desired,
+                                 memory_order order = memory_order_seq_cst) {
+        return __atomic_compare_exchange_n(&mValue, &expected, desired, false,
+                                           static_cast<int>(order),
+                                           failure_order(order));
+    }
+
+    T fetch_add(T value, memory_order order = memory_order_seq_cst) {
+        return __atomic_fetch_add(&mValue, value, static_cast<int>(order));
+    }
+
+    T fetch_sub(T value, memory_order order = memory_order_seq_cst) {
+        return __atomic_fetch_sub(&mValue, value, static_cast<int>(order));
+    }
+
+    T fetch_and(T value, memory_order order = memory_order_seq_cst) {
+        return __atomic_fetch_and(&mValue, value, static_cast<int>(order));
+    }
+
+    T fetch_or(T value, memory_order order = memory_order_seq_cst) {
+        return __atomic_fetch_or(&mValue, value, static_cast<int>(order));
+    }
+
+    T fetch_xor(T value, memory_order order = memory_order_seq_cst) {
+        return __atomic_fetch_xor(&mValue, value, static_cast<int>(order));
+    }
+
+    T operator=(T value) {
+        store(value);
+        return value;
+    }
+
+    operator T() const { return load(); }
+
+    T operator++() { return fetch_add(1) + 1; }
+    T operator++(int) { return fetch_add(1); }
+    T operator--() { return fetch_sub(1) - 1; }
+    T operator--(int) { return fetch_sub(1); }
+    T operator+=(T value) { return fetch_add(value) + value; }
+    T operator-=(T value) { return fetch_sub(value) - value; }
+    T operator&=(T value) { return fetch_and(value) & value; }
+    T operator|=(T value) { return fetch_or(value) | value; }
+    T operator^=(T value) { return fetch_xor(value) ^ value; }
+
+  private:
+    // A failed compare-exchange only loads, so it may not use a release
+    // order.
+    static int failure_order(memory_order order) {
+        if (order == memory_order_acq_rel) {
+            return static_cast<int>(memory_order_acquire);
+        }
+        if (order == memory_order_release) {
+            return static_cast<int>(memory_order_relaxed);
+        }
+        return static_cast<int>(order);
+    }
+
+    // Naturally aligned, which the builtins need to be lock-free.
+    alignas(sizeof(T) >= 8 ? 8 : sizeof(T) >= 4 ? 4 : sizeof(T) >= 2 ? 2 : 1) T mValue;
+};
+
+#endif // FL_HAS_ATOMIC_BUILTINS
+
 } // namespace fl
@@ -59,12 +59,11 @@ AudioSample::~AudioSample() {
     }
 }
 
-const AudioSample::VectorPCM &AudioSample::pcm() const {
+AudioSample::PCM AudioSample::pcm() const {
     if (isValid()) {
         return mImpl->pcm();
     }
-    static VectorPCM empty;
-    return empty;
+    return PCM();
 }
 
 AudioSample &AudioSample::operator=(const AudioSample &other) {
@@ -83,7 +82,8 @@ const fl::i16 &AudioSample::at(fl::size i) const {
     if (i < size()) {
         return pcm()[i];
     }
-    return empty()[0];
+    static const fl::i16 zero = 0;
+    return zero;
 }
 
 const fl::i16 &AudioSample::operator[](fl::size i) const { return at(i); }
@@ -110,12 +110,6 @@ bool AudioSample::operator!=(const AudioSample &other) const {
     return !(*this == other);
 }
 
-const AudioSample::VectorPCM &AudioSample::empty() {
-    static fl::i16 empty_data[1] = {0};
-    static VectorPCM empty(empty_data);
-    return empty;
-}
-
 float AudioSample::zcf() const { return mImpl->zcf(); }
 
 fl::u32 AudioSample::timestamp() const {
@@ -125,18 +119,14 @@ fl::u32 AudioSample::timestamp() const {
     return 0;
 }
 
-float AudioSample::rms() const {
-    if (!isValid()) {
-        return 0.0f;
-    }
-    fl::u64 sum_sq = 0;
-    const int N = size();
-    for (int i = 0; i < N; ++i) {
-        fl::i32 x32 = fl::i32(pcm()[i]);
-        sum_sq += x32 * x32;
+float AudioSample::rms() const { return stats().rms(); }
+
+const AudioStats &AudioSample::stats() const {
+    if (isValid()) {
+        return mImpl->stats();
     }
-    float rms = sqrtf(float(sum_sq) / N);
-    return rms;
+    static const AudioStats empty_stats;
+    return empty_stats;
 }
 
 SoundLevelMeter::SoundLevelMeter(double spl_floor, double smoothing_alpha)
@@ -145,14 +135,12 @@ SoundLevelMeter::SoundLevelMeter(double spl_floor, double smoothing_alpha)
       current_spl_(spl_floor) {}
 
 void SoundLevelMeter::processBlock(const fl::i16 *samples, fl::size count) {
-    // 1) compute block power → dBFS
-    double sum_sq = 0.0;
-    for (fl::size i = 0; i < count; ++i) {
-        double s = samples[i] / 32768.0; // normalize to ±1
-        sum_sq += s * s;
-    }
-    double p = sum_sq / count; // mean power
-    double dbfs = 10.0 * log10(p + 1e-12);
+    processStats(AudioStats::compute(fl::span<const fl::i16>(samples, count)));
+}
+
+void SoundLevelMeter::processStats(const AudioStats &stats) {
+    // 1) block power → dBFS
+    double dbfs = stats.dbfs();
     current_dbfs_ = dbfs;
 
     // 2) update global floor (with optional smoothing)
@@ -190,5 +178,12 @@ AudioSample::AudioSample(fl::span<const fl::i16> span, fl::u32 timestamp) {
     mImpl->assign(begin, end, timestamp);
 }
 
+AudioSample::AudioSample(fl::span<const fl::i16> span, fl::u32 timestamp,
+                         const fl::shared_ptr<AudioBufferOwner> &owner,
+                         fl::u32 token) {
+    mImpl = AudioSamplePool::instance().getOrCreate();
+    mImpl->borrow(span, timestamp, owner, token);
+}
+
 
 } // namespace fl
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "fl/audio_stats.h"
 #include "fl/fft.h"
 #include "fl/math.h"
 #include "fl/memory.h"
@@ -16,13 +17,23 @@ class AudioSampleImpl;
 
 FASTLED_SMART_PTR(AudioSampleImpl);
 
+// Lends sample memory to AudioSample without copying, e.g. a ring of DMA
+// buffers. releaseBuffer(token) is called once the last AudioSample using
+// the buffer is gone, from whichever thread drops it.
+class AudioBufferOwner {
+  public:
+    virtual ~AudioBufferOwner() {}
+    virtual void releaseBuffer(fl::u32 token) = 0;
+};
+
 // AudioSample is a wrapper around AudioSampleImpl, hiding the reference
 // counting so that the api object can be simple and have standard object
 // semantics.
 class AudioSample {
   public:
     using VectorPCM = fl::vector<fl::i16>;
-    using const_iterator = VectorPCM::const_iterator;
+    using PCM = fl::span<const fl::i16>;
+    using const_iterator = const fl::i16 *;
     AudioSample() {}
     AudioSample(const AudioSample &other) : mImpl(other.mImpl) {}
     AudioSample(AudioSampleImplPtr impl) : mImpl(impl) {}
@@ -31,17 +42,26 @@ class AudioSample {
     // Constructor that takes raw audio data and handles pooling internally
     AudioSample(fl::span<const fl::i16> span, fl::u32 timestamp = 0);
 
+    // Wraps `span` without copying. The memory belongs to `owner`, which
+    // gets `token` back through releaseBuffer() when the last copy of this
+    // sample is destroyed.
+    AudioSample(fl::span<const fl::i16> span, fl::u32 timestamp,
+                const fl::shared_ptr<AudioBufferOwner> &owner, fl::u32 token);
+
 
     AudioSample &operator=(const AudioSample &other);
     bool isValid() const { return mImpl != nullptr; }
 
     fl::size size() const;
-    // Raw pcm levels.
-    const VectorPCM &pcm() const;
+    // Raw pcm levels, either a copy owned by the sample or borrowed memory.
+    PCM pcm() const;
     // Zero crossing factor between 0.0f -> 1.0f, detects "hiss"
     // and sounds like cloths rubbing. Useful for sound analysis.
     float zcf() const;
     float rms() const;
+    // Level statistics of the whole sample, computed once when it is
+    // created; zcf() and rms() come from here.
+    const AudioStats &stats() const;
     fl::u32 timestamp() const;  // Timestamp when sample became valid (millis)
 
     void fft(FFTBins *out) const;
@@ -55,7 +75,6 @@ class AudioSample {
     bool operator!=(const AudioSample &other) const;
 
   private:
-    static const VectorPCM &empty();
     AudioSampleImplPtr mImpl;
 };
 
@@ -77,6 +96,9 @@ class SoundLevelMeter {
             void processBlock(fl::span<const fl::i16> samples) {
         processBlock(samples.data(), samples.size());
     }
+    /// Process a block that has already been measured, e.g.
+    /// AudioSample::stats(), without another pass over the samples.
+    void processStats(const AudioStats &stats);
 
     /// @returns most recent block’s level in dBFS (≤ 0)
     double getDBFS() const { return current_dbfs_; }
@@ -109,23 +131,39 @@ class SoundLevelMeter {
 class AudioSampleImpl {
   public:
     using VectorPCM = fl::vector<fl::i16>;
-    ~AudioSampleImpl() {}
+    ~AudioSampleImpl() { releaseBorrowed(); }
     // template <typename It> void assign(It begin, It end) {
     //     assign(begin, end, 0);  // Default timestamp to 0
     // }
     template <typename It> void assign(It begin, It end, fl::u32 timestamp) {
+        releaseBorrowed();
         mSignedPcm.assign(begin, end);
+        mPcm = fl::span<const fl::i16>(mSignedPcm.data(), mSignedPcm.size());
         mTimestamp = timestamp;
-        // calculate zero crossings
-        initZeroCrossings();
+        // zero crossings, rms and peak in one pass
+        mStats = AudioStats::compute(mPcm);
     }
-    const VectorPCM &pcm() const { return mSignedPcm; }
+    // Uses `pcm` in place until reset(), then hands `token` back to owner.
+    void borrow(fl::span<const fl::i16> pcm, fl::u32 timestamp,
+                const fl::shared_ptr<AudioBufferOwner> &owner, fl::u32 token) {
+        releaseBorrowed();
+        mSignedPcm.clear();
+        mPcm = pcm;
+        mOwner = owner;
+        mToken = token;
+        mTimestamp = timestamp;
+        mStats = AudioStats::compute(mPcm);
+    }
+    fl::span<const fl::i16> pcm() const { return mPcm; }
     fl::u32 timestamp() const { return mTimestamp; }
+    const AudioStats &stats() const { return mStats; }
     
     // For object pool - reset internal state for reuse
     void reset() {
+        releaseBorrowed();
         mSignedPcm.clear();
-        mZeroCrossings = 0;
+        mPcm = fl::span<const fl::i16>();
+        mStats = AudioStats();
         mTimestamp = 0;
     }
 
@@ -138,31 +176,23 @@ class AudioSampleImpl {
     // signals to reject or accept a sound signal.
     //
     // Returns: a value -> [0.0f, 1.0f)
-    float zcf() const {
-        const fl::size n = pcm().size();
-        if (n < 2) {
-            return 0.f;
-        }
-        return float(mZeroCrossings) / static_cast<float>(n - 1);
-    }
+    float zcf() const { return mStats.zcf(); }
 
   private:
-    void initZeroCrossings() {
-        mZeroCrossings = 0;
-        if (mSignedPcm.size() > 1) {
-            for (fl::size i = 1; i < mSignedPcm.size(); ++i) {
-                const bool crossed =
-                    (mSignedPcm[i - 1] < 0 && mSignedPcm[i] >= 0) ||
-                    (mSignedPcm[i - 1] >= 0 && mSignedPcm[i] < 0);
-                if (crossed) {
-                    ++mZeroCrossings;
-                }
-            }
+    void releaseBorrowed() {
+        if (mOwner) {
+            fl::shared_ptr<AudioBufferOwner> owner;
+            owner.swap(mOwner);
+            mPcm = fl::span<const fl::i16>();
+            owner->releaseBuffer(mToken);
         }
     }
 
     VectorPCM mSignedPcm;
-    fl::i16 mZeroCrossings = 0;
+    fl::span<const fl::i16> mPcm; // mSignedPcm or borrowed memory
+    fl::shared_ptr<AudioBufferOwner> mOwner;
+    fl::u32 mToken = 0;
+    AudioStats mStats;
     fl::u32 mTimestamp = 0;
 };
 
@@ -0,0 +1,140 @@
+#include "fl/audio_analyzer.h"
+
+#include "fl/math_macros.h"
+#include "fl/warn.h"
+#include <math.h>
+
+namespace fl {
+
+AudioAnalyzer::AudioAnalyzer(const AudioAnalyzerConfig &config)
+    : mBins(config.bands) {
+    configure(config);
+}
+
+AudioAnalyzer::~AudioAnalyzer() = default;
+
+void AudioAnalyzer::configure(const AudioAnalyzerConfig &config) {
+    mConfig = config;
+    if (mConfig.windowSize < 2) {
+        mConfig.windowSize = 2;
+    }
+    // kiss_fftr only does even lengths.
+    mConfig.windowSize &= ~1;
+    if (mConfig.hopSize < 1 || mConfig.hopSize > mConfig.windowSize) {
+        FASTLED_WARN("AudioAnalyzer: hop size out of range, using half the window");
+        mConfig.hopSize = mConfig.windowSize / 2;
+    }
+    if (mConfig.bands < 1) {
+        mConfig.bands = 1;
+    }
+    const fl::size n = static_cast<fl::size>(mConfig.windowSize);
+
+    mFFT.reset(new FFTImpl(FFT_Args(mConfig.windowSize, mConfig.bands,
+                                    mConfig.fmin, mConfig.fmax,
+                                    mConfig.sampleRate, mConfig.backend)));
+    mBins = FFTBins(mConfig.bands);
+    mRing.assign(n, 0);
+    mWindowed.assign(n, 0);
+    mTaper.clear();
+    if (mConfig.window == AudioAnalyzerConfig::kHann) {
+        // Periodic Hann: overlapping windows at a hop of N/2 or N/4 sum to a
+        // constant, so every sample carries the same weight.
+        mTaper.resize(n);
+        for (fl::size i = 0; i < n; ++i) {
+            const float w = 0.5f - 0.5f * cosf(2.0f * float(PI) * float(i) / float(n));
+            mTaper[i] = static_cast<fl::i16>(w * 32767.0f + 0.5f);
+        }
+    }
+    for (fl::size i = 0; i < mFrames.size(); ++i) {
+        AudioAnalysisFrame &frame = mFrames.slot(i);
+        frame = AudioAnalysisFrame();
+        frame.bins.assign(static_cast<fl::size>(mConfig.bands), 0.0f);
+    }
+    mSequence = 0;
+    reset();
+}
+
+void AudioAnalyzer::reset() {
+    mWrite = 0;
+    mUntilNext = mRing.size();
+}
+
+fl::size AudioAnalyzer::feed(fl::span<const fl::i16> pcm, fl::u32 timestamp) {
+    const fl::size n = mRing.size();
+    const fl::i16 *src = pcm.data();
+    fl::size remaining = pcm.size();
+    fl::size consumed = 0;
+    fl::size frames = 0;
+    while (remaining) {
+        // Copy straight into the ring up to the next frame boundary or the
+        // end of the ring, whichever comes first.
+        fl::size chunk = remaining < mUntilNext ? remaining : mUntilNext;
+        if (chunk > n - mWrite) {
+            chunk = n - mWrite;
+        }
+        for (fl::size i = 0; i < chunk; ++i) {
+            mRing[mWrite + i] = src[i];
+        }
+        mWrite += chunk;
+        if (mWrite == n) {
+            mWrite = 0;
+        }
+        src += chunk;
+        remaining -= chunk;
+        consumed += chunk;
+        mUntilNext -= chunk;
+        if (mUntilNext == 0) {
+            const fl::u32 offset_ms = static_cast<fl::u32>(
+                fl::u64(consumed - 1) * 1000u / fl::u64(mConfig.sampleRate));
+            analyze(timestamp + offset_ms);
+            mUntilNext = static_cast<fl::size>(mConfig.hopSize);
+            ++frames;
+        }
+    }
+    return frames;
+}
+
+void AudioAnalyzer::analyze(fl::u32 timestamp) {
+    const fl::size n = mRing.size();
+    const bool taper = !mTaper.empty();
+    // Unroll the ring into time order, tapering and measuring on the way.
+    fl::u64 sum_sq = 0;
+    fl::i32 peak = 0;
+    for (fl::size i = 0, j = mWrite; i < n; ++i) {
+        const fl::i32 s = mRing[j];
+        if (++j == n) {
+            j = 0;
+        }
+        sum_sq += static_cast<fl::u64>(s * s);
+        const fl::i32 mag = s < 0 ? -s : s;
+        if (mag > peak) {
+            peak = mag;
+        }
+        mWindowed[i] = taper ? static_cast<fl::i16>((s * mTaper[i]) >> 15)
+                             : static_cast<fl::i16>(s);
+    }
+
+    // mBins has the capacity for every band, so this does not allocate.
+    mFFT->run(fl::span<const fl::i16>(mWindowed.data(), n), &mBins);
+
+    AudioAnalysisFrame &frame = mFrames.back();
+    frame.sequence = ++mSequence;
+    frame.timestamp = timestamp;
+    frame.rms = sqrtf(float(sum_sq) / float(n));
+    frame.peak = float(peak);
+    const fl::size bands = frame.bins.size();
+    for (fl::size i = 0; i < bands; ++i) {
+        frame.bins[i] = i < mBins.bins_raw.size() ? mBins.bins_raw[i] : 0.0f;
+    }
+    if (mOnFrame) {
+        mOnFrame(frame);
+    }
+    mFrames.publish();
+}
+
+const AudioAnalysisFrame &AudioAnalyzer::latest() {
+    mFrames.update();
+    return mFrames.front();
+}
+
+} // namespace fl
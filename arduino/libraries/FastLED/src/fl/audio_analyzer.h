@@ -0,0 +1,104 @@
+#pragma once
+
+#include "fl/fft.h"
+#include "fl/fft_impl.h"
+#include "fl/function.h"
+#include "fl/int.h"
+#include "fl/span.h"
+#include "fl/triple_buffer.h"
+#include "fl/unique_ptr.h"
+#include "fl/vector.h"
+
+namespace fl {
+
+// One analysed window of audio. Frames are produced at a fixed hop through
+// the stream, so their rate depends only on the sample rate and hop size,
+// not on how the samples were delivered.
+struct AudioAnalysisFrame {
+    fl::u32 sequence = 0;   // 1 for the first frame, 0 if none analysed yet
+    fl::u32 timestamp = 0;  // millis() of the last sample in the window
+    float rms = 0.0f;       // of the raw (unwindowed) samples
+    float peak = 0.0f;      // largest absolute sample value
+    fl::vector<float> bins; // constant-Q band magnitudes, windowed
+};
+
+struct AudioAnalyzerConfig {
+    enum Window {
+        kRectangular = 0,
+        kHann = 1,
+    };
+
+    int windowSize = 512;     // samples per FFT, must be even
+    int hopSize = 256;        // samples between FFTs; 256 of 512 = 50% overlap
+    int bands = FFT_Args::DefaultBands();
+    float fmin = FFT_Args::DefaultMinFrequency();
+    float fmax = FFT_Args::DefaultMaxFrequency();
+    int sampleRate = FFT_Args::DefaultSampleRate();
+    Window window = kHann;
+    FFTBackendType backend = FFTBackendType::Default;
+};
+
+// Streaming analyser. PCM of any block size goes in through feed() and
+// lands in a ring buffer; every hopSize samples, once a full window is
+// buffered, the window is tapered, transformed and reduced to band
+// magnitudes. All buffers are sized in configure(), so analysing allocates
+// nothing.
+//
+// feed() and onFrame() belong to the producer (for example the task that
+// reads the I2S driver). The newest frame is published through a triple
+// buffer, so one reader, typically the render loop, can pick it up with
+// latest() without locking and without ever stalling the producer.
+//
+// Example:
+//   AudioAnalyzer analyzer;             // 512 window, 50% overlap
+//   analyzer.feed(sample.pcm(), sample.timestamp());
+//   const AudioAnalysisFrame &f = analyzer.latest();
+class AudioAnalyzer {
+  public:
+    using FrameCallback = fl::function<void(const AudioAnalysisFrame &)>;
+
+    explicit AudioAnalyzer(const AudioAnalyzerConfig &config = AudioAnalyzerConfig());
+    ~AudioAnalyzer();
+
+    AudioAnalyzer(const AudioAnalyzer &) = delete;
+    AudioAnalyzer &operator=(const AudioAnalyzer &) = delete;
+
+    // Rebuilds the buffers and FFT plan and drops buffered samples. Not safe
+    // while feed() or latest() may run on another thread.
+    void configure(const AudioAnalyzerConfig &config);
+    const AudioAnalyzerConfig &config() const { return mConfig; }
+
+    // Forgets buffered samples so the next frame waits for a full window.
+    void reset();
+
+    // Appends samples, `timestamp` being millis() of the first one. Returns
+    // the number of frames analysed.
+    fl::size feed(fl::span<const fl::i16> pcm, fl::u32 timestamp);
+
+    // Called from feed() with each frame before it is published.
+    void onFrame(FrameCallback callback) { mOnFrame = fl::move(callback); }
+
+    // Reader side. The newest published frame; the same frame is returned
+    // until another one is published.
+    const AudioAnalysisFrame &latest();
+
+    // Frames analysed since configure().
+    fl::u32 frameCount() const { return mSequence; }
+
+  private:
+    void analyze(fl::u32 timestamp);
+
+    AudioAnalyzerConfig mConfig;
+    fl::unique_ptr<FFTImpl> mFFT;
+    FFTBins mBins;
+    fl::vector<fl::i16> mRing;    // last windowSize samples, oldest at mWrite
+    fl::vector<fl::i16> mWindowed; // the window in time order, tapered
+    fl::vector<fl::i16> mTaper;   // Q15 window coefficients, empty if rectangular
+    fl::size mWrite = 0;
+    fl::size mUntilNext = 0; // samples still needed before the next frame
+    fl::u32 mSequence = 0;
+    TripleBuffer<AudioAnalysisFrame> mFrames;
+    FrameCallback mOnFrame;
+};
+
+} // namespace fl
@@ -0,0 +1,72 @@
+#ifndef FASTLED_INTERNAL
+#define FASTLED_INTERNAL
+#endif
+
+#include "FastLED.h"  // delay()
+
+#include "fl/audio_bench.h"
+
+#include "fl/time.h"
+
+namespace fl {
+
+AudioBench::AudioBench(PcmStreamInput &input, AudioReactive &audio, Clock clock)
+    : mInput(input), mAudio(audio), mClock(clock) {}
+
+fl::u64 AudioBench::now() const {
+    if (mClock) {
+        return mClock();
+    }
+    return fl::u64(fl::time()) * 1000;
+}
+
+AudioBenchReport AudioBench::run(float maxAudioSeconds) {
+    AudioBenchReport report;
+    if (mClock) {
+        mAudio.setStageClock(mClock);
+        mAudio.resetStageProfile();
+    }
+    mInput.start();
+    const fl::u64 limit =
+        maxAudioSeconds > 0.0f
+            ? fl::u64(double(maxAudioSeconds) * mInput.sampleRate() + 0.5)
+            : 0;
+    while (!mInput.finished() && (limit == 0 || mInput.samplesRead() < limit)) {
+        if (mInput.error(&report.error)) {
+            break;
+        }
+        AudioSample sample = mInput.read();
+        if (!sample.isValid()) {
+            if (mInput.realTime() && !mInput.finished()) {
+                // Waiting for the next block, as a loop() would between
+                // microphone reads.
+                const fl::u32 wait = mInput.msUntilNextBlock();
+                ::delay(wait ? wait : 1);
+            }
+            continue;
+        }
+        const fl::u64 t0 = now();
+        mAudio.processSample(sample);
+        if (mEffect) {
+            mEffect(mAudio);
+        }
+        const fl::u64 spent = now() - t0;
+        report.processUs += spent;
+        if (spent > report.maxBlockUs) {
+            report.maxBlockUs = fl::u32(spent);
+        }
+        ++report.blocks;
+    }
+    mInput.stop();
+    if (mClock) {
+        report.stages = mAudio.getStageProfile();
+        mAudio.setStageClock(AudioReactive::Clock());
+    }
+    report.audioSeconds = mInput.secondsRead();
+    if (report.blocks) {
+        report.meanBlockUs = float(report.processUs) / float(report.blocks);
+    }
+    return report;
+}
+
+} // namespace fl
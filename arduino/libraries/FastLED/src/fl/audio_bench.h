@@ -0,0 +1,64 @@
+#pragma once
+
+#include "fl/audio_input_stream.h"
+#include "fl/audio_reactive.h"
+#include "fl/function.h"
+#include "fl/int.h"
+
+namespace fl {
+
+// What it cost to run AudioReactive plus an effect over a stream.
+struct AudioBenchReport {
+    float audioSeconds = 0.0f; // audio consumed
+    fl::u32 blocks = 0;        // AudioSamples processed
+    fl::u64 processUs = 0;     // total time in AudioReactive and the effect
+    // Processing time per block, from read() returning the samples to the
+    // effect returning. Not the latency of the analysis, which also includes
+    // the block itself (blockSize / sampleRate) and, when streaming, the
+    // rest of the FFT window.
+    float meanBlockUs = 0.0f;
+    fl::u32 maxBlockUs = 0;
+    // Why the input stopped early, empty if it did not fail.
+    fl::string error;
+    // Where AudioReactive spent its time, if the bench has a clock.
+    AudioStageProfile stages;
+
+    // Milliseconds of processing per second of audio.
+    float cpuMsPerAudioSecond() const {
+        return audioSeconds > 0.0f ? float(processUs) / 1000.0f / audioSeconds : 0.0f;
+    }
+    // Percentage of one core needed to keep up in real time.
+    float cpuPercent() const { return cpuMsPerAudioSecond() / 10.0f; }
+};
+
+// Runs an input through AudioReactive and an effect end to end and measures
+// it. The effect runs after every block with the updated AudioReactive, as
+// it would from loop(). Time is measured with `clock`, which returns
+// microseconds (micros() on a device, a steady clock on the host); without
+// one, fl::time() is used at millisecond resolution. With a clock the
+// AudioReactive stages are profiled too.
+class AudioBench {
+  public:
+    using Clock = fl::function<fl::u64()>;
+    using Effect = fl::function<void(const AudioReactive &)>;
+
+    AudioBench(PcmStreamInput &input, AudioReactive &audio, Clock clock = Clock());
+
+    void setEffect(const Effect &effect) { mEffect = effect; }
+
+    // Starts the input and processes it until it ends, fails (see
+    // AudioBenchReport::error) or `maxAudioSeconds` of audio (0 = no limit)
+    // have gone through. In real time mode this takes as long as the audio,
+    // sleeping until each block is due.
+    AudioBenchReport run(float maxAudioSeconds = 0.0f);
+
+  private:
+    fl::u64 now() const;
+
+    PcmStreamInput &mInput;
+    AudioReactive &mAudio;
+    Clock mClock;
+    Effect mEffect;
+};
+
+} // namespace fl
@@ -0,0 +1,87 @@
+#include "fl/audio_dma_ring.h"
+
+namespace fl {
+
+AudioDmaRing::Storage::Storage(fl::size buffers, fl::size samplesPerBuffer)
+    : buffers(buffers), samplesPerBuffer(samplesPerBuffer), overruns(0) {
+    samples.resize(buffers * samplesPerBuffer, 0);
+    for (fl::u32 i = 0; i < buffers; ++i) {
+        freeBuffers.push(i);
+    }
+}
+
+void AudioDmaRing::Storage::releaseBuffer(fl::u32 token) { freeBuffers.push(token); }
+
+AudioDmaRing::AudioDmaRing(fl::size buffers, fl::size samplesPerBuffer) {
+    if (buffers < 1) {
+        buffers = 1;
+    }
+    if (buffers > kMaxBuffers) {
+        buffers = kMaxBuffers;
+    }
+    if (samplesPerBuffer < 1) {
+        samplesPerBuffer = I2S_AUDIO_BUFFER_LEN;
+    }
+    mStorage = fl::make_shared<Storage>(buffers, samplesPerBuffer);
+}
+
+AudioDmaRing::~AudioDmaRing() {}
+
+fl::span<fl::i16> AudioDmaRing::acquire() {
+    Storage &s = *mStorage;
+    if (mAcquired < 0) {
+        fl::u32 index;
+        if (!s.freeBuffers.pop(index)) {
+            s.overruns.fetch_add(1);
+            return fl::span<fl::i16>();
+        }
+        mAcquired = fl::i32(index);
+    }
+    return fl::span<fl::i16>(s.samples.data() + fl::size(mAcquired) * s.samplesPerBuffer,
+                             s.samplesPerBuffer);
+}
+
+void AudioDmaRing::commit(fl::size count, fl::u32 timestamp) {
+    if (mAcquired < 0) {
+        return;
+    }
+    Storage &s = *mStorage;
+    const fl::u32 index = fl::u32(mAcquired);
+    mAcquired = -1;
+    if (count == 0) {
+        s.freeBuffers.push(index);
+        return;
+    }
+    Published block;
+    block.index = index;
+    block.count = fl::u32(count < s.samplesPerBuffer ? count : s.samplesPerBuffer);
+    block.timestamp = timestamp;
+    // Cannot fail: there are never more buffers than queue slots.
+    s.published.push(block);
+}
+
+AudioSample AudioDmaRing::pop() {
+    Storage &s = *mStorage;
+    Published block;
+    if (!s.published.pop(block)) {
+        return AudioSample();
+    }
+    const fl::i16 *data = s.samples.data() + fl::size(block.index) * s.samplesPerBuffer;
+    fl::shared_ptr<AudioBufferOwner> owner = mStorage;
+    return AudioSample(fl::span<const fl::i16>(data, block.count), block.timestamp,
+                       owner, block.index);
+}
+
+fl::size AudioDmaRing::bufferCount() const { return mStorage->buffers; }
+
+fl::size AudioDmaRing::samplesPerBuffer() const { return mStorage->samplesPerBuffer; }
+
+fl::size AudioDmaRing::ready() const { return mStorage->published.size(); }
+
+fl::size AudioDmaRing::available() const {
+    return mStorage->freeBuffers.size() + (mAcquired >= 0 ? 1 : 0);
+}
+
+fl::u32 AudioDmaRing::overruns() const { return mStorage->overruns.load(); }
+
+} // namespace fl
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "fl/atomic.h"
+#include "fl/audio.h"
+#include "fl/audio_input.h"
+#include "fl/int.h"
+#include "fl/mpsc_queue.h"
+#include "fl/shared_ptr.h"
+#include "fl/span.h"
+#include "fl/spsc_queue.h"
+#include "fl/vector.h"
+
+namespace fl {
+
+// A fixed set of capture buffers passed from an audio driver to
+// AudioSamples without copying the samples.
+//
+// The driver (one producer: a task, or an ISR once the buffers are
+// allocated) takes a free buffer with acquire(), fills it and publishes it
+// with commit(). The reader (one consumer) turns published buffers into
+// AudioSamples with pop(). Each sample points into its buffer, and copies
+// of the sample share it; when the last copy is destroyed the buffer goes
+// back to the free list, from whatever thread that happens on. If the
+// reader holds on to every buffer, acquire() fails and the driver drops
+// the block, counted by overruns(), rather than overwriting audio that is
+// still in use.
+//
+// Buffers are allocated once up front; nothing allocates while streaming.
+// The storage stays alive until the ring and every sample using it are
+// gone, so samples may outlive the ring.
+class AudioDmaRing {
+  public:
+    static const fl::size kMaxBuffers = 16;
+
+    explicit AudioDmaRing(fl::size buffers = AUDIO_DMA_BUFFER_COUNT,
+                          fl::size samplesPerBuffer = I2S_AUDIO_BUFFER_LEN);
+    ~AudioDmaRing();
+
+    AudioDmaRing(const AudioDmaRing &) = delete;
+    AudioDmaRing &operator=(const AudioDmaRing &) = delete;
+
+    // Producer. A free buffer to fill, or an empty span if every buffer is
+    // in use. Calling it again before commit() returns the same buffer.
+    fl::span<fl::i16> acquire();
+    // Publishes the acquired buffer holding `count` samples captured by
+    // `timestamp`. A count of 0 gives the buffer back unused.
+    void commit(fl::size count, fl::u32 timestamp);
+
+    // Consumer. The oldest published buffer as an AudioSample, or an
+    // invalid sample if none is ready.
+    AudioSample pop();
+
+    fl::size bufferCount() const;
+    fl::size samplesPerBuffer() const;
+    // Published buffers waiting for pop().
+    fl::size ready() const;
+    // Buffers the producer could acquire right now.
+    fl::size available() const;
+    // Blocks dropped because no buffer was free.
+    fl::u32 overruns() const;
+
+  private:
+    struct Published {
+        fl::u32 index;
+        fl::u32 count;
+        fl::u32 timestamp;
+    };
+
+    class Storage : public AudioBufferOwner {
+      public:
+        Storage(fl::size buffers, fl::size samplesPerBuffer);
+        void releaseBuffer(fl::u32 token) override;
+
+        fl::size buffers;
+        fl::size samplesPerBuffer;
+        fl::vector<fl::i16> samples;
+        // Released from any thread, taken by the producer.
+        mpsc_queue<fl::u32, kMaxBuffers> freeBuffers;
+        spsc_queue<Published, kMaxBuffers> published;
+        AtomicBuiltin<fl::u32> overruns;
+    };
+
+    fl::shared_ptr<Storage> mStorage;
+    fl::i32 mAcquired = -1; // producer only
+};
+
+} // namespace fl
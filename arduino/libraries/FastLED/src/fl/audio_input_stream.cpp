@@ -0,0 +1,347 @@
+#include "fl/audio_input_stream.h"
+
+#include "fl/math_macros.h"
+#include "fl/time.h"
+#include <math.h>
+#include <string.h>
+
+namespace fl {
+
+namespace {
+
+class MemoryFileHandle : public FileHandle {
+  public:
+    explicit MemoryFileHandle(fl::span<const fl::u8> data) : mData(data) {}
+
+    bool available() const override { return mPos < mData.size(); }
+    fl::size size() const override { return mData.size(); }
+    fl::size read(fl::u8 *dst, fl::size bytesToRead) override {
+        const fl::size left = mData.size() - mPos;
+        const fl::size n = bytesToRead < left ? bytesToRead : left;
+        memcpy(dst, mData.data() + mPos, n);
+        mPos += n;
+        return n;
+    }
+    fl::size pos() const override { return mPos; }
+    const char *path() const override { return "memory"; }
+    bool seek(fl::size pos) override {
+        if (pos > mData.size()) {
+            return false;
+        }
+        mPos = pos;
+        return true;
+    }
+    void close() override {}
+    bool valid() const override { return true; }
+
+  private:
+    fl::span<const fl::u8> mData;
+    fl::size mPos = 0;
+};
+
+fl::u16 le16(const fl::u8 *p) { return fl::u16(p[0] | (p[1] << 8)); }
+fl::u32 le32(const fl::u8 *p) {
+    return fl::u32(p[0]) | (fl::u32(p[1]) << 8) | (fl::u32(p[2]) << 16) |
+           (fl::u32(p[3]) << 24);
+}
+
+fl::i16 to_pcm(float v) {
+    v = v * 32767.0f;
+    v += v < 0.0f ? -0.5f : 0.5f;
+    if (v > 32767.0f) {
+        return 32767;
+    }
+    if (v < -32768.0f) {
+        return -32768;
+    }
+    return static_cast<fl::i16>(v);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+
+PcmStreamInput::PcmStreamInput(int sampleRate, fl::size blockSize, bool realTime)
+    : mSampleRate(sampleRate > 0 ? sampleRate : int(AUDIO_DEFAULT_SAMPLE_RATE)),
+      mRealTime(realTime) {
+    mBlock.resize(blockSize ? blockSize : I2S_AUDIO_BUFFER_LEN);
+}
+
+PcmStreamInput::~PcmStreamInput() {}
+
+void PcmStreamInput::start() {
+    rewind();
+    mStarted = true;
+    mFinished = false;
+    mSamplesRead = 0;
+    mStartMs = fl::time();
+}
+
+void PcmStreamInput::stop() { mStarted = false; }
+
+bool PcmStreamInput::error(fl::string *msg) {
+    if (msg) {
+        *msg = mError;
+    }
+    return !mError.empty();
+}
+
+void PcmStreamInput::setError(const char *msg) { mError = msg; }
+
+fl::u32 PcmStreamInput::nextBlockDueMs() const {
+    return mStartMs + fl::u32((mSamplesRead + mBlock.size()) * 1000 / fl::u64(mSampleRate));
+}
+
+fl::u32 PcmStreamInput::msUntilNextBlock() const {
+    if (!mRealTime || !mStarted || mFinished || !mError.empty()) {
+        return 0;
+    }
+    const fl::i32 wait = fl::i32(nextBlockDueMs() - fl::time());
+    return wait > 0 ? fl::u32(wait) : 0;
+}
+
+AudioSample PcmStreamInput::read() {
+    if (!mStarted || mFinished || !mError.empty()) {
+        return AudioSample();
+    }
+    const fl::size n = mBlock.size();
+    if (mRealTime) {
+        // Like a microphone, a block exists once its last sample has
+        // been captured.
+        if (fl::i32(fl::time() - nextBlockDueMs()) < 0) {
+            return AudioSample();
+        }
+    }
+    const fl::size got = generate(mBlock.data(), n);
+    if (got < n) {
+        mFinished = true;
+    }
+    if (got == 0) {
+        return AudioSample();
+    }
+    const fl::u32 timestamp = mStartMs + fl::u32(mSamplesRead * 1000 / fl::u64(mSampleRate));
+    mSamplesRead += got;
+    return AudioSample(fl::span<const fl::i16>(mBlock.data(), got), timestamp);
+}
+
+// ---------------------------------------------------------------------------
+
+SynthAudioInput::SynthAudioInput(const SynthAudioConfig &config)
+    : PcmStreamInput(config.sampleRate, config.blockSize, config.realTime),
+      mConfig(config) {
+    const float seconds = config.seconds > 0.0f ? config.seconds : 0.0f;
+    mTotal = fl::u64(double(seconds) * sampleRate() + 0.5);
+    rewind();
+}
+
+void SynthAudioInput::rewind() {
+    mIndex = 0;
+    mPhase = 0.0;
+    mNoise = mConfig.seed ? mConfig.seed : 1;
+    mPink[0] = mPink[1] = mPink[2] = 0.0f;
+}
+
+fl::size SynthAudioInput::generate(fl::i16 *dst, fl::size n) {
+    if (mTotal && mTotal - mIndex < n) {
+        n = fl::size(mTotal - mIndex);
+    }
+    const float amplitude = mConfig.amplitude;
+    for (fl::size i = 0; i < n; ++i) {
+        dst[i] = to_pcm(amplitude * next());
+    }
+    return n;
+}
+
+float SynthAudioInput::next() {
+    const double fs = sampleRate();
+    const double t = double(mIndex++) / fs;
+    float v = 0.0f;
+    switch (mConfig.signal) {
+    case SynthAudioConfig::kSine:
+    case SynthAudioConfig::kSweep: {
+        double f = mConfig.frequency;
+        if (mConfig.signal == SynthAudioConfig::kSweep && mConfig.sweepSeconds > 0.0f) {
+            const double x = fmod(t, double(mConfig.sweepSeconds)) / mConfig.sweepSeconds;
+            f *= pow(double(mConfig.endFrequency) / mConfig.frequency, x);
+        }
+        v = float(sin(mPhase));
+        // Accumulated phase keeps the sweep continuous.
+        mPhase += 2.0 * PI * f / fs;
+        if (mPhase > 2.0 * PI) {
+            mPhase -= 2.0 * PI;
+        }
+        break;
+    }
+    case SynthAudioConfig::kClicks: {
+        const double period = 60.0 / (mConfig.bpm > 0.0f ? mConfig.bpm : 120.0f);
+        const double into = fmod(t, period);
+        if (into < 0.01) {
+            v = float(sin(2.0 * PI * 2000.0 * into) * exp(-into / 0.002));
+        }
+        break;
+    }
+    case SynthAudioConfig::kPinkNoise: {
+        mNoise ^= mNoise << 13;
+        mNoise ^= mNoise >> 17;
+        mNoise ^= mNoise << 5;
+        const float white = float(fl::i32(mNoise)) / 2147483648.0f;
+        // Paul Kellet's economy pinking filter, -3 dB per octave within
+        // about 1 dB above 10 Hz.
+        mPink[0] = 0.99765f * mPink[0] + white * 0.0990460f;
+        mPink[1] = 0.96300f * mPink[1] + white * 0.2965164f;
+        mPink[2] = 0.57000f * mPink[2] + white * 1.0526913f;
+        v = 0.25f * (mPink[0] + mPink[1] + mPink[2] + white * 0.1848f);
+        break;
+    }
+    case SynthAudioConfig::kSilence:
+        break;
+    }
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+
+fl::shared_ptr<PcmFileInput> PcmFileInput::open(FileHandlePtr file,
+                                                const PcmFileConfig &config,
+                                                fl::string *error) {
+    if (!file || !file->valid()) {
+        if (error) {
+            *error = "PcmFileInput: file is not open";
+        }
+        return fl::shared_ptr<PcmFileInput>();
+    }
+    fl::shared_ptr<PcmFileInput> input = fl::make_shared<PcmFileInput>(file, config);
+    fl::string msg;
+    if (input->error(&msg)) {
+        if (error) {
+            *error = msg;
+        }
+        return fl::shared_ptr<PcmFileInput>();
+    }
+    return input;
+}
+
+fl::shared_ptr<PcmFileInput> PcmFileInput::open(fl::span<const fl::u8> data,
+                                                const PcmFileConfig &config,
+                                                fl::string *error) {
+    FileHandlePtr file = fl::make_shared<MemoryFileHandle>(data);
+    return open(file, config, error);
+}
+
+PcmFileInput::PcmFileInput(FileHandlePtr file, const PcmFileConfig &config)
+    : PcmStreamInput(config.rawSampleRate, config.blockSize, config.realTime),
+      mFile(file), mConfig(config) {
+    fl::string error;
+    if (!parseHeader(&error)) {
+        setError(error.c_str());
+        return;
+    }
+    mScratch.resize(blockSize() * mChannels * (mBits / 8));
+}
+
+bool PcmFileInput::parseHeader(fl::string *error) {
+    fl::u8 head[12];
+    mFile->seek(0);
+    const fl::size got = mFile->read(head, sizeof(head));
+    if (got < sizeof(head) || memcmp(head, "RIFF", 4) != 0 ||
+        memcmp(head + 8, "WAVE", 4) != 0) {
+        // Headerless.
+        mDataStart = 0;
+        mDataBytes = mFile->size() & ~fl::size(1);
+        mChannels = 1;
+        mBits = 16;
+        mFile->seek(0);
+        return true;
+    }
+
+    bool have_format = false;
+    fl::u8 chunk[8];
+    while (mFile->read(chunk, sizeof(chunk)) == sizeof(chunk)) {
+        const fl::u32 size = le32(chunk + 4);
+        const fl::size body = mFile->pos();
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            fl::u8 fmt[16];
+            if (size < sizeof(fmt) || mFile->read(fmt, sizeof(fmt)) != sizeof(fmt)) {
+                *error = "PcmFileInput: truncated fmt chunk";
+                return false;
+            }
+            const fl::u16 format = le16(fmt);
+            mChannels = le16(fmt + 2);
+            const fl::u32 rate = le32(fmt + 4);
+            mBits = le16(fmt + 14);
+            // 0xFFFE is WAVE_FORMAT_EXTENSIBLE, used for integer PCM too.
+            if ((format != 1 && format != 0xFFFE) || mChannels == 0 || rate == 0 ||
+                (mBits != 8 && mBits != 16)) {
+                *error = "PcmFileInput: only 8 and 16 bit integer PCM is supported";
+                return false;
+            }
+            setSampleRate(int(rate));
+            have_format = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_format) {
+                *error = "PcmFileInput: data before fmt chunk";
+                return false;
+            }
+            const fl::size left = mFile->size() - body;
+            mDataStart = body;
+            mDataBytes = size < left ? size : left;
+            return true;
+        }
+        // Chunks are padded to an even length.
+        if (!mFile->seek(body + size + (size & 1))) {
+            break;
+        }
+    }
+    *error = "PcmFileInput: no data chunk";
+    return false;
+}
+
+fl::size PcmFileInput::frames() const { return mDataBytes / (mChannels * (mBits / 8)); }
+
+void PcmFileInput::rewind() {
+    if (mFile) {
+        mFile->seek(mDataStart);
+    }
+}
+
+fl::size PcmFileInput::generate(fl::i16 *dst, fl::size n) {
+    const fl::size frame_bytes = mChannels * (mBits / 8);
+    const fl::size end = mDataStart + frames() * frame_bytes;
+    fl::size done = 0;
+    while (done < n) {
+        fl::size pos = mFile->pos();
+        if (pos >= end) {
+            if (!mConfig.loop || end == mDataStart) {
+                break;
+            }
+            mFile->seek(mDataStart);
+            pos = mDataStart;
+        }
+        fl::size want = n - done;
+        if (want > (end - pos) / frame_bytes) {
+            want = (end - pos) / frame_bytes;
+        }
+        const fl::size got = mFile->read(mScratch.data(), want * frame_bytes) / frame_bytes;
+        if (got == 0) {
+            break;
+        }
+        const fl::u8 *p = mScratch.data();
+        for (fl::size i = 0; i < got; ++i) {
+            fl::i32 mix = 0;
+            for (fl::u16 c = 0; c < mChannels; ++c) {
+                if (mBits == 16) {
+                    mix += fl::i16(le16(p));
+                    p += 2;
+                } else {
+                    mix += (fl::i32(*p) - 128) * 256;
+                    p += 1;
+                }
+            }
+            dst[done + i] = static_cast<fl::i16>(mix / mChannels);
+        }
+        done += got;
+    }
+    return done;
+}
+
+} // namespace fl
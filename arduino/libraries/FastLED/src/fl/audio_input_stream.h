@@ -0,0 +1,157 @@
+#pragma once
+
+#include "fl/audio_input.h"
+#include "fl/file_system.h"
+#include "fl/int.h"
+#include "fl/shared_ptr.h"
+#include "fl/span.h"
+#include "fl/str.h"
+#include "fl/vector.h"
+
+namespace fl {
+
+// Audio inputs that need no microphone: generated test signals and PCM
+// read from a file or a buffer. They behave like I2S_Audio, handing out
+// blocks of mono samples from read(), so audio reactive code can be run and
+// profiled on the host or replayed deterministically on a device.
+//
+// Timestamps come from the sample count, not from the clock: a block's
+// timestamp is start() time plus the time of its first sample, as with
+// I2S_Audio, so they are exact and do not drift. In real time mode read()
+// returns nothing until fl::time() reaches the end of a block, as with a
+// live microphone; otherwise blocks are available as fast as they are read.
+class PcmStreamInput : public IAudioInput {
+  public:
+    ~PcmStreamInput() override;
+
+    void start() override;
+    void stop() override;
+    bool error(fl::string *msg = nullptr) override;
+    AudioSample read() override;
+
+    int sampleRate() const { return mSampleRate; }
+    fl::size blockSize() const { return mBlock.size(); }
+    bool realTime() const { return mRealTime; }
+    // Samples handed out since start().
+    fl::u64 samplesRead() const { return mSamplesRead; }
+    float secondsRead() const { return float(mSamplesRead) / float(mSampleRate); }
+    // The stream ran out; read() will not return anything more.
+    bool finished() const { return mFinished; }
+    // In real time mode, milliseconds until read() has the next block; 0
+    // once it is due, and always 0 otherwise.
+    fl::u32 msUntilNextBlock() const;
+
+  protected:
+    PcmStreamInput(int sampleRate, fl::size blockSize, bool realTime);
+
+    // Writes up to `n` samples to dst and returns how many; fewer than `n`
+    // ends the stream after this block.
+    virtual fl::size generate(fl::i16 *dst, fl::size n) = 0;
+    // Back to the first sample, called by start().
+    virtual void rewind() {}
+
+    void setError(const char *msg);
+    void setSampleRate(int sampleRate) { mSampleRate = sampleRate; }
+
+  private:
+    // When the last sample of the next block has been captured.
+    fl::u32 nextBlockDueMs() const;
+
+    int mSampleRate;
+    bool mRealTime;
+    bool mStarted = false;
+    bool mFinished = false;
+    fl::u32 mStartMs = 0;
+    fl::u64 mSamplesRead = 0;
+    fl::vector<fl::i16> mBlock;
+    fl::string mError;
+};
+
+struct SynthAudioConfig {
+    enum Signal {
+        kSine = 0,
+        kSweep,     // logarithmic sweep from frequency to endFrequency, repeated
+        kClicks,    // a short decaying 2 kHz click on every beat
+        kPinkNoise, // 1/f noise
+        kSilence,
+    };
+
+    Signal signal = kSine;
+    int sampleRate = 44100;
+    fl::size blockSize = I2S_AUDIO_BUFFER_LEN;
+    float amplitude = 0.5f;        // of full scale
+    float frequency = 440.0f;      // Hz, sine and sweep start
+    float endFrequency = 8000.0f;  // Hz, sweep end
+    float sweepSeconds = 5.0f;     // duration of one sweep
+    float bpm = 120.0f;            // clicks
+    float seconds = 0.0f;          // length of the stream, 0 = endless
+    fl::u32 seed = 1;              // pink noise
+    bool realTime = false;
+};
+
+// Generated signals. The same config always produces the same samples.
+class SynthAudioInput : public PcmStreamInput {
+  public:
+    explicit SynthAudioInput(const SynthAudioConfig &config = SynthAudioConfig());
+    const SynthAudioConfig &config() const { return mConfig; }
+
+  protected:
+    fl::size generate(fl::i16 *dst, fl::size n) override;
+    void rewind() override;
+
+  private:
+    float next();
+
+    SynthAudioConfig mConfig;
+    fl::u64 mTotal;  // samples in the stream, 0 = endless
+    fl::u64 mIndex = 0;
+    double mPhase = 0.0;
+    fl::u32 mNoise = 0;
+    float mPink[3] = {0.0f, 0.0f, 0.0f};
+};
+
+struct PcmFileConfig {
+    int rawSampleRate = 44100; // for headerless files
+    fl::size blockSize = I2S_AUDIO_BUFFER_LEN;
+    bool realTime = false;
+    bool loop = false;         // start over at the end of the file
+};
+
+// Plays a WAV file (8 or 16 bit integer PCM, any channel count, mixed down
+// to mono) or, if the data does not start with a RIFF header, raw little
+// endian 16 bit mono PCM at rawSampleRate.
+class PcmFileInput : public PcmStreamInput {
+  public:
+    // Null with `error` set if the file is not usable.
+    static fl::shared_ptr<PcmFileInput> open(FileHandlePtr file,
+                                             const PcmFileConfig &config = PcmFileConfig(),
+                                             fl::string *error = nullptr);
+    // Reads from memory, which has to outlive the input.
+    static fl::shared_ptr<PcmFileInput> open(fl::span<const fl::u8> data,
+                                             const PcmFileConfig &config = PcmFileConfig(),
+                                             fl::string *error = nullptr);
+
+    PcmFileInput(FileHandlePtr file, const PcmFileConfig &config);
+
+    fl::u16 channels() const { return mChannels; }
+    fl::u16 bitsPerSample() const { return mBits; }
+    // Frames (samples per channel) in the file.
+    fl::size frames() const;
+
+  protected:
+    fl::size generate(fl::i16 *dst, fl::size n) override;
+    void rewind() override;
+
+  private:
+    bool parseHeader(fl::string *error);
+
+    FileHandlePtr mFile;
+    PcmFileConfig mConfig;
+    fl::size mDataStart = 0;
+    fl::size mDataBytes = 0;
+    fl::u16 mChannels = 1;
+    fl::u16 mBits = 16;
+    fl::vector<fl::u8> mScratch;
+};
+
+} // namespace fl
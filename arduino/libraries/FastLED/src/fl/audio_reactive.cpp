@@ -18,6 +18,7 @@ AudioReactive::AudioReactive()
     for (fl::size i = 0; i < mPreviousMagnitudes.size(); ++i) {
         mPreviousMagnitudes[i] = 0.0f;
     }
+    updateStages();
 }
 
 AudioReactive::~AudioReactive() = default;
@@ -39,6 +40,9 @@ void AudioReactive::begin(const AudioReactiveConfig& config) {
         mSpectralFluxDetector->reset();
         mSpectralFluxDetector->setThreshold(config.spectralFluxThreshold);
     }
+    if (mTempo) {
+        mTempo->reset();
+    }
     
     // Reset previous magnitudes
     for (fl::size i = 0; i < mPreviousMagnitudes.size(); ++i) {
@@ -48,6 +52,31 @@ void AudioReactive::begin(const AudioReactiveConfig& config) {
 
 void AudioReactive::setConfig(const AudioReactiveConfig& config) {
     mConfig = config;
+    updateStages();
+    if (!config.enableTempo) {
+        mTempo.reset();
+    } else if (!mTempo) {
+        mTempo = fl::make_unique<TempoTracker>(config.tempo);
+    } else {
+        mTempo->configure(config.tempo);
+    }
+    if (config.fftSize == 0) {
+        mAnalyzer.reset();
+        return;
+    }
+    AudioAnalyzerConfig analyzerConfig;
+    analyzerConfig.windowSize = config.fftSize;
+    analyzerConfig.hopSize = config.hopSize ? config.hopSize : config.fftSize / 2;
+    analyzerConfig.bands = 16;
+    analyzerConfig.sampleRate = config.sampleRate;
+    if (!mAnalyzer) {
+        mAnalyzer = fl::make_unique<AudioAnalyzer>(analyzerConfig);
+        mAnalyzer->onFrame([this](const AudioAnalysisFrame& frame) {
+            processFrame(frame);
+        });
+    } else {
+        mAnalyzer->configure(analyzerConfig);
+    }
 }
 
 void AudioReactive::processSample(const AudioSample& sample) {
@@ -55,31 +84,222 @@ void AudioReactive::processSample(const AudioSample& sample) {
         return; // Invalid sample, ignore
     }
     
+    if (mAnalyzer && runsStage(kAudioStageSpectrum)) {
+        // Streaming mode - processFrame() runs for each completed window
+        fl::u64 start = stageStart();
+        mFrameUs = 0;
+        mFeedBeats = FeedBeats();
+        mAnalyzer->feed(sample.pcm(), sample.timestamp());
+        // A block can complete several windows; a beat found by an earlier
+        // one must not be lost to the last one.
+        mCurrentData.beatDetected = mFeedBeats.beat;
+        mCurrentData.bassBeatDetected = mFeedBeats.bass;
+        mCurrentData.midBeatDetected = mFeedBeats.mid;
+        mCurrentData.trebleBeatDetected = mFeedBeats.treble;
+        mSmoothedData.beatDetected = mFeedBeats.beat;
+        if (mStageClock) {
+            // The FFTs; processFrame() timed its own stages
+            fl::u64 spent = mStageClock() - start;
+            mStageProfile.us[kAudioStageSpectrum] += spent > mFrameUs ? spent - mFrameUs : 0;
+        }
+        return;
+    }
+    
     // Extract timestamp from the AudioSample
     fl::u32 currentTimeMs = sample.timestamp();
     
-    // Process the AudioSample immediately - timing is gated by sample availability
-    processFFT(sample);
-    updateVolumeAndPeak(sample);
+    // The timestamp is that of the first sample
+    fl::u32 durationMs = mConfig.sampleRate
+        ? static_cast<fl::u32>(sample.size() * 1000 / mConfig.sampleRate) : 0;
     
-    // Enhanced processing pipeline
-    calculateBandEnergies();
-    updateSpectralFlux();
+    // Process the AudioSample immediately - timing is gated by sample availability
+    if (runsStage(kAudioStageSpectrum)) {
+        fl::u64 start = stageStart();
+        processFFT(sample);
+        stageEnd(kAudioStageSpectrum, start);
+    }
+    if (runsStage(kAudioStageVolume)) {
+        fl::u64 start = stageStart();
+        updateVolumeAndPeak(sample);
+        stageEnd(kAudioStageVolume, start);
+    }
+    finishProcessing(currentTimeMs, currentTimeMs + durationMs / 2);
+}
+
+void AudioReactive::processFrame(const AudioAnalysisFrame& frame) {
+    fl::u64 frameStart = stageStart();
+    fl::u64 start = frameStart;
+    mapFFTBinsToFrequencyChannels(frame.bins.data(), frame.bins.size());
+    stageEnd(kAudioStageSpectrum, start);
+    if (runsStage(kAudioStageVolume)) {
+        start = stageStart();
+        updateVolumeAndPeak(frame.rms, frame.peak);
+        stageEnd(kAudioStageVolume, start);
+    }
+    // The frame timestamp is that of the last sample in the window
+    fl::u32 windowMs = mConfig.sampleRate
+        ? static_cast<fl::u32>(mConfig.fftSize) * 1000 / mConfig.sampleRate : 0;
+    finishProcessing(frame.timestamp, frame.timestamp - windowMs / 2);
+    mFeedBeats.beat = mFeedBeats.beat || mCurrentData.beatDetected;
+    mFeedBeats.bass = mFeedBeats.bass || mCurrentData.bassBeatDetected;
+    mFeedBeats.mid = mFeedBeats.mid || mCurrentData.midBeatDetected;
+    mFeedBeats.treble = mFeedBeats.treble || mCurrentData.trebleBeatDetected;
+    if (mStageClock) {
+        mFrameUs += mStageClock() - frameStart;
+    }
+}
+
+void AudioReactive::finishProcessing(fl::u32 currentTimeMs, fl::u32 audioCentreMs) {
+    // Enhanced processing pipeline, skipping the stages no subscriber needs
+    fl::u64 start;
+    if (runsStage(kAudioStageBandEnergy)) {
+        start = stageStart();
+        calculateBandEnergies();
+        stageEnd(kAudioStageBandEnergy, start);
+    }
+    if (runsStage(kAudioStageSpectralFlux)) {
+        start = stageStart();
+        updateSpectralFlux();
+        stageEnd(kAudioStageSpectralFlux, start);
+    }
+    if (runsStage(kAudioStageTempo)) {
+        start = stageStart();
+        updateTempo(currentTimeMs, audioCentreMs);
+        stageEnd(kAudioStageTempo, start);
+    }
     
     // Enhanced beat detection (includes original)
-    detectBeat(currentTimeMs);
-    detectEnhancedBeats(currentTimeMs);
+    if (runsStage(kAudioStageBeat)) {
+        start = stageStart();
+        detectBeat(currentTimeMs);
+        detectEnhancedBeats(currentTimeMs);
+        stageEnd(kAudioStageBeat, start);
+    }
     
     // Apply perceptual weighting if enabled
-    applyPerceptualWeighting();
+    if (runsStage(kAudioStageWeighting)) {
+        start = stageStart();
+        applyPerceptualWeighting();
+        stageEnd(kAudioStageWeighting, start);
+    }
     
-    applyGain();
-    applyScaling();
+    if (runsStage(kAudioStageGain)) {
+        start = stageStart();
+        applyGain();
+        stageEnd(kAudioStageGain, start);
+    }
+    if (runsStage(kAudioStageScaling)) {
+        start = stageStart();
+        applyScaling();
+        stageEnd(kAudioStageScaling, start);
+    }
+    start = stageStart();
     smoothResults();
+    stageEnd(kAudioStageSmoothing, start);
     
     mCurrentData.timestamp = currentTimeMs;
 }
 
+fl::u32 AudioReactive::subscribe(fl::u32 features) {
+    Subscription subscription;
+    subscription.id = mNextSubscriptionId++;
+    subscription.features = features;
+    mSubscriptions.push_back(subscription);
+    updateStages();
+    return subscription.id;
+}
+
+void AudioReactive::unsubscribe(fl::u32 id) {
+    for (fl::size i = 0; i < mSubscriptions.size(); ++i) {
+        if (mSubscriptions[i].id == id) {
+            mSubscriptions.erase(mSubscriptions.begin() + i);
+            break;
+        }
+    }
+    updateStages();
+}
+
+fl::u32 AudioReactive::getFeatures() const {
+    if (mSubscriptions.empty()) {
+        return kAudioAllFeatures;
+    }
+    fl::u32 features = 0;
+    for (fl::size i = 0; i < mSubscriptions.size(); ++i) {
+        features |= mSubscriptions[i].features;
+    }
+    return features;
+}
+
+void AudioReactive::updateStages() {
+    // Which stages each group of fields depends on
+    const fl::u32 features = getFeatures();
+    fl::u32 stages = 1u << kAudioStageSmoothing;
+    if (features & kAudioVolume) {
+        stages |= (1u << kAudioStageVolume) | (1u << kAudioStageGain);
+    }
+    if (features & kAudioFrequencyBins) {
+        // Loudness compensation of the bins follows the volume
+        stages |= (1u << kAudioStageSpectrum) | (1u << kAudioStageVolume) |
+                  (1u << kAudioStageWeighting) | (1u << kAudioStageGain) |
+                  (1u << kAudioStageScaling);
+    }
+    if (features & (kAudioBeat | kAudioBandBeats)) {
+        stages |= (1u << kAudioStageVolume) | (1u << kAudioStageBeat);
+        if (mConfig.enableSpectralFlux) {
+            // The onset detector measures against the bins that
+            // updateSpectralFlux() last saw, and its beats move the cooldown
+            // the band beats share, so both need the flux stage.
+            stages |= (1u << kAudioStageSpectrum) | (1u << kAudioStageSpectralFlux);
+        }
+    }
+    if (features & (kAudioBandBeats | kAudioBandEnergy)) {
+        stages |= (1u << kAudioStageSpectrum) | (1u << kAudioStageBandEnergy);
+    }
+    if (features & kAudioSpectralFlux) {
+        stages |= (1u << kAudioStageSpectrum) | (1u << kAudioStageSpectralFlux);
+    }
+    if (features & kAudioTempo) {
+        stages |= (1u << kAudioStageSpectrum) | (1u << kAudioStageSpectralFlux) |
+                  (1u << kAudioStageTempo);
+    }
+    mStages = stages;
+}
+
+fl::u64 AudioReactive::stageStart() const {
+    return mStageClock ? mStageClock() : 0;
+}
+
+void AudioReactive::stageEnd(AudioStage stage, fl::u64 start) {
+    ++mStageProfile.runs[stage];
+    if (mStageClock) {
+        mStageProfile.us[stage] += mStageClock() - start;
+    }
+}
+
+fl::u64 AudioStageProfile::totalUs() const {
+    fl::u64 total = 0;
+    for (int i = 0; i < kAudioStageCount; ++i) {
+        total += us[i];
+    }
+    return total;
+}
+
+const char* AudioStageProfile::name(AudioStage stage) {
+    switch (stage) {
+        case kAudioStageSpectrum: return "spectrum";
+        case kAudioStageVolume: return "volume";
+        case kAudioStageBandEnergy: return "band energy";
+        case kAudioStageSpectralFlux: return "spectral flux";
+        case kAudioStageTempo: return "tempo";
+        case kAudioStageBeat: return "beat";
+        case kAudioStageWeighting: return "weighting";
+        case kAudioStageGain: return "gain";
+        case kAudioStageScaling: return "scaling";
+        case kAudioStageSmoothing: return "smoothing";
+        default: return "?";
+    }
+}
+
 void AudioReactive::update(fl::u32 currentTimeMs) {
     // This method handles updates without new sample data
     // Just apply smoothing and update timestamp
@@ -96,14 +316,14 @@ void AudioReactive::processFFT(const AudioSample& sample) {
     sample.fft(&mFFTBins);
     
     // Map FFT bins to frequency channels using WLED-compatible mapping
-    mapFFTBinsToFrequencyChannels();
+    mapFFTBinsToFrequencyChannels(mFFTBins.bins_raw.data(), mFFTBins.bins_raw.size());
 }
 
-void AudioReactive::mapFFTBinsToFrequencyChannels() {
+void AudioReactive::mapFFTBinsToFrequencyChannels(const float* bins, fl::size count) {
     // Copy FFT results to frequency bins array
     for (int i = 0; i < 16; ++i) {
-        if (i < static_cast<int>(mFFTBins.bins_raw.size())) {
-            mCurrentData.frequencyBins[i] = mFFTBins.bins_raw[i];
+        if (i < static_cast<int>(count)) {
+            mCurrentData.frequencyBins[i] = bins[i];
         } else {
             mCurrentData.frequencyBins[i] = 0.0f;
         }
@@ -150,25 +370,19 @@ void AudioReactive::mapFFTBinsToFrequencyChannels() {
 }
 
 void AudioReactive::updateVolumeAndPeak(const AudioSample& sample) {
-    // Get PCM data from AudioSample
-    const auto& pcmData = sample.pcm();
-    if (pcmData.empty()) {
+    // Measured once when the sample was created
+    const AudioStats& stats = sample.stats();
+    if (stats.count == 0) {
         mCurrentData.volume = 0.0f;
         mCurrentData.volumeRaw = 0.0f;
         mCurrentData.peak = 0.0f;
         return;
     }
-    
-    // Use AudioSample's built-in RMS calculation
-    float rms = sample.rms();
-    
-    // Calculate peak from PCM data
-    float maxSample = 0.0f;
-    for (fl::i16 pcmSample : pcmData) {
-        float absSample = (pcmSample < 0) ? -pcmSample : pcmSample;
-        maxSample = (maxSample > absSample) ? maxSample : absSample;
-    }
-    
+
+    updateVolumeAndPeak(stats.rms(), float(stats.peak));
+}
+
+void AudioReactive::updateVolumeAndPeak(float rms, float maxSample) {
     // Scale to 0-255 range (approximately)
     mCurrentData.volumeRaw = rms / 128.0f;  // Rough scaling
     mCurrentData.volume = mCurrentData.volumeRaw;
@@ -357,6 +571,10 @@ void AudioReactive::smoothResults() {
     mSmoothedData.dominantFrequency = mCurrentData.dominantFrequency;
     mSmoothedData.magnitude = mCurrentData.magnitude;
     mSmoothedData.timestamp = mCurrentData.timestamp;
+    mSmoothedData.bpm = mCurrentData.bpm;
+    mSmoothedData.tempoConfidence = mCurrentData.tempoConfidence;
+    mSmoothedData.beatPhase = mCurrentData.beatPhase;
+    mSmoothedData.nextBeatTime = mCurrentData.nextBeatTime;
 }
 
 const AudioData& AudioReactive::getData() const {
@@ -418,6 +636,22 @@ float AudioReactive::getTrebleEnergy() const {
     return mCurrentData.trebleEnergy;
 }
 
+float AudioReactive::getBPM() const {
+    return mTempo ? mTempo->bpm() : 0.0f;
+}
+
+float AudioReactive::getTempoConfidence() const {
+    return mTempo ? mTempo->confidence() : 0.0f;
+}
+
+fl::u32 AudioReactive::getNextBeatTime(fl::u32 nowMs) const {
+    return mTempo ? mTempo->nextBeatMs(nowMs) : 0;
+}
+
+float AudioReactive::getBeatPhase(fl::u32 nowMs) const {
+    return mTempo ? mTempo->phase(nowMs) : 0.0f;
+}
+
 fl::u8 AudioReactive::volumeToScale255() const {
     float vol = (mCurrentData.volume < 0.0f) ? 0.0f : ((mCurrentData.volume > 255.0f) ? 255.0f : mCurrentData.volume);
     return static_cast<fl::u8>(vol);
@@ -526,6 +760,19 @@ void AudioReactive::applyPerceptualWeighting() {
     }
 }
 
+void AudioReactive::updateTempo(fl::u32 currentTimeMs, fl::u32 audioCentreMs) {
+    if (!mTempo) {
+        return;
+    }
+    // Spectral flux is the onset strength; the tracker wants to know when
+    // the analysed audio happened, not when it was delivered.
+    mTempo->update(mCurrentData.spectralFlux, audioCentreMs);
+    mCurrentData.bpm = mTempo->bpm();
+    mCurrentData.tempoConfidence = mTempo->confidence();
+    mCurrentData.beatPhase = mTempo->phase(currentTimeMs);
+    mCurrentData.nextBeatTime = mTempo->nextBeatMs(currentTimeMs);
+}
+
 // Helper methods
 float AudioReactive::mapFrequencyBin(int fromBin, int toBin) {
     if (fromBin < 0 || toBin >= static_cast<int>(mFFTBins.size()) || fromBin > toBin) {
@@ -6,11 +6,14 @@
 #include "fl/stdint.h"
 #include "fl/int.h"
 #include "fl/audio.h"
+#include "fl/audio_analyzer.h"
+#include "fl/audio_tempo.h"
 #include "fl/array.h"
 #include "fl/unique_ptr.h"
 #include "fl/sketch_macros.h"
 #include "crgb.h"
 #include "fl/colorutils.h"
+#include "fl/function.h"
 
 namespace fl {
 
@@ -37,6 +40,50 @@ struct AudioData {
     float bassEnergy = 0.0f;                // Energy in bass frequencies (0-1)
     float midEnergy = 0.0f;                 // Energy in mid frequencies (6-7)
     float trebleEnergy = 0.0f;              // Energy in treble frequencies (14-15)
+
+    // Tempo tracking fields (0 until a tempo is found)
+    float bpm = 0.0f;                       // Estimated tempo
+    float tempoConfidence = 0.0f;           // How steady the beat is (0-1)
+    float beatPhase = 0.0f;                 // 0 on a beat rising to 1 before the next, at timestamp
+    fl::u32 nextBeatTime = 0;               // Predicted time of the next beat after timestamp
+};
+
+// Groups of AudioData fields an effect can subscribe to, see
+// AudioReactive::subscribe(). Stages that no subscribed field needs are
+// skipped, and the fields outside the subscription are left stale.
+enum AudioFeature : fl::u32 {
+    kAudioVolume = 0x01,        // volume, volumeRaw, peak
+    kAudioFrequencyBins = 0x02, // frequencyBins, dominantFrequency, magnitude
+    kAudioBeat = 0x04,          // beatDetected
+    kAudioBandBeats = 0x08,     // bassBeatDetected, midBeatDetected, trebleBeatDetected
+    kAudioBandEnergy = 0x10,    // bassEnergy, midEnergy, trebleEnergy
+    kAudioSpectralFlux = 0x20,  // spectralFlux
+    kAudioTempo = 0x40,         // bpm, tempoConfidence, beatPhase, nextBeatTime
+    kAudioAllFeatures = 0x7F,
+};
+
+// AudioReactive analysis stages, in the order they run.
+enum AudioStage : fl::u8 {
+    kAudioStageSpectrum = 0,  // FFT and mapping to 16 channels
+    kAudioStageVolume,        // RMS, peak and AGC tracking
+    kAudioStageBandEnergy,
+    kAudioStageSpectralFlux,
+    kAudioStageTempo,
+    kAudioStageBeat,          // volume, spectral flux and band beats
+    kAudioStageWeighting,     // perceptual weighting of the bins
+    kAudioStageGain,
+    kAudioStageScaling,
+    kAudioStageSmoothing,
+    kAudioStageCount
+};
+
+// Runs and time spent per stage, see AudioReactive::setStageClock().
+struct AudioStageProfile {
+    fl::u32 runs[kAudioStageCount] = {0};
+    fl::u64 us[kAudioStageCount] = {0};
+
+    fl::u64 totalUs() const;
+    static const char* name(AudioStage stage);
 };
 
 struct AudioReactiveConfig {
@@ -56,6 +103,18 @@ struct AudioReactiveConfig {
     float bassThreshold = 0.15f;        // Threshold for bass beat detection
     float midThreshold = 0.12f;         // Threshold for mid beat detection
     float trebleThreshold = 0.08f;      // Threshold for treble beat detection
+
+    // Tempo tracking from spectral flux, see TempoTracker. Off by default
+    // on small chips, it needs about 3.3 KB.
+    bool enableTempo = SKETCH_HAS_LOTS_OF_MEMORY;
+    TempoConfig tempo;
+
+    // Streaming analysis. With fftSize 0 every AudioSample gets one FFT over
+    // the whole block. Otherwise samples are buffered and an fftSize window
+    // is analysed every hopSize samples (0 = fftSize / 2), so the analysis
+    // rate no longer depends on the I2S block size.
+    u16 fftSize = 0;
+    u16 hopSize = 0;
 };
 
 class AudioReactive {
@@ -67,7 +126,9 @@ public:
     void begin(const AudioReactiveConfig& config = AudioReactiveConfig{});
     void setConfig(const AudioReactiveConfig& config);
     
-    // Process audio sample - this does all the work immediately
+    // Process audio sample - this does all the work immediately. In
+    // streaming mode the sample is buffered and processing runs once per
+    // completed analysis window, which may be zero or several times.
     void processSample(const AudioSample& sample);
     
     // Optional: update smoothing without new sample data  
@@ -92,17 +153,50 @@ public:
     float getBassEnergy() const;
     float getMidEnergy() const;
     float getTrebleEnergy() const;
+
+    // Tempo tracking accessors. Pass millis() as nowMs to get predictions
+    // for the moment the LEDs are drawn rather than for the last frame.
+    float getBPM() const;
+    float getTempoConfidence() const;
+    fl::u32 getNextBeatTime(fl::u32 nowMs) const;
+    float getBeatPhase(fl::u32 nowMs) const;
+    // nullptr unless config.enableTempo is set.
+    const TempoTracker* getTempoTracker() const { return mTempo.get(); }
     
     // Effect helpers
     fl::u8 volumeToScale255() const;
     CRGB volumeToColor(const CRGBPalette16& palette) const;
     fl::u8 frequencyToScale255(fl::u8 binIndex) const;
 
+    // The streaming analyser, or nullptr unless config.fftSize is set. Its
+    // latest() frame may be read from another task than processSample().
+    AudioAnalyzer* getAnalyzer() { return mAnalyzer.get(); }
+
+    // Feature subscriptions. Each effect declares the AudioFeature fields
+    // it reads and only the stages they need run: a volume only sketch
+    // skips the FFT entirely, even in streaming mode. Without any
+    // subscription every stage runs. Returns an id for unsubscribe().
+    fl::u32 subscribe(fl::u32 features);
+    void unsubscribe(fl::u32 id);
+    // Union of the subscriptions, or kAudioAllFeatures if there are none.
+    fl::u32 getFeatures() const;
+    bool runsStage(AudioStage stage) const { return (mStages & (1u << stage)) != 0; }
+
+    // Per stage profiling. `micros` returns microseconds (micros() on a
+    // device, a steady clock on the host); an empty clock turns it off.
+    using Clock = fl::function<fl::u64()>;
+    void setStageClock(const Clock& micros) { mStageClock = micros; }
+    const AudioStageProfile& getStageProfile() const { return mStageProfile; }
+    void resetStageProfile() { mStageProfile = AudioStageProfile(); }
+
 private:
     // Internal processing methods
     void processFFT(const AudioSample& sample);
-    void mapFFTBinsToFrequencyChannels();
+    void processFrame(const AudioAnalysisFrame& frame);
+    void finishProcessing(fl::u32 currentTimeMs, fl::u32 audioCentreMs);
+    void mapFFTBinsToFrequencyChannels(const float* bins, fl::size count);
     void updateVolumeAndPeak(const AudioSample& sample);
+    void updateVolumeAndPeak(float rms, float maxSample);
     void detectBeat(fl::u32 currentTimeMs);
     void smoothResults();
     void applyScaling();
@@ -113,6 +207,12 @@ private:
     void calculateBandEnergies();
     void updateSpectralFlux();
     void applyPerceptualWeighting();
+    void updateTempo(fl::u32 currentTimeMs, fl::u32 audioCentreMs);
+
+    // Stage graph and profiling
+    void updateStages();
+    fl::u64 stageStart() const;
+    void stageEnd(AudioStage stage, fl::u64 start);
     
     // Helper methods
     float mapFrequencyBin(int fromBin, int toBin);
@@ -124,6 +224,7 @@ private:
     // FFT processing
     FFT mFFT;
     FFTBins mFFTBins;
+    fl::unique_ptr<AudioAnalyzer> mAnalyzer;  // streaming mode only
     
     // Audio data  
     AudioData mCurrentData;
@@ -151,9 +252,30 @@ private:
     // Enhanced beat detection components
     fl::unique_ptr<SpectralFluxDetector> mSpectralFluxDetector;
     fl::unique_ptr<PerceptualWeighting> mPerceptualWeighting;
+    fl::unique_ptr<TempoTracker> mTempo;  // config.enableTempo only
     
     // Enhanced beat detection state
     fl::array<float, 16> mPreviousMagnitudes;
+
+    // Feature subscriptions and the stages they need
+    struct Subscription {
+        fl::u32 id;
+        fl::u32 features;
+    };
+    fl::vector<Subscription> mSubscriptions;
+    fl::u32 mNextSubscriptionId = 1;
+    fl::u32 mStages = 0xFFFFFFFF;  // bit per AudioStage
+    Clock mStageClock;
+    AudioStageProfile mStageProfile;
+    fl::u64 mFrameUs = 0;  // time in processFrame() during one feed()
+    // Beats found by any window completed during one feed()
+    struct FeedBeats {
+        bool beat = false;
+        bool bass = false;
+        bool mid = false;
+        bool treble = false;
+    };
+    FeedBeats mFeedBeats;
 };
 
 // Spectral flux-based onset detection for enhanced beat detection
@@ -0,0 +1,192 @@
+#include "fl/audio_stats.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FL_AUDIO_STATS_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FL_AUDIO_STATS_NEON 1
+#endif
+
+namespace fl {
+
+namespace {
+
+struct Partial {
+    fl::u64 sumSquares = 0;
+    fl::i64 sum = 0;
+    fl::u32 zeroCrossings = 0;
+    fl::i32 max = -32768;
+    fl::i32 min = 32767;
+};
+
+// p[0, n) with `prev` standing in for p[-1].
+void scalar_stats(const fl::i16 *p, fl::size n, fl::i16 prev, Partial *acc) {
+    for (fl::size i = 0; i < n; ++i) {
+        const fl::i32 x = p[i];
+        acc->sumSquares += fl::u32(x * x);
+        acc->sum += x;
+        // Crossing when exactly one of the two is negative.
+        acc->zeroCrossings += fl::u32(fl::u16(x ^ prev)) >> 15;
+        acc->max = x > acc->max ? x : acc->max;
+        acc->min = x < acc->min ? x : acc->min;
+        prev = static_cast<fl::i16>(x);
+    }
+}
+
+#if defined(FL_AUDIO_STATS_SSE2) || defined(FL_AUDIO_STATS_NEON)
+
+// The 16 and 32 bit lane counters are folded into acc at least this often
+// (in vectors of eight samples) so they cannot overflow.
+const fl::size kFlushVectors = 4096;
+
+// Whole vectors of eight from p[0, n), reading p[-1] for the first
+// crossing. Returns the number of samples done.
+fl::size simd_stats(const fl::i16 *p, fl::size n, Partial *acc) {
+    const fl::size vectors = n / 8;
+#if defined(FL_AUDIO_STATS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sq = zero;
+    __m128i hi = _mm_set1_epi16(-32768);
+    __m128i lo = _mm_set1_epi16(32767);
+    for (fl::size v = 0; v < vectors;) {
+        const fl::size end = v + kFlushVectors < vectors ? v + kFlushVectors : vectors;
+        __m128i sum = zero;
+        __m128i crossings = zero;
+        for (; v < end; ++v) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8 * v));
+            const __m128i prev =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8 * v - 1));
+            // Pairs of squares, at most 2^31 each, so unsigned 32 bit.
+            const __m128i pairs = _mm_madd_epi16(x, x);
+            sq = _mm_add_epi64(sq, _mm_unpacklo_epi32(pairs, zero));
+            sq = _mm_add_epi64(sq, _mm_unpackhi_epi32(pairs, zero));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(x, ones));
+            crossings = _mm_sub_epi16(crossings, _mm_srai_epi16(_mm_xor_si128(x, prev), 15));
+            hi = _mm_max_epi16(hi, x);
+            lo = _mm_min_epi16(lo, x);
+        }
+        fl::i32 sums[4];
+        fl::i32 counts[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(sums), sum);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(counts), _mm_madd_epi16(crossings, ones));
+        for (int i = 0; i < 4; ++i) {
+            acc->sum += sums[i];
+            acc->zeroCrossings += fl::u32(counts[i]);
+        }
+    }
+    fl::u64 squares[2];
+    fl::i16 highs[8];
+    fl::i16 lows[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(squares), sq);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(highs), hi);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lows), lo);
+#else
+    uint64x2_t sq = vdupq_n_u64(0);
+    int16x8_t hi = vdupq_n_s16(-32768);
+    int16x8_t lo = vdupq_n_s16(32767);
+    for (fl::size v = 0; v < vectors;) {
+        const fl::size end = v + kFlushVectors < vectors ? v + kFlushVectors : vectors;
+        int32x4_t sum = vdupq_n_s32(0);
+        int16x8_t crossings = vdupq_n_s16(0);
+        for (; v < end; ++v) {
+            const int16x8_t x = vld1q_s16(p + 8 * v);
+            const int16x8_t prev = vld1q_s16(p + 8 * v - 1);
+            // Squares are at most 2^30, pairs of them fit unsigned 32 bit.
+            const int32x4_t sq_lo = vmull_s16(vget_low_s16(x), vget_low_s16(x));
+            const int32x4_t sq_hi = vmull_s16(vget_high_s16(x), vget_high_s16(x));
+            sq = vpadalq_u32(sq, vreinterpretq_u32_s32(sq_lo));
+            sq = vpadalq_u32(sq, vreinterpretq_u32_s32(sq_hi));
+            sum = vpadalq_s16(sum, x);
+            crossings = vsubq_s16(crossings, vshrq_n_s16(veorq_s16(x, prev), 15));
+            hi = vmaxq_s16(hi, x);
+            lo = vminq_s16(lo, x);
+        }
+        fl::i32 sums[4];
+        fl::i16 counts[8];
+        vst1q_s32(sums, sum);
+        vst1q_s16(counts, crossings);
+        for (int i = 0; i < 4; ++i) {
+            acc->sum += sums[i];
+        }
+        for (int i = 0; i < 8; ++i) {
+            acc->zeroCrossings += fl::u32(counts[i]);
+        }
+    }
+    fl::u64 squares[2];
+    fl::i16 highs[8];
+    fl::i16 lows[8];
+    vst1q_u64(squares, sq);
+    vst1q_s16(highs, hi);
+    vst1q_s16(lows, lo);
+#endif
+    acc->sumSquares += squares[0] + squares[1];
+    for (int i = 0; i < 8; ++i) {
+        acc->max = highs[i] > acc->max ? highs[i] : acc->max;
+        acc->min = lows[i] < acc->min ? lows[i] : acc->min;
+    }
+    return vectors * 8;
+}
+
+#endif
+
+} // namespace
+
+void AudioStats::add(fl::span<const fl::i16> pcm) {
+    const fl::i16 *p = pcm.data();
+    const fl::size n = pcm.size();
+    if (n == 0) {
+        return;
+    }
+    Partial acc;
+    // The first sample crosses against the end of the previous piece, if
+    // there was one.
+    scalar_stats(p, 1, count ? last : p[0], &acc);
+    fl::size done = 1;
+#if defined(FL_AUDIO_STATS_SSE2) || defined(FL_AUDIO_STATS_NEON)
+    done += simd_stats(p + 1, n - 1, &acc);
+#endif
+    scalar_stats(p + done, n - done, p[done - 1], &acc);
+
+    sumSquares += acc.sumSquares;
+    sum += acc.sum;
+    zeroCrossings += acc.zeroCrossings;
+    const fl::i32 mag = acc.max > -acc.min ? acc.max : -acc.min;
+    peak = mag > peak ? static_cast<fl::u16>(mag) : peak;
+    count += static_cast<fl::u32>(n);
+    last = p[n - 1];
+}
+
+float AudioStats::rms() const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    return sqrtf(float(sumSquares) / float(count));
+}
+
+float AudioStats::dcOffset() const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    return float(sum) / float(count);
+}
+
+float AudioStats::zcf() const {
+    if (count < 2) {
+        return 0.0f;
+    }
+    return float(zeroCrossings) / float(count - 1);
+}
+
+double AudioStats::dbfs() const {
+    double power = 0.0;
+    if (count) {
+        power = double(sumSquares) / (32768.0 * 32768.0) / double(count);
+    }
+    return 10.0 * log10(power + 1e-12);
+}
+
+} // namespace fl
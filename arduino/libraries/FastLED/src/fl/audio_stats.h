@@ -0,0 +1,39 @@
+#pragma once
+
+#include "fl/int.h"
+#include "fl/span.h"
+
+namespace fl {
+
+// Level statistics of a block of int16 PCM: everything AudioSample,
+// AudioReactive and SoundLevelMeter derive from the raw samples, gathered
+// in a single pass (SSE2 / NEON where available) instead of one per value.
+//
+// add() continues the block, so a ring buffer or a stream of chunks can be
+// measured in pieces; a zero crossing between two pieces is counted.
+struct AudioStats {
+    fl::u64 sumSquares = 0;
+    fl::i64 sum = 0;
+    fl::u32 count = 0;
+    fl::u32 zeroCrossings = 0; // sign changes between neighbouring samples
+    fl::u16 peak = 0;          // largest |sample|, 32768 for -32768
+    fl::i16 last = 0;          // final sample seen
+
+    static AudioStats compute(fl::span<const fl::i16> pcm) {
+        AudioStats stats;
+        stats.add(pcm);
+        return stats;
+    }
+
+    void add(fl::span<const fl::i16> pcm);
+
+    float rms() const;
+    // Mean of the samples, the DC bias of the microphone.
+    float dcOffset() const;
+    // Zero crossings per sample pair, [0, 1]. See AudioSample::zcf().
+    float zcf() const;
+    // Mean power relative to full scale, in dB (<= 0).
+    double dbfs() const;
+};
+
+} // namespace fl
@@ -0,0 +1,276 @@
+#include "fl/audio_tempo.h"
+
+#include <math.h>
+
+namespace fl {
+
+namespace {
+
+const fl::u32 kHistoryMask = TempoTracker::kHistoryCells - 1;
+// Cells of history needed before a tempo is reported.
+const fl::u32 kMinCells = 200;
+// Longer gaps between updates restart the tracker.
+const fl::i32 kRestartGapMs = 2000;
+// Per cell, for the running mean subtracted from the onsets (about 1 s).
+const float kMeanRate = 0.01f;
+// Per update, for the onset level used to compress the onsets.
+const float kLevelRate = 0.02f;
+// Weight of each older beat when matching the phase comb.
+const float kPhaseDecay = 0.8f;
+// Half the period wins if its autocorrelation is at least this fraction.
+const float kHalfPeriodRatio = 0.5f;
+
+float clampf(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+} // namespace
+
+TempoTracker::TempoTracker(const TempoConfig &config) { configure(config); }
+
+void TempoTracker::configure(const TempoConfig &config) {
+    mConfig = config;
+    const float minBpm = clampf(config.minBpm, 40.0f, 300.0f);
+    const float maxBpm = clampf(config.maxBpm, minBpm, 300.0f);
+    const float cellsPerMinute = 60000.0f / kCellMs;
+    mMinLag = cellsPerMinute / maxBpm;
+    mMaxLag = cellsPerMinute / minBpm;
+    mPreferredLag = cellsPerMinute / clampf(config.preferredBpm, minBpm, maxBpm);
+    const float memoryMs = config.memorySeconds > 0.5f ? config.memorySeconds * 1000.0f : 500.0f;
+    mDecay = powf(0.5f, float(kCellMs) / memoryMs);
+    reset();
+}
+
+void TempoTracker::reset() {
+    mEnv.fill(0.0f);
+    mAcf.fill(0.0f);
+    mWrite = 0;
+    mCells = 0;
+    mMean = 0.0f;
+    mLevel = 0.0f;
+    mStarted = false;
+    mLastMs = 0;
+    mLastOnset = 0.0f;
+    mNewestCellMs = 0;
+    mPeriodMs = 0.0f;
+    mConfidence = 0.0f;
+    mLastBeatMs = 0;
+}
+
+void TempoTracker::restart(fl::u32 timeMs) {
+    reset();
+    mStarted = true;
+    mLastMs = timeMs;
+    mNewestCellMs = timeMs - timeMs % kCellMs;
+}
+
+void TempoTracker::update(float onset, fl::u32 timeMs) {
+    const fl::i32 gap = fl::i32(timeMs - mLastMs);
+    const bool restarted = !mStarted || gap < 0 || gap > kRestartGapMs;
+    if (restarted) {
+        restart(timeMs);
+    }
+    // Compressed relative to the recent level, so that the rhythm counts
+    // rather than the loudest hits. Onsets measured with non-overlapping
+    // windows vary a lot with where the hit lands in the window, and
+    // alternately strong and weak beats would otherwise read as half tempo.
+    if (onset < 0.0f) {
+        onset = 0.0f;
+    }
+    mLevel += (onset - mLevel) * kLevelRate;
+    onset = logf(1.0f + onset / (mLevel + 1e-6f));
+    if (restarted) {
+        mLastOnset = onset;
+        return;
+    }
+    if (gap == 0) {
+        mLastOnset = onset > mLastOnset ? onset : mLastOnset;
+        return;
+    }
+    // Linear interpolation between frames onto the cell grid.
+    bool pushed = false;
+    while (fl::i32(mNewestCellMs + kCellMs - timeMs) <= 0) {
+        mNewestCellMs += kCellMs;
+        const float t = float(fl::i32(mNewestCellMs - mLastMs)) / float(gap);
+        pushCell(mLastOnset + (onset - mLastOnset) * t);
+        pushed = true;
+    }
+    mLastMs = timeMs;
+    mLastOnset = onset;
+    if (pushed) {
+        estimate();
+    }
+}
+
+void TempoTracker::pushCell(float value) {
+    // Only rises above the recent level count as onsets.
+    mMean += (value - mMean) * kMeanRate;
+    const float x = value > mMean ? value - mMean : 0.0f;
+    mWrite = (mWrite + 1) & kHistoryMask;
+    mEnv[mWrite] = x;
+    if (mCells < kHistoryCells) {
+        ++mCells;
+    }
+    if (x == 0.0f) {
+        for (int lag = 0; lag <= kMaxLagCells; ++lag) {
+            mAcf[lag] *= mDecay;
+        }
+        return;
+    }
+    for (int lag = 0; lag <= kMaxLagCells; ++lag) {
+        mAcf[lag] = mAcf[lag] * mDecay + x * mEnv[(mWrite - fl::u32(lag)) & kHistoryMask];
+    }
+}
+
+float TempoTracker::envAt(float cellsAgo) const {
+    const fl::u32 i = fl::u32(cellsAgo);
+    const float f = cellsAgo - float(i);
+    const float a = mEnv[(mWrite - i) & kHistoryMask];
+    const float b = mEnv[(mWrite - i - 1) & kHistoryMask];
+    return a + (b - a) * f;
+}
+
+float TempoTracker::acfAt(float lag) const {
+    int i = int(lag);
+    if (i < 0) {
+        return mAcf[0];
+    }
+    if (i >= kMaxLagCells) {
+        return mAcf[kMaxLagCells];
+    }
+    const float f = lag - float(i);
+    return mAcf[i] + (mAcf[i + 1] - mAcf[i]) * f;
+}
+
+// The autocorrelation peak within `search` cells of `lag`, to a fraction of
+// a cell by fitting a parabola through it and its neighbours.
+float TempoTracker::refinePeak(float lag, int search) const {
+    const int centre = int(lag + 0.5f);
+    int best = centre;
+    for (int i = centre - search; i <= centre + search; ++i) {
+        if (i >= 1 && i < kMaxLagCells && mAcf[i] > mAcf[best]) {
+            best = i;
+        }
+    }
+    if (best < 1 || best >= kMaxLagCells) {
+        return lag;
+    }
+    const float a = mAcf[best - 1];
+    const float b = mAcf[best];
+    const float c = mAcf[best + 1];
+    const float denom = a - 2.0f * b + c;
+    if (denom >= 0.0f) {
+        return float(best);
+    }
+    return float(best) + clampf(0.5f * (a - c) / denom, -0.5f, 0.5f);
+}
+
+void TempoTracker::estimate() {
+    if (mCells < kMinCells || mAcf[0] <= 0.0f) {
+        return;
+    }
+
+    // Score every lag in range by its comb of multiples, weighted towards
+    // the preferred tempo.
+    const int lo = int(ceilf(mMinLag));
+    const int hi = int(mMaxLag);
+    int best = -1;
+    float bestScore = 0.0f;
+    for (int lag = lo; lag <= hi; ++lag) {
+        float score = 0.0f;
+        float weight = 0.0f;
+        for (int k = 1; k <= 3 && k * lag <= kMaxLagCells; ++k) {
+            score += mAcf[k * lag] / float(k);
+            weight += 1.0f / float(k);
+        }
+        const float octaves = log2f(float(lag) / mPreferredLag);
+        score = score / weight * expf(-0.5f * octaves * octaves);
+        if (score > bestScore) {
+            bestScore = score;
+            best = lag;
+        }
+    }
+    if (best < 0) {
+        return;
+    }
+    float period = refinePeak(float(best), 1);
+
+    // A pulse at period P also correlates at 2P, so prefer P whenever the
+    // half period is strongly periodic too.
+    while (period * 0.5f >= mMinLag) {
+        const float half = refinePeak(period * 0.5f, 1);
+        if (acfAt(half) < kHalfPeriodRatio * acfAt(period)) {
+            break;
+        }
+        period = half;
+    }
+
+    // Later teeth of the comb pin the period down more precisely.
+    float sum = 0.0f;
+    float count = 0.0f;
+    for (int k = 1; k <= 3 && period * k + 2.0f <= kMaxLagCells; ++k) {
+        sum += refinePeak(period * k, k);
+        count += float(k);
+    }
+    if (count > 0.0f) {
+        period = sum / count;
+    }
+
+    mPeriodMs = period * kCellMs;
+    mConfidence = clampf(acfAt(period) / mAcf[0], 0.0f, 1.0f);
+
+    // Phase: the offset at which a comb at the period collects the most
+    // onset energy, recent beats counting most.
+    const float span = float(mCells) - 2.0f;
+    const int phases = int(ceilf(period));
+    auto comb = [&](float offset) {
+        float s = 0.0f;
+        float w = 1.0f;
+        for (float at = offset; at < span; at += period) {
+            s += w * envAt(at);
+            w *= kPhaseDecay;
+        }
+        return s;
+    };
+    int bestPhase = 0;
+    float bestPhaseScore = -1.0f;
+    for (int p = 0; p < phases; ++p) {
+        const float s = comb(float(p));
+        if (s > bestPhaseScore) {
+            bestPhaseScore = s;
+            bestPhase = p;
+        }
+    }
+    // Neighbours wrap around to the same phase one beat earlier.
+    const float before = comb(bestPhase > 0 ? float(bestPhase - 1) : float(bestPhase) - 1.0f + period);
+    const float after = comb(bestPhase + 1 < phases ? float(bestPhase + 1) : float(bestPhase) + 1.0f - period);
+    const float denom = before - 2.0f * bestPhaseScore + after;
+    float offset = float(bestPhase);
+    if (denom < 0.0f) {
+        offset += clampf(0.5f * (before - after) / denom, -0.5f, 0.5f);
+    }
+    mLastBeatMs = mNewestCellMs - fl::u32(fl::i32(offset * kCellMs + 0.5f));
+}
+
+fl::u32 TempoTracker::nextBeatMs(fl::u32 nowMs) const {
+    if (!locked()) {
+        return 0;
+    }
+    // Half a millisecond of slack so that a beat time rounded up still
+    // counts as that beat.
+    const double since = double(fl::i32(nowMs - mLastBeatMs)) - 0.5;
+    const double beats = ceil(since / double(mPeriodMs));
+    return mLastBeatMs + fl::u32(fl::i32(floor(beats * mPeriodMs + 0.5)));
+}
+
+float TempoTracker::phase(fl::u32 nowMs) const {
+    if (!locked()) {
+        return 0.0f;
+    }
+    const float since = float(fl::i32(nowMs - mLastBeatMs));
+    float p = fmodf(since, mPeriodMs) / mPeriodMs;
+    if (p < 0.0f) {
+        p += 1.0f;
+    }
+    return p;
+}
+
+} // namespace fl
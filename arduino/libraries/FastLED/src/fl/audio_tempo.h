@@ -0,0 +1,97 @@
+#pragma once
+
+#include "fl/array.h"
+#include "fl/int.h"
+
+namespace fl {
+
+struct TempoConfig {
+    float minBpm = 60.0f;        // slowest tempo reported, at least 40
+    float maxBpm = 200.0f;       // fastest tempo reported, at most 300
+    float preferredBpm = 120.0f; // ties between double and half tempo go towards this
+    float memorySeconds = 4.0f;  // half life of the tempo evidence
+};
+
+// Tempo and beat phase from an onset strength signal such as spectral flux.
+//
+// Onset values arrive once per analysis frame, at whatever rate the frames
+// come; they are log compressed and resampled onto a fixed 10 ms grid.
+// Every grid cell updates a leaky autocorrelation of the onset envelope;
+// its strongest peak in the tempo range, checked against its multiples so
+// that a steady pulse does not lock to half tempo, gives the beat period.
+// The beat phase comes from matching a comb at that period against the
+// recent envelope.
+//
+// Because both are estimated from several seconds of audio, the tracker
+// predicts beats: nextBeatMs() says when the next one will happen, so an
+// effect can flash on the beat instead of one analysis block after it.
+//
+// Times are in the timestamp domain of the audio (millis() on a device).
+// update() wants the time of the middle of the analysed audio; the tracker
+// cannot tell when a frame was delivered, only when its audio happened.
+//
+// Uses about 3.3 KB.
+class TempoTracker {
+  public:
+    static constexpr int kCellMs = 10;
+    static constexpr int kHistoryCells = 512; // 5.12 s, a power of two
+    static constexpr int kMaxLagCells = 300;  // comb teeth up to 3 s
+
+    explicit TempoTracker(const TempoConfig &config = TempoConfig());
+
+    void configure(const TempoConfig &config);
+    const TempoConfig &config() const { return mConfig; }
+    void reset();
+
+    // Adds the onset strength of the audio around `timeMs`. Times should
+    // increase; a jump back or a gap of more than two seconds restarts the
+    // tracker.
+    void update(float onset, fl::u32 timeMs);
+
+    // True once a tempo has been found, about two seconds into a beat.
+    bool locked() const { return mPeriodMs > 0.0f; }
+    // Beats per minute, 0 until locked.
+    float bpm() const { return locked() ? 60000.0f / mPeriodMs : 0.0f; }
+    float periodMs() const { return mPeriodMs; }
+    // How periodic the onsets are at the chosen tempo, 0 to 1.
+    float confidence() const { return mConfidence; }
+    // Time of the most recent beat in the analysed audio.
+    fl::u32 lastBeatMs() const { return mLastBeatMs; }
+    // The first predicted beat at or after `nowMs`, or 0 if not locked.
+    fl::u32 nextBeatMs(fl::u32 nowMs) const;
+    // Position within the beat at `nowMs`: 0 on a beat, rising towards 1
+    // just before the next one. 0 if not locked.
+    float phase(fl::u32 nowMs) const;
+
+  private:
+    void restart(fl::u32 timeMs);
+    void pushCell(float value);
+    void estimate();
+    float envAt(float cellsAgo) const;
+    float acfAt(float lag) const;
+    float refinePeak(float lag, int search) const;
+
+    TempoConfig mConfig;
+    float mDecay = 1.0f;    // per cell
+    float mMinLag = 0.0f;   // cells
+    float mMaxLag = 0.0f;
+    float mPreferredLag = 0.0f;
+
+    fl::array<float, kHistoryCells> mEnv;    // rectified onsets, newest at mWrite
+    fl::array<float, kMaxLagCells + 1> mAcf; // leaky autocorrelation by lag
+    fl::u32 mWrite = 0;
+    fl::u32 mCells = 0;                      // cells since restart, saturates
+    float mMean = 0.0f;
+    float mLevel = 0.0f;                     // recent raw onset level
+
+    bool mStarted = false;
+    fl::u32 mLastMs = 0;     // time of the last update()
+    float mLastOnset = 0.0f;
+    fl::u32 mNewestCellMs = 0;
+
+    float mPeriodMs = 0.0f;
+    float mConfidence = 0.0f;
+    fl::u32 mLastBeatMs = 0;
+};
+
+} // namespace fl
@@ -0,0 +1,51 @@
+#include "fl/coroutine.h"
+
+#include "fl/allocator.h"
+
+namespace fl {
+namespace detail {
+
+namespace {
+
+struct alignas(16) CoroutineFrameBlock {
+    u8 bytes[64];
+};
+
+// 32 blocks per slab: frames of up to 2 KB share slabs by power of two size
+// class, anything larger falls through to malloc.
+typedef SlabAllocator<CoroutineFrameBlock, 32> CoroutineFramePool;
+
+CoroutineFramePool& frame_pool() {
+    static CoroutineFramePool pool;
+    return pool;
+}
+
+fl::size blocks_for(fl::size size) {
+    const fl::size n = (size + sizeof(CoroutineFrameBlock) - 1) / sizeof(CoroutineFrameBlock);
+    return n ? n : 1;
+}
+
+fl::size gLiveFrames = 0;
+
+} // namespace
+
+void* coroutine_frame_allocate(fl::size size) {
+    void* ptr = frame_pool().allocate(blocks_for(size));
+    if (ptr) {
+        ++gLiveFrames;
+    }
+    return ptr;
+}
+
+void coroutine_frame_deallocate(void* ptr, fl::size size) {
+    if (!ptr) {
+        return;
+    }
+    --gLiveFrames;
+    frame_pool().deallocate(static_cast<CoroutineFrameBlock*>(ptr), blocks_for(size));
+}
+
+fl::size coroutine_frames_live() { return gLiveFrames; }
+
+} // namespace detail
+} // namespace fl
@@ -0,0 +1,192 @@
+#pragma once
+
+/// @file coroutine.h
+/// @brief C++20 coroutine support for fl::promise and the fl::Scheduler
+///
+/// With a compiler that supports coroutines, a function returning
+/// fl::promise<T> may be written as a coroutine. It runs straight away up to
+/// its first co_await, and the returned promise completes when it reaches
+/// co_return. Suspended coroutines are resumed by fl::Scheduler, so they
+/// advance while async_run() / FastLED.show() pump the scheduler and never
+/// spin-wait.
+///
+/// @section Usage
+/// @code
+/// #include "fl/coroutine.h"
+///
+/// fl::promise<int> fetch_status(const char* url) {
+///     fl::result<fl::response> r = co_await fl::fetch_get(url);
+///     if (!r.ok()) {
+///         co_return fl::Error(r.error().message);
+///     }
+///     co_return r.value().status();
+/// }
+///
+/// fl::promise<bool> blink_sequence(CRGB* leds) {
+///     for (int i = 0; i < 3; ++i) {
+///         leds[0] = CRGB::Red;
+///         co_await fl::next_frame();
+///         co_await fl::sleep_ms(250);
+///         leds[0] = CRGB::Black;
+///         co_await fl::sleep_ms(250);
+///     }
+///     co_return true;
+/// }
+/// @endcode
+///
+/// co_await on a fl::promise<U> yields a fl::result<U>, since builds run
+/// without exceptions. Awaiting a promise takes over its then() and catch_()
+/// callbacks. Coroutine frames come from a slab pool rather than the heap.
+///
+/// Without coroutine support (FASTLED_HAS_COROUTINES is 0, which is the case
+/// on the C++17 and older MCU toolchains) only the frame pool is declared;
+/// use the promise then()/catch_() callbacks and fl::task instead.
+
+#include "fl/int.h"
+#include "fl/namespace.h"
+
+#ifndef FASTLED_HAS_COROUTINES
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define FASTLED_HAS_COROUTINES 1
+#endif
+#endif
+#endif
+#ifndef FASTLED_HAS_COROUTINES
+#define FASTLED_HAS_COROUTINES 0
+#endif
+
+namespace fl {
+namespace detail {
+
+// Pool for coroutine frames. Frames up to 2 KB are served from slabs of
+// 64 byte blocks, larger ones from malloc. Not thread safe: coroutines are
+// resumed by the scheduler on the main loop.
+void* coroutine_frame_allocate(fl::size size);
+void coroutine_frame_deallocate(void* ptr, fl::size size);
+// Frames currently allocated, for tests and leak checks.
+fl::size coroutine_frames_live();
+
+} // namespace detail
+} // namespace fl
+
+#if FASTLED_HAS_COROUTINES
+
+#include <coroutine> // ok include
+
+#include "fl/promise.h"
+#include "fl/promise_result.h"
+#include "fl/task.h"
+#include "fl/type_traits.h"
+
+namespace fl {
+namespace detail {
+
+// Continues a suspended coroutine on the next Scheduler::update(), rather
+// than inside whatever callback noticed it could go on.
+inline void resume_from_scheduler(std::coroutine_handle<> handle) {
+    task::after_ms(0).then([handle]() { handle.resume(); });
+}
+
+// Promise type of coroutines that return fl::promise<T>.
+template <typename T> class PromiseCoroutine {
+  public:
+    fl::promise<T> get_return_object() { return mResult; }
+
+    // Runs eagerly and frees its frame as soon as it finishes; the result
+    // lives on in the shared promise state.
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+
+    template <typename U, typename = typename fl::enable_if<!fl::is_same<
+                              typename fl::decay<U>::type, Error>::value>::type>
+    void return_value(U&& value) {
+        mResult.complete_with_value(T(fl::forward<U>(value)));
+    }
+    void return_value(const Error& error) { mResult.complete_with_error(error); }
+
+    void unhandled_exception() {}
+
+    static void* operator new(fl::size size) {
+        return coroutine_frame_allocate(size);
+    }
+    static void operator delete(void* ptr, fl::size size) {
+        coroutine_frame_deallocate(ptr, size);
+    }
+
+  private:
+    fl::promise<T> mResult = fl::promise<T>::create();
+};
+
+template <typename T> class PromiseAwaiter {
+  public:
+    explicit PromiseAwaiter(fl::promise<T> p) : mPromise(fl::move(p)) {}
+
+    bool await_ready() const {
+        return !mPromise.valid() || mPromise.is_completed();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        mPromise.then([handle](const T&) { resume_from_scheduler(handle); });
+        mPromise.catch_([handle](const Error&) { resume_from_scheduler(handle); });
+    }
+
+    fl::result<T> await_resume() {
+        if (!mPromise.valid()) {
+            return fl::result<T>(Error("Invalid promise"));
+        }
+        if (mPromise.is_resolved()) {
+            return fl::result<T>(mPromise.value());
+        }
+        return fl::result<T>(mPromise.error());
+    }
+
+  private:
+    fl::promise<T> mPromise;
+};
+
+struct SleepAwaiter {
+    fl::u32 delay_ms;
+
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        task::after_ms(static_cast<int>(delay_ms)).then([handle]() { handle.resume(); });
+    }
+    void await_resume() {}
+};
+
+struct NextFrameAwaiter {
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        task::after_frame([handle]() { handle.resume(); });
+    }
+    void await_resume() {}
+};
+
+} // namespace detail
+
+template <typename T>
+detail::PromiseAwaiter<T> operator co_await(fl::promise<T> p) {
+    return detail::PromiseAwaiter<T>(fl::move(p));
+}
+
+/// Suspends the calling coroutine for at least delay_ms.
+inline detail::SleepAwaiter sleep_ms(fl::u32 delay_ms) {
+    return detail::SleepAwaiter{delay_ms};
+}
+
+/// Suspends the calling coroutine until the current frame has been shown.
+inline detail::NextFrameAwaiter next_frame() { return detail::NextFrameAwaiter{}; }
+
+} // namespace fl
+
+namespace std {
+
+template <typename T, typename... Args>
+struct coroutine_traits<fl::promise<T>, Args...> {
+    using promise_type = fl::detail::PromiseCoroutine<T>;
+};
+
+} // namespace std
+
+#endif // FASTLED_HAS_COROUTINES
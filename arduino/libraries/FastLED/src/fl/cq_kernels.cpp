@@ -0,0 +1,295 @@
+#include "fl/cq_kernels.h"
+
+#include "third_party/cq_kernel/cq_kernel.h"
+
+#include "fl/compiler_control.h"
+#include "fl/memfill.h"
+#include "fl/mutex.h"
+#include "fl/strstream.h"
+#include "fl/weak_ptr.h"
+#include <string.h>
+
+namespace fl {
+
+namespace {
+
+// Blob layout, native endianness:
+//   BlobHeader, Band[bands], i16 re[coefficients], i16 im[coefficients]
+const fl::u32 kBlobMagic = 0x314b5143; // "CQK1"
+
+struct BlobHeader {
+    fl::u32 magic;
+    fl::u16 samples;
+    fl::u16 bands;
+    float fmin;
+    float fmax;
+    float fs;
+    fl::i16 minVal;
+    fl::u8 window;
+    fl::u8 reserved0;
+    fl::u32 coefficients;
+    fl::u32 reserved1;
+};
+
+fl::size blob_size(fl::size bands, fl::size coefficients) {
+    return sizeof(BlobHeader) + bands * sizeof(CqKernelBank::Band) +
+           2 * coefficients * sizeof(fl::i16);
+}
+
+struct CacheEntry {
+    CqKernelParams params;
+    fl::weak_ptr<const CqKernelBank> bank;
+};
+
+struct KernelCache {
+    fl::mutex mutex;
+    fl::vector<CacheEntry> entries;
+    // Preloaded banks are static tables, so they are kept for good.
+    fl::vector<fl::shared_ptr<const CqKernelBank>> pinned;
+
+    static KernelCache &instance() {
+        static KernelCache sCache;
+        return sCache;
+    }
+
+    // Called with the mutex held.
+    fl::shared_ptr<const CqKernelBank> find(const CqKernelParams &params) {
+        for (fl::size i = 0; i < entries.size(); ++i) {
+            if (entries[i].params == params) {
+                fl::shared_ptr<const CqKernelBank> bank = entries[i].bank.lock();
+                if (bank) {
+                    return bank;
+                }
+            }
+        }
+        return fl::shared_ptr<const CqKernelBank>();
+    }
+
+    void put(const CqKernelParams &params, const fl::shared_ptr<const CqKernelBank> &bank) {
+        for (fl::size i = 0; i < entries.size(); ++i) {
+            if (entries[i].params == params || entries[i].bank.expired()) {
+                entries[i].params = params;
+                entries[i].bank = bank;
+                return;
+            }
+        }
+        CacheEntry entry;
+        entry.params = params;
+        entry.bank = bank;
+        entries.push_back(entry);
+    }
+};
+
+} // namespace
+
+bool CqKernelParams::operator==(const CqKernelParams &other) const {
+    FL_DISABLE_WARNING_PUSH
+    FL_DISABLE_WARNING(float-equal);
+
+    return samples == other.samples && bands == other.bands &&
+           fmin == other.fmin && fmax == other.fmax && fs == other.fs &&
+           minVal == other.minVal && window == other.window;
+
+    FL_DISABLE_WARNING_POP
+}
+
+fl::shared_ptr<const CqKernelBank> CqKernelBank::get(const CqKernelParams &params) {
+    KernelCache &cache = KernelCache::instance();
+    {
+        fl::lock_guard<fl::mutex> lock(cache.mutex);
+        fl::shared_ptr<const CqKernelBank> bank = cache.find(params);
+        if (bank) {
+            return bank;
+        }
+    }
+    // Generate outside the lock, it is slow. If two threads race the loser's
+    // bank is simply not cached.
+    fl::shared_ptr<const CqKernelBank> bank = generate(params);
+    fl::lock_guard<fl::mutex> lock(cache.mutex);
+    fl::shared_ptr<const CqKernelBank> existing = cache.find(params);
+    if (existing) {
+        return existing;
+    }
+    cache.put(params, bank);
+    return bank;
+}
+
+fl::shared_ptr<const CqKernelBank> CqKernelBank::generate(const CqKernelParams &params) {
+    cq_kernel_cfg cfg;
+    fl::memfill(&cfg, 0, sizeof(cfg));
+    cfg.samples = params.samples;
+    cfg.bands = params.bands;
+    cfg.fmin = params.fmin;
+    cfg.fmax = params.fmax;
+    cfg.fs = params.fs;
+    cfg.window_type = static_cast<window_type>(params.window);
+    cfg.min_val = params.minVal;
+    cq_kernels_t sparse = generate_kernels(cfg);
+
+    fl::shared_ptr<CqKernelBank> bank = fl::make_shared<CqKernelBank>();
+    bank->mParams = params;
+    bank->mOwnedBands.reserve(params.bands);
+    for (int i = 0; i < params.bands; ++i) {
+        const sparse_arr &kernel = sparse[i];
+        Band band;
+        band.offset = static_cast<fl::u32>(bank->mOwnedRe.size());
+        band.first = 0;
+        band.count = 0;
+        if (kernel.n_elems > 0) {
+            const int first = kernel.elems[0].n;
+            const int last = kernel.elems[kernel.n_elems - 1].n;
+            band.first = static_cast<fl::u16>(first);
+            band.count = static_cast<fl::u16>(last - first + 1);
+            // Entries dropped inside the run become zeros, which add
+            // nothing to the sum.
+            bank->mOwnedRe.resize(band.offset + band.count, 0);
+            bank->mOwnedIm.resize(band.offset + band.count, 0);
+            for (int j = 0; j < kernel.n_elems; ++j) {
+                const fl::u32 k = band.offset + (kernel.elems[j].n - first);
+                bank->mOwnedRe[k] = kernel.elems[j].val.r;
+                bank->mOwnedIm[k] = kernel.elems[j].val.i;
+            }
+        }
+        bank->mOwnedBands.push_back(band);
+    }
+    free_kernels(sparse, cfg);
+
+    bank->mBands = bank->mOwnedBands.data();
+    bank->mRe = bank->mOwnedRe.data();
+    bank->mIm = bank->mOwnedIm.data();
+    bank->mBandCount = bank->mOwnedBands.size();
+    bank->mCoefficientCount = bank->mOwnedRe.size();
+    return bank;
+}
+
+fl::shared_ptr<const CqKernelBank> CqKernelBank::fromBlob(fl::span<const fl::u8> blob) {
+    BlobHeader header;
+    if (blob.size() < sizeof(header) ||
+        (reinterpret_cast<fl::uptr>(blob.data()) & 3) != 0) {
+        return fl::shared_ptr<const CqKernelBank>();
+    }
+    memcpy(&header, blob.data(), sizeof(header));
+    if (header.magic != kBlobMagic ||
+        blob.size() < blob_size(header.bands, header.coefficients)) {
+        return fl::shared_ptr<const CqKernelBank>();
+    }
+    fl::shared_ptr<CqKernelBank> bank = fl::make_shared<CqKernelBank>();
+    bank->mParams.samples = header.samples;
+    bank->mParams.bands = header.bands;
+    bank->mParams.fmin = header.fmin;
+    bank->mParams.fmax = header.fmax;
+    bank->mParams.fs = header.fs;
+    bank->mParams.minVal = header.minVal;
+    bank->mParams.window = header.window;
+    bank->mBandCount = header.bands;
+    bank->mCoefficientCount = header.coefficients;
+    const fl::u8 *p = blob.data() + sizeof(header);
+    bank->mBands = reinterpret_cast<const Band *>(p);
+    p += header.bands * sizeof(Band);
+    bank->mRe = reinterpret_cast<const fl::i16 *>(p);
+    bank->mIm = bank->mRe + header.coefficients;
+    // Every run has to stay inside the coefficients and the FFT output.
+    for (fl::size i = 0; i < bank->mBandCount; ++i) {
+        const Band &band = bank->mBands[i];
+        if (band.offset + band.count > header.coefficients ||
+            band.first + band.count > header.samples / 2 + 1) {
+            return fl::shared_ptr<const CqKernelBank>();
+        }
+    }
+    return bank;
+}
+
+bool CqKernelBank::preload(fl::span<const fl::u8> blob) {
+    fl::shared_ptr<const CqKernelBank> bank = fromBlob(blob);
+    if (!bank) {
+        return false;
+    }
+    KernelCache &cache = KernelCache::instance();
+    fl::lock_guard<fl::mutex> lock(cache.mutex);
+    cache.pinned.push_back(bank);
+    cache.put(bank->params(), bank);
+    return true;
+}
+
+void CqKernelBank::clearCache() {
+    KernelCache &cache = KernelCache::instance();
+    fl::lock_guard<fl::mutex> lock(cache.mutex);
+    cache.entries.clear();
+    cache.pinned.clear();
+}
+
+// Vectorized by the compiler at O3; the -Os / -O2 that sketches build with
+// would leave the inner loop scalar.
+FL_OPTIMIZATION_LEVEL_O3_BEGIN
+
+void CqKernelBank::apply(const fl::i16 *fft, fl::i16 *cq) const {
+    for (fl::size b = 0; b < mBandCount; ++b) {
+        const Band &band = mBands[b];
+        const fl::i16 *x = fft + 2 * band.first;
+        const fl::i16 *re = mRe + band.offset;
+        const fl::i16 *im = mIm + band.offset;
+        const fl::u32 count = band.count;
+        // Each product is rounded back to Q15 before it is summed, as
+        // C_MUL / C_ADDTO do, and the sum wraps to 16 bits at the end.
+        fl::i32 acc_re = 0;
+        fl::i32 acc_im = 0;
+        for (fl::u32 k = 0; k < count; ++k) {
+            const fl::i32 xr = x[2 * k];
+            const fl::i32 xi = x[2 * k + 1];
+            const fl::i32 kr = re[k];
+            const fl::i32 ki = im[k];
+            acc_re += (xr * kr - xi * ki + (1 << 14)) >> 15;
+            acc_im += (xr * ki + xi * kr + (1 << 14)) >> 15;
+        }
+        cq[2 * b] = static_cast<fl::i16>(acc_re);
+        cq[2 * b + 1] = static_cast<fl::i16>(acc_im);
+    }
+}
+
+FL_OPTIMIZATION_LEVEL_O3_END
+
+fl::vector<fl::u8> CqKernelBank::toBlob() const {
+    BlobHeader header;
+    fl::memfill(&header, 0, sizeof(header));
+    header.magic = kBlobMagic;
+    header.samples = static_cast<fl::u16>(mParams.samples);
+    header.bands = static_cast<fl::u16>(mBandCount);
+    header.fmin = mParams.fmin;
+    header.fmax = mParams.fmax;
+    header.fs = mParams.fs;
+    header.minVal = mParams.minVal;
+    header.window = mParams.window;
+    header.coefficients = static_cast<fl::u32>(mCoefficientCount);
+
+    fl::vector<fl::u8> out;
+    out.resize(blob_size(mBandCount, mCoefficientCount));
+    fl::u8 *p = out.data();
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, mBands, mBandCount * sizeof(Band));
+    p += mBandCount * sizeof(Band);
+    memcpy(p, mRe, mCoefficientCount * sizeof(fl::i16));
+    p += mCoefficientCount * sizeof(fl::i16);
+    memcpy(p, mIm, mCoefficientCount * sizeof(fl::i16));
+    return out;
+}
+
+fl::string CqKernelBank::toCSource(const char *name) const {
+    static const char kHex[] = "0123456789abcdef";
+    const fl::vector<fl::u8> blob = toBlob();
+    fl::StrStream ss;
+    ss << "// cq kernels: " << mParams.samples << " samples, " << mParams.bands
+       << " bands, " << mParams.fmin << "-" << mParams.fmax << " Hz at "
+       << mParams.fs << " Hz\n";
+    ss << "alignas(4) const unsigned char " << name << "[" << blob.size()
+       << "] = {";
+    for (fl::size i = 0; i < blob.size(); ++i) {
+        ss << (i % 16 == 0 ? "\n    " : " ");
+        char byte[6] = {'0', 'x', kHex[blob[i] >> 4], kHex[blob[i] & 0xf], ',', 0};
+        ss << byte;
+    }
+    ss << "\n};\n";
+    return ss.str();
+}
+
+} // namespace fl
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "fl/int.h"
+#include "fl/shared_ptr.h"
+#include "fl/span.h"
+#include "fl/str.h"
+#include "fl/vector.h"
+
+namespace fl {
+
+// Parameters of a constant-Q kernel bank, see third_party/cq_kernel.
+struct CqKernelParams {
+    int samples = 512;
+    int bands = 16;
+    float fmin = 174.6f;
+    float fmax = 4698.3f;
+    float fs = 44100.0f;
+    fl::i16 minVal = 5000; // Q15 magnitude below which kernel entries are dropped
+    fl::u8 window = 0;     // cq_kernel window_type, 0 = Hamming
+
+    bool operator==(const CqKernelParams &other) const;
+    bool operator!=(const CqKernelParams &other) const { return !(*this == other); }
+};
+
+// Constant-Q kernels in a layout made for applying them quickly. Each
+// band's kernel covers a short contiguous run of FFT bins, so a band is
+// stored as its first bin plus dense real and imaginary coefficient arrays
+// (gaps below the threshold are zero). apply() is then one straight
+// multiply-accumulate loop per band that the compiler can vectorize, and the
+// result is bit for bit what cq_kernel's apply_kernels() gives.
+//
+// Generating kernels costs one FFT per band plus a window of
+// transcendentals, so banks are cached: get() builds each parameter set once
+// and hands out the same bank for as long as something holds on to it.
+// A bank can also be serialized with toBlob() / toCSource() on the host and
+// compiled into the sketch; preload() makes get() use that blob in place, so
+// nothing is computed at startup and the coefficients stay in flash.
+class CqKernelBank {
+  public:
+    struct Band {
+        fl::u16 first;  // first FFT bin
+        fl::u16 count;  // number of bins
+        fl::u32 offset; // into the coefficient arrays
+    };
+
+    // Cached bank for `params`, generated on first use.
+    static fl::shared_ptr<const CqKernelBank> get(const CqKernelParams &params);
+
+    // A new bank, bypassing the cache.
+    static fl::shared_ptr<const CqKernelBank> generate(const CqKernelParams &params);
+
+    // A bank that reads directly from `blob`, which must stay alive, be
+    // 4 byte aligned and come from toBlob() on a machine of the same
+    // endianness. Returns null if the blob is not valid.
+    static fl::shared_ptr<const CqKernelBank> fromBlob(fl::span<const fl::u8> blob);
+
+    // Makes get() return the bank in `blob` for its parameters from now on.
+    // The blob is expected to be a static table. Returns false if it is not
+    // valid.
+    static bool preload(fl::span<const fl::u8> blob);
+
+    // Drops cached and preloaded banks; banks in use stay valid.
+    static void clearCache();
+
+    // cq receives `bands` complex values as interleaved re, im pairs, from
+    // the interleaved kiss_fftr output in fft.
+    void apply(const fl::i16 *fft, fl::i16 *cq) const;
+
+    const CqKernelParams &params() const { return mParams; }
+    fl::size bandCount() const { return mBandCount; }
+    const Band &band(fl::size i) const { return mBands[i]; }
+    fl::size coefficientCount() const { return mCoefficientCount; }
+
+    fl::vector<fl::u8> toBlob() const;
+    // The blob as a C array definition named `name`, ready to paste into a
+    // sketch and pass to preload().
+    fl::string toCSource(const char *name) const;
+
+    CqKernelBank(const CqKernelBank &) = delete;
+    CqKernelBank &operator=(const CqKernelBank &) = delete;
+    CqKernelBank() = default; // use the factories
+
+  private:
+    CqKernelParams mParams;
+    // Either point into the owned vectors or into a blob.
+    const Band *mBands = nullptr;
+    const fl::i16 *mRe = nullptr;
+    const fl::i16 *mIm = nullptr;
+    fl::size mBandCount = 0;
+    fl::size mCoefficientCount = 0;
+    fl::vector<Band> mOwnedBands;
+    fl::vector<fl::i16> mOwnedRe;
+    fl::vector<fl::i16> mOwnedIm;
+};
+
+} // namespace fl
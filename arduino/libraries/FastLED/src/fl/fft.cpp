@@ -39,6 +39,10 @@ void FFT::run(const span<const fl::i16> &sample, FFTBins *out,
               const FFT_Args &args) {
     FFT_Args args2 = args;
     args2.samples = sample.size();
+    // Resolve the default now so that changing it takes effect here.
+    if (args2.backend == FFTBackendType::Default) {
+        args2.backend = fft_default_backend();
+    }
     get_or_create(args2).run(sample, out);
 }
 
@@ -66,7 +70,7 @@ bool FFT_Args::operator==(const FFT_Args &other) const {
 
     return samples == other.samples && bands == other.bands &&
            fmin == other.fmin && fmax == other.fmax &&
-           sample_rate == other.sample_rate;
+           sample_rate == other.sample_rate && backend == other.backend;
 
     FL_DISABLE_WARNING_POP
 }
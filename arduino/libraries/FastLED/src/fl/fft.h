@@ -5,6 +5,7 @@
 #include "fl/vector.h"
 #include "fl/move.h"
 #include "fl/memfill.h"
+#include "fl/fft_backend.h"
 
 namespace fl {
 
@@ -70,11 +71,14 @@ struct FFT_Args {
     float fmin;
     float fmax;
     int sample_rate;
+    // Which FFT to run, see fl/fft_backend.h.
+    FFTBackendType backend;
 
     FFT_Args(int samples = DefaultSamples(), int bands = DefaultBands(),
              float fmin = DefaultMinFrequency(),
              float fmax = DefaultMaxFrequency(),
-             int sample_rate = DefaultSampleRate()) {
+             int sample_rate = DefaultSampleRate(),
+             FFTBackendType backend = FFTBackendType::Default) {
         // Memset so that this object can be hashed without garbage from packed
         // in data.
         fl::memfill(this, 0, sizeof(FFT_Args));
@@ -83,6 +87,7 @@ struct FFT_Args {
         this->fmin = fmin;
         this->fmax = fmax;
         this->sample_rate = sample_rate;
+        this->backend = backend;
     }
     
     // Rule of 5 for POD data
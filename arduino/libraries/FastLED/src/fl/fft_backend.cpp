@@ -0,0 +1,539 @@
+#include "fl/fft_backend.h"
+
+#include "third_party/cq_kernel/kiss_fftr.h"
+
+#include "fl/compiler_control.h"
+#include "fl/math_macros.h"
+#include "fl/mutex.h"
+#include "fl/shared_ptr.h"
+#include "fl/vector.h"
+#include "fl/weak_ptr.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FL_FFT_SIMD_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FL_FFT_SIMD_NEON 1
+#endif
+
+namespace fl {
+
+namespace {
+
+// Both radix-4 backends split the real FFT of N points into a complex FFT
+// of M = N / 2 points over the even / odd samples packed as re / im, then
+// untangle the two halves. The complex FFT is decimation in time on
+// bit-reversed input: one radix-2 pass when log2(M) is odd, then radix-4
+// passes. In bit-reversed order the four blocks a radix-4 pass combines
+// hold the sub-transforms of residues 0, 2, 1, 3.
+
+const int kMinRadix4Size = 64;
+const int kMaxRadix4Size = 4096;
+
+FFTBackendType gDefaultBackend = FFTBackendType::Kiss;
+
+int log2_of(int n) {
+    int bits = 0;
+    while ((1 << bits) < n) {
+        ++bits;
+    }
+    return bits;
+}
+
+void fill_bitrev(fl::vector<u16> &table, int m) {
+    const int bits = log2_of(m);
+    table.resize(m);
+    for (int i = 0; i < m; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        table[i] = static_cast<u16>(r);
+    }
+}
+
+i16 to_q15(double v) { return static_cast<i16>(floor(0.5 + 32767.0 * v)); }
+
+// Plans are cached per size while any backend uses them.
+template <typename Plan> struct PlanCache {
+    fl::mutex mutex;
+    fl::vector<fl::weak_ptr<Plan>> plans;
+
+    static PlanCache &instance() {
+        static PlanCache sCache;
+        return sCache;
+    }
+
+    fl::shared_ptr<Plan> get(int n) {
+        fl::lock_guard<fl::mutex> lock(mutex);
+        for (fl::size i = 0; i < plans.size(); ++i) {
+            fl::shared_ptr<Plan> plan = plans[i].lock();
+            if (plan && plan->n == n) {
+                return plan;
+            }
+        }
+        fl::shared_ptr<Plan> plan = fl::make_shared<Plan>(n);
+        for (fl::size i = 0; i < plans.size(); ++i) {
+            if (plans[i].expired()) {
+                plans[i] = plan;
+                return plan;
+            }
+        }
+        plans.push_back(plan);
+        return plan;
+    }
+
+    fl::size live() {
+        fl::lock_guard<fl::mutex> lock(mutex);
+        fl::size count = 0;
+        for (fl::size i = 0; i < plans.size(); ++i) {
+            count += plans[i].expired() ? 0 : 1;
+        }
+        return count;
+    }
+};
+
+class KissBackend : public IFFTBackend {
+  public:
+    explicit KissBackend(int n) : mSize(n) {
+        mCfg = kiss_fftr_alloc(n, 0, nullptr, nullptr);
+    }
+    ~KissBackend() override {
+        if (mCfg) {
+            kiss_fftr_free(mCfg);
+        }
+    }
+    bool ok() const { return mCfg != nullptr; }
+
+    FFTBackendType type() const override { return FFTBackendType::Kiss; }
+    const char *name() const override { return "kiss_fftr"; }
+    int size() const override { return mSize; }
+    void forward(const i16 *in, i16 *out) override {
+        kiss_fftr(mCfg, in, reinterpret_cast<kiss_fft_cpx *>(out));
+    }
+
+  private:
+    kiss_fftr_cfg mCfg;
+    int mSize;
+};
+
+// ---------------------------------------------------------------------------
+// Q15 fixed point. Data stays 16 bit between passes; each pass divides by its
+// radix, so nothing overflows, and rounds once per output from 32 bit
+// intermediates. Twiddle products are Q30 and fit an i32 for any i16 input.
+
+struct FixedPlan {
+    explicit FixedPlan(int size) : n(size), m(size / 2) {
+        fill_bitrev(bitrev, m);
+        twiddles.resize(2 * m);
+        for (int j = 0; j < m; ++j) {
+            const double phase = -2.0 * PI * j / m;
+            twiddles[2 * j] = to_q15(cos(phase));
+            twiddles[2 * j + 1] = to_q15(sin(phase));
+        }
+        // -j * exp(-2 pi i k / N), as kiss_fftr's super twiddles.
+        split.resize(2 * (m / 2 + 1));
+        for (int k = 0; k <= m / 2; ++k) {
+            const double phase = 2.0 * PI * k / n;
+            split[2 * k] = to_q15(-sin(phase));
+            split[2 * k + 1] = to_q15(-cos(phase));
+        }
+    }
+
+    int n;
+    int m;
+    fl::vector<u16> bitrev;
+    fl::vector<i16> twiddles; // exp(-2 pi i j / M), interleaved
+    fl::vector<i16> split;
+};
+
+class FixedBackend : public IFFTBackend {
+  public:
+    explicit FixedBackend(int n)
+        : mPlan(PlanCache<FixedPlan>::instance().get(n)) {
+        mWork.resize(2 * mPlan->m);
+    }
+
+    FFTBackendType type() const override { return FFTBackendType::Radix4Fixed; }
+    const char *name() const override { return "radix4_q15"; }
+    int size() const override { return mPlan->n; }
+    void forward(const i16 *in, i16 *out) override;
+
+  private:
+    void radix4(int l);
+
+    fl::shared_ptr<const FixedPlan> mPlan;
+    fl::vector<i16> mWork;
+};
+
+inline i16 round_q15(i32 v) { return static_cast<i16>((v + (1 << 14)) >> 15); }
+
+void FixedBackend::radix4(int l) {
+    const int m = mPlan->m;
+    const int stride = m / (4 * l);
+    const i16 *tw = mPlan->twiddles.data();
+    i16 *x = mWork.data();
+    for (int g = 0; g < m; g += 4 * l) {
+        for (int k = 0; k < l; ++k) {
+            i16 *p0 = x + 2 * (g + k);
+            i16 *p1 = p0 + 2 * l;
+            i16 *p2 = p1 + 2 * l;
+            i16 *p3 = p2 + 2 * l;
+            const i16 *w1 = tw + 2 * (k * stride);
+            const i16 *w2 = tw + 2 * (2 * k * stride);
+            const i16 *w3 = tw + 2 * (3 * k * stride);
+            // Residues 0, 2, 1, 3 in block order; everything in Q28, which
+            // is Q30 divided by the radix.
+            const i32 b0r = i32(p0[0]) << 13;
+            const i32 b0i = i32(p0[1]) << 13;
+            const i32 b2r = (i32(p1[0]) * w2[0] - i32(p1[1]) * w2[1]) >> 2;
+            const i32 b2i = (i32(p1[0]) * w2[1] + i32(p1[1]) * w2[0]) >> 2;
+            const i32 b1r = (i32(p2[0]) * w1[0] - i32(p2[1]) * w1[1]) >> 2;
+            const i32 b1i = (i32(p2[0]) * w1[1] + i32(p2[1]) * w1[0]) >> 2;
+            const i32 b3r = (i32(p3[0]) * w3[0] - i32(p3[1]) * w3[1]) >> 2;
+            const i32 b3i = (i32(p3[0]) * w3[1] + i32(p3[1]) * w3[0]) >> 2;
+
+            const i32 s02r = b0r + b2r, s02i = b0i + b2i;
+            const i32 d02r = b0r - b2r, d02i = b0i - b2i;
+            const i32 s13r = b1r + b3r, s13i = b1i + b3i;
+            const i32 d13r = b1r - b3r, d13i = b1i - b3i;
+            p0[0] = round_q15(s02r + s13r);
+            p0[1] = round_q15(s02i + s13i);
+            // -j (b1 - b3)
+            p1[0] = round_q15(d02r + d13i);
+            p1[1] = round_q15(d02i - d13r);
+            p2[0] = round_q15(s02r - s13r);
+            p2[1] = round_q15(s02i - s13i);
+            p3[0] = round_q15(d02r - d13i);
+            p3[1] = round_q15(d02i + d13r);
+        }
+    }
+}
+
+void FixedBackend::forward(const i16 *in, i16 *out) {
+    const FixedPlan &plan = *mPlan;
+    const int m = plan.m;
+    i16 *x = mWork.data();
+    const u16 *bitrev = plan.bitrev.data();
+    for (int i = 0; i < m; ++i) {
+        const int j = bitrev[i];
+        x[2 * j] = in[2 * i];
+        x[2 * j + 1] = in[2 * i + 1];
+    }
+    int l = 1;
+    if (log2_of(m) & 1) {
+        for (int i = 0; i < 2 * m; i += 4) {
+            const i32 ar = x[i], ai = x[i + 1], br = x[i + 2], bi = x[i + 3];
+            x[i] = static_cast<i16>((ar + br + 1) >> 1);
+            x[i + 1] = static_cast<i16>((ai + bi + 1) >> 1);
+            x[i + 2] = static_cast<i16>((ar - br + 1) >> 1);
+            x[i + 3] = static_cast<i16>((ai - bi + 1) >> 1);
+        }
+        l = 2;
+    }
+    for (; l < m; l *= 4) {
+        radix4(l);
+    }
+
+    // x now holds Z / M. With A = Z[k] and B = conj(Z[M - k]):
+    //   out[k]     = (A + B + T (A - B)) / 4
+    //   out[M - k] = conj(A + B - T (A - B)) / 4
+    out[0] = static_cast<i16>((i32(x[0]) + x[1] + 1) >> 1);
+    out[1] = 0;
+    out[2 * m] = static_cast<i16>((i32(x[0]) - x[1] + 1) >> 1);
+    out[2 * m + 1] = 0;
+    const i16 *t = plan.split.data();
+    for (int k = 1; k <= m / 2; ++k) {
+        const i32 ar = x[2 * k], ai = x[2 * k + 1];
+        const i32 br = x[2 * (m - k)], bi = -i32(x[2 * (m - k) + 1]);
+        const i32 tr = t[2 * k], ti = t[2 * k + 1];
+        const i32 f1r = (ar + br) << 13;
+        const i32 f1i = (ai + bi) << 13;
+        const i32 tfr = ((ar * tr - ai * ti) >> 2) - ((br * tr - bi * ti) >> 2);
+        const i32 tfi = ((ar * ti + ai * tr) >> 2) - ((br * ti + bi * tr) >> 2);
+        out[2 * k] = round_q15(f1r + tfr);
+        out[2 * k + 1] = round_q15(f1i + tfi);
+        out[2 * (m - k)] = round_q15(f1r - tfr);
+        out[2 * (m - k) + 1] = round_q15(tfi - f1i);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Float. Unscaled until the end; the radix-4 passes run four butterflies at a
+// time with SSE / NEON, or plain floats elsewhere, over split re / im arrays.
+
+#if defined(FL_FFT_SIMD_SSE)
+typedef __m128 f32x4;
+inline f32x4 f4_load(const float *p) { return _mm_loadu_ps(p); }
+inline void f4_store(float *p, f32x4 v) { _mm_storeu_ps(p, v); }
+inline f32x4 f4_add(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+inline f32x4 f4_sub(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+inline f32x4 f4_mul(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+#elif defined(FL_FFT_SIMD_NEON)
+typedef float32x4_t f32x4;
+inline f32x4 f4_load(const float *p) { return vld1q_f32(p); }
+inline void f4_store(float *p, f32x4 v) { vst1q_f32(p, v); }
+inline f32x4 f4_add(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+inline f32x4 f4_sub(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+inline f32x4 f4_mul(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+#else
+struct f32x4 {
+    float v[4];
+};
+inline f32x4 f4_load(const float *p) {
+    f32x4 r = {{p[0], p[1], p[2], p[3]}};
+    return r;
+}
+inline void f4_store(float *p, f32x4 a) {
+    p[0] = a.v[0];
+    p[1] = a.v[1];
+    p[2] = a.v[2];
+    p[3] = a.v[3];
+}
+inline f32x4 f4_add(f32x4 a, f32x4 b) {
+    f32x4 r = {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+    return r;
+}
+inline f32x4 f4_sub(f32x4 a, f32x4 b) {
+    f32x4 r = {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+    return r;
+}
+inline f32x4 f4_mul(f32x4 a, f32x4 b) {
+    f32x4 r = {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+    return r;
+}
+#endif
+
+struct FloatPlan {
+    explicit FloatPlan(int size) : n(size), m(size / 2) {
+        fill_bitrev(bitrev, m);
+        // Per pass, for k < L: W^k, W^2k, W^3k of the 4L point transform,
+        // each as a run of L re values followed by L im values, so the
+        // butterfly loop loads them four at a time.
+        int l = (log2_of(m) & 1) ? 2 : 1;
+        for (; l < m; l *= 4) {
+            offsets.push_back(static_cast<u32>(twiddles.size()));
+            for (int r = 1; r <= 3; ++r) {
+                for (int part = 0; part < 2; ++part) {
+                    for (int k = 0; k < l; ++k) {
+                        const double phase = -2.0 * PI * r * k / (4.0 * l);
+                        twiddles.push_back(float(part == 0 ? cos(phase) : sin(phase)));
+                    }
+                }
+            }
+        }
+        split.resize(2 * (m / 2 + 1));
+        for (int k = 0; k <= m / 2; ++k) {
+            const double phase = 2.0 * PI * k / n;
+            split[2 * k] = float(-sin(phase));
+            split[2 * k + 1] = float(-cos(phase));
+        }
+    }
+
+    int n;
+    int m;
+    fl::vector<u16> bitrev;
+    fl::vector<float> twiddles;
+    fl::vector<u32> offsets; // start of each radix-4 pass in twiddles
+    fl::vector<float> split;
+};
+
+class FloatBackend : public IFFTBackend {
+  public:
+    explicit FloatBackend(int n)
+        : mPlan(PlanCache<FloatPlan>::instance().get(n)) {
+        mRe.resize(mPlan->m);
+        mIm.resize(mPlan->m);
+    }
+
+    FFTBackendType type() const override { return FFTBackendType::Radix4Float; }
+    const char *name() const override {
+#if defined(FL_FFT_SIMD_SSE)
+        return "radix4_float_sse";
+#elif defined(FL_FFT_SIMD_NEON)
+        return "radix4_float_neon";
+#else
+        return "radix4_float";
+#endif
+    }
+    int size() const override { return mPlan->n; }
+    void forward(const i16 *in, i16 *out) override;
+
+  private:
+    void radix4(int l, const float *tw);
+
+    fl::shared_ptr<const FloatPlan> mPlan;
+    fl::vector<float> mRe;
+    fl::vector<float> mIm;
+};
+
+FL_OPTIMIZATION_LEVEL_O3_BEGIN
+
+void FloatBackend::radix4(int l, const float *tw) {
+    const int m = mPlan->m;
+    float *re = mRe.data();
+    float *im = mIm.data();
+    const float *w1r = tw, *w1i = tw + l;
+    const float *w2r = tw + 2 * l, *w2i = tw + 3 * l;
+    const float *w3r = tw + 4 * l, *w3i = tw + 5 * l;
+    for (int g = 0; g < m; g += 4 * l) {
+        float *r0 = re + g, *r1 = r0 + l, *r2 = r1 + l, *r3 = r2 + l;
+        float *i0 = im + g, *i1 = i0 + l, *i2 = i1 + l, *i3 = i2 + l;
+        int k = 0;
+        for (; k + 4 <= l; k += 4) {
+            const f32x4 a1r = f4_load(r1 + k), a1i = f4_load(i1 + k);
+            const f32x4 a2r = f4_load(r2 + k), a2i = f4_load(i2 + k);
+            const f32x4 a3r = f4_load(r3 + k), a3i = f4_load(i3 + k);
+            const f32x4 c1r = f4_load(w1r + k), c1i = f4_load(w1i + k);
+            const f32x4 c2r = f4_load(w2r + k), c2i = f4_load(w2i + k);
+            const f32x4 c3r = f4_load(w3r + k), c3i = f4_load(w3i + k);
+            // Block 1 holds residue 2, block 2 residue 1.
+            const f32x4 b2r = f4_sub(f4_mul(a1r, c2r), f4_mul(a1i, c2i));
+            const f32x4 b2i = f4_add(f4_mul(a1r, c2i), f4_mul(a1i, c2r));
+            const f32x4 b1r = f4_sub(f4_mul(a2r, c1r), f4_mul(a2i, c1i));
+            const f32x4 b1i = f4_add(f4_mul(a2r, c1i), f4_mul(a2i, c1r));
+            const f32x4 b3r = f4_sub(f4_mul(a3r, c3r), f4_mul(a3i, c3i));
+            const f32x4 b3i = f4_add(f4_mul(a3r, c3i), f4_mul(a3i, c3r));
+            const f32x4 b0r = f4_load(r0 + k), b0i = f4_load(i0 + k);
+            const f32x4 s02r = f4_add(b0r, b2r), s02i = f4_add(b0i, b2i);
+            const f32x4 d02r = f4_sub(b0r, b2r), d02i = f4_sub(b0i, b2i);
+            const f32x4 s13r = f4_add(b1r, b3r), s13i = f4_add(b1i, b3i);
+            const f32x4 d13r = f4_sub(b1r, b3r), d13i = f4_sub(b1i, b3i);
+            f4_store(r0 + k, f4_add(s02r, s13r));
+            f4_store(i0 + k, f4_add(s02i, s13i));
+            f4_store(r1 + k, f4_add(d02r, d13i));
+            f4_store(i1 + k, f4_sub(d02i, d13r));
+            f4_store(r2 + k, f4_sub(s02r, s13r));
+            f4_store(i2 + k, f4_sub(s02i, s13i));
+            f4_store(r3 + k, f4_sub(d02r, d13i));
+            f4_store(i3 + k, f4_add(d02i, d13r));
+        }
+        // The first passes, with fewer than four butterflies per group.
+        for (; k < l; ++k) {
+            const float b2r = r1[k] * w2r[k] - i1[k] * w2i[k];
+            const float b2i = r1[k] * w2i[k] + i1[k] * w2r[k];
+            const float b1r = r2[k] * w1r[k] - i2[k] * w1i[k];
+            const float b1i = r2[k] * w1i[k] + i2[k] * w1r[k];
+            const float b3r = r3[k] * w3r[k] - i3[k] * w3i[k];
+            const float b3i = r3[k] * w3i[k] + i3[k] * w3r[k];
+            const float s02r = r0[k] + b2r, s02i = i0[k] + b2i;
+            const float d02r = r0[k] - b2r, d02i = i0[k] - b2i;
+            const float s13r = b1r + b3r, s13i = b1i + b3i;
+            const float d13r = b1r - b3r, d13i = b1i - b3i;
+            r0[k] = s02r + s13r;
+            i0[k] = s02i + s13i;
+            r1[k] = d02r + d13i;
+            i1[k] = d02i - d13r;
+            r2[k] = s02r - s13r;
+            i2[k] = s02i - s13i;
+            r3[k] = d02r - d13i;
+            i3[k] = d02i + d13r;
+        }
+    }
+}
+
+FL_OPTIMIZATION_LEVEL_O3_END
+
+inline i16 saturate_q15(float v) {
+    v += v < 0.0f ? -0.5f : 0.5f;
+    if (v > 32767.0f) {
+        return 32767;
+    }
+    if (v < -32768.0f) {
+        return -32768;
+    }
+    return static_cast<i16>(v);
+}
+
+void FloatBackend::forward(const i16 *in, i16 *out) {
+    const FloatPlan &plan = *mPlan;
+    const int m = plan.m;
+    float *re = mRe.data();
+    float *im = mIm.data();
+    const u16 *bitrev = plan.bitrev.data();
+    for (int i = 0; i < m; ++i) {
+        const int j = bitrev[i];
+        re[j] = in[2 * i];
+        im[j] = in[2 * i + 1];
+    }
+    int l = 1;
+    if (log2_of(m) & 1) {
+        for (int i = 0; i < m; i += 2) {
+            const float ar = re[i], ai = im[i];
+            re[i] = ar + re[i + 1];
+            im[i] = ai + im[i + 1];
+            re[i + 1] = ar - re[i + 1];
+            im[i + 1] = ai - im[i + 1];
+        }
+        l = 2;
+    }
+    for (fl::size pass = 0; l < m; l *= 4, ++pass) {
+        radix4(l, plan.twiddles.data() + plan.offsets[pass]);
+    }
+
+    // As in the fixed point split, plus the 1 / M the passes did not apply.
+    const float scale = 0.25f / float(m);
+    out[0] = saturate_q15((re[0] + im[0]) * 2.0f * scale);
+    out[1] = 0;
+    out[2 * m] = saturate_q15((re[0] - im[0]) * 2.0f * scale);
+    out[2 * m + 1] = 0;
+    const float *t = plan.split.data();
+    for (int k = 1; k <= m / 2; ++k) {
+        const float ar = re[k], ai = im[k];
+        const float br = re[m - k], bi = -im[m - k];
+        const float f1r = ar + br, f1i = ai + bi;
+        const float f2r = ar - br, f2i = ai - bi;
+        const float tfr = f2r * t[2 * k] - f2i * t[2 * k + 1];
+        const float tfi = f2r * t[2 * k + 1] + f2i * t[2 * k];
+        out[2 * k] = saturate_q15((f1r + tfr) * scale);
+        out[2 * k + 1] = saturate_q15((f1i + tfi) * scale);
+        out[2 * (m - k)] = saturate_q15((f1r - tfr) * scale);
+        out[2 * (m - k) + 1] = saturate_q15((tfi - f1i) * scale);
+    }
+}
+
+} // namespace
+
+bool fft_backend_supports(FFTBackendType type, int samples) {
+    if (type == FFTBackendType::Default) {
+        type = gDefaultBackend;
+    }
+    if (type == FFTBackendType::Kiss) {
+        return samples >= 2 && (samples & 1) == 0;
+    }
+    return samples >= kMinRadix4Size && samples <= kMaxRadix4Size &&
+           (samples & (samples - 1)) == 0;
+}
+
+fl::unique_ptr<IFFTBackend> make_fft_backend(FFTBackendType type, int samples) {
+    if (type == FFTBackendType::Default) {
+        type = gDefaultBackend;
+    }
+    if (type != FFTBackendType::Kiss && fft_backend_supports(type, samples)) {
+        if (type == FFTBackendType::Radix4Fixed) {
+            return fl::unique_ptr<IFFTBackend>(new FixedBackend(samples));
+        }
+        return fl::unique_ptr<IFFTBackend>(new FloatBackend(samples));
+    }
+    KissBackend *kiss = new KissBackend(samples);
+    if (!kiss->ok()) {
+        delete kiss;
+        return fl::unique_ptr<IFFTBackend>();
+    }
+    return fl::unique_ptr<IFFTBackend>(kiss);
+}
+
+void set_fft_default_backend(FFTBackendType type) {
+    gDefaultBackend = type == FFTBackendType::Default ? FFTBackendType::Kiss : type;
+}
+
+FFTBackendType fft_default_backend() { return gDefaultBackend; }
+
+fl::size fft_backend_plans_live() {
+    return PlanCache<FixedPlan>::instance().live() +
+           PlanCache<FloatPlan>::instance().live();
+}
+
+} // namespace fl
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "fl/int.h"
+#include "fl/unique_ptr.h"
+
+namespace fl {
+
+// Which real FFT implementation FFTImpl runs on.
+enum class FFTBackendType : u8 {
+    Default,     // whatever set_fft_default_backend() selected, Kiss to start with
+    Kiss,        // third_party kiss_fftr, any even size
+    Radix4Fixed, // Q15 data with 32 bit intermediates, for MCUs without an FPU
+    Radix4Float, // float, SSE / NEON when the target has them
+};
+
+// A real forward FFT of a fixed size. All backends take size() Q15 samples
+// and produce size() / 2 + 1 complex bins as interleaved re, im Q15 pairs,
+// scaled by 1 / size() exactly like kiss_fftr in fixed point mode, so the
+// constant-Q kernels and everything downstream work with any of them.
+//
+// The radix-4 backends handle power of two sizes from 64 to 4096. Their
+// twiddle and bit-reversal tables are shared between all instances of the
+// same size and type while any of them is alive.
+class IFFTBackend {
+  public:
+    virtual ~IFFTBackend() {}
+    virtual FFTBackendType type() const = 0;
+    virtual const char *name() const = 0;
+    virtual int size() const = 0;
+    virtual void forward(const i16 *in, i16 *out) = 0;
+};
+
+// Creates a backend for `samples`. Default is resolved through
+// fft_default_backend(); a radix-4 type that does not support `samples`
+// falls back to Kiss, so check type() if it matters. Returns null only if
+// kiss_fftr cannot be allocated.
+fl::unique_ptr<IFFTBackend> make_fft_backend(FFTBackendType type, int samples);
+
+// Whether `type` can run an FFT of `samples` points.
+bool fft_backend_supports(FFTBackendType type, int samples);
+
+// Backend used for FFTBackendType::Default from now on. FFTs created before
+// the call keep the backend they have.
+void set_fft_default_backend(FFTBackendType type);
+FFTBackendType fft_default_backend();
+
+// Radix-4 plans currently alive, for tests.
+fl::size fft_backend_plans_live();
+
+} // namespace fl
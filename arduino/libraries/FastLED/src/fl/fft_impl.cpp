@@ -17,7 +17,9 @@
 
 #include "fl/array.h"
 #include "fl/audio.h"
+#include "fl/cq_kernels.h"
 #include "fl/fft.h"
+#include "fl/fft_backend.h"
 #include "fl/fft_impl.h"
 #include "fl/str.h"
 #include "fl/unused.h"
@@ -40,8 +42,8 @@ namespace fl {
 
 class FFTContext {
   public:
-    FFTContext(int samples, int bands, float fmin, float fmax, int sample_rate)
-        : m_fftr_cfg(nullptr), m_kernels(nullptr) {
+    FFTContext(int samples, int bands, float fmin, float fmax, int sample_rate,
+               FFTBackendType backend) {
         fl::memfill(&m_cq_cfg, 0, sizeof(m_cq_cfg));
         m_cq_cfg.samples = samples;
         m_cq_cfg.bands = bands;
@@ -49,20 +51,22 @@ class FFTContext {
         m_cq_cfg.fmax = fmax;
         m_cq_cfg.fs = sample_rate;
         m_cq_cfg.min_val = MIN_VAL;
-        m_fftr_cfg = kiss_fftr_alloc(samples, 0, NULL, NULL);
-        if (!m_fftr_cfg) {
+        m_backend = make_fft_backend(backend, samples);
+        if (!m_backend) {
             FASTLED_WARN("Failed to allocate FFTImpl context");
             return;
         }
-        m_kernels = generate_kernels(m_cq_cfg);
-    }
-    ~FFTContext() {
-        if (m_fftr_cfg) {
-            kiss_fftr_free(m_fftr_cfg);
-        }
-        if (m_kernels) {
-            free_kernels(m_kernels, m_cq_cfg);
-        }
+        // Shared with every other FFT of the same shape, and only generated
+        // if no such FFT exists and no table was preloaded.
+        CqKernelParams params;
+        params.samples = samples;
+        params.bands = bands;
+        params.fmin = fmin;
+        params.fmax = fmax;
+        params.fs = float(sample_rate);
+        params.minVal = MIN_VAL;
+        params.window = static_cast<u8>(m_cq_cfg.window_type);
+        m_kernels = CqKernelBank::get(params);
     }
 
     fl::size sampleSize() const { return m_cq_cfg.samples; }
@@ -76,8 +80,11 @@ class FFTContext {
         FASTLED_STACK_ARRAY(kiss_fft_cpx, fft, m_cq_cfg.samples);
         FASTLED_STACK_ARRAY(kiss_fft_cpx, cq, m_cq_cfg.bands);
         // initialize
-        kiss_fftr(m_fftr_cfg, buffer.data(), fft);
-        apply_kernels(fft, cq, m_kernels, m_cq_cfg);
+        // kiss_fft_cpx is a pair of i16, so both arrays are interleaved
+        // re, im, which is what every backend writes.
+        m_backend->forward(buffer.data(), reinterpret_cast<i16 *>(&fft[0]));
+        m_kernels->apply(reinterpret_cast<const i16 *>(&fft[0]),
+                         reinterpret_cast<i16 *>(&cq[0]));
         const float maxf = m_cq_cfg.fmax;
         const float minf = m_cq_cfg.fmin;
         const float delta_f = (maxf - minf) / m_cq_cfg.bands;
@@ -122,14 +129,14 @@ class FFTContext {
     }
 
   private:
-    kiss_fftr_cfg m_fftr_cfg;
-    cq_kernels_t m_kernels;
+    fl::unique_ptr<IFFTBackend> m_backend;
+    fl::shared_ptr<const CqKernelBank> m_kernels;
     cq_kernel_cfg m_cq_cfg;
 };
 
 FFTImpl::FFTImpl(const FFT_Args &args) {
     mContext.reset(new FFTContext(args.samples, args.bands, args.fmin,
-                                  args.fmax, args.sample_rate));
+                                  args.fmax, args.sample_rate, args.backend));
 }
 
 FFTImpl::~FFTImpl() { mContext.reset(); }
@@ -151,9 +158,7 @@ fl::size FFTImpl::sampleSize() const {
 }
 
 FFTImpl::Result FFTImpl::run(const AudioSample &sample, FFTBins *out) {
-    auto &audio_sample = sample.pcm();
-    span<const i16> slice(audio_sample);
-    return run(slice, out);
+    return run(sample.pcm(), out);
 }
 
 FFTImpl::Result FFTImpl::run(span<const i16> sample, FFTBins *out) {
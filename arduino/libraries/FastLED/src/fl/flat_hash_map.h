@@ -0,0 +1,576 @@
+#pragma once
+
+/*
+Open addressing hash map in the style of Swiss tables.
+
+Every slot has a control byte: 0x80 when the slot is empty, otherwise the low
+7 bits of the key's hash. Slots are grouped by 16 and a lookup compares the
+7 bit tag against a whole group at once (SSE2 on the host, 32 bit SWAR
+elsewhere), so keys are only compared for slots whose tag matches.
+
+Instead of tombstones each group keeps a count of the keys that probed past
+it because it was full. A lookup stops at the first group with a zero
+count, and erase() decrements the counts along the erased key's probe path.
+A count that reaches 0xff saturates and erase() can no longer decrement it,
+so lookups keep probing past that group. erase() counts those missed
+decrements, and once they reach an eighth of the capacity the next insert
+rebuilds the table at the same size, which recomputes every count.
+
+insert() returns false, and operator[] a shared default value, when the
+table must grow and the allocation fails.
+
+String keyed maps also accept `const char*` for find(), contains(),
+find_value() and erase(), without building an fl::string.
+*/
+
+#include "fl/allocator.h"
+#include "fl/bitset.h"
+#include "fl/hash.h"
+#include "fl/hash_map.h"
+#include "fl/int.h"
+#include "fl/move.h"
+#include "fl/pair.h"
+#include "fl/str.h"
+#include "fl/type_traits.h"
+#include "fl/warn.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h> // ok include
+#endif
+
+namespace fl {
+
+// Hash and equality for fl::string keys that also take `const char*`.
+struct StringHash {
+    u32 operator()(const fl::string &key) const noexcept {
+        return MurmurHash3_x86_32(key.data(), key.size());
+    }
+    u32 operator()(const char *key) const noexcept {
+        return MurmurHash3_x86_32(key, strlen(key));
+    }
+};
+
+struct StringEqual {
+    bool operator()(const fl::string &a, const fl::string &b) const {
+        return a == b;
+    }
+    bool operator()(const fl::string &a, const char *b) const {
+        return a.size() == strlen(b) && memcmp(a.data(), b, a.size()) == 0;
+    }
+};
+
+namespace flat_hash_map_detail {
+
+template <typename Key> struct DefaultHash {
+    using type = Hash<Key>;
+};
+template <> struct DefaultHash<fl::string> {
+    using type = StringHash;
+};
+
+template <typename Key> struct DefaultEqual {
+    using type = EqualTo<Key>;
+};
+template <> struct DefaultEqual<fl::string> {
+    using type = StringEqual;
+};
+
+enum : u8 { kEmpty = 0x80 };
+
+// One bit per slot of a group, lowest bit is slot 0.
+class BitMask {
+  public:
+    explicit BitMask(u32 bits) : mBits(bits) {}
+    explicit operator bool() const { return mBits != 0; }
+    u32 lowest() const { return fl::countr_zero(mBits); }
+    void clearLowest() { mBits &= mBits - 1; }
+    u32 bits() const { return mBits; }
+
+  private:
+    u32 mBits;
+};
+
+// 16 control bytes probed together with 32 bit SWAR, for targets without a
+// vector unit.
+struct GroupSwar {
+    static const u32 kWidth = 16;
+
+    explicit GroupSwar(const u8 *ctrl) { memcpy(mWords, ctrl, sizeof(mWords)); }
+
+    // Slots whose tag equals `tag`. The slot right above a real match can be
+    // reported too; callers compare keys anyway.
+    BitMask match(u8 tag) const {
+        const u32 pattern = 0x01010101u * tag;
+        u32 bits = 0;
+        for (u32 i = 0; i < 4; ++i) {
+            u32 x = mWords[i] ^ pattern;
+            bits |= gather((x - 0x01010101u) & ~x & 0x80808080u) << (4 * i);
+        }
+        return BitMask(bits);
+    }
+
+    BitMask matchEmpty() const {
+        u32 bits = 0;
+        for (u32 i = 0; i < 4; ++i) {
+            bits |= gather(mWords[i] & 0x80808080u) << (4 * i);
+        }
+        return BitMask(bits);
+    }
+
+    // Packs the high bit of each byte into the low 4 bits, byte 0 first.
+    // Assumes a little endian target.
+    static u32 gather(u32 highBits) {
+        u32 m = highBits >> 7;
+        return (m | (m >> 7) | (m >> 14) | (m >> 21)) & 0xf;
+    }
+
+    u32 mWords[4];
+};
+
+#if defined(__SSE2__)
+struct GroupSse2 {
+    static const u32 kWidth = 16;
+
+    explicit GroupSse2(const u8 *ctrl)
+        : mCtrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+    // Slots whose tag equals `tag`.
+    BitMask match(u8 tag) const {
+        __m128i needle = _mm_set1_epi8(static_cast<char>(tag));
+        return BitMask(static_cast<u32>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(needle, mCtrl))));
+    }
+
+    BitMask matchEmpty() const {
+        return BitMask(static_cast<u32>(_mm_movemask_epi8(mCtrl)));
+    }
+
+    __m128i mCtrl;
+};
+using Group = GroupSse2;
+#else
+using Group = GroupSwar;
+#endif
+
+} // namespace flat_hash_map_detail
+
+template <typename Key, typename T,
+          typename Hash = typename flat_hash_map_detail::DefaultHash<Key>::type,
+          typename KeyEqual =
+              typename flat_hash_map_detail::DefaultEqual<Key>::type>
+class FlatHashMap {
+    using Group = flat_hash_map_detail::Group;
+    using BitMask = flat_hash_map_detail::BitMask;
+    static const u32 kGroupWidth = Group::kWidth;
+    // Grow once more than 14 of every 16 slots are used.
+    static const u32 kMaxLoadPerGroup = 14;
+    static const u8 kEmpty = flat_hash_map_detail::kEmpty;
+    static const u8 kOverflowSaturated = 0xff;
+
+    // Stored as pair<Key, T> and handed out as pair<const Key, T>, the same
+    // way HashMap does.
+    using Slot = fl::pair<Key, T>;
+
+  public:
+    using value_type = fl::pair<const Key, T>;
+    using size_type = fl::size;
+
+    template <bool Const> class Iterator {
+      public:
+        using map_type =
+            typename fl::conditional<Const, const FlatHashMap, FlatHashMap>::type;
+        using value_type = FlatHashMap::value_type;
+        using reference =
+            typename fl::conditional<Const, const value_type &, value_type &>::type;
+        using pointer =
+            typename fl::conditional<Const, const value_type *, value_type *>::type;
+
+        Iterator() = default;
+        Iterator(map_type *map, fl::size idx) : mMap(map), mIdx(idx) {
+            skipEmpty();
+        }
+        // iterator converts to const_iterator.
+        template <bool C = Const, typename = typename fl::enable_if<C>::type>
+        Iterator(const Iterator<false> &other)
+            : mMap(other.mMap), mIdx(other.mIdx) {}
+
+        reference operator*() const { return mMap->valueAt(mIdx); }
+        pointer operator->() const { return &mMap->valueAt(mIdx); }
+
+        Iterator &operator++() {
+            ++mIdx;
+            skipEmpty();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const Iterator &o) const {
+            return mMap == o.mMap && mIdx == o.mIdx;
+        }
+        bool operator!=(const Iterator &o) const { return !(*this == o); }
+
+      private:
+        friend class FlatHashMap;
+        template <bool> friend class Iterator;
+
+        void skipEmpty() {
+            const fl::size cap = mMap ? mMap->capacity() : 0;
+            while (mIdx < cap && mMap->mCtrl[mIdx] == kEmpty) {
+                ++mIdx;
+            }
+        }
+
+        map_type *mMap = nullptr;
+        fl::size mIdx = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    explicit FlatHashMap(fl::size initial_capacity) { reserve(initial_capacity); }
+
+    FlatHashMap(const FlatHashMap &other) { *this = other; }
+
+    FlatHashMap(FlatHashMap &&other) noexcept { swap(other); }
+
+    ~FlatHashMap() { release(); }
+
+    FlatHashMap &operator=(const FlatHashMap &other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            for (const_iterator it = other.begin(); it != other.end(); ++it) {
+                insert(it->first, it->second);
+            }
+        }
+        return *this;
+    }
+
+    FlatHashMap &operator=(FlatHashMap &&other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    void swap(FlatHashMap &other) noexcept {
+        fl::swap(mMemory, other.mMemory);
+        fl::swap(mCtrl, other.mCtrl);
+        fl::swap(mOverflow, other.mOverflow);
+        fl::swap(mSlots, other.mSlots);
+        fl::swap(mGroupCount, other.mGroupCount);
+        fl::swap(mSize, other.mSize);
+        fl::swap(mStaleCounts, other.mStaleCounts);
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, capacity()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, capacity()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    fl::size size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+    fl::size capacity() const { return mGroupCount * kGroupWidth; }
+
+    // Makes room for `count` keys without growing again.
+    void reserve(fl::size count) {
+        fl::size groups = 1;
+        while (groups * kMaxLoadPerGroup < count) {
+            groups <<= 1;
+        }
+        if (groups > mGroupCount) {
+            rehash(groups);
+        }
+    }
+
+    // insert or overwrite; false when out of memory
+    bool insert(const Key &key, const T &value) {
+        const u32 h = mHash(key);
+        fl::size idx = findIndex(key, h);
+        if (idx != npos()) {
+            slotAt(idx).second = value;
+            return true;
+        }
+        void *slot = prepareInsert(h);
+        if (!slot) {
+            return false;
+        }
+        new (slot) Slot(key, value);
+        return true;
+    }
+
+    bool insert(Key &&key, T &&value) {
+        const u32 h = mHash(key);
+        fl::size idx = findIndex(key, h);
+        if (idx != npos()) {
+            slotAt(idx).second = fl::move(value);
+            return true;
+        }
+        void *slot = prepareInsert(h);
+        if (!slot) {
+            return false;
+        }
+        new (slot) Slot(fl::move(key), fl::move(value));
+        return true;
+    }
+
+    // access or default-construct
+    T &operator[](const Key &key) {
+        const u32 h = mHash(key);
+        fl::size idx = findIndex(key, h);
+        if (idx != npos()) {
+            return slotAt(idx).second;
+        }
+        void *slot = prepareInsert(h);
+        if (!slot) {
+            // Out of memory, as HashMap does.
+            static T default_value{};
+            return default_value;
+        }
+        return (new (slot) Slot(key, T()))->second;
+    }
+
+    template <typename K> iterator find(const K &key) {
+        fl::size idx = findIndex(key);
+        return idx == npos() ? end() : iterator(this, idx);
+    }
+
+    template <typename K> const_iterator find(const K &key) const {
+        fl::size idx = findIndex(key);
+        return idx == npos() ? end() : const_iterator(this, idx);
+    }
+
+    template <typename K> T *find_value(const K &key) {
+        fl::size idx = findIndex(key);
+        return idx == npos() ? nullptr : &slotAt(idx).second;
+    }
+
+    template <typename K> const T *find_value(const K &key) const {
+        fl::size idx = findIndex(key);
+        return idx == npos() ? nullptr : &slotAt(idx).second;
+    }
+
+    template <typename K> bool contains(const K &key) const {
+        return findIndex(key) != npos();
+    }
+
+    // remove key; returns true if removed
+    template <typename K> bool erase(const K &key) {
+        fl::size idx = findIndex(key);
+        if (idx == npos()) {
+            return false;
+        }
+        eraseAt(idx);
+        return true;
+    }
+
+    template <typename K> bool remove(const K &key) { return erase(key); }
+
+    iterator erase(iterator it) {
+        if (it.mMap != this || it.mIdx >= capacity()) {
+            return end();
+        }
+        eraseAt(it.mIdx);
+        ++it;
+        return it;
+    }
+
+    // Removes every key and keeps the memory.
+    void clear() {
+        for (fl::size i = 0; i < capacity(); ++i) {
+            if (mCtrl[i] != kEmpty) {
+                slotAt(i).~Slot();
+            }
+        }
+        if (mGroupCount > 0) {
+            memset(mCtrl, kEmpty, capacity());
+            memset(mOverflow, 0, mGroupCount);
+        }
+        mSize = 0;
+        mStaleCounts = 0;
+    }
+
+  private:
+    static fl::size npos() { return static_cast<fl::size>(-1); }
+
+    static u8 tagOf(u32 hash) { return static_cast<u8>(hash & 0x7f); }
+    fl::size firstGroup(u32 hash) const {
+        return (hash >> 7) & (mGroupCount - 1);
+    }
+    // Triangular probing visits every group once when the group count is a
+    // power of two.
+    fl::size nextGroup(fl::size group, fl::size step) const {
+        return (group + step) & (mGroupCount - 1);
+    }
+
+    Slot &slotAt(fl::size idx) const { return mSlots[idx]; }
+    value_type &valueAt(fl::size idx) const {
+        return *reinterpret_cast<value_type *>(&mSlots[idx]);
+    }
+
+    template <typename K> fl::size findIndex(const K &key) const {
+        if (mSize == 0) {
+            return npos();
+        }
+        return findIndex(key, mHash(key));
+    }
+
+    template <typename K> fl::size findIndex(const K &key, u32 h) const {
+        if (mSize == 0) {
+            return npos();
+        }
+        const u8 tag = tagOf(h);
+        fl::size group = firstGroup(h);
+        for (fl::size step = 1; step <= mGroupCount; ++step) {
+            const fl::size base = group * kGroupWidth;
+            BitMask candidates = Group(mCtrl + base).match(tag);
+            while (candidates) {
+                const fl::size idx = base + candidates.lowest();
+                if (mEqual(mSlots[idx].first, key)) {
+                    return idx;
+                }
+                candidates.clearLowest();
+            }
+            if (mOverflow[group] == 0) {
+                return npos();
+            }
+            group = nextGroup(group, step);
+        }
+        return npos();
+    }
+
+    // Claims an empty slot for a key with hash `h` known not to be in the
+    // map and returns the storage to construct it in, or nullptr when the
+    // table is full and cannot grow.
+    void *prepareInsert(u32 h) {
+        if ((mSize + 1) > mGroupCount * kMaxLoadPerGroup) {
+            rehash(mGroupCount == 0 ? 1 : mGroupCount * 2);
+        } else if (mStaleCounts >= capacity() / 8) {
+            // Enough erases went past saturated counts that probes are
+            // longer than they need to be.
+            rehash(mGroupCount);
+        }
+        if (mSize >= capacity()) {
+            // A failed rehash leaves the old table; without a free slot the
+            // probe below would never end.
+            return nullptr;
+        }
+        fl::size idx = claimSlot(h);
+        ++mSize;
+        return &mSlots[idx];
+    }
+
+    fl::size claimSlot(u32 h) {
+        fl::size group = firstGroup(h);
+        for (fl::size step = 1;; ++step) {
+            const fl::size base = group * kGroupWidth;
+            BitMask empty = Group(mCtrl + base).matchEmpty();
+            if (empty) {
+                const fl::size idx = base + empty.lowest();
+                mCtrl[idx] = tagOf(h);
+                return idx;
+            }
+            if (mOverflow[group] != kOverflowSaturated) {
+                ++mOverflow[group];
+            }
+            group = nextGroup(group, step);
+        }
+    }
+
+    void eraseAt(fl::size idx) {
+        const u32 h = mHash(slotAt(idx).first);
+        const fl::size home = idx / kGroupWidth;
+        // Undo the overflow counts this key left on its way to its group. A
+        // saturated count has lost track and stays put until a rebuild.
+        fl::size group = firstGroup(h);
+        for (fl::size step = 1; group != home; ++step) {
+            if (mOverflow[group] != kOverflowSaturated) {
+                --mOverflow[group];
+            } else {
+                ++mStaleCounts;
+            }
+            group = nextGroup(group, step);
+        }
+        slotAt(idx).~Slot();
+        mCtrl[idx] = kEmpty;
+        --mSize;
+    }
+
+    // Returns false, keeping the current table, when out of memory.
+    bool rehash(fl::size groupCount) {
+        const fl::size cap = groupCount * kGroupWidth;
+        // Control bytes, then overflow counts, then the slots.
+        const fl::size slotOffset =
+            (cap + groupCount + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+        void *memory = Malloc(slotOffset + cap * sizeof(Slot));
+        if (!memory) {
+            FASTLED_WARN("FlatHashMap: out of memory");
+            return false;
+        }
+
+        void *oldMemory = mMemory;
+        u8 *oldCtrl = mCtrl;
+        Slot *oldSlots = mSlots;
+        const fl::size oldCap = capacity();
+
+        mMemory = memory;
+        mCtrl = static_cast<u8 *>(memory);
+        mOverflow = mCtrl + cap;
+        mSlots = reinterpret_cast<Slot *>(mCtrl + slotOffset);
+        mGroupCount = groupCount;
+        memset(mCtrl, kEmpty, cap);
+        memset(mOverflow, 0, groupCount);
+        mStaleCounts = 0;
+
+        for (fl::size i = 0; i < oldCap; ++i) {
+            if (oldCtrl[i] != kEmpty) {
+                Slot &old = oldSlots[i];
+                fl::size idx = claimSlot(mHash(old.first));
+                new (&mSlots[idx]) Slot(fl::move(old));
+                old.~Slot();
+            }
+        }
+        Free(oldMemory);
+        return true;
+    }
+
+    void release() {
+        clear();
+        Free(mMemory);
+        mMemory = nullptr;
+        mCtrl = nullptr;
+        mOverflow = nullptr;
+        mSlots = nullptr;
+        mGroupCount = 0;
+        mStaleCounts = 0;
+    }
+
+    void *mMemory = nullptr;
+    u8 *mCtrl = nullptr;     // one control byte per slot
+    u8 *mOverflow = nullptr; // one count per group
+    Slot *mSlots = nullptr;
+    fl::size mGroupCount = 0;
+    fl::size mSize = 0;
+    fl::size mStaleCounts = 0; // decrements lost to saturated counts
+    Hash mHash;
+    KeyEqual mEqual;
+};
+
+template <typename Key, typename T,
+          typename Hash = typename flat_hash_map_detail::DefaultHash<Key>::type,
+          typename KeyEqual =
+              typename flat_hash_map_detail::DefaultEqual<Key>::type>
+using flat_hash_map = FlatHashMap<Key, T, Hash, KeyEqual>;
+
+} // namespace fl
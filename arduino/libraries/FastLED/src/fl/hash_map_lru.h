@@ -4,10 +4,25 @@
 LRU (Least Recently Used) HashMap that is optimized for embedded devices.
 This hashmap has a maximum size and will automatically evict the least
 recently used items when it reaches capacity.
+
+Entries live in a node array threaded on an intrusive doubly linked list in
+recency order, and a FlatHashMap maps keys to node indices. Lookups move the
+node to the front and eviction takes the back, so get, put and evict are all
+O(1). Freed nodes are reused, so a full cache does not allocate.
+
+Besides the entry limit the cache can have a byte budget: give each entry a
+cost with insert(key, value, bytes) and set setMaxBytes(), and the least
+recently used entries are evicted until the total fits. hits(), misses() and
+evictions() report how well the cache is doing.
+
+Pointers returned by find_value() and operator[] stay valid until the next
+call that inserts a new key.
 */
 
+#include "fl/flat_hash_map.h"
 #include "fl/hash_map.h"
 #include "fl/type_traits.h"
+#include "fl/vector.h"
 
 namespace fl {
 
@@ -16,147 +31,237 @@ template <typename Key, typename T, typename Hash = Hash<Key>,
           int INLINED_COUNT = FASTLED_HASHMAP_INLINED_COUNT>
 class HashMapLru {
   private:
-    // Wrapper for values that includes access time tracking
-    struct ValueWithTimestamp {
-        T value;
-        u32 last_access_time;
+    static const u32 kNil = 0xffffffffu;
 
-        ValueWithTimestamp() : last_access_time(0) {}
-        ValueWithTimestamp(const T &v, u32 time)
-            : value(v), last_access_time(time) {}
+    struct Node {
+        Key key;
+        T value;
+        fl::size bytes = 0;
+        u32 prev = kNil; // towards the most recently used end
+        u32 next = kNil; // towards the least recently used end
     };
 
   public:
-    HashMapLru(fl::size max_size) : mMaxSize(max_size), mCurrentTime(0) {
+    HashMapLru(fl::size max_size) : mMaxSize(max_size) {
         // Ensure max size is at least 1
         if (mMaxSize < 1)
             mMaxSize = 1;
     }
 
     void setMaxSize(fl::size max_size) {
-        while (mMaxSize < max_size) {
-            // Evict oldest items until we reach the new max size
+        mMaxSize = max_size < 1 ? 1 : max_size;
+        while (size() > mMaxSize) {
+            evictOldest();
+        }
+    }
+
+    // Total cost of the cached entries, as given to insert(), that the cache
+    // may hold. 0 means no byte limit.
+    void setMaxBytes(fl::size max_bytes) {
+        mMaxBytes = max_bytes;
+        while (mMaxBytes && mBytes > mMaxBytes && !empty()) {
             evictOldest();
         }
-        mMaxSize = max_size;
     }
 
     void swap(HashMapLru &other) {
-        fl::swap(mMap, other.mMap);
+        fl::swap(mIndex, other.mIndex);
+        fl::swap(mNodes, other.mNodes);
+        fl::swap(mHead, other.mHead);
+        fl::swap(mTail, other.mTail);
+        fl::swap(mFree, other.mFree);
         fl::swap(mMaxSize, other.mMaxSize);
-        fl::swap(mCurrentTime, other.mCurrentTime);
+        fl::swap(mMaxBytes, other.mMaxBytes);
+        fl::swap(mBytes, other.mBytes);
+        fl::swap(mHits, other.mHits);
+        fl::swap(mMisses, other.mMisses);
+        fl::swap(mEvictions, other.mEvictions);
     }
 
     // Insert or update a key-value pair
-    void insert(const Key &key, const T &value) {
-        // Only evict if we're at capacity AND this is a new key
-        const ValueWithTimestamp *existing = mMap.find_value(key);
-
-        auto curr = mCurrentTime++;
-
-        if (existing) {
-            // Update the value and access time
-            ValueWithTimestamp &vwt =
-                const_cast<ValueWithTimestamp &>(*existing);
-            vwt.value = value;
-            vwt.last_access_time = curr;
-            return;
-        }
-        if (mMap.size() >= mMaxSize) {
-            evictOldest();
-        }
+    void insert(const Key &key, const T &value) { insert(key, value, 0); }
 
-        // Insert or update the value with current timestamp
-        ValueWithTimestamp vwt(value, mCurrentTime);
-        mMap.insert(key, vwt);
+    // Insert or update a key-value pair that costs `bytes` against the
+    // byte budget. The entry just inserted is never evicted to make room,
+    // so one entry larger than the budget is still cached on its own.
+    void insert(const Key &key, const T &value, fl::size bytes) {
+        u32 idx;
+        if (const u32 *existing = mIndex.find_value(key)) {
+            idx = *existing;
+            mNodes[idx].value = value;
+            mBytes -= mNodes[idx].bytes;
+            moveToFront(idx);
+        } else {
+            idx = addNode(key);
+            mNodes[idx].value = value;
+        }
+        mNodes[idx].bytes = bytes;
+        mBytes += bytes;
+        enforceByteBudget();
     }
 
     // Get value for key, returns nullptr if not found
     T *find_value(const Key &key) {
-        ValueWithTimestamp *vwt = mMap.find_value(key);
-        if (vwt) {
-            // Update access time
-            auto curr = mCurrentTime++;
-            vwt->last_access_time = curr;
-            return &vwt->value;
+        const u32 *idx = mIndex.find_value(key);
+        if (!idx) {
+            ++mMisses;
+            return nullptr;
         }
-        return nullptr;
+        ++mHits;
+        moveToFront(*idx);
+        return &mNodes[*idx].value;
     }
 
-    // Get value for key, returns nullptr if not found (const version)
+    // Get value for key, returns nullptr if not found (const version). Does
+    // not count as a use of the entry.
     const T *find_value(const Key &key) const {
-        const ValueWithTimestamp *vwt = mMap.find_value(key);
-        return vwt ? &vwt->value : nullptr;
+        const u32 *idx = mIndex.find_value(key);
+        return idx ? &mNodes[*idx].value : nullptr;
     }
 
     // Access operator - creates entry if not exists
     T &operator[](const Key &key) {
-        // If we're at capacity and this is a new key, evict oldest
-        auto curr = mCurrentTime++;
-
-        auto entry = mMap.find_value(key);
-        if (entry) {
-            // Update access time
-            entry->last_access_time = curr;
-            return entry->value;
+        if (const u32 *existing = mIndex.find_value(key)) {
+            ++mHits;
+            moveToFront(*existing);
+            return mNodes[*existing].value;
         }
-
-        if (mMap.size() >= mMaxSize) {
-            evictOldest();
-        }
-
-        // Get or create entry and update timestamp
-        // mCurrentTime++;
-        ValueWithTimestamp &vwt = mMap[key];
-        vwt.last_access_time = curr;
-        return vwt.value;
+        ++mMisses;
+        return mNodes[addNode(key)].value;
     }
 
     // Remove a key
-    bool remove(const Key &key) { return mMap.remove(key); }
+    bool remove(const Key &key) {
+        const u32 *idx = mIndex.find_value(key);
+        if (!idx) {
+            return false;
+        }
+        const u32 node = *idx;
+        mIndex.erase(key);
+        releaseNode(node);
+        return true;
+    }
 
-    // Clear the map
+    // Clear the map. The statistics are kept, see resetStats().
     void clear() {
-        mMap.clear();
-        mCurrentTime = 0;
+        mIndex.clear();
+        mNodes.clear();
+        mHead = mTail = mFree = kNil;
+        mBytes = 0;
     }
 
     // Size accessors
-    fl::size size() const { return mMap.size(); }
-    bool empty() const { return mMap.empty(); }
+    fl::size size() const { return mIndex.size(); }
+    bool empty() const { return mIndex.size() == 0; }
     fl::size capacity() const { return mMaxSize; }
+    fl::size bytes() const { return mBytes; }
+    fl::size maxBytes() const { return mMaxBytes; }
+
+    // Lookups through find_value() and operator[] that found / did not find
+    // their key, and entries dropped to stay within the limits.
+    u32 hits() const { return mHits; }
+    u32 misses() const { return mMisses; }
+    u32 evictions() const { return mEvictions; }
+    void resetStats() { mHits = mMisses = mEvictions = 0; }
 
   private:
+    // Takes a free node for `key`, evicting the least recently used entry
+    // first if the cache is full, and links it at the front.
+    u32 addNode(const Key &key) {
+        if (size() >= mMaxSize) {
+            evictOldest();
+        }
+        u32 idx;
+        if (mFree != kNil) {
+            idx = mFree;
+            mFree = mNodes[idx].next;
+        } else {
+            idx = static_cast<u32>(mNodes.size());
+            mNodes.push_back(Node());
+        }
+        Node &node = mNodes[idx];
+        node.key = key;
+        node.bytes = 0;
+        linkFront(idx);
+        mIndex.insert(key, idx);
+        return idx;
+    }
+
+    void releaseNode(u32 idx) {
+        unlink(idx);
+        Node &node = mNodes[idx];
+        mBytes -= node.bytes;
+        // Drop whatever the value holds on to now, not when the node is
+        // reused.
+        node.value = T();
+        node.bytes = 0;
+        node.next = mFree;
+        mFree = idx;
+    }
+
     // Evict the least recently used item
     void evictOldest() {
-        if (mMap.empty())
+        if (mTail == kNil)
             return;
+        const u32 idx = mTail;
+        mIndex.erase(mNodes[idx].key);
+        releaseNode(idx);
+        ++mEvictions;
+    }
 
-        // Find the entry with the oldest timestamp
-        Key oldest_key;
-        u32 oldest_time = UINT32_MAX;
-        bool found = false;
+    void enforceByteBudget() {
+        // Stop before the entry at the front, the one just used.
+        while (mMaxBytes && mBytes > mMaxBytes && mTail != mHead) {
+            evictOldest();
+        }
+    }
 
-        for (auto it = mMap.begin(); it != mMap.end(); ++it) {
-            const auto &entry = *it;
-            const ValueWithTimestamp &vwt = entry.second;
+    void linkFront(u32 idx) {
+        Node &node = mNodes[idx];
+        node.prev = kNil;
+        node.next = mHead;
+        if (mHead != kNil) {
+            mNodes[mHead].prev = idx;
+        }
+        mHead = idx;
+        if (mTail == kNil) {
+            mTail = idx;
+        }
+    }
 
-            if (vwt.last_access_time < oldest_time) {
-                oldest_time = vwt.last_access_time;
-                oldest_key = entry.first;
-                found = true;
-            }
+    void unlink(u32 idx) {
+        Node &node = mNodes[idx];
+        if (node.prev != kNil) {
+            mNodes[node.prev].next = node.next;
+        } else {
+            mHead = node.next;
         }
+        if (node.next != kNil) {
+            mNodes[node.next].prev = node.prev;
+        } else {
+            mTail = node.prev;
+        }
+        node.prev = node.next = kNil;
+    }
 
-        // Remove the oldest entry
-        if (found) {
-            mMap.remove(oldest_key);
+    void moveToFront(u32 idx) {
+        if (idx != mHead) {
+            unlink(idx);
+            linkFront(idx);
         }
     }
 
-    HashMap<Key, ValueWithTimestamp, Hash, KeyEqual, INLINED_COUNT> mMap;
+    FlatHashMap<Key, u32, Hash, KeyEqual> mIndex;
+    fl::vector<Node> mNodes;
+    u32 mHead = kNil; // most recently used
+    u32 mTail = kNil; // least recently used, evicted first
+    u32 mFree = kNil; // released nodes, chained through Node::next
     fl::size mMaxSize;
-    u32 mCurrentTime;
+    fl::size mMaxBytes = 0;
+    fl::size mBytes = 0;
+    u32 mHits = 0;
+    u32 mMisses = 0;
+    u32 mEvictions = 0;
 };
 
 } // namespace fl
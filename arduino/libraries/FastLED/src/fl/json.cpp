@@ -1,9 +1,10 @@
 
 #include "fl/json.h"
+#include "fl/json_arduinojson.h"
+#include "fl/json_reader.h"
+#include "fl/json_writer.h"
 #include "fl/string.h"
 #include "fl/vector.h"
-#include "fl/deque.h"
-#include "fl/function.h"
 #include "fl/sketch_macros.h"
 #include "fl/math.h" // For floor function
 #include "fl/compiler_control.h"
@@ -78,11 +79,219 @@ JsonObject& get_empty_json_object() {
     return empty_object.access();
 }
 
+namespace {
+
+// Enum to represent array optimization types
+enum ArrayType {
+    ALL_UINT8,
+    ALL_INT16,
+    ALL_FLOATS,
+    GENERIC_ARRAY
+};
+
+// Tracks which compact representation every number of an array fits in.
+struct ArrayTypeInfo {
+    bool isUint8 = true;
+    bool isInt16 = true;
+    bool isFloat = true;
+
+    void disableAll() {
+        isUint8 = false;
+        isInt16 = false;
+        isFloat = false;
+    }
+
+    void checkNumericValue(double val) {
+        // Check integer ranges in one pass
+        bool isInteger = val == floor(val);
+        if (!isInteger || val < 0 || val > UINT8_MAX) {
+            isUint8 = false;
+        }
+        if (!isInteger || val < INT16_MIN || val > INT16_MAX) {
+            isInt16 = false;
+        }
+        if (!canBeRepresentedAsFloat(val)) {
+            isFloat = false;
+        }
+    }
+
+    void checkIntegerValue(int64_t val) {
+        // Check all ranges in one pass
+        if (val < 0 || val > UINT8_MAX) {
+            isUint8 = false;
+        }
+        if (val < INT16_MIN || val > INT16_MAX) {
+            isInt16 = false;
+        }
+        if (val < -16777216 || val > 16777216) {
+            isFloat = false;
+        }
+    }
+
+    ArrayType getBestType() const {
+        if (isUint8) return ALL_UINT8;
+        if (isInt16) return ALL_INT16;
+        if (isFloat) return ALL_FLOATS;
+        return GENERIC_ARRAY;
+    }
+};
+
+#if FASTLED_ENABLE_JSON
+
+// Builds the JsonValue tree straight from the JsonReader token stream.
+// Returns an empty pointer on malformed input.
+class JsonTreeBuilder {
+  public:
+    explicit JsonTreeBuilder(JsonReader& reader) : mReader(reader) {}
+
+    fl::shared_ptr<JsonValue> build(JsonToken token) {
+        switch (token) {
+            case JsonToken::BeginObject:
+                return buildObject();
+            case JsonToken::BeginArray:
+                return buildArray();
+            case JsonToken::String:
+                return fl::make_shared<JsonValue>(mReader.string().str());
+            case JsonToken::Int:
+                return fl::make_shared<JsonValue>(mReader.intValue());
+            case JsonToken::Float:
+                return fl::make_shared<JsonValue>(static_cast<float>(mReader.floatValue()));
+            case JsonToken::Bool:
+                return fl::make_shared<JsonValue>(mReader.boolValue());
+            case JsonToken::Null:
+                return fl::make_shared<JsonValue>(nullptr);
+            default:
+                return fl::shared_ptr<JsonValue>();
+        }
+    }
+
+  private:
+    // Numbers are held back until the array ends, so an all numeric array
+    // goes straight into one of the compact vectors.
+    struct Number {
+        int64_t i;
+        double d;
+        bool isFloat;
+    };
+
+    static fl::shared_ptr<JsonValue> toValue(const Number& n) {
+        return n.isFloat ? fl::make_shared<JsonValue>(static_cast<float>(n.d))
+                         : fl::make_shared<JsonValue>(n.i);
+    }
+
+    template <typename T>
+    static fl::vector<T> toVector(const fl::InlinedVector<Number, 16>& numbers) {
+        fl::vector<T> out;
+        out.reserve(numbers.size());
+        for (fl::size i = 0; i < numbers.size(); ++i) {
+            const Number& n = numbers[i];
+            out.push_back(n.isFloat ? static_cast<T>(n.d) : static_cast<T>(n.i));
+        }
+        return out;
+    }
+
+    fl::shared_ptr<JsonValue> buildArray() {
+        fl::InlinedVector<Number, 16> numbers;
+        ArrayTypeInfo typeInfo;
+        JsonArray items;
+        bool numeric = true;
+        for (JsonToken token = mReader.next(); token != JsonToken::EndArray;
+             token = mReader.next()) {
+            if (numeric && token == JsonToken::Int) {
+                typeInfo.checkIntegerValue(mReader.intValue());
+                numbers.push_back(Number{mReader.intValue(), 0.0, false});
+                continue;
+            }
+            if (numeric && token == JsonToken::Float) {
+                typeInfo.checkNumericValue(mReader.floatValue());
+                numbers.push_back(Number{0, mReader.floatValue(), true});
+                continue;
+            }
+            if (numeric) {
+                // Not a numeric array after all.
+                numeric = false;
+                typeInfo.disableAll();
+                for (fl::size i = 0; i < numbers.size(); ++i) {
+                    items.push_back(toValue(numbers[i]));
+                }
+                numbers.clear();
+            }
+            fl::shared_ptr<JsonValue> item = build(token);
+            if (!item) {
+                return item;
+            }
+            items.push_back(fl::move(item));
+        }
+        if (numbers.empty()) {
+            // Empty arrays should remain regular arrays
+            return fl::make_shared<JsonValue>(fl::move(items));
+        }
+        switch (typeInfo.getBestType()) {
+            case ALL_UINT8:
+                return fl::make_shared<JsonValue>(toVector<uint8_t>(numbers));
+            case ALL_INT16:
+                return fl::make_shared<JsonValue>(toVector<int16_t>(numbers));
+            case ALL_FLOATS:
+                return fl::make_shared<JsonValue>(toVector<float>(numbers));
+            case GENERIC_ARRAY:
+            default:
+                for (fl::size i = 0; i < numbers.size(); ++i) {
+                    items.push_back(toValue(numbers[i]));
+                }
+                return fl::make_shared<JsonValue>(fl::move(items));
+        }
+    }
+
+    fl::shared_ptr<JsonValue> buildObject() {
+        JsonObject obj;
+        for (JsonToken token = mReader.next(); token != JsonToken::EndObject;
+             token = mReader.next()) {
+            if (token != JsonToken::Key) {
+                return fl::shared_ptr<JsonValue>();
+            }
+            // The key text is only valid until the next token.
+            fl::string key = mReader.string().str();
+            fl::shared_ptr<JsonValue> value = build(mReader.next());
+            if (!value) {
+                return value;
+            }
+            obj[key] = fl::move(value);
+        }
+        return fl::make_shared<JsonValue>(fl::move(obj));
+    }
+
+    JsonReader& mReader;
+};
+
+#endif  // FASTLED_ENABLE_JSON
+
+} // namespace
+
 fl::shared_ptr<JsonValue> JsonValue::parse(const fl::string& txt) {
     #if !FASTLED_ENABLE_JSON
     return fl::make_shared<JsonValue>(fl::string(txt));
     #else
-    // Determine the size of the JsonDocument needed.
+    JsonReader reader(txt.c_str(), txt.size());
+    JsonTreeBuilder builder(reader);
+    fl::shared_ptr<JsonValue> root = builder.build(reader.next());
+    if (root && reader.next() != JsonToken::End) {
+        root.reset();
+    }
+    if (!root) {
+        FL_WARN("JSON parsing failed: " << (reader.error() ? reader.error() : "unexpected token")
+                << " at offset " << reader.errorOffset());
+        return fl::make_shared<JsonValue>(nullptr); // Return null on error
+    }
+    return root;
+    #endif
+}
+
+namespace detail {
+
+fl::shared_ptr<JsonValue> parse_arduinojson(const fl::string& txt) {
+    #if !FASTLED_ENABLE_JSON
+    return fl::make_shared<JsonValue>(fl::string(txt));
+    #else
     FLArduinoJson::JsonDocument doc;
 
     FLArduinoJson::DeserializationError error = FLArduinoJson::deserializeJson(doc, txt.c_str());
@@ -124,61 +333,6 @@ fl::shared_ptr<JsonValue> JsonValue::parse(const fl::string& txt) {
                     return fl::make_shared<JsonValue>(JsonArray{});
                 }
                 
-                // Enum to represent array optimization types
-                enum ArrayType {
-                    ALL_UINT8,
-                    ALL_INT16,
-                    ALL_FLOATS,
-                    GENERIC_ARRAY
-                };
-                
-                // Helper struct to track array type info
-                struct ArrayTypeInfo {
-                    bool isUint8 = true;
-                    bool isInt16 = true;
-                    bool isFloat = true;
-                    
-                    void disableAll() {
-                        isUint8 = false;
-                        isInt16 = false;
-                        isFloat = false;
-                    }
-                    
-                    void checkNumericValue(double val) {
-                        // Check integer ranges in one pass
-                        bool isInteger = val == floor(val);
-                        if (!isInteger || val < 0 || val > UINT8_MAX) {
-                            isUint8 = false;
-                        }
-                        if (!isInteger || val < INT16_MIN || val > INT16_MAX) {
-                            isInt16 = false;
-                        }
-                        if (!canBeRepresentedAsFloat(val)) {
-                            isFloat = false;
-                        }
-                    }
-                    
-                    void checkIntegerValue(int64_t val) {
-                        // Check all ranges in one pass
-                        if (val < 0 || val > UINT8_MAX) {
-                            isUint8 = false;
-                        }
-                        if (val < INT16_MIN || val > INT16_MAX) {
-                            isInt16 = false;
-                        }
-                        if (val < -16777216 || val > 16777216) {
-                            isFloat = false;
-                        }
-                    }
-                    
-                    ArrayType getBestType() const {
-                        if (isUint8) return ALL_UINT8;
-                        if (isInt16) return ALL_INT16;
-                        if (isFloat) return ALL_FLOATS;
-                        return GENERIC_ARRAY;
-                    }
-                };
-                
                 ArrayTypeInfo typeInfo;
                 
                 #if FASTLED_DEBUG_LEVEL >= 2
@@ -274,217 +428,30 @@ fl::shared_ptr<JsonValue> JsonValue::parse(const fl::string& txt) {
     #endif
 }
 
+} // namespace detail
+
 fl::string JsonValue::to_string() const {
-    // Parse the JSON value to a string, then parse it back to a Json object,
-    // and use the working to_string_native method
-    // This is a workaround to avoid reimplementing the serialization logic
-    
-    // First, create a temporary Json document with this value
-    Json temp;
-    // Use the public method to set the value
-    temp.set_value(fl::make_shared<JsonValue>(*this));
-    // Use the working implementation
-    return temp.to_string_native();
+    fl::string out;
+    out.reserve(JsonWriter::estimateSize(*this));
+    JsonWriter writer(out);
+    writer.value(*this);
+    writer.flush();
+    return out;
 }
 
 fl::string Json::to_string_native() const {
     if (!m_value) {
         return "null";
     }
-    
-    // 🚨 NEW APPROACH: Use fl::deque for memory-efficient JSON serialization
-    // This avoids memory fragmentation and bypasses broken ArduinoJson integration
-    fl::deque<char> json_chars;
-    
-    // Helper lambda for appending strings to deque
-    auto append_string = [&json_chars](const char* str) {
-        while (*str) {
-            json_chars.push_back(*str);
-            ++str;
-        }
-    };
-    
-    // Helper lambda for appending fl::string to deque
-    auto append_fl_string = [&json_chars](const fl::string& str) {
-        for (size_t i = 0; i < str.size(); ++i) {
-            json_chars.push_back(str[i]);
-        }
-    };
-    
-    // Helper lambda for appending escaped strings
-    auto append_escaped_string = [&](const fl::string& str) {
-        json_chars.push_back('"');
-        for (size_t i = 0; i < str.size(); ++i) {
-            char c = str[i];
-            switch (c) {
-                case '"':  append_string("\\\""); break;
-                case '\\': append_string("\\\\"); break;
-                case '\n': append_string("\\n"); break;
-                case '\r': append_string("\\r"); break;
-                case '\t': append_string("\\t"); break;
-                case '\b': append_string("\\b"); break;
-                case '\f': append_string("\\f"); break;
-                default:
-                    json_chars.push_back(c);
-                    break;
-            }
-        }
-        json_chars.push_back('"');
-    };
-    
-    // Recursive function to serialize JsonValue to deque
-    fl::function<void(const JsonValue&)> serialize_value = [&](const JsonValue& value) {
-        if (value.is_null()) {
-            append_string("null");
-        } else if (value.is_bool()) {
-            auto opt = value.as_bool();
-            if (opt) {
-                append_string(*opt ? "true" : "false");
-            } else {
-                append_string("null");
-            }
-        } else if (value.is_int()) {
-            auto opt = value.as_int();
-            if (opt) {
-                fl::string num_str;
-                num_str.append(*opt);
-                append_fl_string(num_str);
-            } else {
-                append_string("null");
-            }
-        } else if (value.is_float()) {
-            auto opt = value.as_float();
-            if (opt) {
-                fl::string num_str;
-                // Use fl::string::append which already handles float formatting correctly
-                //num_str.append(*opt);
-                num_str.append(static_cast<float>(*opt), 3);
-                append_fl_string(num_str);
-            } else {
-                append_string("null");
-            }
-        } else if (value.is_string()) {
-            auto opt = value.as_string();
-            if (opt) {
-                append_escaped_string(*opt);
-            } else {
-                append_string("null");
-            }
-        } else if (value.is_array()) {
-            auto opt = value.as_array();
-            if (opt) {
-                json_chars.push_back('[');
-                bool first = true;
-                for (const auto& item : *opt) {
-                    if (!first) {
-                        json_chars.push_back(',');
-                    }
-                    first = false;
-                    if (item) {
-                        serialize_value(*item);
-                    } else {
-                        append_string("null");
-                    }
-                }
-                json_chars.push_back(']');
-            } else {
-                append_string("null");
-            }
-        } else if (value.is_object()) {
-            auto opt = value.as_object();
-            if (opt) {
-                json_chars.push_back('{');
-                bool first = true;
-                for (const auto& kv : *opt) {
-                    if (!first) {
-                        json_chars.push_back(',');
-                    }
-                    first = false;
-                    append_escaped_string(kv.first);
-                    json_chars.push_back(':');
-                    if (kv.second) {
-                        serialize_value(*kv.second);
-                    } else {
-                        append_string("null");
-                    }
-                }
-                json_chars.push_back('}');
-            } else {
-                append_string("null");
-            }
-        } else {
-            // Handle specialized array types
-            if (value.is_audio()) {
-                auto audioOpt = value.as_audio();
-                if (audioOpt) {
-                    json_chars.push_back('[');
-                    bool first = true;
-                    for (const auto& item : *audioOpt) {
-                        if (!first) {
-                            json_chars.push_back(',');
-                        }
-                        first = false;
-                        fl::string num_str;
-                        num_str.append(static_cast<int>(item));
-                        append_fl_string(num_str);
-                    }
-                    json_chars.push_back(']');
-                } else {
-                    append_string("null");
-                }
-            } else if (value.is_bytes()) {
-                auto bytesOpt = value.as_bytes();
-                if (bytesOpt) {
-                    json_chars.push_back('[');
-                    bool first = true;
-                    for (const auto& item : *bytesOpt) {
-                        if (!first) {
-                            json_chars.push_back(',');
-                        }
-                        first = false;
-                        fl::string num_str;
-                        num_str.append(static_cast<int>(item));
-                        append_fl_string(num_str);
-                    }
-                    json_chars.push_back(']');
-                } else {
-                    append_string("null");
-                }
-            } else if (value.is_floats()) {
-                auto floatsOpt = value.as_floats();
-                if (floatsOpt) {
-                    json_chars.push_back('[');
-                    bool first = true;
-                    for (const auto& item : *floatsOpt) {
-                        if (!first) {
-                            json_chars.push_back(',');
-                        }
-                        first = false;
-                        fl::string num_str;
-                        num_str.append(static_cast<float>(item), 6);
-                        append_fl_string(num_str);
-                    }
-                    json_chars.push_back(']');
-                } else {
-                    append_string("null");
-                }
-            } else {
-                append_string("null");
-            }
-        }
-    };
-    
-    // Serialize the root value
-    serialize_value(*m_value);
-    
-    // Convert deque to fl::string efficiently
-    fl::string result;
-    if (!json_chars.empty()) {
-        // Get pointer to the underlying data and construct string directly
-        result.assign(&json_chars[0], json_chars.size());
+    return m_value->to_string();
+}
+
+void Json::write(JsonWriter &writer) const {
+    if (m_value) {
+        writer.value(*m_value);
+    } else {
+        writer.nullValue();
     }
-    
-    return result;
 }
 
 // Forward declaration for the serializeValue function
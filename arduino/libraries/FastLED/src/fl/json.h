@@ -166,6 +166,7 @@ namespace fl {
 
 // Forward declarations
 struct JsonValue;
+class JsonWriter;
 
 // Define Array and Object as pointers to avoid incomplete type issues
 // We'll use heap-allocated containers for these to avoid alignment issues
@@ -693,6 +694,8 @@ struct JsonValue {
     JsonValue(const JsonObject& o) : data(o) {
         //FASTLED_WARN("Created JsonValue with object");
     }
+    JsonValue(JsonArray&& a) : data(fl::move(a)) {}
+    JsonValue(JsonObject&& o) : data(fl::move(o)) {}
     JsonValue(const fl::vector<int16_t>& audio) : data(audio) {
         //FASTLED_WARN("Created JsonValue with audio data");
     }
@@ -1511,7 +1514,8 @@ struct JsonValue {
     // Visitor-based serialization helper
     friend class SerializerVisitor;
 
-    // Parsing factory (FLArduinoJson implementation)
+    // Parsing factory, builds the tree in a single pass with fl::JsonReader.
+    // Malformed input gives a null value.
     static fl::shared_ptr<JsonValue> parse(const fl::string &txt);
     
     // Iterator support for objects
@@ -2124,6 +2128,10 @@ public:
     // Native serialization (without external libraries)
     fl::string to_string_native() const;
 
+    // Streams the document into `writer` without building a string first,
+    // see fl/json_writer.h.
+    void write(JsonWriter &writer) const;
+
     // Parsing factory method
     static Json parse(const fl::string &txt) {
         auto parsed = JsonValue::parse(txt);
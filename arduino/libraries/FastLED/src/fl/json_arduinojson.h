@@ -0,0 +1,23 @@
+#pragma once
+
+// Internal: the FLArduinoJson based parser that JsonValue::parse() replaced.
+// Not part of the Json API; tests and benchmarks use it to cross-check
+// parse() against the old backend.
+
+#include "fl/namespace.h"
+#include "fl/shared_ptr.h"
+#include "fl/str.h"
+
+namespace fl {
+
+struct JsonValue;
+
+namespace detail {
+
+// Deserializes into a JsonDocument and converts that into a JsonValue tree,
+// with the same typing rules as JsonValue::parse(). Malformed input gives a
+// null value.
+fl::shared_ptr<JsonValue> parse_arduinojson(const fl::string &txt);
+
+} // namespace detail
+} // namespace fl
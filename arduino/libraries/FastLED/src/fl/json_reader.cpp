@@ -0,0 +1,509 @@
+#include "fl/json_reader.h"
+
+#include <string.h>
+
+namespace fl {
+
+namespace {
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// mantissa * 10^exponent. Powers up to 1e22 are exact in a double, larger
+// ones are applied in steps.
+double scaleByPowerOf10(u64 mantissa, int exponent) {
+    static const double kPowers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    double value = static_cast<double>(mantissa);
+    if (mantissa == 0) {
+        return 0.0;
+    }
+    if (exponent > 330) {
+        exponent = 330; // already infinite
+    } else if (exponent < -360) {
+        return 0.0;
+    }
+    while (exponent > 22) {
+        value *= 1e22;
+        exponent -= 22;
+    }
+    while (exponent < -22) {
+        value /= 1e22;
+        exponent += 22;
+    }
+    return exponent >= 0 ? value * kPowers[exponent] : value / kPowers[-exponent];
+}
+
+void appendUtf8(fl::vector<char> &out, u32 cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+} // namespace
+
+bool JsonStringRef::equals(const char *str) const {
+    if (!str) {
+        return size == 0;
+    }
+    return strlen(str) == size && (size == 0 || memcmp(data, str, size) == 0);
+}
+
+JsonReader::JsonReader(const char *text, fl::size length)
+    : mPos(text), mEnd(text + length), mBegin(text) {}
+
+JsonReader::JsonReader(const char *text)
+    : JsonReader(text ? text : "", text ? strlen(text) : 0) {}
+
+JsonToken JsonReader::next() {
+    if (mError) {
+        return JsonToken::Error;
+    }
+    if (mState == kDone) {
+        return JsonToken::End;
+    }
+    skipWhitespace();
+    if (mDepth == 0) {
+        if (mState == kAfterValue) {
+            if (mPos != mEnd) {
+                return fail("unexpected data after the document");
+            }
+            mState = kDone;
+            return JsonToken::End;
+        }
+        if (mPos == mEnd) {
+            return fail("empty input");
+        }
+        return readValue();
+    }
+    if (mPos == mEnd) {
+        return fail("unexpected end of input");
+    }
+    const bool object = insideObject();
+    const char close = object ? '}' : ']';
+    switch (mState) {
+    case kFirst:
+        if (*mPos == close) {
+            ++mPos;
+            return closeContainer(object);
+        }
+        return object ? readKey() : readValue();
+    case kAfterValue:
+        if (*mPos == close) {
+            ++mPos;
+            return closeContainer(object);
+        }
+        if (*mPos != ',') {
+            return fail(object ? "expected ',' or '}'" : "expected ',' or ']'");
+        }
+        ++mPos;
+        skipWhitespace();
+        return object ? readKey() : readValue();
+    default:
+        // The value after a key.
+        return readValue();
+    }
+}
+
+bool JsonReader::skip(JsonToken token) {
+    if (token == JsonToken::Error) {
+        return false;
+    }
+    if (token != JsonToken::BeginObject && token != JsonToken::BeginArray) {
+        return true;
+    }
+    const int depth = mDepth - 1;
+    for (;;) {
+        const JsonToken t = next();
+        if (t == JsonToken::Error) {
+            return false;
+        }
+        if ((t == JsonToken::EndObject || t == JsonToken::EndArray) &&
+            mDepth == depth) {
+            return true;
+        }
+    }
+}
+
+bool JsonReader::parse(JsonHandler &handler) {
+    for (;;) {
+        bool keepGoing = true;
+        switch (next()) {
+        case JsonToken::BeginObject:
+            keepGoing = handler.onBeginObject();
+            break;
+        case JsonToken::EndObject:
+            keepGoing = handler.onEndObject();
+            break;
+        case JsonToken::BeginArray:
+            keepGoing = handler.onBeginArray();
+            break;
+        case JsonToken::EndArray:
+            keepGoing = handler.onEndArray();
+            break;
+        case JsonToken::Key:
+            keepGoing = handler.onKey(mString);
+            break;
+        case JsonToken::String:
+            keepGoing = handler.onString(mString);
+            break;
+        case JsonToken::Int:
+            keepGoing = handler.onInt(mInt);
+            break;
+        case JsonToken::Float:
+            keepGoing = handler.onFloat(mFloat);
+            break;
+        case JsonToken::Bool:
+            keepGoing = handler.onBool(mBool);
+            break;
+        case JsonToken::Null:
+            keepGoing = handler.onNull();
+            break;
+        case JsonToken::End:
+            return true;
+        case JsonToken::Error:
+            return false;
+        }
+        if (!keepGoing) {
+            return false;
+        }
+    }
+}
+
+JsonToken JsonReader::readValue() {
+    if (mPos == mEnd) {
+        return fail("unexpected end of input");
+    }
+    switch (*mPos) {
+    case '{':
+    case '[': {
+        if (mDepth >= FASTLED_JSON_MAX_DEPTH) {
+            return fail("nesting too deep");
+        }
+        const bool object = *mPos == '{';
+        const u32 bit = 1u << (mDepth % 32);
+        u32 &word = mObjectBits[mDepth / 32];
+        word = object ? (word | bit) : (word & ~bit);
+        ++mDepth;
+        ++mPos;
+        mState = kFirst;
+        return object ? JsonToken::BeginObject : JsonToken::BeginArray;
+    }
+    case '"': {
+        const JsonToken token = readString();
+        if (token == JsonToken::String) {
+            mState = kAfterValue;
+        }
+        return token;
+    }
+    case 't':
+        mBool = true;
+        return readLiteral("true", 4, JsonToken::Bool);
+    case 'f':
+        mBool = false;
+        return readLiteral("false", 5, JsonToken::Bool);
+    case 'n':
+        return readLiteral("null", 4, JsonToken::Null);
+    default:
+        if (*mPos == '-' || isDigit(*mPos)) {
+            return readNumber();
+        }
+        return fail("unexpected character");
+    }
+}
+
+JsonToken JsonReader::readKey() {
+    if (mPos == mEnd || *mPos != '"') {
+        return fail("expected a key");
+    }
+    if (readString() == JsonToken::Error) {
+        return JsonToken::Error;
+    }
+    skipWhitespace();
+    if (mPos == mEnd || *mPos != ':') {
+        return fail("expected ':'");
+    }
+    ++mPos;
+    mState = kValue;
+    return JsonToken::Key;
+}
+
+JsonToken JsonReader::readString() {
+    ++mPos; // opening quote
+    const char *start = mPos;
+    // Fast path: no escapes, the token points into the source.
+    while (mPos < mEnd) {
+        const unsigned char c = static_cast<unsigned char>(*mPos);
+        if (c == '"') {
+            mString.data = start;
+            mString.size = static_cast<fl::size>(mPos - start);
+            ++mPos;
+            return JsonToken::String;
+        }
+        if (c == '\\') {
+            break;
+        }
+        if (c < 0x20) {
+            return fail("control character in string");
+        }
+        ++mPos;
+    }
+    if (mPos == mEnd) {
+        return fail("unterminated string");
+    }
+    mScratch.clear();
+    for (const char *p = start; p < mPos; ++p) {
+        mScratch.push_back(*p);
+    }
+    while (mPos < mEnd) {
+        const unsigned char c = static_cast<unsigned char>(*mPos);
+        if (c == '"') {
+            mString.data = mScratch.data();
+            mString.size = mScratch.size();
+            ++mPos;
+            return JsonToken::String;
+        }
+        if (c == '\\') {
+            if (!readEscape()) {
+                return JsonToken::Error;
+            }
+            continue;
+        }
+        if (c < 0x20) {
+            return fail("control character in string");
+        }
+        mScratch.push_back(static_cast<char>(c));
+        ++mPos;
+    }
+    return fail("unterminated string");
+}
+
+bool JsonReader::readEscape() {
+    ++mPos; // backslash
+    if (mPos == mEnd) {
+        fail("unterminated string");
+        return false;
+    }
+    const char c = *mPos++;
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+        mScratch.push_back(c);
+        return true;
+    case 'b':
+        mScratch.push_back('\b');
+        return true;
+    case 'f':
+        mScratch.push_back('\f');
+        return true;
+    case 'n':
+        mScratch.push_back('\n');
+        return true;
+    case 'r':
+        mScratch.push_back('\r');
+        return true;
+    case 't':
+        mScratch.push_back('\t');
+        return true;
+    case 'u':
+        break;
+    default:
+        --mPos;
+        fail("invalid escape sequence");
+        return false;
+    }
+
+    auto readHex4 = [this](u32 *out) -> bool {
+        if (mEnd - mPos < 4) {
+            return false;
+        }
+        u32 value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int digit = hexValue(mPos[i]);
+            if (digit < 0) {
+                return false;
+            }
+            value = (value << 4) | static_cast<u32>(digit);
+        }
+        mPos += 4;
+        *out = value;
+        return true;
+    };
+
+    u32 cp = 0;
+    if (!readHex4(&cp)) {
+        fail("invalid \\u escape");
+        return false;
+    }
+    if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        fail("unpaired surrogate");
+        return false;
+    }
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        // UTF-16 surrogate pair, the low half must follow right away.
+        u32 low = 0;
+        if (mEnd - mPos < 2 || mPos[0] != '\\' || mPos[1] != 'u') {
+            fail("unpaired surrogate");
+            return false;
+        }
+        mPos += 2;
+        if (!readHex4(&low) || low < 0xDC00 || low > 0xDFFF) {
+            fail("unpaired surrogate");
+            return false;
+        }
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+    }
+    appendUtf8(mScratch, cp);
+    return true;
+}
+
+JsonToken JsonReader::readNumber() {
+    const bool negative = *mPos == '-';
+    if (negative) {
+        ++mPos;
+    }
+    if (mPos == mEnd || !isDigit(*mPos)) {
+        return fail("invalid number");
+    }
+
+    // Keep as many significant digits as fit in 64 bits, the rest only
+    // shift the decimal exponent.
+    const u64 kMaxMantissa = (~u64(0) - 9) / 10;
+    u64 mantissa = 0;
+    int exponent = 0;
+    bool truncated = false;
+    bool isFloat = false;
+
+    if (*mPos == '0') {
+        ++mPos;
+        if (mPos < mEnd && isDigit(*mPos)) {
+            return fail("leading zero in number");
+        }
+    } else {
+        while (mPos < mEnd && isDigit(*mPos)) {
+            if (mantissa <= kMaxMantissa) {
+                mantissa = mantissa * 10 + static_cast<u64>(*mPos - '0');
+            } else {
+                ++exponent;
+                truncated = true;
+            }
+            ++mPos;
+        }
+    }
+    if (mPos < mEnd && *mPos == '.') {
+        isFloat = true;
+        ++mPos;
+        if (mPos == mEnd || !isDigit(*mPos)) {
+            return fail("invalid number");
+        }
+        while (mPos < mEnd && isDigit(*mPos)) {
+            if (mantissa <= kMaxMantissa) {
+                mantissa = mantissa * 10 + static_cast<u64>(*mPos - '0');
+                --exponent;
+            }
+            ++mPos;
+        }
+    }
+    if (mPos < mEnd && (*mPos == 'e' || *mPos == 'E')) {
+        isFloat = true;
+        ++mPos;
+        bool negativeExponent = false;
+        if (mPos < mEnd && (*mPos == '+' || *mPos == '-')) {
+            negativeExponent = *mPos == '-';
+            ++mPos;
+        }
+        if (mPos == mEnd || !isDigit(*mPos)) {
+            return fail("invalid number");
+        }
+        int e = 0;
+        while (mPos < mEnd && isDigit(*mPos)) {
+            if (e < 100000) {
+                e = e * 10 + (*mPos - '0');
+            }
+            ++mPos;
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    mState = kAfterValue;
+
+    const u64 kInt64Max = ~u64(0) >> 1;
+    if (!isFloat && !truncated &&
+        (mantissa <= kInt64Max || (negative && mantissa == kInt64Max + 1))) {
+        if (!negative) {
+            mInt = static_cast<int64_t>(mantissa);
+        } else if (mantissa == 0) {
+            mInt = 0;
+        } else {
+            mInt = -static_cast<int64_t>(mantissa - 1) - 1;
+        }
+        return JsonToken::Int;
+    }
+    const double value = scaleByPowerOf10(mantissa, exponent);
+    mFloat = negative ? -value : value;
+    return JsonToken::Float;
+}
+
+JsonToken JsonReader::readLiteral(const char *word, fl::size length,
+                                  JsonToken token) {
+    if (static_cast<fl::size>(mEnd - mPos) < length ||
+        memcmp(mPos, word, length) != 0) {
+        return fail("unexpected character");
+    }
+    mPos += length;
+    mState = kAfterValue;
+    return token;
+}
+
+JsonToken JsonReader::closeContainer(bool isObject) {
+    --mDepth;
+    mState = kAfterValue;
+    return isObject ? JsonToken::EndObject : JsonToken::EndArray;
+}
+
+JsonToken JsonReader::fail(const char *message) {
+    if (!mError) {
+        mError = message;
+        mErrorOffset = static_cast<fl::size>(mPos - mBegin);
+    }
+    return JsonToken::Error;
+}
+
+void JsonReader::skipWhitespace() {
+    while (mPos < mEnd &&
+           (*mPos == ' ' || *mPos == '\n' || *mPos == '\r' || *mPos == '\t')) {
+        ++mPos;
+    }
+}
+
+bool JsonReader::insideObject() const {
+    const int index = mDepth - 1;
+    return (mObjectBits[index / 32] >> (index % 32)) & 1u;
+}
+
+} // namespace fl
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "fl/int.h"
+#include "fl/namespace.h"
+#include "fl/str.h"
+#include "fl/vector.h"
+
+// Deepest nesting of arrays and objects JsonReader accepts. Documents that go
+// deeper are rejected instead of risking the stack of a recursive consumer.
+#ifndef FASTLED_JSON_MAX_DEPTH
+#define FASTLED_JSON_MAX_DEPTH 32
+#endif
+
+namespace fl {
+
+// Text of a key or string token. Points into the source buffer when the
+// string has no escapes, otherwise into the reader's scratch buffer. Not null
+// terminated, and only valid until the next call to JsonReader::next().
+struct JsonStringRef {
+    const char *data = nullptr;
+    fl::size size = 0;
+
+    bool equals(const char *str) const;
+    fl::string str() const { return fl::string(data, size); }
+};
+
+enum class JsonToken : u8 {
+    BeginObject,
+    EndObject,
+    BeginArray,
+    EndArray,
+    Key,    // object key, see JsonReader::string()
+    String, // see JsonReader::string()
+    Int,    // integer that fits in int64_t, see JsonReader::intValue()
+    Float,  // any other number, see JsonReader::floatValue()
+    Bool,
+    Null,
+    End,   // the document was read completely
+    Error, // malformed input, see JsonReader::error()
+};
+
+// Push (SAX style) interface for JsonReader::parse(). Every callback returns
+// true to keep going; returning false stops the parse early, which is handy
+// when only the start of a large document is of interest.
+class JsonHandler {
+  public:
+    virtual ~JsonHandler() = default;
+    virtual bool onBeginObject() { return true; }
+    virtual bool onEndObject() { return true; }
+    virtual bool onBeginArray() { return true; }
+    virtual bool onEndArray() { return true; }
+    virtual bool onKey(const JsonStringRef & /*key*/) { return true; }
+    virtual bool onString(const JsonStringRef & /*value*/) { return true; }
+    virtual bool onInt(int64_t /*value*/) { return true; }
+    virtual bool onFloat(double /*value*/) { return true; }
+    virtual bool onBool(bool /*value*/) { return true; }
+    virtual bool onNull() { return true; }
+};
+
+// Single pass pull parser over a JSON document in memory.
+//
+//   fl::JsonReader reader(text, length);
+//   for (fl::JsonToken t = reader.next(); t != fl::JsonToken::End;
+//        t = reader.next()) {
+//       if (t == fl::JsonToken::Error) { ... reader.error() ... }
+//   }
+//
+// The reader never copies the document and allocates nothing unless a string
+// contains escape sequences, which are decoded into a reused scratch buffer.
+// It accepts standard JSON (RFC 8259) only: no comments, no single quotes, no
+// trailing commas and nothing but whitespace after the top level value.
+class JsonReader {
+  public:
+    JsonReader(const char *text, fl::size length);
+    explicit JsonReader(const char *text);
+
+    JsonReader(const JsonReader &) = delete;
+    JsonReader &operator=(const JsonReader &) = delete;
+
+    // Reads the next token. Once End or Error is returned it is returned
+    // again on every later call.
+    JsonToken next();
+
+    // Skips the value that starts at `token` (the token just returned by
+    // next()): for BeginObject/BeginArray everything up to the matching end,
+    // for scalars nothing. Returns false if the input is malformed.
+    bool skip(JsonToken token);
+
+    // Reads the whole document, reporting every token to `handler`. Returns
+    // false on malformed input or when the handler stops the parse.
+    bool parse(JsonHandler &handler);
+
+    // Value of the last Key/String, Int, Float or Bool token.
+    const JsonStringRef &string() const { return mString; }
+    int64_t intValue() const { return mInt; }
+    double floatValue() const { return mFloat; }
+    bool boolValue() const { return mBool; }
+
+    // Number of arrays and objects the reader is inside of.
+    int depth() const { return mDepth; }
+
+    // Description and byte offset of the first syntax error, or nullptr.
+    const char *error() const { return mError; }
+    fl::size errorOffset() const { return mErrorOffset; }
+
+  private:
+    enum State : u8 {
+        kValue,      // expecting a value
+        kFirst,      // just after '{' or '['
+        kAfterValue, // expecting ',' or the end of the container
+        kDone,
+    };
+
+    JsonToken readValue();
+    JsonToken readKey();
+    JsonToken readString();
+    JsonToken readNumber();
+    JsonToken readLiteral(const char *word, fl::size length, JsonToken token);
+    JsonToken closeContainer(bool isObject);
+    JsonToken fail(const char *message);
+    bool readEscape(); // appends one decoded escape sequence to mScratch
+    void skipWhitespace();
+    bool insideObject() const;
+
+    const char *mPos;
+    const char *mEnd;
+    const char *mBegin;
+    State mState = kValue;
+    int mDepth = 0;
+    // One bit per open container, set for objects.
+    u32 mObjectBits[(FASTLED_JSON_MAX_DEPTH + 31) / 32] = {};
+    JsonStringRef mString;
+    fl::vector<char> mScratch;
+    int64_t mInt = 0;
+    double mFloat = 0;
+    bool mBool = false;
+    const char *mError = nullptr;
+    fl::size mErrorOffset = 0;
+};
+
+} // namespace fl
@@ -0,0 +1,450 @@
+#include "fl/json_writer.h"
+
+#include <string.h>
+
+#include "fl/json.h"
+#include "fl/ostream.h"
+
+namespace fl {
+
+namespace {
+
+const u64 kPowersOf10[] = {1ull,
+                           10ull,
+                           100ull,
+                           1000ull,
+                           10000ull,
+                           100000ull,
+                           1000000ull,
+                           10000000ull,
+                           100000000ull,
+                           1000000000ull};
+
+const int kMaxPrecision = 9;
+
+// Digits of `value`, most significant first. Returns the count.
+fl::size writeDigits(u64 value, char *out) {
+    char tmp[20];
+    fl::size n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (fl::size i = 0; i < n; ++i) {
+        out[i] = tmp[n - 1 - i];
+    }
+    return n;
+}
+
+bool needsEscape(unsigned char c) { return c == '"' || c == '\\' || c < 0x20; }
+
+} // namespace
+
+JsonWriter::JsonWriter(fl::string &out)
+    : mSink(kString), mString(&out), mBuf(mChunk), mCapacity(sizeof(mChunk)) {}
+
+JsonWriter::JsonWriter(char *buffer, fl::size capacity)
+    : mSink(kBuffer), mBuf(buffer), mCapacity(capacity ? capacity - 1 : 0) {
+    if (buffer && capacity) {
+        buffer[0] = '\0';
+    } else {
+        mBuf = mChunk;
+        mCapacity = 0;
+    }
+}
+
+JsonWriter::JsonWriter(fl::ostream &out)
+    : mSink(kStream), mStream(&out), mBuf(mChunk),
+      mCapacity(sizeof(mChunk) - 1) {}
+
+JsonWriter::~JsonWriter() { flush(); }
+
+JsonWriter &JsonWriter::beginObject() {
+    separate();
+    put('{');
+    mNeedComma = false;
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject() {
+    put('}');
+    mNeedComma = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::beginArray() {
+    separate();
+    put('[');
+    mNeedComma = false;
+    return *this;
+}
+
+JsonWriter &JsonWriter::endArray() {
+    put(']');
+    mNeedComma = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::key(const char *name) {
+    return key(name, name ? strlen(name) : 0);
+}
+
+JsonWriter &JsonWriter::key(const char *name, fl::size length) {
+    separate();
+    writeEscaped(name, length);
+    put(':');
+    mNeedComma = false;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(const char *str) {
+    if (!str) {
+        return nullValue();
+    }
+    return value(str, strlen(str));
+}
+
+JsonWriter &JsonWriter::value(const char *str, fl::size length) {
+    separate();
+    writeEscaped(str, length);
+    mNeedComma = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(bool b) {
+    separate();
+    if (b) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+    mNeedComma = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(int64_t i) {
+    separate();
+    char buf[24];
+    put(buf, formatInt(i, buf));
+    mNeedComma = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(float f, int precision) {
+    separate();
+    char buf[48];
+    put(buf, formatFloat(f, precision, buf));
+    mNeedComma = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::nullValue() {
+    separate();
+    put("null", 4);
+    mNeedComma = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(const JsonValue &node) {
+    const JsonValue::variant_t &data = node.data;
+    if (data.is<bool>()) {
+        return value(*data.ptr<bool>());
+    }
+    if (data.is<int64_t>()) {
+        return value(*data.ptr<int64_t>());
+    }
+    if (data.is<float>()) {
+        return value(*data.ptr<float>());
+    }
+    if (data.is<fl::string>()) {
+        return value(*data.ptr<fl::string>());
+    }
+    if (data.is<JsonArray>()) {
+        beginArray();
+        for (const fl::shared_ptr<JsonValue> &item : *data.ptr<JsonArray>()) {
+            if (item) {
+                value(*item);
+            } else {
+                nullValue();
+            }
+        }
+        return endArray();
+    }
+    if (data.is<JsonObject>()) {
+        beginObject();
+        for (const auto &kv : *data.ptr<JsonObject>()) {
+            key(kv.first);
+            if (kv.second) {
+                value(*kv.second);
+            } else {
+                nullValue();
+            }
+        }
+        return endObject();
+    }
+    if (data.is<fl::vector<int16_t>>()) {
+        beginArray();
+        for (int16_t v : *data.ptr<fl::vector<int16_t>>()) {
+            value(static_cast<int64_t>(v));
+        }
+        return endArray();
+    }
+    if (data.is<fl::vector<uint8_t>>()) {
+        beginArray();
+        for (uint8_t v : *data.ptr<fl::vector<uint8_t>>()) {
+            value(static_cast<int64_t>(v));
+        }
+        return endArray();
+    }
+    if (data.is<fl::vector<float>>()) {
+        beginArray();
+        for (float v : *data.ptr<fl::vector<float>>()) {
+            value(v, kFloatArrayPrecision);
+        }
+        return endArray();
+    }
+    return nullValue();
+}
+
+void JsonWriter::flush() {
+    if (mSink != kBuffer) {
+        drain();
+    }
+}
+
+fl::size JsonWriter::estimateSize(const JsonValue &node) {
+    const JsonValue::variant_t &data = node.data;
+    if (data.is<bool>()) {
+        return 5;
+    }
+    if (data.is<int64_t>()) {
+        return 12;
+    }
+    if (data.is<float>()) {
+        return 12;
+    }
+    if (data.is<fl::string>()) {
+        return data.ptr<fl::string>()->size() + 2;
+    }
+    if (data.is<JsonArray>()) {
+        fl::size total = 2;
+        for (const fl::shared_ptr<JsonValue> &item : *data.ptr<JsonArray>()) {
+            total += (item ? estimateSize(*item) : 4) + 1;
+        }
+        return total;
+    }
+    if (data.is<JsonObject>()) {
+        fl::size total = 2;
+        for (const auto &kv : *data.ptr<JsonObject>()) {
+            total += kv.first.size() + 4;
+            total += kv.second ? estimateSize(*kv.second) : 4;
+        }
+        return total;
+    }
+    if (data.is<fl::vector<int16_t>>()) {
+        return 2 + data.ptr<fl::vector<int16_t>>()->size() * 7;
+    }
+    if (data.is<fl::vector<uint8_t>>()) {
+        return 2 + data.ptr<fl::vector<uint8_t>>()->size() * 4;
+    }
+    if (data.is<fl::vector<float>>()) {
+        return 2 + data.ptr<fl::vector<float>>()->size() * 12;
+    }
+    return 4;
+}
+
+fl::size JsonWriter::formatInt(int64_t value, char *out) {
+    if (value >= 0) {
+        return writeDigits(static_cast<u64>(value), out);
+    }
+    // Negate in unsigned arithmetic so INT64_MIN works.
+    out[0] = '-';
+    return 1 + writeDigits(0 - static_cast<u64>(value), out + 1);
+}
+
+fl::size JsonWriter::formatFloat(float value, int precision, char *out) {
+    if (value != value || value - value != 0.0f) {
+        // NaN or infinity.
+        memcpy(out, "null", 4);
+        return 4;
+    }
+    if (precision < 0) {
+        precision = 0;
+    } else if (precision > kMaxPrecision) {
+        precision = kMaxPrecision;
+    }
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const bool negative = (bits >> 31) != 0; // keeps the sign of -0.0
+    const double magnitude = negative ? -static_cast<double>(value)
+                                      : static_cast<double>(value);
+
+    fl::size n = 0;
+    if (negative) {
+        out[n++] = '-';
+    }
+
+    const u64 unit = kPowersOf10[precision];
+    if (magnitude < 16777216.0) {
+        // A float has 24 significant bits and 10^9 = 2^9 * 5^9 adds 21, so
+        // the scaled value is exact in a double and the rounding below is
+        // the same round-half-to-even printf("%.*f") does.
+        const double scaled = magnitude * static_cast<double>(unit);
+        u64 whole = static_cast<u64>(scaled);
+        const double frac = scaled - static_cast<double>(whole);
+        if (frac > 0.5 || (frac == 0.5 && (whole & 1))) {
+            ++whole;
+        }
+        n += writeDigits(whole / unit, out + n);
+        if (precision > 0) {
+            out[n++] = '.';
+            u64 fraction = whole % unit;
+            for (int i = precision - 1; i >= 0; --i) {
+                out[n + i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            n += precision;
+        }
+        return n;
+    }
+
+    if (magnitude < 18446744073709551616.0) {
+        // From 2^24 up every float is a whole number.
+        n += writeDigits(static_cast<u64>(magnitude), out + n);
+        if (precision > 0) {
+            out[n++] = '.';
+            for (int i = 0; i < precision; ++i) {
+                out[n++] = '0';
+            }
+        }
+        return n;
+    }
+
+    // Beyond 64 bits: nine significant digits (enough to read the same float
+    // back) in exponent form, which is still valid JSON.
+    int exponent = 0;
+    double scale = 1.0;
+    while (magnitude / scale >= 1e9) {
+        scale *= 10.0;
+        ++exponent;
+    }
+    const double mantissa = magnitude / scale;
+    u64 digits = static_cast<u64>(mantissa);
+    const double frac = mantissa - static_cast<double>(digits);
+    if (frac > 0.5 || (frac == 0.5 && (digits & 1))) {
+        ++digits;
+    }
+    if (digits >= 1000000000ull) {
+        digits /= 10;
+        ++exponent;
+    }
+    char tmp[10];
+    const fl::size count = writeDigits(digits, tmp);
+    out[n++] = tmp[0];
+    out[n++] = '.';
+    for (fl::size i = 1; i < count; ++i) {
+        out[n++] = tmp[i];
+    }
+    out[n++] = 'e';
+    out[n++] = '+';
+    n += writeDigits(static_cast<u64>(exponent + static_cast<int>(count) - 1),
+                     out + n);
+    return n;
+}
+
+void JsonWriter::put(char c) {
+    if (mLength == mCapacity) {
+        drain();
+    }
+    ++mWritten;
+    if (mLength < mCapacity) {
+        mBuf[mLength++] = c;
+        if (mSink == kBuffer) {
+            mBuf[mLength] = '\0';
+        }
+    } else {
+        mOverflow = true;
+    }
+}
+
+void JsonWriter::put(const char *str, fl::size length) {
+    mWritten += length;
+    while (length) {
+        if (mLength == mCapacity) {
+            drain();
+            if (mLength == mCapacity) {
+                mOverflow = true;
+                return;
+            }
+        }
+        fl::size n = mCapacity - mLength;
+        if (n > length) {
+            n = length;
+        }
+        memcpy(mBuf + mLength, str, n);
+        mLength += n;
+        str += n;
+        length -= n;
+    }
+    if (mSink == kBuffer) {
+        mBuf[mLength] = '\0';
+    }
+}
+
+void JsonWriter::drain() {
+    if (mLength == 0) {
+        return;
+    }
+    switch (mSink) {
+    case kString:
+        mString->append(mBuf, mLength);
+        mLength = 0;
+        break;
+    case kStream:
+        mBuf[mLength] = '\0';
+        *mStream << static_cast<const char *>(mBuf);
+        mLength = 0;
+        break;
+    case kBuffer:
+        break; // fixed size, nowhere to go
+    }
+}
+
+void JsonWriter::separate() {
+    if (mNeedComma) {
+        put(',');
+    }
+}
+
+void JsonWriter::writeEscaped(const char *str, fl::size length) {
+    static const char kHex[] = "0123456789abcdef";
+    put('"');
+    fl::size start = 0;
+    for (fl::size i = 0; i < length; ++i) {
+        const unsigned char c = static_cast<unsigned char>(str[i]);
+        if (!needsEscape(c)) {
+            continue;
+        }
+        put(str + start, i - start);
+        start = i + 1;
+        switch (c) {
+        case '"': put("\\\"", 2); break;
+        case '\\': put("\\\\", 2); break;
+        case '\n': put("\\n", 2); break;
+        case '\r': put("\\r", 2); break;
+        case '\t': put("\\t", 2); break;
+        case '\b': put("\\b", 2); break;
+        case '\f': put("\\f", 2); break;
+        default: {
+            const char escape[6] = {'\\', 'u', '0', '0', kHex[c >> 4],
+                                    kHex[c & 0xF]};
+            put(escape, 6);
+            break;
+        }
+        }
+    }
+    put(str + start, length - start);
+    put('"');
+}
+
+} // namespace fl
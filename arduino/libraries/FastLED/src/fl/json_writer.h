@@ -0,0 +1,109 @@
+#pragma once
+
+#include "fl/int.h"
+#include "fl/namespace.h"
+#include "fl/str.h"
+
+namespace fl {
+
+class ostream;
+struct JsonValue;
+
+// Streaming JSON serializer. Output goes straight into the destination: a
+// fl::string (appended to), a fixed char buffer or a fl::ostream. Numbers are
+// formatted here without printf.
+//
+//   fl::string out;
+//   fl::JsonWriter w(out);
+//   w.beginObject().key("id").value(int64_t(3)).key("on").value(true);
+//   w.endObject();
+//   w.flush();
+//
+// Commas and colons are inserted automatically; the caller is trusted to
+// balance begin/end calls and to give objects a key before every value.
+class JsonWriter {
+  public:
+    // Digits after the decimal point used for float values, matching what
+    // Json::to_string() has always produced.
+    static const int kFloatPrecision = 3;
+    static const int kFloatArrayPrecision = 6;
+
+    explicit JsonWriter(fl::string &out);
+    // Writes at most `capacity - 1` characters and always null terminates.
+    // Output that does not fit is dropped and reported by overflow().
+    JsonWriter(char *buffer, fl::size capacity);
+    explicit JsonWriter(fl::ostream &out);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter &) = delete;
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    JsonWriter &beginObject();
+    JsonWriter &endObject();
+    JsonWriter &beginArray();
+    JsonWriter &endArray();
+
+    JsonWriter &key(const char *name);
+    JsonWriter &key(const char *name, fl::size length);
+    JsonWriter &key(const fl::string &name) {
+        return key(name.c_str(), name.size());
+    }
+
+    JsonWriter &value(const char *str);
+    JsonWriter &value(const char *str, fl::size length);
+    JsonWriter &value(const fl::string &str) {
+        return value(str.c_str(), str.size());
+    }
+    JsonWriter &value(bool b);
+    JsonWriter &value(int32_t i) { return value(static_cast<int64_t>(i)); }
+    JsonWriter &value(int64_t i);
+    JsonWriter &value(float f, int precision = kFloatPrecision);
+    JsonWriter &value(double d, int precision = kFloatPrecision) {
+        return value(static_cast<float>(d), precision);
+    }
+    JsonWriter &nullValue();
+
+    // Writes a whole tree.
+    JsonWriter &value(const JsonValue &node);
+
+    // Passes buffered output on to a string or stream destination. Also done
+    // by the destructor.
+    void flush();
+
+    // Characters produced so far, including any that did not fit.
+    fl::size size() const { return mWritten; }
+    bool overflow() const { return mOverflow; }
+
+    // Rough serialized size of `node`, for reserving the destination up
+    // front. Strings that need escaping can make it come out short.
+    static fl::size estimateSize(const JsonValue &node);
+
+    // Formatting helpers. `out` must have room for 24 characters for
+    // integers and 48 for floats. Return the number of characters written,
+    // without a terminator. Infinity and NaN have no JSON spelling and are
+    // written as null.
+    static fl::size formatInt(int64_t value, char *out);
+    static fl::size formatFloat(float value, int precision, char *out);
+
+  private:
+    enum Sink : u8 { kString, kBuffer, kStream };
+
+    void put(char c);
+    void put(const char *str, fl::size length);
+    void drain();
+    void separate();
+    void writeEscaped(const char *str, fl::size length);
+
+    Sink mSink;
+    fl::string *mString = nullptr;
+    fl::ostream *mStream = nullptr;
+    char *mBuf;
+    fl::size mCapacity; // usable bytes of mBuf, excluding the terminator
+    fl::size mLength = 0;
+    fl::size mWritten = 0;
+    bool mNeedComma = false;
+    bool mOverflow = false;
+    char mChunk[128];
+};
+
+} // namespace fl
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "fl/align.h"
+#include "fl/atomic.h"
+#include "fl/inplacenew.h"
+#include "fl/int.h"
+#include "fl/move.h"
+#include "fl/namespace.h"
+#include "fl/type_traits.h"
+
+namespace fl {
+
+// Bounded lock-free queue for any number of producers and one consumer,
+// e.g. several network or capture tasks feeding the render loop. N must be
+// a power of two and is the number of elements the queue can hold. Storage
+// is inline, so large queues should be static or heap allocated.
+//
+// Every cell carries a sequence number that says whether it is free for
+// the producer claiming that position or filled for the consumer. Producers
+// claim positions with a compare-exchange on the tail, the consumer needs
+// no read-modify-write at all. pop() may only be called from the consumer.
+template <typename T, fl::size N> class mpsc_queue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0,
+                  "mpsc_queue capacity must be a power of two");
+
+  public:
+    mpsc_queue() {
+        for (fl::size i = 0; i < N; ++i) {
+            mCells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+    ~mpsc_queue() {
+        for (fl::size pos = mHead.load(memory_order_relaxed);; ++pos) {
+            Cell& cell = mCells[pos & (N - 1)];
+            if (cell.sequence.load(memory_order_acquire) != pos + 1) {
+                break;
+            }
+            reinterpret_cast<T*>(cell.storage)->~T();
+        }
+    }
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    // Producer side, safe from any thread. Returns false when the queue is
+    // full.
+    bool push(const T& value) { return emplace(value); }
+    bool push(T&& value) { return emplace(fl::move(value)); }
+
+    template <typename... Args> bool emplace(Args&&... args) {
+        fl::size pos = mTail.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &mCells[pos & (N - 1)];
+            const fl::size seq = cell->sequence.load(memory_order_acquire);
+            const fl::i32 diff = static_cast<fl::i32>(seq - pos);
+            if (diff == 0) {
+                // On failure pos is reloaded with the current tail.
+                if (mTail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // the consumer has not freed this cell yet
+            } else {
+                pos = mTail.load(memory_order_relaxed); // lost a race
+            }
+        }
+        new (cell->storage) T(fl::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the queue is empty, or when the
+    // oldest element is still being written by its producer.
+    bool pop(T& out) {
+        const fl::size pos = mHead.load(memory_order_relaxed);
+        Cell& cell = mCells[pos & (N - 1)];
+        const fl::size seq = cell.sequence.load(memory_order_acquire);
+        if (seq != pos + 1) {
+            return false;
+        }
+        T* item = reinterpret_cast<T*>(cell.storage);
+        out = fl::move(*item);
+        item->~T();
+        cell.sequence.store(pos + N, memory_order_release);
+        mHead.store(pos + 1, memory_order_relaxed);
+        return true;
+    }
+
+    // Snapshot, may count elements whose producer is still writing them.
+    fl::size size() const {
+        const fl::size head = mHead.load(memory_order_relaxed);
+        return mTail.load(memory_order_relaxed) - head;
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr fl::size capacity() { return N; }
+
+  private:
+    struct Cell {
+        AtomicBuiltin<fl::size> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    alignas(FL_CACHE_LINE_SIZE) AtomicBuiltin<fl::size> mTail; // producers
+    alignas(FL_CACHE_LINE_SIZE) AtomicBuiltin<fl::size> mHead; // consumer
+    alignas(FL_CACHE_LINE_SIZE) Cell mCells[N];
+};
+
+} // namespace fl
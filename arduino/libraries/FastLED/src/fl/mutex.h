@@ -2,6 +2,7 @@
 
 #include "fl/thread.h"
 #include "fl/assert.h"
+#include "fl/allocator.h"
 
 #if FASTLED_MULTITHREADED
 #include <mutex>  // ok include
@@ -92,4 +93,13 @@ class lock_guard {
     MutexType& mMutex;
 };
 
+// Slab allocators guarded by fl::mutex, for pools shared between threads on
+// the host. Declared here rather than in fl/allocator.h because this header
+// already depends on it.
+template <typename T, fl::size SLAB_SIZE = FASTLED_DEFAULT_SLAB_SIZE>
+using SlabAllocatorThreadSafe = SlabAllocator<T, SLAB_SIZE, fl::mutex>;
+
+template <typename T, fl::size SLAB_SIZE = FASTLED_DEFAULT_SLAB_SIZE>
+using allocator_slab_threadsafe = allocator_slab<T, SLAB_SIZE, fl::mutex>;
+
 } // namespace fl
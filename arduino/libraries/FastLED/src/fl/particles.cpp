@@ -0,0 +1,280 @@
+#ifndef FASTLED_INTERNAL
+#define FASTLED_INTERNAL
+#endif
+
+#include "FastLED.h"
+
+#include "fl/particles.h"
+
+#include "fl/math_macros.h"
+
+namespace fl {
+
+namespace {
+
+// Nearest pixel of a Q16.16 coordinate.
+inline i32 round_position(i32 v) { return (v + 0x8000) >> 16; }
+
+} // namespace
+
+Particles2D::Particles2D(u32 capacity) { resize(capacity); }
+
+void Particles2D::resize(u32 capacity) {
+    mCapacity = capacity;
+    mX.assign(capacity, 0);
+    mY.assign(capacity, 0);
+    mAngle.assign(capacity, 0);
+    mSpin.assign(capacity, 1);
+    mGroup.assign(capacity, 0);
+    mStrength.assign(capacity, 0);
+    mAlive.assign(capacity, 0);
+}
+
+u32 Particles2D::aliveCount() const {
+    u32 count = 0;
+    const u8 *alive = mAlive.data();
+    for (u32 i = 0; i < mCapacity; ++i) {
+        count += alive[i] ? 1 : 0;
+    }
+    return count;
+}
+
+void Particles2D::spawn(u32 slot, i32 x, i32 y, u16 angle, i8 spin, u16 group,
+                        u16 strength) {
+    if (slot >= mCapacity) {
+        return;
+    }
+    mX[slot] = x;
+    mY[slot] = y;
+    mAngle[slot] = angle;
+    mSpin[slot] = spin < 0 ? -1 : 1;
+    mGroup[slot] = group;
+    mStrength[slot] = strength;
+    mAlive[slot] = 1;
+}
+
+void Particles2D::decay(u16 factor, u16 minStrength) {
+    u16 *strength = mStrength.data();
+    u8 *alive = mAlive.data();
+    for (u32 i = 0; i < mCapacity; ++i) {
+        if (!alive[i]) {
+            continue;
+        }
+        u16 s = static_cast<u16>((static_cast<u32>(strength[i]) * factor) >> 16);
+        strength[i] = s;
+        alive[i] = s >= minStrength ? 1 : 0;
+    }
+}
+
+void Particles2D::advance() {
+    i32 *px = mX.data();
+    i32 *py = mY.data();
+    const u16 *angle = mAngle.data();
+    const u8 *alive = mAlive.data();
+    for (u32 i = 0; i < mCapacity; ++i) {
+        if (!alive[i]) {
+            continue;
+        }
+        // sin16/cos16 are Q1.15, positions are Q16.16.
+        px[i] += static_cast<i32>(cos16(angle[i])) * 2;
+        py[i] += static_cast<i32>(sin16(angle[i])) * 2;
+    }
+}
+
+void ParticleSplatter::setSize(u16 width, u16 height) {
+    if (width == mWidth && height == mHeight) {
+        return;
+    }
+    mWidth = width;
+    mHeight = height;
+    mTilesX = static_cast<u16>((width + kTileSize - 1) / kTileSize);
+    mTilesY = static_cast<u16>((height + kTileSize - 1) / kTileSize);
+    const u32 tiles = static_cast<u32>(mTilesX) * mTilesY;
+    mAccum.assign(static_cast<u32>(width) * height, 0);
+    mTileTouched.assign(tiles, 0);
+    mTileStart.assign(tiles + 1, 0);
+}
+
+void ParticleSplatter::setGain(u8 gain) {
+    if (mGain == gain) {
+        return;
+    }
+    mGain = gain;
+    for (int v = 0; v < 256; ++v) {
+        CRGB c = CHSV(0, 0, scale8(static_cast<u8>(v), gain));
+        mGrayLut[v] = c.r;
+    }
+}
+
+u8 ParticleSplatter::accumulated(u16 x, u16 y) const {
+    if (x >= mWidth || y >= mHeight) {
+        return 0;
+    }
+    return mAccum[static_cast<u32>(y) * mWidth + x];
+}
+
+void ParticleSplatter::sortByTile(const Particles2D &particles) {
+    const u32 n = particles.capacity();
+    const u32 tiles = static_cast<u32>(mTilesX) * mTilesY;
+    const u16 kSkip = 0xffff;
+    if (mParticleTile.size() < n) {
+        mParticleTile.assign(n, kSkip);
+        mOrder.assign(n, 0);
+    }
+    u32 *start = mTileStart.data();
+    for (u32 t = 0; t <= tiles; ++t) {
+        start[t] = 0;
+    }
+
+    // Bucket each live particle by the tile under its center. Particles more
+    // than a dot radius outside the screen cannot touch it and are skipped.
+    const i32 *px = particles.x();
+    const i32 *py = particles.y();
+    const u8 *alive = particles.aliveFlags();
+    const i32 w = mWidth;
+    const i32 h = mHeight;
+    u16 *tileOf = mParticleTile.data();
+    for (u32 i = 0; i < n; ++i) {
+        tileOf[i] = kSkip;
+        if (!alive[i]) {
+            continue;
+        }
+        i32 cx = round_position(px[i]);
+        i32 cy = round_position(py[i]);
+        if (cx < -kMaxRadius || cy < -kMaxRadius || cx >= w + kMaxRadius ||
+            cy >= h + kMaxRadius) {
+            continue;
+        }
+        cx = MAX(0, MIN(cx, w - 1));
+        cy = MAX(0, MIN(cy, h - 1));
+        u16 tile = static_cast<u16>((cy / kTileSize) * mTilesX + cx / kTileSize);
+        tileOf[i] = tile;
+        ++start[tile + 1];
+    }
+    for (u32 t = 0; t < tiles; ++t) {
+        start[t + 1] += start[t];
+    }
+    mSplatCount = start[tiles];
+
+    // Stable scatter into tile order. start[t] is advanced while filling, so
+    // afterwards start[t] holds the end of bucket t.
+    u32 *order = mOrder.data();
+    for (u32 i = 0; i < n; ++i) {
+        if (tileOf[i] != kSkip) {
+            order[start[tileOf[i]]++] = i;
+        }
+    }
+}
+
+void ParticleSplatter::splatDot(i32 fx, i32 fy, u16 strength) {
+    // Radius is strength / 2 clamped to [1, 3], in Q8.8.
+    u32 r = static_cast<u32>(strength) >> 5;
+    r = MAX(256u, MIN(r, static_cast<u32>(kMaxRadius) << 8));
+    const u32 r2 = (r * r) >> 8;                  // Q.8
+    // 255 / r^2 in Q.8, rounded up so the center sample reaches 255.
+    const u32 inv = ((255u << 16) + r2 - 1) / r2;
+    const i32 R = static_cast<i32>((r + 255) >> 8); // ceil(r)
+    const i32 cx = round_position(fx);
+    const i32 cy = round_position(fy);
+
+    const i32 x0 = MAX(cx - R, 0);
+    const i32 x1 = MIN(cx + R, static_cast<i32>(mWidth) - 1);
+    const i32 y0 = MAX(cy - R, 0);
+    const i32 y1 = MIN(cy + R, static_cast<i32>(mHeight) - 1);
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    for (i32 y = y0; y <= y1; ++y) {
+        const i32 dy = y - cy;
+        u8 *row = mAccum.data() + static_cast<u32>(y) * mWidth;
+        for (i32 x = x0; x <= x1; ++x) {
+            const i32 dx = x - cx;
+            const u32 d2 = static_cast<u32>(dx * dx + dy * dy) << 8;
+            if (d2 > r2) {
+                continue;
+            }
+            // 255 * (1 - d^2 / r^2)
+            const u32 v = ((r2 - d2) * inv) >> 16;
+            const u32 sum = static_cast<u32>(row[x]) + mGrayLut[MIN(v, 255u)];
+            row[x] = static_cast<u8>(MIN(sum, 255u));
+        }
+    }
+    const u16 tx0 = static_cast<u16>(x0 / kTileSize);
+    const u16 tx1 = static_cast<u16>(x1 / kTileSize);
+    const u16 ty0 = static_cast<u16>(y0 / kTileSize);
+    const u16 ty1 = static_cast<u16>(y1 / kTileSize);
+    for (u16 ty = ty0; ty <= ty1; ++ty) {
+        for (u16 tx = tx0; tx <= tx1; ++tx) {
+            mTileTouched[static_cast<u32>(ty) * mTilesX + tx] = 1;
+        }
+    }
+}
+
+void ParticleSplatter::clearTouchedTiles() {
+    // The previous draw's sums are kept for accumulated(); only the tiles it
+    // wrote to need clearing.
+    for (u16 ty = 0; ty < mTilesY; ++ty) {
+        for (u16 tx = 0; tx < mTilesX; ++tx) {
+            u8 &touched = mTileTouched[static_cast<u32>(ty) * mTilesX + tx];
+            if (!touched) {
+                continue;
+            }
+            touched = 0;
+            const u16 x0 = static_cast<u16>(tx * kTileSize);
+            const u16 xEnd = static_cast<u16>(MIN(x0 + kTileSize, (int)mWidth));
+            const u16 yEnd = static_cast<u16>(MIN((ty + 1) * kTileSize, (int)mHeight));
+            for (u16 y = static_cast<u16>(ty * kTileSize); y < yEnd; ++y) {
+                u8 *row = mAccum.data() + static_cast<u32>(y) * mWidth;
+                for (u16 x = x0; x < xEnd; ++x) {
+                    row[x] = 0;
+                }
+            }
+        }
+    }
+}
+
+void ParticleSplatter::flush(const XYMap &xyMap, CRGB *leds) {
+    // Adding the clamped per pixel sum once is the same as adding every dot
+    // sample with qadd8, since all samples are non negative.
+    for (u16 ty = 0; ty < mTilesY; ++ty) {
+        for (u16 tx = 0; tx < mTilesX; ++tx) {
+            if (!mTileTouched[static_cast<u32>(ty) * mTilesX + tx]) {
+                continue;
+            }
+            const u16 xEnd = static_cast<u16>(MIN((tx + 1) * kTileSize, (int)mWidth));
+            const u16 yEnd = static_cast<u16>(MIN((ty + 1) * kTileSize, (int)mHeight));
+            for (u16 y = static_cast<u16>(ty * kTileSize); y < yEnd; ++y) {
+                const u8 *row = mAccum.data() + static_cast<u32>(y) * mWidth;
+                for (u16 x = static_cast<u16>(tx * kTileSize); x < xEnd; ++x) {
+                    const u8 v = row[x];
+                    if (!v) {
+                        continue;
+                    }
+                    if (xyMap.has(x, y)) {
+                        leds[xyMap.mapToIndex(x, y)] += CRGB(v, v, v);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ParticleSplatter::draw(const Particles2D &particles, u8 gain,
+                            const XYMap &xyMap, CRGB *leds) {
+    setSize(xyMap.getWidth(), xyMap.getHeight());
+    setGain(gain);
+    clearTouchedTiles();
+    sortByTile(particles);
+
+    const i32 *px = particles.x();
+    const i32 *py = particles.y();
+    const u16 *strength = particles.strength();
+    const u32 *order = mOrder.data();
+    for (u32 k = 0; k < mSplatCount; ++k) {
+        const u32 i = order[k];
+        splatDot(px[i], py[i], strength[i]);
+    }
+    flush(xyMap, leds);
+}
+
+} // namespace fl
@@ -0,0 +1,126 @@
+#pragma once
+
+/// @file particles.h
+/// @brief Structure-of-arrays particle pool and a tile sorted soft-dot
+/// splatter.
+///
+/// Particles2D keeps each particle attribute in its own array so that the
+/// per frame passes (decay, advance) are tight loops over contiguous memory
+/// using fixed point maths only. ParticleSplatter draws the live particles as
+/// soft round dots: particles are bucketed by screen tile with a counting
+/// sort, accumulated into a dense intensity buffer tile by tile, and the
+/// result is added to the LED buffer once through the XYMap.
+
+#include "fl/int.h"
+#include "fl/namespace.h"
+#include "fl/vector.h"
+#include "fl/xymap.h"
+
+#include "crgb.h"
+
+namespace fl {
+
+class Particles2D {
+  public:
+    // Positions are Q16.16 pixels.
+    static const i32 kPositionOne = 1 << 16;
+    // Strength is Q4.12, so 1.0 == 4096.
+    static const u16 kStrengthOne = 1 << 12;
+
+    explicit Particles2D(u32 capacity = 0);
+
+    // Resizes the pool. All particles are dead afterwards.
+    void resize(u32 capacity);
+    u32 capacity() const { return mCapacity; }
+    // Counts live particles (linear in capacity).
+    u32 aliveCount() const;
+
+    // Places a live particle in `slot`, replacing whatever was there.
+    // `angle` uses the sin16/cos16 convention (65536 == full turn) and `spin`
+    // is +1 or -1.
+    void spawn(u32 slot, i32 x, i32 y, u16 angle, i8 spin, u16 group,
+               u16 strength);
+    void kill(u32 slot) { mAlive[slot] = 0; }
+    bool alive(u32 slot) const { return mAlive[slot] != 0; }
+
+    // strength = strength * factor / 65536. Particles that fall below
+    // `minStrength` die.
+    void decay(u16 factor, u16 minStrength);
+    // Moves every live particle one pixel along its heading.
+    void advance();
+
+    // Raw attribute arrays, `capacity()` entries each.
+    i32 *x() { return mX.data(); }
+    i32 *y() { return mY.data(); }
+    u16 *angle() { return mAngle.data(); }
+    i8 *spin() { return mSpin.data(); }
+    u16 *group() { return mGroup.data(); }
+    u16 *strength() { return mStrength.data(); }
+    u8 *aliveFlags() { return mAlive.data(); }
+    const i32 *x() const { return mX.data(); }
+    const i32 *y() const { return mY.data(); }
+    const u16 *angle() const { return mAngle.data(); }
+    const i8 *spin() const { return mSpin.data(); }
+    const u16 *group() const { return mGroup.data(); }
+    const u16 *strength() const { return mStrength.data(); }
+    const u8 *aliveFlags() const { return mAlive.data(); }
+
+  private:
+    u32 mCapacity = 0;
+    fl::vector<i32> mX;
+    fl::vector<i32> mY;
+    fl::vector<u16> mAngle;
+    fl::vector<i8> mSpin;
+    fl::vector<u16> mGroup;
+    fl::vector<u16> mStrength;
+    fl::vector<u8> mAlive;
+};
+
+// Draws particles as soft dots whose radius is half the particle strength,
+// clamped to 1..3 pixels, with an intensity falloff of 1 - d^2/r^2. Each dot
+// sample is scaled by `gain` and added as CHSV(0, 0, v), exactly like adding
+// the samples to the LED buffer one at a time. All scratch buffers are kept
+// between frames, so steady-state drawing does not allocate.
+class ParticleSplatter {
+  public:
+    static const u16 kTileSize = 8;
+    static const u16 kMaxRadius = 3;
+
+    ParticleSplatter() = default;
+
+    // Sorts the live particles by tile, accumulates their dots and adds the
+    // result to `leds`.
+    void draw(const Particles2D &particles, u8 gain, const XYMap &xyMap,
+              CRGB *leds);
+
+    // The last draw's accumulated gray level at (x, y). Only meaningful until
+    // the next draw; exposed for tests.
+    u8 accumulated(u16 x, u16 y) const;
+    // Number of particles that were inside the drawable area on the last
+    // draw.
+    u32 lastSplatCount() const { return mSplatCount; }
+
+  private:
+    void setSize(u16 width, u16 height);
+    void setGain(u8 gain);
+    void sortByTile(const Particles2D &particles);
+    void clearTouchedTiles();
+    void splatDot(i32 fx, i32 fy, u16 strength);
+    void flush(const XYMap &xyMap, CRGB *leds);
+
+    u16 mWidth = 0;
+    u16 mHeight = 0;
+    u16 mTilesX = 0;
+    u16 mTilesY = 0;
+    u32 mSplatCount = 0;
+    int mGain = -1;
+    // Gray level of CRGB(CHSV(0, 0, scale8(v, gain))) for each sample v.
+    u8 mGrayLut[256] = {};
+    fl::vector<u8> mAccum;        // width * height, row major
+    fl::vector<u8> mTileTouched;  // one flag per tile
+    fl::vector<u32> mTileStart;   // counting sort offsets, tiles + 1
+    fl::vector<u32> mOrder;       // particle indices in tile order
+    fl::vector<u16> mParticleTile;
+};
+
+} // namespace fl
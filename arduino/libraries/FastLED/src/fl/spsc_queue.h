@@ -0,0 +1,133 @@
+#pragma once
+
+#include "fl/align.h"
+#include "fl/atomic.h"
+#include "fl/inplacenew.h"
+#include "fl/int.h"
+#include "fl/move.h"
+#include "fl/namespace.h"
+#include "fl/type_traits.h"
+
+namespace fl {
+
+// Bounded lock-free queue for exactly one producer and one consumer, which
+// may run on different cores, tasks or in an ISR. N must be a power of two
+// and is the number of elements the queue can hold. Storage is inline, so
+// large queues should be static or heap allocated.
+//
+// push() and the bulk push() may only be called from the producer, pop()
+// and the bulk pop() only from the consumer. size() and empty() can be
+// called from either side but are only a snapshot.
+//
+// The two indices live on separate cache lines and each side keeps a
+// private copy of the other side's index, so in the common case a push or
+// pop touches no cache line the other core is writing.
+template <typename T, fl::size N> class spsc_queue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0,
+                  "spsc_queue capacity must be a power of two");
+
+  public:
+    spsc_queue() = default;
+    ~spsc_queue() {
+        const fl::size tail = mTail.load(memory_order_relaxed);
+        for (fl::size i = mHead.load(memory_order_relaxed); i != tail; ++i) {
+            slot(i)->~T();
+        }
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    // Producer side. Return false when the queue is full.
+    bool push(const T& value) { return emplace(value); }
+    bool push(T&& value) { return emplace(fl::move(value)); }
+
+    template <typename... Args> bool emplace(Args&&... args) {
+        const fl::size tail = mTail.load(memory_order_relaxed);
+        if (tail - mHeadCache == N) {
+            mHeadCache = mHead.load(memory_order_acquire);
+            if (tail - mHeadCache == N) {
+                return false;
+            }
+        }
+        new (slot(tail)) T(fl::forward<Args>(args)...);
+        mTail.store(tail + 1, memory_order_release);
+        return true;
+    }
+
+    // Copies up to `count` elements in and publishes them at once. Returns
+    // how many fit.
+    fl::size push(const T* values, fl::size count) {
+        const fl::size tail = mTail.load(memory_order_relaxed);
+        fl::size free = N - (tail - mHeadCache);
+        if (free < count) {
+            mHeadCache = mHead.load(memory_order_acquire);
+            free = N - (tail - mHeadCache);
+        }
+        const fl::size n = count < free ? count : free;
+        for (fl::size i = 0; i < n; ++i) {
+            new (slot(tail + i)) T(values[i]);
+        }
+        if (n) {
+            mTail.store(tail + n, memory_order_release);
+        }
+        return n;
+    }
+
+    // Consumer side. Returns false when the queue is empty.
+    bool pop(T& out) {
+        const fl::size head = mHead.load(memory_order_relaxed);
+        if (head == mTailCache) {
+            mTailCache = mTail.load(memory_order_acquire);
+            if (head == mTailCache) {
+                return false;
+            }
+        }
+        T* item = slot(head);
+        out = fl::move(*item);
+        item->~T();
+        mHead.store(head + 1, memory_order_release);
+        return true;
+    }
+
+    // Moves up to `max_count` elements out. Returns how many there were.
+    fl::size pop(T* out, fl::size max_count) {
+        const fl::size head = mHead.load(memory_order_relaxed);
+        fl::size available = mTailCache - head;
+        if (available < max_count) {
+            mTailCache = mTail.load(memory_order_acquire);
+            available = mTailCache - head;
+        }
+        const fl::size n = max_count < available ? max_count : available;
+        for (fl::size i = 0; i < n; ++i) {
+            T* item = slot(head + i);
+            out[i] = fl::move(*item);
+            item->~T();
+        }
+        if (n) {
+            mHead.store(head + n, memory_order_release);
+        }
+        return n;
+    }
+
+    fl::size size() const {
+        const fl::size head = mHead.load(memory_order_acquire);
+        return mTail.load(memory_order_acquire) - head;
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr fl::size capacity() { return N; }
+
+  private:
+    T* slot(fl::size index) {
+        return reinterpret_cast<T*>(mStorage) + (index & (N - 1));
+    }
+
+    // Indices run freely and wrap; only their difference matters.
+    alignas(FL_CACHE_LINE_SIZE) AtomicBuiltin<fl::size> mTail; // next write
+    fl::size mHeadCache = 0; // producer's view of mHead
+    alignas(FL_CACHE_LINE_SIZE) AtomicBuiltin<fl::size> mHead; // next read
+    fl::size mTailCache = 0; // consumer's view of mTail
+    alignas(FL_CACHE_LINE_SIZE) alignas(T) unsigned char mStorage[N * sizeof(T)];
+};
+
+} // namespace fl
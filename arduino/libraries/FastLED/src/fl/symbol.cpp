@@ -0,0 +1,147 @@
+#include "fl/symbol.h"
+
+#include <string.h>
+
+#include "fl/allocator.h"
+#include "fl/mutex.h"
+#include "fl/singleton.h"
+
+namespace fl {
+
+struct Symbol::Entry {
+    u32 hash;
+    u32 length;
+    char text[1]; // null terminated, allocated to fit
+};
+
+namespace {
+
+// Small strings are packed into chunks of this size instead of getting a
+// heap allocation each.
+const fl::size kChunkSize = 512;
+
+class SymbolTable {
+  public:
+    const Symbol::Entry *intern(const char *str, fl::size length, bool insert) {
+        if (length == 0) {
+            return nullptr;
+        }
+        const u32 hash = MurmurHash3_x86_32(str, length);
+        fl::lock_guard<fl::mutex> lock(mMutex);
+        if (!mSlots.empty()) {
+            const fl::size mask = mSlots.size() - 1;
+            for (fl::size i = hash & mask;; i = (i + 1) & mask) {
+                const Symbol::Entry *entry = mSlots[i];
+                if (!entry) {
+                    break;
+                }
+                if (entry->hash == hash && entry->length == length &&
+                    memcmp(entry->text, str, length) == 0) {
+                    return entry;
+                }
+            }
+        }
+        if (!insert) {
+            return nullptr;
+        }
+        Symbol::Entry *entry = allocateEntry(length);
+        if (!entry) {
+            return nullptr;
+        }
+        entry->hash = hash;
+        entry->length = static_cast<u32>(length);
+        memcpy(entry->text, str, length);
+        entry->text[length] = '\0';
+        if ((mCount + 1) * 2 > mSlots.size()) {
+            grow();
+        }
+        place(entry);
+        ++mCount;
+        return entry;
+    }
+
+    fl::size count() {
+        fl::lock_guard<fl::mutex> lock(mMutex);
+        return mCount;
+    }
+
+  private:
+    Symbol::Entry *allocateEntry(fl::size length) {
+        const fl::size align = alignof(Symbol::Entry);
+        // text[1] already holds the terminator.
+        fl::size bytes = sizeof(Symbol::Entry) + length;
+        bytes = (bytes + align - 1) / align * align;
+        if (bytes > kChunkSize / 4) {
+            return static_cast<Symbol::Entry *>(Malloc(bytes));
+        }
+        if (!mChunk || mChunkUsed + bytes > kChunkSize) {
+            mChunk = static_cast<u8 *>(Malloc(kChunkSize));
+            mChunkUsed = 0;
+            if (!mChunk) {
+                return nullptr;
+            }
+        }
+        void *out = mChunk + mChunkUsed;
+        mChunkUsed += bytes;
+        return static_cast<Symbol::Entry *>(out);
+    }
+
+    void place(const Symbol::Entry *entry) {
+        const fl::size mask = mSlots.size() - 1;
+        fl::size i = entry->hash & mask;
+        while (mSlots[i]) {
+            i = (i + 1) & mask;
+        }
+        mSlots[i] = entry;
+    }
+
+    void grow() {
+        fl::vector<const Symbol::Entry *> old;
+        old.swap(mSlots);
+        mSlots.assign(old.empty() ? 64 : old.size() * 2, nullptr);
+        for (const Symbol::Entry *entry : old) {
+            if (entry) {
+                place(entry);
+            }
+        }
+    }
+
+    fl::mutex mMutex;
+    // Open addressing, linear probing, at most half full.
+    fl::vector<const Symbol::Entry *> mSlots;
+    fl::size mCount = 0;
+    u8 *mChunk = nullptr;
+    fl::size mChunkUsed = 0;
+};
+
+SymbolTable &table() { return Singleton<SymbolTable>::instance(); }
+
+} // namespace
+
+Symbol::Symbol(const char *str)
+    : mEntry(str ? table().intern(str, strlen(str), true) : nullptr) {}
+
+Symbol::Symbol(const char *str, fl::size length)
+    : mEntry(str ? table().intern(str, length, true) : nullptr) {}
+
+Symbol::Symbol(const fl::string &str)
+    : mEntry(table().intern(str.c_str(), str.size(), true)) {}
+
+Symbol Symbol::find(const char *str) {
+    if (!str) {
+        return Symbol();
+    }
+    return Symbol(table().intern(str, strlen(str), false));
+}
+
+const char *Symbol::c_str() const { return mEntry ? mEntry->text : ""; }
+
+fl::size Symbol::size() const { return mEntry ? mEntry->length : 0; }
+
+u32 Symbol::hash() const {
+    return mEntry ? mEntry->hash : MurmurHash3_x86_32("", 0);
+}
+
+fl::size Symbol::poolSize() { return table().count(); }
+
+} // namespace fl
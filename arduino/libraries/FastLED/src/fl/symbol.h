@@ -0,0 +1,62 @@
+#pragma once
+
+#include "fl/hash.h"
+#include "fl/int.h"
+#include "fl/namespace.h"
+#include "fl/str.h"
+
+namespace fl {
+
+// Interned string. Every distinct text is stored once in a global pool and a
+// Symbol is a pointer to that copy, so copying is free, equality is a pointer
+// compare and the hash is computed once when the text is interned.
+//
+// Useful for names that are looked up over and over (UI component names,
+// JSON keys, group names). The pool only grows: interning a stream of
+// unbounded, ever changing text leaks.
+class Symbol {
+  public:
+    // The empty symbol, equal to Symbol("").
+    Symbol() = default;
+
+    // Interns `str`, adding it to the pool if needed.
+    explicit Symbol(const char *str);
+    Symbol(const char *str, fl::size length);
+    explicit Symbol(const fl::string &str);
+
+    // Returns the symbol for `str` if it was ever interned, otherwise the
+    // empty symbol. Never grows the pool, so it is safe to call with
+    // untrusted input.
+    static Symbol find(const char *str);
+
+    const char *c_str() const;
+    fl::size size() const;
+    bool empty() const { return mEntry == nullptr; }
+    fl::string str() const { return fl::string(c_str(), size()); }
+
+    // Same value as fl::Hash<fl::string> gives for the text.
+    u32 hash() const;
+
+    bool operator==(const Symbol &other) const { return mEntry == other.mEntry; }
+    bool operator!=(const Symbol &other) const { return mEntry != other.mEntry; }
+    // Orders by pool address, which is stable but not alphabetical.
+    bool operator<(const Symbol &other) const {
+        return reinterpret_cast<fl::uptr>(mEntry) <
+               reinterpret_cast<fl::uptr>(other.mEntry);
+    }
+
+    // Number of distinct strings in the pool.
+    static fl::size poolSize();
+
+    struct Entry;
+
+  private:
+    explicit Symbol(const Entry *entry) : mEntry(entry) {}
+    const Entry *mEntry = nullptr;
+};
+
+template <> struct Hash<Symbol> {
+    u32 operator()(const Symbol &key) const noexcept { return key.hash(); }
+};
+
+} // namespace fl
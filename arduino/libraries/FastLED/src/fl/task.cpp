@@ -54,6 +54,18 @@ fl::shared_ptr<TaskImpl> TaskImpl::create_at_framerate(int fps, const fl::TraceP
     return fl::make_shared<TaskImpl>(TaskType::kAtFramerate, 1000 / fps, trace);
 }
 
+fl::shared_ptr<TaskImpl> TaskImpl::create_after_ms(int delay_ms) {
+    auto impl = fl::make_shared<TaskImpl>(TaskType::kAfterMs, delay_ms);
+    impl->mLastRunTime = fl::time(); // the delay counts from now
+    return impl;
+}
+
+fl::shared_ptr<TaskImpl> TaskImpl::create_after_ms(int delay_ms, const fl::TracePoint& trace) {
+    auto impl = fl::make_shared<TaskImpl>(TaskType::kAfterMs, delay_ms, trace);
+    impl->mLastRunTime = fl::time();
+    return impl;
+}
+
 fl::shared_ptr<TaskImpl> TaskImpl::create_before_frame() {
     return fl::make_shared<TaskImpl>(TaskType::kBeforeFrame, 0);
 }
@@ -84,6 +96,17 @@ void TaskImpl::set_catch(fl::function<void(const Error&)> on_catch) {
 
 void TaskImpl::set_canceled() {
     mCanceled = true;
+    if (mSlot >= 0) {
+        // Drop the scheduler's reference (and the callbacks it keeps alive) now.
+        fl::Scheduler::instance().on_canceled(*this);
+    }
+}
+
+void TaskImpl::set_last_run_time(uint32_t time) {
+    mLastRunTime = time;
+    if (mSlot >= 0) {
+        fl::Scheduler::instance().on_last_run_time_changed(*this);
+    }
 }
 
 void TaskImpl::auto_register_with_scheduler() {
@@ -156,6 +179,14 @@ task task::at_framerate(int fps, const fl::TracePoint& trace) {
     return task(TaskImpl::create_at_framerate(fps, trace));
 }
 
+task task::after_ms(int delay_ms) {
+    return task(TaskImpl::create_after_ms(delay_ms));
+}
+
+task task::after_ms(int delay_ms, const fl::TracePoint& trace) {
+    return task(TaskImpl::create_after_ms(delay_ms, trace));
+}
+
 task task::before_frame() {
     return task(TaskImpl::create_before_frame());
 }
@@ -44,7 +44,8 @@ enum class TaskType {
     kEveryMs,
     kAtFramerate,
     kBeforeFrame,
-    kAfterFrame
+    kAfterFrame,
+    kAfterMs
 };
 
 // Forward declaration
@@ -70,6 +71,10 @@ public:
     static task at_framerate(int fps);
     static task at_framerate(int fps, const fl::TracePoint& trace);
 
+    // Runs once, delay_ms after the task is created.
+    static task after_ms(int delay_ms);
+    static task after_ms(int delay_ms, const fl::TracePoint& trace);
+
     // For most cases you want after_frame() instead of before_frame(), unless you
     // are doing operations that need to happen right before the frame is rendered.
     // Most of the time for ui stuff (button clicks, etc) you want after_frame(), so it
@@ -136,6 +141,8 @@ public:
     static shared_ptr<TaskImpl> create_every_ms(int interval_ms, const fl::TracePoint& trace);
     static shared_ptr<TaskImpl> create_at_framerate(int fps);
     static shared_ptr<TaskImpl> create_at_framerate(int fps, const fl::TracePoint& trace);
+    static shared_ptr<TaskImpl> create_after_ms(int delay_ms);
+    static shared_ptr<TaskImpl> create_after_ms(int delay_ms, const fl::TracePoint& trace);
     static shared_ptr<TaskImpl> create_before_frame();
     static shared_ptr<TaskImpl> create_before_frame(const fl::TracePoint& trace);
     static shared_ptr<TaskImpl> create_after_frame();
@@ -154,7 +161,7 @@ public:
     TaskType type() const { return mType; }
     int interval_ms() const { return mIntervalMs; }
     uint32_t last_run_time() const { return mLastRunTime; }
-    void set_last_run_time(uint32_t time) { mLastRunTime = time; }
+    void set_last_run_time(uint32_t time);
     bool ready_to_run(uint32_t current_time) const;
     bool ready_to_run_frame_task(uint32_t current_time) const;  // New method for frame tasks
     bool is_canceled() const { return mCanceled; }
@@ -180,6 +187,7 @@ private:
     bool mHasThen = false;
     bool mHasCatch = false;
     uint32_t mLastRunTime = 0; // Last time the task was run
+    int mSlot = -1; // Index in the Scheduler's task table while registered
 
     function<void()> mThenCallback;
     function<void(const Error&)> mCatchCallback;
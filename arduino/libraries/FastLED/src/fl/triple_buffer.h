@@ -0,0 +1,69 @@
+#pragma once
+
+#include "fl/atomic.h"
+#include "fl/int.h"
+#include "fl/move.h"
+#include "fl/namespace.h"
+
+namespace fl {
+
+// Lock-free hand-off of the latest value from one writer to one reader,
+// which may run on different cores or tasks. Unlike a queue nothing is ever
+// rejected or waited for: the writer always has a slot to fill and the
+// reader always sees the most recent complete value, intermediate values
+// that were never read are simply dropped.
+//
+// Writer:  T& slot = buf.back(); ...fill slot...; buf.publish();
+// Reader:  buf.update(); const T& v = buf.front();
+//
+// Of the three slots one belongs to the writer, one to the reader and one
+// holds the last published value. publish() and update() swap their slot
+// with that middle one in a single atomic exchange, so a value is never
+// read while it is being written.
+template <typename T> class TripleBuffer {
+  public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side. The slot to fill. After publish() it is a slot the reader
+    // may have seen several values ago, so fill in the whole value every
+    // time, never just the fields that changed.
+    T& back() { return mSlots[mBack]; }
+
+    // Makes back() visible to the reader and hands the writer a new slot.
+    void publish() {
+        const u8 prev = mMiddle.exchange(u8(mBack | kFresh), memory_order_acq_rel);
+        mBack = prev & kIndexMask;
+    }
+
+    // Reader side. Moves the newest published value to front(). Returns
+    // false, leaving front() alone, if nothing was published since the last
+    // call.
+    bool update() {
+        if (!(mMiddle.load(memory_order_acquire) & kFresh)) {
+            return false;
+        }
+        const u8 prev = mMiddle.exchange(mFront, memory_order_acq_rel);
+        mFront = prev & kIndexMask;
+        return true;
+    }
+
+    const T& front() const { return mSlots[mFront]; }
+
+    // All three slots, for sizing them before the buffer is shared. Not safe
+    // once the writer or reader is running.
+    T& slot(fl::size i) { return mSlots[i]; }
+    static constexpr fl::size size() { return 3; }
+
+  private:
+    static const u8 kIndexMask = 0x3;
+    static const u8 kFresh = 0x4;
+
+    T mSlots[3];
+    u8 mBack = 0;  // writer private
+    u8 mFront = 1; // reader private
+    AtomicBuiltin<u8> mMiddle{2};
+};
+
+} // namespace fl
@@ -51,7 +51,9 @@ void WaveSimulation2D::init(u32 width, u32 height, SuperSample factor,
     // Only allocate change grid if it's enabled (saves memory when disabled)
     if (mUseChangeGrid) {
         mChangeGrid.reset(w, h);
+        mChangeTiles.assign(mSim->getTileColumns() * mSim->getTileRows(), 0);
     }
+    mHasChanges = false;
     // Extra frames are needed because the simulation slows down in
     // proportion to the supersampling factor.
     mExtraFrames = u8(factor) - 1;
@@ -77,24 +79,23 @@ float WaveSimulation2D::getf(fl::size x, fl::size y) const {
 
 i16 WaveSimulation2D::geti16(fl::size x, fl::size y) const {
     if (!has(x, y))
-        return 0;    
+        return 0;
     i32 sum = 0;
     u8 mult = MAX(1, mMultiplier);
     for (u32 j = 0; j < mult; ++j) {
-        for (u32 i = 0; i < mult; ++i) {
-            u32 xx = x * mult + i;
-            u32 yy = y * mult + j;
-            i32 pt = mSim->geti16(xx, yy);
-            if (mUseChangeGrid) {
-                // i32 ch_pt = mChangeGrid[(yy * mMultiplier) + xx];
-                i32 ch_pt = mChangeGrid(xx, yy);
-                if (ch_pt != 0) { // we got a hit.
-                    sum += ch_pt;
-                } else {
-                    sum += pt;
-                }
-            } else {
-                sum += pt;
+        const u32 yy = y * mult + j;
+        const i16 *row = mSim->rowi16(yy) + x * mult;
+        if (mUseChangeGrid) {
+            // Pending writes that have not reached the simulation yet take
+            // precedence.
+            const i16 *pending =
+                mChangeGrid.data() + yy * mChangeGrid.width() + x * mult;
+            for (u32 i = 0; i < mult; ++i) {
+                sum += pending[i] != 0 ? pending[i] : row[i];
+            }
+        } else {
+            for (u32 i = 0; i < mult; ++i) {
+                sum += row[i];
             }
         }
     }
@@ -108,9 +109,9 @@ i16 WaveSimulation2D::geti16Previous(fl::size x, fl::size y) const {
     i32 sum = 0;
     u8 mult = MAX(1, mMultiplier);
     for (u32 j = 0; j < mult; ++j) {
+        const i16 *row = mSim->rowi16Previous(y * mult + j) + x * mult;
         for (u32 i = 0; i < mult; ++i) {
-            sum +=
-                mSim->geti16Previous(x * mult + i, y * mult + j);
+            sum += row[i];
         }
     }
     i16 out = static_cast<i16>(sum / (mult * mult));
@@ -171,6 +172,7 @@ void WaveSimulation2D::seti16(fl::size x, fl::size y, i16 v16) {
             fl::size yy = y * mult + j;
             if (mSim->has(xx, yy)) {
                 if (mUseChangeGrid) {
+                    markChangeTile(xx, yy);
                     i16 &pt = mChangeGrid.at(xx, yy);
                     if (pt == 0) {
                         // not set yet so set unconditionally.
@@ -208,34 +210,53 @@ void WaveSimulation2D::setf(fl::size x, fl::size y, float value) {
     seti16(x, y, v16);
 }
 
-void WaveSimulation2D::update() {
-    if (mUseChangeGrid) {
-        const vec2<i16> min_max = mChangeGrid.minMax();
-        const bool has_updates = min_max != vec2<i16>(0, 0);
-        for (u8 i = 0; i < mExtraFrames + 1; ++i) {
-            if (has_updates) {
-                // apply them
-                const u32 w = mChangeGrid.width();
-                const u32 h = mChangeGrid.height();
-                for (u32 x = 0; x < w; ++x) {
-                    for (u32 y = 0; y < h; ++y) {
-                        i16 v16 = mChangeGrid(x, y);
-                        if (v16 != 0) {
-                            mSim->seti16(x, y, v16);
-                        }
+void WaveSimulation2D::markChangeTile(u32 x, u32 y) {
+    const u32 tx = x / WaveSimulation2D_Real::kTileWidth;
+    const u32 ty = y / WaveSimulation2D_Real::kTileHeight;
+    mChangeTiles[ty * mSim->getTileColumns() + tx] = 1;
+    mHasChanges = true;
+}
+
+void WaveSimulation2D::applyChanges() {
+    // Only tiles that received writes since the last update are visited.
+    const u32 w = mChangeGrid.width();
+    const u32 h = mChangeGrid.height();
+    const u32 tilesX = mSim->getTileColumns();
+    const u32 tilesY = mSim->getTileRows();
+    for (u32 ty = 0; ty < tilesY; ++ty) {
+        for (u32 tx = 0; tx < tilesX; ++tx) {
+            u8 &dirty = mChangeTiles[ty * tilesX + tx];
+            if (!dirty) {
+                continue;
+            }
+            dirty = 0;
+            const u32 x0 = tx * WaveSimulation2D_Real::kTileWidth;
+            const u32 y0 = ty * WaveSimulation2D_Real::kTileHeight;
+            const u32 x1 = MIN(x0 + WaveSimulation2D_Real::kTileWidth, w);
+            const u32 y1 = MIN(y0 + WaveSimulation2D_Real::kTileHeight, h);
+            for (u32 y = y0; y < y1; ++y) {
+                i16 *row = mChangeGrid.data() + y * w;
+                for (u32 x = x0; x < x1; ++x) {
+                    if (row[x] != 0) {
+                        mSim->seti16(x, y, row[x]);
+                        row[x] = 0;
                     }
                 }
             }
-            mSim->update();
-        }
-        // zero out mChangeGrid
-        mChangeGrid.clear();
-    } else {
-        // When change grid is disabled, just run the simulation updates
-        for (u8 i = 0; i < mExtraFrames + 1; ++i) {
-            mSim->update();
         }
     }
+    mHasChanges = false;
+}
+
+void WaveSimulation2D::update() {
+    if (mUseChangeGrid && mHasChanges) {
+        // Pending writes are applied once, before the first step, which is
+        // what writing straight into the simulation does.
+        applyChanges();
+    }
+    for (u8 i = 0; i < mExtraFrames + 1; ++i) {
+        mSim->update();
+    }
 }
 
 u32 WaveSimulation2D::getWidth() const { return mOuterWidth; }
@@ -255,10 +276,13 @@ void WaveSimulation2D::setUseChangeGrid(bool enabled) {
         u32 w = mOuterWidth * mMultiplier;
         u32 h = mOuterHeight * mMultiplier;
         mChangeGrid.reset(w, h);
+        mChangeTiles.assign(mSim->getTileColumns() * mSim->getTileRows(), 0);
     } else {
         // Deallocate change grid if disabling (saves memory)
         mChangeGrid.reset(0, 0);
+        mChangeTiles.clear();
     }
+    mHasChanges = false;
 }
 
 WaveSimulation1D::WaveSimulation1D(u32 length, SuperSample factor,
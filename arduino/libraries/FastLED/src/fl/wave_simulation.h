@@ -154,8 +154,13 @@ class WaveSimulation2D {
         if (u32(factor) == mMultiplier) {
             return;
         }
+        // Keep the boundary settings across the re-initialization.
+        const bool halfDuplex = mSim->getHalfDuplex();
+        const bool xCylindrical = mSim->getXCylindrical();
         init(mOuterWidth, mOuterHeight, factor, mSim->getSpeed(),
              mSim->getDampenening());
+        mSim->setHalfDuplex(halfDuplex);
+        mSim->setXCylindrical(xCylindrical);
     }
 
     void setXCylindrical(bool on) { mSim->setXCylindrical(on); }
@@ -199,22 +204,30 @@ class WaveSimulation2D {
     u32 getWidth() const;
     u32 getHeight() const;
 
-    // Configure whether to use the change grid tracking optimization
+    // Configure whether to use the change grid tracking optimization. When
+    // enabled, writes are merged (largest magnitude wins) and applied once at
+    // the next update(), visiting only the tiles that were written to.
     void setUseChangeGrid(bool enabled);
     bool getUseChangeGrid() const { return mUseChangeGrid; }
 
     WaveSimulation2D_Real &real() { return *mSim; }
 
   private:
+    void markChangeTile(u32 x, u32 y);
+    void applyChanges();
+
     u32 mOuterWidth;  // Width of the downsampled (outer) grid.
     u32 mOuterHeight; // Height of the downsampled (outer) grid.
     u8 mExtraFrames = 0;
     u32 mMultiplier = 1; // Supersampling multiplier (e.g., 1, 2, 4, or 8).
     U8EasingFunction mU8Mode = WAVE_U8_MODE_LINEAR;
-    bool mUseChangeGrid = false; // Whether to use change grid tracking (default: disabled for better visuals)
+    bool mUseChangeGrid = false; // Whether to use change grid tracking (default: disabled, it costs a second i16 grid)
     // Internal high-resolution simulation.
     fl::unique_ptr<WaveSimulation2D_Real> mSim;
     fl::Grid<i16> mChangeGrid; // Needed for multiple updates.
+    // One flag per simulation tile with pending writes in mChangeGrid.
+    fl::vector<u8> mChangeTiles;
+    bool mHasChanges = false;
 };
 
 } // namespace fl
@@ -161,6 +161,10 @@ WaveSimulation2D_Real::WaveSimulation2D_Real(u32 W, u32 H,
     : width(W), height(H), stride(W + 2),
       grid1((W + 2) * (H + 2)),
       grid2((W + 2) * (H + 2)), whichGrid(0),
+      mTilesX((W + kTileWidth - 1) / kTileWidth),
+      mTilesY((H + kTileHeight - 1) / kTileHeight),
+      mTileNonZero1(mTilesX * mTilesY),
+      mTileNonZero2(mTilesX * mTilesY),
       // Initialize speed 0.16 in fixed Q15
       mCourantSq(float_to_fixed(speed)),
       // Dampening exponent; e.g., 6 means a factor of 2^6 = 64.
@@ -221,11 +225,58 @@ void WaveSimulation2D_Real::seti16(fl::size x, fl::size y, i16 value) {
     }
     i16 *curr = (whichGrid == 0 ? grid1.data() : grid2.data());
     curr[(y + 1) * stride + (x + 1)] = value;
+    if (value != 0) {
+        markTile(x, y);
+    }
+}
+
+void WaveSimulation2D_Real::markTile(fl::size x, fl::size y) {
+    fl::vector<u8> &flags = (whichGrid == 0) ? mTileNonZero1 : mTileNonZero2;
+    flags[(y / kTileHeight) * mTilesX + (x / kTileWidth)] = 1;
+}
+
+bool WaveSimulation2D_Real::tileNeedsUpdate(u32 tx, u32 ty) const {
+    const u8 *curr =
+        (whichGrid == 0) ? mTileNonZero1.data() : mTileNonZero2.data();
+    const u8 *next =
+        (whichGrid == 0) ? mTileNonZero2.data() : mTileNonZero1.data();
+    const u32 t = ty * mTilesX + tx;
+    // The stencil reads the four direct neighbours of each cell, so a tile
+    // can only become non-zero if it, or an edge-adjacent tile, is non-zero.
+    if (curr[t] || next[t]) {
+        return true;
+    }
+    if (ty > 0 && curr[t - mTilesX]) {
+        return true;
+    }
+    if (ty + 1 < mTilesY && curr[t + mTilesX]) {
+        return true;
+    }
+    if (tx > 0) {
+        if (curr[t - 1]) {
+            return true;
+        }
+    } else if (mXCylindrical && curr[t + mTilesX - 1]) {
+        return true; // Left border wraps to the right edge.
+    }
+    if (tx + 1 < mTilesX) {
+        if (curr[t + 1]) {
+            return true;
+        }
+    } else if (mXCylindrical && curr[t + 1 - mTilesX]) {
+        return true; // Right border wraps to the left edge.
+    }
+    return false;
 }
 
 void WaveSimulation2D_Real::update() {
+    beginUpdate();
+    updateTileRows(0, mTilesY);
+    endUpdate();
+}
+
+void WaveSimulation2D_Real::beginUpdate() {
     i16 *curr = (whichGrid == 0 ? grid1.data() : grid2.data());
-    i16 *next = (whichGrid == 0 ? grid2.data() : grid1.data());
 
     // Update horizontal boundaries.
     for (fl::size j = 0; j < height + 2; ++j) {
@@ -243,53 +294,75 @@ void WaveSimulation2D_Real::update() {
         curr[0 * stride + i] = curr[1 * stride + i];
         curr[(height + 1) * stride + i] = curr[height * stride + i];
     }
+}
 
-    // Compute the dampening factor as an integer: 2^(dampening).
-    i32 dampening_factor = 1 << mDampening; // e.g., 6 -> 64
-    i32 mCourantSq32 = static_cast<i32>(mCourantSq);
-
-    // Update each inner cell.
-    for (fl::size j = 1; j <= height; ++j) {
-        for (fl::size i = 1; i <= width; ++i) {
-            int index = j * stride + i;
-            // Laplacian: sum of four neighbors minus 4 times the center.
-            i32 laplacian = (i32)curr[index + 1] + curr[index - 1] +
-                                curr[index + stride] + curr[index - stride] -
-                                ((i32)curr[index] << 2);
-            // Compute the new value:
-            // f = - next[index] + 2 * curr[index] + mCourantSq * laplacian
-            // The multiplication is in Q15, so we shift right by 15.
-            i32 term = (mCourantSq32 * laplacian) >> 15;
-            i32 f =
-                -(i32)next[index] + ((i32)curr[index] << 1) + term;
-
-            // Apply damping:
-            f = f - (f / dampening_factor);
-
-            // Clamp f to the Q15 range.
-            if (f > 32767)
-                f = 32767;
-            else if (f < -32768)
-                f = -32768;
-
-            next[index] = (i16)f;
-        }
-    }
-
-    if (mHalfDuplex) {
-        // Set negative values to zero.
-        for (fl::size j = 1; j <= height; ++j) {
-            for (fl::size i = 1; i <= width; ++i) {
-                int index = j * stride + i;
-                if (next[index] < 0) {
-                    next[index] = 0;
+void WaveSimulation2D_Real::updateTileRows(u32 tileRowBegin,
+                                           u32 tileRowEnd) {
+    const i16 *curr = (whichGrid == 0 ? grid1.data() : grid2.data());
+    i16 *next = (whichGrid == 0 ? grid2.data() : grid1.data());
+    u8 *nextNonZero =
+        (whichGrid == 0) ? mTileNonZero2.data() : mTileNonZero1.data();
+
+    // Damping is f - f / 2^dampening. The division truncates towards zero,
+    // which is an arithmetic shift after biasing negative values.
+    const int shift = mDampening;
+    const i32 bias = (i32(1) << shift) - 1;
+    const i32 courantSq = static_cast<i32>(mCourantSq);
+    const i32 lo = mHalfDuplex ? 0 : -32768;
+    tileRowEnd = MIN(tileRowEnd, mTilesY);
+
+    for (u32 ty = tileRowBegin; ty < tileRowEnd; ++ty) {
+        const u32 y0 = 1 + ty * kTileHeight;
+        const u32 y1 = MIN(y0 + kTileHeight, height + 1);
+        for (u32 tx = 0; tx < mTilesX; ++tx) {
+            const u32 t = ty * mTilesX + tx;
+            if (!tileNeedsUpdate(tx, ty)) {
+                // Everything the stencil would read is zero, and so is the
+                // output.
+                continue;
+            }
+            const u32 x0 = 1 + tx * kTileWidth;
+            const u32 x1 = MIN(x0 + kTileWidth, width + 1);
+            i32 any = 0;
+            for (u32 j = y0; j < y1; ++j) {
+                // Contiguous int16 rows with no index arithmetic or branches
+                // in the inner loop, which lets the compiler use SIMD lanes.
+                const i16 *c = curr + j * stride;
+                const i16 *up = c - stride;
+                const i16 *down = c + stride;
+                i16 *n = next + j * stride;
+                for (u32 i = x0; i < x1; ++i) {
+                    // Laplacian: sum of four neighbors minus 4 times the
+                    // center.
+                    i32 laplacian = (i32)c[i + 1] + c[i - 1] + up[i] +
+                                    down[i] - ((i32)c[i] << 2);
+                    // f = - next + 2 * curr + mCourantSq * laplacian, with
+                    // the multiplication in Q15.
+                    i32 term = (courantSq * laplacian) >> 15;
+                    i32 f = -(i32)n[i] + ((i32)c[i] << 1) + term;
+                    f = f - ((f + ((f >> 31) & bias)) >> shift);
+                    // Clamp to Q15, and to positive values in half duplex.
+                    f = f > 32767 ? 32767 : f;
+                    f = f < lo ? lo : f;
+                    n[i] = (i16)f;
+                    any |= f;
                 }
             }
+            nextNonZero[t] = any != 0;
         }
     }
+}
 
+void WaveSimulation2D_Real::endUpdate() {
     // Swap the roles of the grids.
     whichGrid ^= 1;
+    const fl::vector<u8> &flags =
+        (whichGrid == 0) ? mTileNonZero1 : mTileNonZero2;
+    u32 live = 0;
+    for (fl::size i = 0; i < flags.size(); ++i) {
+        live += flags[i];
+    }
+    mLiveTiles = live;
 }
 
 } // namespace fl
@@ -167,6 +167,7 @@ class WaveSimulation2D_Real {
     }
 
     void setXCylindrical(bool on) { mXCylindrical = on; }
+    bool getXCylindrical() const { return mXCylindrical; }
 
     // Check if (x,y) is within the inner grid.
     bool has(fl::size x, fl::size y) const;
@@ -183,12 +184,48 @@ class WaveSimulation2D_Real {
     bool getHalfDuplex() const { return mHalfDuplex; }
 
     // Advance the simulation one time step using fixed-point arithmetic.
+    // Equivalent to beginUpdate(); updateTileRows(0, getTileRows());
+    // endUpdate();
     void update();
 
+    // Striped update. The grid is processed in tiles of kTileWidth x
+    // kTileHeight cells and tiles that are zero, along with their neighbours,
+    // are skipped since the stencil would leave them at zero. Distinct tile
+    // row ranges write to disjoint memory, so on multi-core targets the calls
+    // to updateTileRows() between beginUpdate() and endUpdate() may run
+    // concurrently.
+    void beginUpdate();
+    void updateTileRows(u32 tileRowBegin, u32 tileRowEnd);
+    void endUpdate();
+
+    u32 getTileRows() const { return mTilesY; }
+    u32 getTileColumns() const { return mTilesX; }
+
+    // Number of tiles holding non-zero values after the last update. Only
+    // these tiles and their neighbours are computed on the next step.
+    u32 getLiveTileCount() const { return mLiveTiles; }
+
     u32 getWidth() const { return width; }
     u32 getHeight() const { return height; }
 
+    // Direct access to an inner row of the current or previous grid, width
+    // entries long. Used by WaveSimulation2D to downsample without per cell
+    // bounds checks.
+    const i16 *rowi16(fl::size y) const {
+        const i16 *curr = (whichGrid == 0 ? grid1.data() : grid2.data());
+        return curr + (y + 1) * stride + 1;
+    }
+    const i16 *rowi16Previous(fl::size y) const {
+        const i16 *prev = (whichGrid == 0 ? grid2.data() : grid1.data());
+        return prev + (y + 1) * stride + 1;
+    }
+
+    enum { kTileWidth = 16, kTileHeight = 8 };
+
   private:
+    bool tileNeedsUpdate(u32 tx, u32 ty) const;
+    void markTile(fl::size x, fl::size y);
+
     u32 width;  // Width of the inner grid.
     u32 height; // Height of the inner grid.
     u32 stride; // Row length (width + 2 for the borders).
@@ -199,6 +236,15 @@ class WaveSimulation2D_Real {
 
     fl::size whichGrid; // Indicates the active grid (0 or 1).
 
+    // Per tile flags, one array per grid, set when the tile may hold a
+    // non-zero value. Kept apart so that a stripe writing the flags of the
+    // next grid never shares a byte with a neighbour reading the current one.
+    u32 mTilesX;
+    u32 mTilesY;
+    fl::vector<u8> mTileNonZero1;
+    fl::vector<u8> mTileNonZero2;
+    u32 mLiveTiles = 0;
+
     i16 mCourantSq; // Fixed speed parameter in Q15.
     int mDampening;     // Dampening exponent; used as 2^(dampening).
     bool mHalfDuplex =
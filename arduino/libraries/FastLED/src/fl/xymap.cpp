@@ -3,10 +3,12 @@
 #include <string.h>
 
 #include "fl/clamp.h"
+#include "fl/compiler_control.h"
 #include "fl/force_inline.h"
 #include "fl/namespace.h"
 #include "fl/screenmap.h"
 #include "fl/xymap.h"
+#include "fl/xymap_geometry.h"
 
 namespace fl {
 
@@ -90,8 +92,33 @@ void XYMap::setRectangularGrid() {
     type = kLineByLine;
     xyFunction = nullptr;
     mLookUpTable.reset();
+    // The led indices changed, so the cached neighbour tables are stale.
+    mGeometry.reset();
 }
 
+XYMapGeometryPtr XYMap::geometry() const {
+    if (!mGeometry) {
+        mGeometry = XYMapGeometry::get(*this);
+    }
+    return mGeometry;
+}
+
+XYMapPolarPtr XYMap::polar() const {
+    return polar(XYMapPolar::centerOf(width), XYMapPolar::centerOf(height));
+}
+
+FL_DISABLE_WARNING_PUSH
+FL_DISABLE_WARNING(float-equal)
+
+XYMapPolarPtr XYMap::polar(float cx, float cy) const {
+    if (!mPolar || mPolar->centerX() != cx || mPolar->centerY() != cy) {
+        mPolar = XYMapPolar::get(width, height, cx, cy);
+    }
+    return mPolar;
+}
+
+FL_DISABLE_WARNING_POP
+
 u16 XYMap::mapToIndex(const u16 &x, const u16 &y) const {
     u16 index;
     switch (type) {
@@ -15,6 +15,8 @@
 
 namespace fl {
 class ScreenMap;
+FASTLED_SMART_PTR(XYMapGeometry);
+FASTLED_SMART_PTR(XYMapPolar);
 
 FASTLED_FORCE_INLINE u16 xy_serpentine(u16 x, u16 y,
                                             u16 width, u16 height) {
@@ -120,6 +122,17 @@ class XYMap {
     u16 getTotal() const;
     XyMapType getType() const;
 
+    // LED indices, neighbour indices and row spans of this layout, built on
+    // first use. Maps with the same layout share the same tables.
+    XYMapGeometryPtr geometry() const;
+
+    // Per-pixel polar angle and distance around (cx, cy), by default the
+    // centre of the grid. These only depend on the grid size, so every map
+    // of that size shares them; asking for another origin fetches another
+    // set and leaves geometry() alone.
+    XYMapPolarPtr polar() const;
+    XYMapPolarPtr polar(float cx, float cy) const;
+
   private:
     XYMap(u16 width, u16 height, XyMapType type);
 
@@ -129,6 +142,8 @@ class XYMap {
     XYFunction xyFunction = nullptr;
     fl::LUT16Ptr mLookUpTable; // optional refptr to look up table.
     u16 mOffset = 0;      // offset to be added to the output
+    mutable XYMapGeometryPtr mGeometry; // lazily fetched, see geometry()
+    mutable XYMapPolarPtr mPolar;       // lazily fetched, see polar()
 };
 
 } // namespace fl
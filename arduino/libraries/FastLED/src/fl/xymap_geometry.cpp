@@ -0,0 +1,152 @@
+#include <math.h>
+
+#include "fl/xymap_geometry.h"
+
+#include "fl/compiler_control.h"
+#include "fl/singleton.h"
+#include "fl/weak_ptr.h"
+#include "fl/xymap.h"
+
+FL_DISABLE_WARNING_PUSH
+FL_DISABLE_WARNING(float-equal)
+
+namespace fl {
+
+const u16 XYMapGeometry::kNoNeighbor;
+
+namespace {
+
+// Every table set that is still in use, so that maps with the same layout
+// (or grids with the same size and centre) share one copy.
+template <typename T> struct Registry {
+    fl::vector<fl::weak_ptr<T>> entries;
+};
+
+// Returns the live entry that `matches` accepts, dropping expired entries on
+// the way, or builds one with `make` and registers it.
+template <typename T, typename Matches, typename Make>
+fl::shared_ptr<T> findOrBuild(Matches matches, Make make) {
+    fl::vector<fl::weak_ptr<T>> &entries =
+        Singleton<Registry<T>>::instance().entries;
+    fl::shared_ptr<T> found;
+    for (fl::size i = 0; i < entries.size();) {
+        fl::shared_ptr<T> entry = entries[i].lock();
+        if (!entry) {
+            entries.erase(entries.begin() + i);
+            continue;
+        }
+        if (!found && matches(*entry)) {
+            found = entry;
+        }
+        ++i;
+    }
+    if (!found) {
+        found = make();
+        entries.push_back(fl::weak_ptr<T>(found));
+    }
+    return found;
+}
+
+} // namespace
+
+XYMapGeometryPtr XYMapGeometry::get(const XYMap &xyMap) {
+    return findOrBuild<XYMapGeometry>(
+        [&](const XYMapGeometry &g) { return g.matches(xyMap); },
+        [&]() { return fl::make_shared<XYMapGeometry>(xyMap); });
+}
+
+bool XYMapGeometry::matches(const XYMap &xyMap) const {
+    if (xyMap.getWidth() != mWidth || xyMap.getHeight() != mHeight) {
+        return false;
+    }
+    for (u16 y = 0; y < mHeight; ++y) {
+        for (u16 x = 0; x < mWidth; ++x) {
+            if (xyMap.mapToIndex(x, y) != mLedIndex[index(x, y)]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+XYMapGeometry::XYMapGeometry(const XYMap &xyMap)
+    : mWidth(xyMap.getWidth()), mHeight(xyMap.getHeight()) {
+    const fl::u32 n = static_cast<fl::u32>(mWidth) * mHeight;
+    mLedIndex.assign(n, 0);
+    mNeighbors.assign(n * kNumDirections, kNoNeighbor);
+    mRowSpans.assign(mHeight, RowSpan());
+
+    for (u16 y = 0; y < mHeight; ++y) {
+        for (u16 x = 0; x < mWidth; ++x) {
+            const fl::u32 i = index(x, y);
+            mLedIndex[i] = xyMap.mapToIndex(x, y);
+            u16 *nb = &mNeighbors[i * kNumDirections];
+            if (x > 0) {
+                nb[kLeft] = xyMap.mapToIndex(x - 1, y);
+            }
+            if (x + 1 < mWidth) {
+                nb[kRight] = xyMap.mapToIndex(x + 1, y);
+            }
+            if (y > 0) {
+                nb[kUp] = xyMap.mapToIndex(x, y - 1);
+            }
+            if (y + 1 < mHeight) {
+                nb[kDown] = xyMap.mapToIndex(x, y + 1);
+            }
+        }
+
+        RowSpan &span = mRowSpans[y];
+        span.start = xyMap.mapToIndex(0, y);
+        if (mWidth < 2) {
+            span.step = 1;
+            continue;
+        }
+        const int step = static_cast<int>(xyMap.mapToIndex(1, y)) - span.start;
+        bool contiguous = step == 1 || step == -1;
+        for (u16 x = 2; contiguous && x < mWidth; ++x) {
+            const int expected = static_cast<int>(span.start) + step * x;
+            contiguous = xyMap.mapToIndex(x, y) == expected;
+        }
+        span.step = contiguous ? static_cast<i8>(step) : 0;
+    }
+}
+
+fl::size XYMapGeometry::memoryUsage() const {
+    return mLedIndex.size() * sizeof(u16) + mNeighbors.size() * sizeof(u16) +
+           mRowSpans.size() * sizeof(RowSpan);
+}
+
+XYMapPolarPtr XYMapPolar::get(u16 width, u16 height, float cx, float cy) {
+    return findOrBuild<XYMapPolar>(
+        [&](const XYMapPolar &p) { return p.matches(width, height, cx, cy); },
+        [&]() { return fl::make_shared<XYMapPolar>(width, height, cx, cy); });
+}
+
+bool XYMapPolar::matches(u16 width, u16 height, float cx, float cy) const {
+    return width == mWidth && height == mHeight && cx == mCenterX &&
+           cy == mCenterY;
+}
+
+XYMapPolar::XYMapPolar(u16 width, u16 height, float cx, float cy)
+    : mWidth(width), mHeight(height), mCenterX(cx), mCenterY(cy) {
+    const fl::u32 n = static_cast<fl::u32>(mWidth) * mHeight;
+    mAngle.assign(n, 0.0f);
+    mRadius.assign(n, 0.0f);
+    for (u16 y = 0; y < mHeight; ++y) {
+        const float dy = static_cast<float>(y) - cy;
+        for (u16 x = 0; x < mWidth; ++x) {
+            const float dx = static_cast<float>(x) - cx;
+            const fl::u32 i = index(x, y);
+            mAngle[i] = atan2f(dy, dx);
+            mRadius[i] = hypotf(dx, dy);
+        }
+    }
+}
+
+fl::size XYMapPolar::memoryUsage() const {
+    return mAngle.size() * sizeof(float) + mRadius.size() * sizeof(float);
+}
+
+} // namespace fl
+
+FL_DISABLE_WARNING_POP
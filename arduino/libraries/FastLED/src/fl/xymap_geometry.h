@@ -0,0 +1,129 @@
+#pragma once
+
+#include "fl/allocator.h"
+#include "fl/int.h"
+#include "fl/namespace.h"
+#include "fl/memory.h"
+#include "fl/vector.h"
+
+namespace fl {
+
+class XYMap;
+
+FASTLED_SMART_PTR(XYMapGeometry);
+FASTLED_SMART_PTR(XYMapPolar);
+
+// Per-pixel geometry of an XYMap layout: the LED index of every grid
+// position, the LED indices of its four grid neighbours and the LED index
+// span of every row. Effects used to compute these privately; now XYMap
+// builds them lazily, once per layout, and every map with the same layout
+// shares the same tables. The tables are allocated from PSRAM where
+// available.
+//
+// All per-pixel tables are row major: entry y * width + x describes grid
+// position (x, y), not LED index.
+class XYMapGeometry {
+  public:
+    static const u16 kNoNeighbor = 0xffff;
+
+    enum Direction { kLeft = 0, kRight, kUp, kDown, kNumDirections };
+
+    // Led index span of a row. When the row is laid out contiguously in LED
+    // memory the LED for x is `start + x * step`, with step +1 or -1.
+    // Otherwise step is 0 and the row must go through the XYMap.
+    struct RowSpan {
+        u16 start = 0;
+        i8 step = 0;
+    };
+
+    // Returns the live geometry for this layout if any map has already built
+    // it, otherwise builds and registers a new one. Geometry is freed once
+    // the last map and effect holding it let go.
+    static XYMapGeometryPtr get(const XYMap &xyMap);
+
+    // Builds the tables for `xyMap`.
+    explicit XYMapGeometry(const XYMap &xyMap);
+
+    // True if these tables describe `xyMap`.
+    bool matches(const XYMap &xyMap) const;
+
+    u16 width() const { return mWidth; }
+    u16 height() const { return mHeight; }
+
+    // LED index of grid position (x, y).
+    u16 ledIndex(u16 x, u16 y) const { return mLedIndex[index(x, y)]; }
+    // LED index of the neighbour of (x, y) in `dir`, or kNoNeighbor at the
+    // edge of the grid.
+    u16 neighbor(u16 x, u16 y, Direction dir) const {
+        return mNeighbors[index(x, y) * kNumDirections + dir];
+    }
+    const RowSpan &rowSpan(u16 y) const { return mRowSpans[y]; }
+
+    // Bytes held by the tables.
+    fl::size memoryUsage() const;
+
+  private:
+    fl::u32 index(u16 x, u16 y) const {
+        return static_cast<fl::u32>(y) * mWidth + x;
+    }
+
+    u16 mWidth;
+    u16 mHeight;
+    fl::HeapVector<u16, fl::allocator_psram<u16>> mLedIndex;
+    fl::HeapVector<u16, fl::allocator_psram<u16>> mNeighbors;
+    fl::HeapVector<RowSpan, fl::allocator_psram<RowSpan>> mRowSpans;
+};
+
+// Polar angle and distance of every position of a width x height grid
+// around a centre point. These depend only on the grid size and the centre,
+// not on how the LEDs are wired, so every layout of that size shares them.
+// Kept apart from XYMapGeometry so that an effect which needs several
+// centres, or only the polar view, does not copy the LED index tables.
+//
+// Tables are row major like XYMapGeometry's and allocated from PSRAM where
+// available.
+class XYMapPolar {
+  public:
+    // Returns the live tables for this grid and centre, building and
+    // registering them on first use. They are freed once the last holder
+    // lets go.
+    static XYMapPolarPtr get(u16 width, u16 height, float cx, float cy);
+
+    XYMapPolar(u16 width, u16 height, float cx, float cy);
+
+    bool matches(u16 width, u16 height, float cx, float cy) const;
+
+    // The geometric centre of a grid `size` positions wide.
+    static float centerOf(u16 size) { return (static_cast<float>(size) - 1.0f) * 0.5f; }
+
+    u16 width() const { return mWidth; }
+    u16 height() const { return mHeight; }
+    float centerX() const { return mCenterX; }
+    float centerY() const { return mCenterY; }
+
+    // Polar angle in radians, atan2(y - cy, x - cx).
+    float angle(u16 x, u16 y) const { return mAngle[index(x, y)]; }
+    // Distance to the centre.
+    float radius(u16 x, u16 y) const { return mRadius[index(x, y)]; }
+
+    // Raw row-major tables, width() * height() entries each.
+    const float *angles() const { return mAngle.data(); }
+    const float *radii() const { return mRadius.data(); }
+
+    // Bytes held by the tables.
+    fl::size memoryUsage() const;
+
+  private:
+    fl::u32 index(u16 x, u16 y) const {
+        return static_cast<fl::u32>(y) * mWidth + x;
+    }
+
+    u16 mWidth;
+    u16 mHeight;
+    float mCenterX;
+    float mCenterY;
+    fl::HeapVector<float, fl::allocator_psram<float>> mAngle;
+    fl::HeapVector<float, fl::allocator_psram<float>> mRadius;
+};
+
+} // namespace fl
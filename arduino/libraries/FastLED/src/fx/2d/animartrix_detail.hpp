@@ -60,6 +60,8 @@ License CC BY-NC 3.0
 #include "fl/namespace.h"
 #include "fl/math.h"
 #include "fl/compiler_control.h"
+#include "fl/xymap.h"
+#include "fl/xymap_geometry.h"
 
 #ifndef FL_ANIMARTRIX_USES_FAST_MATH
 #define FL_ANIMARTRIX_USES_FAST_MATH 1
@@ -185,10 +187,21 @@ class ANIMartRIX {
     modulators move; // all oscillator based movers and shifters at one place
     rgb pixel;
 
-    fl::HeapVector<fl::HeapVector<float>>
-        polar_theta; // look-up table for polar angles
-    fl::HeapVector<fl::HeapVector<float>>
-        distance; // look-up table for polar distances
+    // Reads a row-major XYMapPolar table as table[x][y].
+    struct polar_table {
+        struct column {
+            const float *data;
+            int stride;
+            float operator[](int y) const { return data[y * stride]; }
+        };
+        const float *data = nullptr;
+        int width = 0;
+        column operator[](int x) const { return column{data + x, width}; }
+    };
+
+    fl::XYMapPolarPtr polar; // shared per-grid polar tables
+    polar_table polar_theta; // look-up table for polar angles
+    polar_table distance;    // look-up table for polar distances
 
     unsigned long a, b, c; // for time measurements
 
@@ -401,19 +414,13 @@ class ANIMartRIX {
     // the polar coordinates
 
     void render_polar_lookup_table(float cx, float cy) {
-        polar_theta.resize(num_x, fl::HeapVector<float>(num_y, 0.0f));
-        distance.resize(num_x, fl::HeapVector<float>(num_y, 0.0f));
-
-        for (int xx = 0; xx < num_x; xx++) {
-            for (int yy = 0; yy < num_y; yy++) {
-
-                float dx = xx - cx;
-                float dy = yy - cy;
-
-                distance[xx][yy] = hypotf(dx, dy);
-                polar_theta[xx][yy] = atan2f(dy, dx);
-            }
-        }
+        // Only the polar tables: the LED index and neighbour tables of
+        // the layout are not needed here.
+        polar = fl::XYMapPolar::get(num_x, num_y, cx, cy);
+        polar_theta.data = polar->angles();
+        polar_theta.width = num_x;
+        distance.data = polar->radii();
+        distance.width = num_x;
     }
 
     // float mapping maintaining 32 bit precision
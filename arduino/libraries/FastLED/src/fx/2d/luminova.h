@@ -7,6 +7,7 @@
 #include "fl/clamp.h"
 #include "fl/math.h"
 #include "fl/memory.h"
+#include "fl/particles.h"
 #include "fl/vector.h"
 #include "fl/xymap.h"
 #include "fx/fx2d.h"
@@ -45,24 +46,21 @@ class Luminova : public Fx2d {
     // Adjust maximum particle slots (reinitializes pool if size changes)
     void setMaxParticles(int max_particles);
 
+    // Quality level 1 skips the trail blur.
+    fl::u8 getMaxQualityLevel() const override { return 1; }
+
+    // Particle storage, exposed for inspection and benchmarking.
+    const Particles2D &getParticles() const { return mParticles; }
+
   private:
-    struct Particle {
-        float x = 0.0f;
-        float y = 0.0f;
-        float a = 0.0f; // angle
-        int f = 0;   // direction (+1 or -1)
-        int g = 0;   // group id (derived from time)
-        float s = 0.0f; // stroke weight / intensity
-        bool alive = false;
-    };
-
-    void resetParticle(Particle &p, fl::u32 tick);
-    void plotDot(CRGB *leds, int x, int y, uint8_t v) const;
-    void plotSoftDot(CRGB *leds, float fx, float fy, float s) const;
+    void resetParticle(fl::u32 slot, fl::u32 tick);
+    // Steers every live particle by the noise value of its group.
+    void applyJitter();
 
     Params mParams;
     fl::u32 mTick = 0;
-    fl::vector<Particle> mParticles;
+    Particles2D mParticles;
+    ParticleSplatter mSplatter;
 };
 
 } // namespace fl
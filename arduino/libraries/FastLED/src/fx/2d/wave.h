@@ -74,7 +74,7 @@ struct WaveFxArgs {
     float speed = 0.16f;
     float dampening = 6.0f;
     bool x_cyclical = false;
-    bool use_change_grid = false; // Whether to use change grid tracking (default: disabled for better visuals)
+    bool use_change_grid = false; // Whether to use change grid tracking (default: disabled, it costs a second i16 grid)
     WaveCrgbMapPtr crgbMap;
 };
 
@@ -85,7 +85,8 @@ class WaveFx : public Fx2d {
 
     WaveFx(const XYMap& xymap, Args args = Args())
         : Fx2d(xymap), mWaveSim(xymap.getWidth(), xymap.getHeight(),
-                                args.factor, args.speed, args.dampening) {
+                                args.factor, args.speed, args.dampening),
+          mSuperSample(args.factor) {
         // Initialize the wave simulation with the given parameters.
         if (args.crgbMap == nullptr) {
             // Use the default CRGB mapping function.
@@ -117,8 +118,21 @@ class WaveFx : public Fx2d {
     }
 
     void setSuperSample(SuperSample factor) {
-        // Set the supersampling factor of the wave simulation.
-        mWaveSim.setSuperSample(factor);
+        // Set the supersampling factor of the wave simulation. Reduced
+        // quality levels halve it from here.
+        mSuperSample = factor;
+        mQualityLevel = MIN(mQualityLevel, getMaxQualityLevel());
+        onQualityLevelChanged(mQualityLevel);
+    }
+
+    // Each quality level halves the supersampling factor. Changing it
+    // restarts the simulation, so the engine only does so sparingly.
+    fl::u8 getMaxQualityLevel() const override {
+        fl::u8 levels = 0;
+        for (fl::u32 f = static_cast<fl::u32>(mSuperSample); f > 1; f >>= 1) {
+            ++levels;
+        }
+        return levels;
     }
 
     void setEasingMode(U8EasingFunction mode) {
@@ -181,9 +195,17 @@ class WaveFx : public Fx2d {
 
     fl::string fxName() const override { return "WaveFx"; }
 
+  protected:
+    void onQualityLevelChanged(fl::u8 level) override {
+        fl::u32 factor = static_cast<fl::u32>(mSuperSample) >> level;
+        mWaveSim.setSuperSample(static_cast<SuperSample>(MAX(factor, 1u)));
+    }
+
+  public:
     WaveSimulation2D mWaveSim;
     WaveCrgbMapPtr mCrgbMap;
     bool mAutoUpdates = true;
+    SuperSample mSuperSample; // factor at full quality
 };
 
 } // namespace fl
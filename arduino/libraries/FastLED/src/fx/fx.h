@@ -48,9 +48,31 @@ class Fx {
 
     uint16_t getNumLeds() const { return mNumLeds; }
 
+    // Number of reduced quality levels this fx offers. Level 0 is full
+    // quality and each higher level should be noticeably cheaper to render.
+    // FxEngine steps through them when the fx runs over its frame budget.
+    virtual fl::u8 getMaxQualityLevel() const { return 0; }
+
+    void setQualityLevel(fl::u8 level) {
+        if (level > getMaxQualityLevel()) {
+            level = getMaxQualityLevel();
+        }
+        if (level == mQualityLevel) {
+            return;
+        }
+        mQualityLevel = level;
+        onQualityLevelChanged(level);
+    }
+    fl::u8 getQualityLevel() const { return mQualityLevel; }
+
   protected:
     virtual ~Fx() {} // Protected destructor
+
+    // Applies a new quality level, see getMaxQualityLevel().
+    virtual void onQualityLevelChanged(fl::u8 level) { FASTLED_UNUSED(level); }
+
     uint16_t mNumLeds;
+    fl::u8 mQualityLevel = 0;
 };
 
 } // namespace fl
@@ -1,3 +1,9 @@
+#ifndef FASTLED_INTERNAL
+#define FASTLED_INTERNAL
+#endif
+
+#include "FastLED.h"
+
 #include "fx_engine.h"
 #include "video.h"
 
@@ -66,6 +72,8 @@ FxPtr FxEngine::removeFx(int index) {
         mDurationSet = true;
         mDuration = 0; // Instant transition
     }
+    // Ids are not reused, so the render cost history goes with the effect.
+    mGovernors.erase(index);
 
     return removedFx;
 }
@@ -95,10 +103,51 @@ bool FxEngine::draw(fl::u32 now, CRGB *finalBuffer) {
         }
         mCompositor.startTransition(now, mDuration, fx);
         mDurationSet = false;
+        // Costs measured before the switch belong to another mix of effects.
+        mGovernors[mCurrId].resetAverage();
     }
     if (!mEffects.empty()) {
+        const fl::u32 start = renderClockUs();
         mCompositor.draw(now, warpedTime, finalBuffer);
+        governQuality(renderClockUs() - start);
+    }
+    return true;
+}
+
+fl::u32 FxEngine::renderClockUs() const {
+    if (mRenderClock) {
+        return mRenderClock();
+    }
+    return micros();
+}
+
+void FxEngine::governQuality(fl::u32 renderUs) {
+    // During a transition both effects render; the cost is charged to the
+    // effect being transitioned to.
+    FxPtr fx;
+    if (!mEffects.get(mCurrId, &fx) || !fx) {
+        return;
+    }
+    QualityGovernor &governor = mGovernors[mCurrId];
+    fl::u8 level =
+        governor.update(renderUs, mFrameBudgetUs, fx->getMaxQualityLevel());
+    if (level != fx->getQualityLevel()) {
+        FASTLED_DBG("FxEngine: " << fx->fxName() << " quality level "
+                                 << int(fx->getQualityLevel()) << " -> "
+                                 << int(level) << " ("
+                                 << governor.telemetry().averageRenderUs
+                                 << "us)");
+        fx->setQualityLevel(level);
+    }
+}
+
+bool FxEngine::getQualityTelemetry(int index,
+                                   FxQualityTelemetry *out) const {
+    IntGovernorMap::const_iterator it = mGovernors.find(index);
+    if (it == mGovernors.end()) {
+        return false;
     }
+    *out = it->second.telemetry();
     return true;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "crgb.h"
+#include "fl/function.h"
 #include "fl/map.h"
 #include "fl/namespace.h"
 #include "fl/memory.h"
@@ -9,6 +10,7 @@
 #include "fx/detail/fx_compositor.h"
 #include "fx/detail/fx_layer.h"
 #include "fx/fx.h"
+#include "fx/quality_governor.h"
 #include "fx/time.h"
 #include "fx/video.h"
 #include "fl/stdint.h"
@@ -29,10 +31,15 @@ namespace fl {
  * - Storing and managing a collection of visual effects (Fx objects)
  * - Handling transitions between effects
  * - Rendering the current effect or transition to an output buffer
+ * - Measuring how long each effect takes to render and, when a frame budget
+ *   is set, lowering the quality level of effects that run over it
  */
 class FxEngine {
   public:
     typedef fl::FixedMap<int, FxPtr, FASTLED_FX_ENGINE_MAX_FX> IntFxMap;
+    typedef fl::SortedHeapMap<int, QualityGovernor> IntGovernorMap;
+    // Returns a free running microsecond counter.
+    typedef fl::function<fl::u32()> RenderClock;
     /**
      * @brief Constructs an FxEngine with the specified number of LEDs.
      * @param numLeds The number of LEDs in the strip.
@@ -111,7 +118,33 @@ class FxEngine {
      */
     void setSpeed(float scale) { mTimeFunction.setSpeed(scale); }
 
+    /**
+     * @brief Sets the time each frame may take to render. While the current
+     * effect's smoothed render cost is over the budget its quality level is
+     * stepped down, and stepped back up once there is headroom again.
+     * @param budget_us Budget in microseconds, 0 (the default) disables the
+     * governor. Render cost is measured either way.
+     */
+    void setFrameBudget(fl::u32 budget_us) { mFrameBudgetUs = budget_us; }
+    fl::u32 getFrameBudget() const { return mFrameBudgetUs; }
+
+    /**
+     * @brief Reports the measured render cost and quality decisions for an
+     * effect.
+     * @return False if the effect has never been drawn.
+     */
+    bool getQualityTelemetry(int index, FxQualityTelemetry *out) const;
+
+    /**
+     * @brief Replaces the clock used to measure render cost, which defaults
+     * to micros(). Mostly useful for tests.
+     */
+    void setRenderClock(RenderClock clock) { mRenderClock = clock; }
+
   private:
+    fl::u32 renderClockUs() const;
+    void governQuality(fl::u32 renderUs);
+
     int mCounter = 0;
     TimeWarp mTimeFunction;   // FxEngine controls the clock, to allow
                               // "time-bending" effects.
@@ -122,6 +155,9 @@ class FxEngine {
     bool mDurationSet =
         false; ///< Flag indicating if a new transition has been set
     bool mInterpolate = true;
+    fl::u32 mFrameBudgetUs = 0;
+    IntGovernorMap mGovernors; ///< Render cost tracking, per effect id
+    RenderClock mRenderClock;
 };
 
 } // namespace fl
@@ -0,0 +1,53 @@
+#include "fx/quality_governor.h"
+
+namespace fl {
+
+const fl::u32 QualityGovernor::kStepDownHoldFrames;
+const fl::u32 QualityGovernor::kStepUpHoldFrames;
+
+void QualityGovernor::resetAverage() {
+    mHasAverage = false;
+    mFramesSinceChange = 0;
+}
+
+fl::u8 QualityGovernor::update(fl::u32 renderUs, fl::u32 budgetUs,
+                               fl::u8 maxLevel) {
+    FxQualityTelemetry &t = mTelemetry;
+    t.lastRenderUs = renderUs;
+    t.maxLevel = maxLevel;
+    if (t.level > maxLevel) {
+        t.level = maxLevel;
+    }
+    // Exponential moving average with weight 1/4 on the new sample.
+    if (!mHasAverage) {
+        t.averageRenderUs = renderUs;
+        mHasAverage = true;
+    } else {
+        t.averageRenderUs = t.averageRenderUs - t.averageRenderUs / 4 + renderUs / 4;
+    }
+    ++mFramesSinceChange;
+    if (budgetUs == 0) {
+        return t.level;
+    }
+
+    if (t.averageRenderUs > budgetUs) {
+        if (t.level < maxLevel && mFramesSinceChange >= kStepDownHoldFrames) {
+            ++t.level;
+            ++t.stepDowns;
+            mFramesSinceChange = 0;
+            // The old average describes the old level.
+            mHasAverage = false;
+        }
+    } else if (t.level > 0 && t.averageRenderUs < budgetUs / 2 &&
+               mFramesSinceChange >= kStepUpHoldFrames) {
+        // Only step up with plenty of headroom: each level roughly halves or
+        // doubles the cost for the effects that support it.
+        --t.level;
+        ++t.stepUps;
+        mFramesSinceChange = 0;
+        mHasAverage = false;
+    }
+    return t.level;
+}
+
+} // namespace fl
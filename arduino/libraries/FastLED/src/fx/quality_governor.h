@@ -0,0 +1,49 @@
+#pragma once
+
+#include "fl/int.h"
+#include "fl/namespace.h"
+
+namespace fl {
+
+// Snapshot of the governor state for one effect.
+struct FxQualityTelemetry {
+    fl::u32 lastRenderUs = 0;    // cost of the most recent frame
+    fl::u32 averageRenderUs = 0; // smoothed cost
+    fl::u8 level = 0;            // current quality level, 0 == full quality
+    fl::u8 maxLevel = 0;         // lowest quality the effect supports
+    fl::u32 stepDowns = 0;       // times quality was lowered
+    fl::u32 stepUps = 0;         // times quality was raised
+};
+
+// Decides when an effect should trade quality for speed. Fed one measured
+// render cost per frame, it lowers the quality level while the smoothed cost
+// is over the frame budget and raises it again once there is comfortable
+// headroom. Changes are spaced out so that a level gets a chance to settle
+// before the next decision.
+class QualityGovernor {
+  public:
+    // Frames to wait after a change before stepping down again.
+    static const fl::u32 kStepDownHoldFrames = 8;
+    // Frames to wait after a change before stepping up again. Longer than the
+    // step down hold so the governor does not oscillate around the budget.
+    static const fl::u32 kStepUpHoldFrames = 60;
+
+    QualityGovernor() = default;
+
+    // Records a frame and returns the quality level to use from now on.
+    // `budgetUs` of 0 means unlimited.
+    fl::u8 update(fl::u32 renderUs, fl::u32 budgetUs, fl::u8 maxLevel);
+
+    const FxQualityTelemetry &telemetry() const { return mTelemetry; }
+
+    // Forgets the measurements but keeps the current level, used when the
+    // effect becomes active again.
+    void resetAverage();
+
+  private:
+    FxQualityTelemetry mTelemetry;
+    fl::u32 mFramesSinceChange = 0;
+    bool mHasAverage = false;
+};
+
+} // namespace fl
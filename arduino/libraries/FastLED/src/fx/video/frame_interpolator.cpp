@@ -13,12 +13,20 @@
 
 namespace fl {
 
-FrameInterpolator::FrameInterpolator(size_t nframes, float fps)
-    : mFrameTracker(fps) {
+FrameInterpolator::FrameInterpolator(size_t nframes, float fps,
+                                     size_t pixelsPerFrame)
+    : mFrameTracker(fps), mFramePool(pixelsPerFrame, MAX(1, nframes)) {
     size_t capacity = MAX(1, nframes);
     mFrames.setMaxSize(capacity);
 }
 
+void FrameInterpolator::clear() {
+    for (auto it = mFrames.begin(); it != mFrames.end(); ++it) {
+        mFramePool.release(it->second);
+    }
+    mFrames.clear();
+}
+
 bool FrameInterpolator::draw(fl::u32 now, Frame *dst) {
     bool ok = draw(now, dst->rgb());
     return ok;
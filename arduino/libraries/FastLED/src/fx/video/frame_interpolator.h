@@ -3,6 +3,7 @@
 #include "fl/map.h"
 #include "fl/namespace.h"
 #include "fx/frame.h"
+#include "fx/video/frame_pool.h"
 #include "fx/video/frame_tracker.h"
 #include "fx/video/pixel_stream.h"
 
@@ -19,7 +20,7 @@ class FrameInterpolator {
         bool operator()(fl::u32 a, fl::u32 b) const { return a < b; }
     };
     typedef fl::SortedHeapMap<fl::u32, FramePtr, Less> FrameBuffer;
-    FrameInterpolator(size_t nframes, float fpsVideo);
+    FrameInterpolator(size_t nframes, float fpsVideo, size_t pixelsPerFrame);
 
     // Will search through the array, select the two frames that are closest to
     // the current time and then interpolate between them, storing the results
@@ -31,14 +32,29 @@ class FrameInterpolator {
     // that this adjustable_time is allowed to go pause or go backward in time.
     bool draw(fl::u32 adjustable_time, Frame *dst);
     bool draw(fl::u32 adjustable_time, CRGB *leds);
+    // Takes ownership of the frame. If the frame is not stored, because the
+    // frame number is already present or the buffer is full, it goes back
+    // into the frame pool.
     bool insert(fl::u32 frameNumber, FramePtr frame) {
         InsertResult result;
         mFrames.insert(frameNumber, frame, &result);
+        if (result != InsertResult::kInserted) {
+            mFramePool.release(frame);
+        }
         return result != InsertResult::kMaxSize;
     }
 
-    // Clear all frames
-    void clear() { mFrames.clear(); }
+    // Clear all frames, returning them to the frame pool.
+    void clear();
+
+    // Hands out a frame buffer for the caller to fill and insert(). Buffers
+    // come from the internal pool so that steady-state playback does not
+    // allocate.
+    FramePtr acquireFrame() { return mFramePool.acquire(); }
+
+    // Returns a frame that was acquired but not inserted, or one that was
+    // erase()'d and is no longer needed.
+    void recycleFrame(const FramePtr &frame) { mFramePool.release(frame); }
 
     bool empty() const { return mFrames.empty(); }
 
@@ -98,10 +114,12 @@ class FrameInterpolator {
     }
 
     FrameTracker &getFrameTracker() { return mFrameTracker; }
+    FramePool &getFramePool() { return mFramePool; }
 
   private:
     FrameBuffer mFrames;
     FrameTracker mFrameTracker;
+    FramePool mFramePool;
 };
 
 } // namespace fl
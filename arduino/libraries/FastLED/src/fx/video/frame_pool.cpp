@@ -0,0 +1,39 @@
+#include "fx/video/frame_pool.h"
+
+#include "fl/math_macros.h"
+#include "fl/namespace.h"
+
+namespace fl {
+
+FramePool::FramePool(size_t pixelsPerFrame, size_t capacity)
+    : mPixelsPerFrame(pixelsPerFrame), mCapacity(MAX(1, capacity)) {
+    // Reserve up front so that release() never grows the free list.
+    mFree.reserve(mCapacity);
+}
+
+FramePtr FramePool::acquire() {
+    if (!mFree.empty()) {
+        FramePtr out = mFree.back();
+        mFree.pop_back();
+        return out;
+    }
+    ++mAllocated;
+    return fl::make_shared<Frame>(static_cast<int>(mPixelsPerFrame));
+}
+
+void FramePool::release(const FramePtr &frame) {
+    if (!frame || frame->size() != mPixelsPerFrame) {
+        return;
+    }
+    if (mFree.size() >= mCapacity) {
+        return;
+    }
+    for (size_t i = 0; i < mFree.size(); ++i) {
+        if (mFree[i] == frame) {
+            return; // Already pooled.
+        }
+    }
+    mFree.push_back(frame);
+}
+
+} // namespace fl
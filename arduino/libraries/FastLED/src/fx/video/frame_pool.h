@@ -0,0 +1,40 @@
+#pragma once
+
+#include "fl/namespace.h"
+#include "fl/vector.h"
+#include "fx/frame.h"
+
+namespace fl {
+
+// Fixed-capacity recycler for Frame buffers. Frames are created lazily the
+// first time they are needed and afterwards are handed back and forth between
+// the pool and the FrameInterpolator. At most `capacity` idle frames are kept.
+// Once the pool has been primed, playback does not touch the heap.
+class FramePool {
+  public:
+    FramePool(size_t pixelsPerFrame, size_t capacity);
+
+    // Returns a recycled frame if one is available, otherwise creates a new
+    // one. The contents of a recycled frame are whatever the previous user
+    // left in it.
+    FramePtr acquire();
+
+    // Returns a frame to the pool. Frames of the wrong size, or frames that
+    // would grow the free list beyond capacity, are dropped.
+    void release(const FramePtr &frame);
+
+    size_t pixelsPerFrame() const { return mPixelsPerFrame; }
+    size_t capacity() const { return mCapacity; }
+    // Number of frames that have been created over the life of the pool.
+    size_t allocated() const { return mAllocated; }
+    // Number of frames sitting in the free list.
+    size_t available() const { return mFree.size(); }
+
+  private:
+    size_t mPixelsPerFrame;
+    size_t mCapacity;
+    size_t mAllocated = 0;
+    fl::vector<FramePtr> mFree;
+};
+
+} // namespace fl
@@ -13,7 +13,8 @@ VideoImpl::VideoImpl(size_t pixelsPerFrame, float fpsVideo,
                      size_t nFramesInBuffer)
     : mPixelsPerFrame(pixelsPerFrame),
       mFrameInterpolator(
-          fl::make_shared<FrameInterpolator>(MAX(1, nFramesInBuffer), fpsVideo)) {}
+          fl::make_shared<FrameInterpolator>(MAX(1, nFramesInBuffer), fpsVideo,
+                                             pixelsPerFrame)) {}
 
 void VideoImpl::pause(fl::u32 now) {
     if (!mTime) {
@@ -204,14 +205,16 @@ bool VideoImpl::updateBufferFromStream(fl::u32 now) {
         }
         fl::u32 frame_to_fetch = frame_numbers[i];
         if (!recycled_frame) {
-            // Happens when we are not full and we need to allocate a new frame.
-            recycled_frame = fl::make_shared<Frame>(mPixelsPerFrame);
+            // Happens when we are not full and we need a new frame. The pool
+            // only allocates until it has been primed.
+            recycled_frame = mFrameInterpolator->acquireFrame();
         }
 
         if (!mStream->readFrame(recycled_frame.get())) {
             if (mStream->atEnd()) {
                 if (!mStream->rewind()) {
                     FASTLED_WARN("rewind failed");
+                    mFrameInterpolator->recycleFrame(recycled_frame);
                     return false;
                 }
                 mTime->reset(now);
@@ -219,10 +222,12 @@ bool VideoImpl::updateBufferFromStream(fl::u32 now) {
                 if (!mStream->readFrameAt(frame_to_fetch,
                                           recycled_frame.get())) {
                     FASTLED_WARN("readFrameAt failed");
+                    mFrameInterpolator->recycleFrame(recycled_frame);
                     return false;
                 }
             } else {
                 FASTLED_WARN("We failed for some other reason");
+                mFrameInterpolator->recycleFrame(recycled_frame);
                 return false;
             }
         }
@@ -290,19 +295,22 @@ bool VideoImpl::updateBufferFromFile(fl::u32 now, bool forward) {
         }
         fl::u32 frame_to_fetch = frame_numbers[i];
         if (!recycled_frame) {
-            // Happens when we are not full and we need to allocate a new frame.
-            recycled_frame = fl::make_shared<Frame>(mPixelsPerFrame);
+            // Happens when we are not full and we need a new frame. The pool
+            // only allocates until it has been primed.
+            recycled_frame = mFrameInterpolator->acquireFrame();
         }
 
         do { // only to use break
             if (!mStream->readFrameAt(frame_to_fetch, recycled_frame.get())) {
                 if (!forward) {
                     // nothing more we can do, we can't go negative.
+                    mFrameInterpolator->recycleFrame(recycled_frame);
                     return false;
                 }
                 if (mStream->atEnd()) {
                     if (!mStream->rewind()) { // Is this still
                         FASTLED_WARN("rewind failed");
+                        mFrameInterpolator->recycleFrame(recycled_frame);
                         return false;
                     }
                     mTime->reset(now);
@@ -310,11 +318,13 @@ bool VideoImpl::updateBufferFromFile(fl::u32 now, bool forward) {
                     if (!mStream->readFrameAt(frame_to_fetch,
                                               recycled_frame.get())) {
                         FASTLED_WARN("readFrameAt failed");
+                        mFrameInterpolator->recycleFrame(recycled_frame);
                         return false;
                     }
                     break; // we have the frame, so we can break out of the loop
                 }
                 FASTLED_WARN("We failed for some other reason");
+                mFrameInterpolator->recycleFrame(recycled_frame);
                 return false;
             }
             break;
@@ -47,6 +47,27 @@ struct PixelControllerVtable {
     pc->loadAndScale_WS2816_HD(s0_out, s1_out, s2_out);
   }
 
+  // The whole loop in one call, so the per-pixel steps inline.
+  static void writeRGB(void* pixel_controller, uint8_t* out) {
+    PixelControllerT* pc = static_cast<PixelControllerT*>(pixel_controller);
+    while (pc->has(1)) {
+      pc->loadAndScaleRGB(out, out + 1, out + 2);
+      out += 3;
+      pc->advanceData();
+      pc->stepDithering();
+    }
+  }
+
+  static void writeRGBW(void* pixel_controller, Rgbw rgbw, uint8_t* out) {
+    PixelControllerT* pc = static_cast<PixelControllerT*>(pixel_controller);
+    while (pc->has(1)) {
+      pc->loadAndScaleRGBW(rgbw, out, out + 1, out + 2, out + 3);
+      out += 4;
+      pc->advanceData();
+      pc->stepDithering();
+    }
+  }
+
   static void stepDithering(void* pixel_controller) {
     PixelControllerT* pc = static_cast<PixelControllerT*>(pixel_controller);
     pc->stepDithering();
@@ -81,6 +102,8 @@ typedef void (*loadAndScaleRGBFunction)(void* pixel_controller, uint8_t* r_out,
 typedef void (*loadAndScale_APA102_HDFunction)(void* pixel_controller, uint8_t* b0_out, uint8_t* b1_out, uint8_t* b2_out, uint8_t* brightness_out);
 #endif
 typedef void (*loadAndScale_WS2816_HDFunction)(void* pixel_controller, uint16_t* b0_out, uint16_t* b1_out, uint16_t* b2_out);
+typedef void (*writeRGBFunction)(void* pixel_controller, uint8_t* out);
+typedef void (*writeRGBWFunction)(void* pixel_controller, Rgbw rgbw, uint8_t* out);
 typedef void (*stepDitheringFunction)(void* pixel_controller);
 typedef void (*advanceDataFunction)(void* pixel_controller);
 typedef int (*sizeFunction)(void* pixel_controller);
@@ -131,6 +154,8 @@ class PixelIterator {
       mLoadAndScale_APA102_HD = &Vtable::loadAndScale_APA102_HD;
       #endif
       mLoadAndScale_WS2816_HD = &Vtable::loadAndScale_WS2816_HD;
+      mWriteRGB = &Vtable::writeRGB;
+      mWriteRGBW = &Vtable::writeRGBW;
       mStepDithering = &Vtable::stepDithering;
       mAdvanceData = &Vtable::advanceData;
       mSize = &Vtable::size;
@@ -155,6 +180,12 @@ class PixelIterator {
     void loadAndScale_WS2816_HD(uint16_t *s0_out, uint16_t *s1_out, uint16_t *s2_out) {
       mLoadAndScale_WS2816_HD(mPixelController, s0_out, s1_out, s2_out);
     }
+    // Scales, dithers and writes every remaining pixel in wire order, 3
+    // bytes each (4 for writeRGBW()), in a single pass. `out` must hold
+    // size() pixels. One indirect call per frame, where a loop over
+    // loadAndScaleRGB() makes four per pixel.
+    void writeRGB(uint8_t *out) { mWriteRGB(mPixelController, out); }
+    void writeRGBW(uint8_t *out) { mWriteRGBW(mPixelController, mRgbw, out); }
     void stepDithering() { mStepDithering(mPixelController); }
     void advanceData() { mAdvanceData(mPixelController); }
     int size() { return mSize(mPixelController); }
@@ -178,6 +209,8 @@ class PixelIterator {
     loadAndScale_APA102_HDFunction mLoadAndScale_APA102_HD = nullptr;
     #endif
     loadAndScale_WS2816_HDFunction mLoadAndScale_WS2816_HD = nullptr;
+    writeRGBFunction mWriteRGB = nullptr;
+    writeRGBWFunction mWriteRGBW = nullptr;
     stepDitheringFunction mStepDithering = nullptr;
     advanceDataFunction mAdvanceData = nullptr;
     sizeFunction mSize = nullptr;
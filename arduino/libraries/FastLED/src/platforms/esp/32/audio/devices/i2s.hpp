@@ -2,6 +2,7 @@
 #pragma once
 
 #include "fl/warn.h"
+#include "fl/audio_dma_ring.h"
 #include "fl/audio_input.h"
 
 
@@ -74,25 +75,32 @@ class I2S_Audio : public IAudioInput {
             return AudioSample();  // Invalid sample
         }
         
-        audio_sample_t buf[I2S_AUDIO_BUFFER_LEN];
+        // The driver reads straight into a ring buffer that the returned
+        // AudioSample then uses in place; the buffer is recycled once the
+        // caller drops the sample.
+        fl::span<fl::i16> buf = mRing.acquire();
+        if (buf.empty()) {
+            // Every buffer is still held by an AudioSample. Leave the data
+            // in the driver's DMA queue for the next read.
+            return AudioSample();
+        }
         const I2SContext &ctx = *mI2sContextOpt;
-        size_t samples_read_size = i2s_read_raw_samples(ctx, buf);
+        size_t samples_read_size = i2s_read_raw_samples(ctx, buf.data(), buf.size());
         int samples_read = static_cast<int>(samples_read_size);
-        
+
         if (samples_read <= 0) {
+            mRing.commit(0, 0);
             return AudioSample();  // Invalid sample
         }
-        
+
         // Calculate timestamp based on sample rate and total samples read
         fl::u32 timestamp_ms = static_cast<fl::u32>((mTotalSamplesRead * 1000ULL) / mStdConfig.mSampleRate);
-        
+
         // Update total samples counter
         mTotalSamplesRead += samples_read;
 
-        fl::span<const fl::i16> data(buf, samples_read);
-        
-        // Create AudioSample with pooled AudioSampleImpl (pooling handled internally)
-        return AudioSample(data, timestamp_ms);
+        mRing.commit(samples_read, timestamp_ms);
+        return mRing.pop();
     }
 
   private:
@@ -101,6 +109,7 @@ class I2S_Audio : public IAudioInput {
     fl::string mErrorMessage;
     fl::optional<I2SContext> mI2sContextOpt;
     fl::u64 mTotalSamplesRead;
+    AudioDmaRing mRing;
 };
 
 #endif // FASTLED_ESP32_I2S_SUPPORTED
@@ -96,13 +96,15 @@ I2SContext i2s_audio_init(const AudioConfigI2S &config) {
     return ctx;
 }
 
-size_t i2s_read_raw_samples(const I2SContext &ctx,
-                            audio_sample_t (&buffer)[I2S_AUDIO_BUFFER_LEN]) {
+// Reads up to `count` samples that the driver has already captured,
+// without waiting.
+size_t i2s_read_raw_samples(const I2SContext &ctx, audio_sample_t *buffer,
+                            size_t count) {
     size_t bytes_read = 0;
     i2s_event_t event;
 
     esp_err_t result =
-        i2s_read(ctx.i2s_port, buffer, sizeof(buffer), &bytes_read, 0);
+        i2s_read(ctx.i2s_port, buffer, count * sizeof(audio_sample_t), &bytes_read, 0);
     if (result == ESP_OK) {
         if (bytes_read > 0) {
             // cout << "Bytes read: " << bytes_read << endl;
@@ -113,6 +115,11 @@ size_t i2s_read_raw_samples(const I2SContext &ctx,
     return 0;
 }
 
+size_t i2s_read_raw_samples(const I2SContext &ctx,
+                            audio_sample_t (&buffer)[I2S_AUDIO_BUFFER_LEN]) {
+    return i2s_read_raw_samples(ctx, buffer, I2S_AUDIO_BUFFER_LEN);
+}
+
 void i2s_audio_destroy(const I2SContext &ctx) {
     i2s_driver_uninstall(ctx.i2s_port);
 }
@@ -15,8 +15,10 @@
 
 #include "fl/assert.h"
 #include "fl/convert.h"  // for convert_fastled_timings_to_timedeltas(...)
+#include "fl/warn.h"
 #include "fl/namespace.h"
 #include "strip_rmt.h"
+#include "rmt_worker_channel.h"
 
 
 #define IDF5_RMT_TAG "idf5_rmt.cpp"
@@ -26,12 +28,19 @@ namespace fl {
 
 RmtController5::RmtController5(int DATA_PIN, int T1, int T2, int T3, RmtController5::DmaMode dma_mode)
         : mPin(DATA_PIN), mT1(T1), mT2(T2), mT3(T3), mDmaMode(dma_mode) {
+#if FASTLED_RMT5_WORKER_POOL
+    mStrip = rmt5WorkerPool().addStrip();
+#endif
 }
 
 RmtController5::~RmtController5() {
+#if FASTLED_RMT5_WORKER_POOL
+    rmt5WorkerPool().removeStrip(mStrip);
+#else
     if (mLedStrip) {
         delete mLedStrip;
     }
+#endif
 }
 
 static IRmtStrip::DmaMode convertDmaMode(RmtController5::DmaMode dma_mode) {
@@ -48,6 +57,40 @@ static IRmtStrip::DmaMode convertDmaMode(RmtController5::DmaMode dma_mode) {
     }
 }
 
+#if FASTLED_RMT5_WORKER_POOL
+
+void RmtController5::loadPixelData(PixelIterator &pixels) {
+    RmtWorkerConfig config;
+    uint16_t t0h, t0l, t1h, t1l;
+    convert_fastled_timings_to_timedeltas(mT1, mT2, mT3, &t0h, &t0l, &t1h, &t1l);
+    config.pin = mPin;
+    config.ledCount = pixels.size();
+    config.isRgbw = pixels.get_rgbw().active();
+    config.t0h = t0h;
+    config.t0l = t0l;
+    config.t1h = t1h;
+    config.t1l = t1l;
+    config.reset = 280;
+    config.dmaMode = convertDmaMode(mDmaMode);
+
+    // Waits until the last frame of this strip has been sent.
+    // The strip buffer is what the RMT encoder reads, so one pass of the
+    // pixel controller writes the frame straight into it.
+    fl::span<fl::u8> buffer = rmt5WorkerPool().buffer(mStrip, config);
+    if (config.isRgbw) {
+        pixels.writeRGBW(buffer.data());
+    } else {
+        pixels.writeRGB(buffer.data());
+    }
+}
+
+void RmtController5::showPixels() {
+    // Returns at once while a channel is free; otherwise waits for one.
+    rmt5WorkerPool().show(mStrip);
+}
+
+#else
+
 void RmtController5::loadPixelData(PixelIterator &pixels) {
     const bool is_rgbw = pixels.get_rgbw().active();
     if (!mLedStrip) {
@@ -57,7 +100,10 @@ void RmtController5::loadPixelData(PixelIterator &pixels) {
             mPin, pixels.size(),
             is_rgbw, t0h, t0l, t1h, t1l, 280,
             convertDmaMode(mDmaMode));
-        
+        if (!mLedStrip) {
+            FASTLED_WARN("RMT5: could not create the LED strip on pin " << mPin);
+            return;
+        }
     } else {
         FASTLED_ASSERT(
             mLedStrip->numPixels() == pixels.size(),
@@ -84,9 +130,13 @@ void RmtController5::loadPixelData(PixelIterator &pixels) {
 }
 
 void RmtController5::showPixels() {
-    mLedStrip->drawAsync();
+    if (mLedStrip) {
+        mLedStrip->drawAsync();
+    }
 }
 
+#endif  // FASTLED_RMT5_WORKER_POOL
+
 } // namespace fl
 
 #endif  // FASTLED_RMT5
@@ -8,6 +8,18 @@
 #include "fl/stdint.h"
 #include "fl/namespace.h"
 
+// Strips share the RMT channels through a worker pool unless one of these
+// asks for the old one channel per controller driver.
+#ifndef FASTLED_RMT5_FORCE_LEGACY_MODE
+#define FASTLED_RMT5_FORCE_LEGACY_MODE 0
+#endif
+
+#if defined(FASTLED_RMT5_DISABLE_WORKER_POOL) || FASTLED_RMT5_FORCE_LEGACY_MODE
+#define FASTLED_RMT5_WORKER_POOL 0
+#else
+#define FASTLED_RMT5_WORKER_POOL 1
+#endif
+
 namespace fl {
 
 class IRmtStrip;
@@ -41,7 +53,11 @@ public:
 private:
     int mPin;
     int mT1, mT2, mT3;
+#if FASTLED_RMT5_WORKER_POOL
+    int mStrip = -1;  // in rmt5WorkerPool()
+#else
     IRmtStrip *mLedStrip = nullptr;
+#endif
     DmaMode mDmaMode;
 };
 
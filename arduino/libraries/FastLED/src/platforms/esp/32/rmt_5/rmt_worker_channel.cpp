@@ -0,0 +1,72 @@
+#ifdef ESP32
+
+#include "third_party/espressif/led_strip/src/enabled.h"
+
+#if FASTLED_RMT5
+
+#include "rmt_worker_channel.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_rom_sys.h"
+#include "soc/soc_caps.h"
+
+#include "fl/namespace.h"
+#include "strip_rmt.h"
+
+// 8 for ESP32, 4 for ESP32-S2/S3, 2 for ESP32-C3/H2.
+#ifndef FASTLED_RMT5_MAX_CHANNELS
+#define FASTLED_RMT5_MAX_CHANNELS SOC_RMT_TX_CANDIDATES_PER_GROUP
+#endif
+
+// How long a strip waiting for a channel sleeps between polls.
+#ifndef FASTLED_RMT5_POLL_US
+#define FASTLED_RMT5_POLL_US 100
+#endif
+
+namespace fl {
+
+RmtWorkerChannel::~RmtWorkerChannel() {
+    delete mStrip;  // waits for the transmission
+}
+
+bool RmtWorkerChannel::configure(const RmtWorkerConfig &config, fl::span<const fl::u8> pixels) {
+    // A led_strip device sends from the buffer it was created with, so
+    // moving to another strip means a new device.
+    delete mStrip;
+    mStrip = IRmtStrip::Create(
+        config.pin, config.ledCount, config.isRgbw,
+        config.t0h, config.t0l, config.t1h, config.t1l, config.reset,
+        IRmtStrip::DmaMode(config.dmaMode), 3,
+        const_cast<fl::u8 *>(pixels.data()));
+    return mStrip != nullptr;
+}
+
+void RmtWorkerChannel::transmit() {
+    mStrip->drawAsync();
+}
+
+bool RmtWorkerChannel::isDone() {
+    return !mStrip || !mStrip->isDrawing();
+}
+
+RmtWorkerPool &rmt5WorkerPool() {
+    static RmtWorkerPool *pool = nullptr;
+    if (!pool) {
+        pool = new RmtWorkerPool();
+        for (int i = 0; i < FASTLED_RMT5_MAX_CHANNELS; ++i) {
+            pool->addChannel(new RmtWorkerChannel());
+        }
+        pool->setIdle([]() {
+            esp_rom_delay_us(FASTLED_RMT5_POLL_US);
+            taskYIELD();
+        });
+    }
+    return *pool;
+}
+
+} // namespace fl
+
+#endif  // FASTLED_RMT5
+
+#endif  // ESP32
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "third_party/espressif/led_strip/src/enabled.h"
+
+#if FASTLED_RMT5
+
+#include "platforms/shared/rmt_worker_pool/rmt_worker_pool.h"
+
+namespace fl {
+
+class IRmtStrip;
+
+// An RMT channel for RmtWorkerPool. The led_strip device is created on the
+// first configure() and rebuilt whenever the channel moves to another
+// strip, sending straight out of that strip's buffer.
+class RmtWorkerChannel : public IRmtWorkerChannel {
+  public:
+    RmtWorkerChannel() = default;
+    ~RmtWorkerChannel() override;
+
+    bool configure(const RmtWorkerConfig &config, fl::span<const fl::u8> pixels) override;
+    void transmit() override;
+    bool isDone() override;
+
+  private:
+    IRmtStrip *mStrip = nullptr;
+};
+
+// The pool shared by every RmtController5, with one worker per RMT TX
+// channel (FASTLED_RMT5_MAX_CHANNELS).
+RmtWorkerPool &rmt5WorkerPool();
+
+} // namespace fl
+
+#endif // FASTLED_RMT5
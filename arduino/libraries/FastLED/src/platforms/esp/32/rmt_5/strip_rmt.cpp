@@ -27,6 +27,8 @@ static const char *STRIP_RMT_TAG = "strip_rmt";
 // 10MHz resolution, 1 tick = 0.1us (led strip needs a high resolution)
 #define LED_STRIP_RMT_RES_HZ (10 * 1000 * 1000)
 
+// Returns nullptr if the device could not be created, e.g. no free RMT
+// channel or not enough memory for the pixel buffer.
 led_strip_handle_t configure_led_with_timings(int pin, uint32_t led_count, bool is_rgbw, uint32_t t0h, uint32_t t0l, uint32_t t1h, uint32_t t1l, uint32_t reset, bool with_dma, uint8_t interrupt_priority, uint8_t* external_pixel_buf)
 {
     led_strip_encoder_timings_t timings = {
@@ -66,8 +68,12 @@ led_strip_handle_t configure_led_with_timings(int pin, uint32_t led_count, bool
     };
 
     // LED Strip object handle
-    led_strip_handle_t led_strip;
-    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip));
+    led_strip_handle_t led_strip = nullptr;
+    esp_err_t err = led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip);
+    if (err != ESP_OK) {
+        FASTLED_ESP_LOGE(STRIP_RMT_TAG, "Failed to create LED strip on pin %d: %s", pin, esp_err_to_name(err));
+        return nullptr;
+    }
     FASTLED_ESP_LOGI(STRIP_RMT_TAG, "Created LED strip object with RMT backend");
     return led_strip;
 }
@@ -76,18 +82,9 @@ led_strip_handle_t configure_led_with_timings(int pin, uint32_t led_count, bool
 class RmtStrip : public IRmtStrip
 {
 public:
-    RmtStrip(int pin, uint32_t led_count, bool is_rgbw, uint32_t th0, uint32_t tl0, uint32_t th1, uint32_t tl1, uint32_t reset, IRmtStrip::DmaMode dma_mode, uint8_t interrupt_priority, uint8_t* external_pixel_buf)
-        : mIsRgbw(is_rgbw), mLedCount(led_count)
+    RmtStrip(led_strip_handle_t strip, uint32_t led_count, bool is_rgbw)
+        : mStrip(strip), mIsRgbw(is_rgbw), mLedCount(led_count)
     {
-        bool with_dma;
-        if (dma_mode == IRmtStrip::DMA_AUTO) {
-            // DMA is buggy on ESP32S3
-            with_dma = false;
-        } else {
-            with_dma = dma_mode == IRmtStrip::DMA_ENABLED;
-        }
-        led_strip_handle_t led_strip = configure_led_with_timings(pin, led_count, is_rgbw, th0, tl0, th1, tl1, reset, with_dma, interrupt_priority, external_pixel_buf);
-        mStrip = led_strip;
     }
 
     ~RmtStrip() override
@@ -132,6 +129,23 @@ public:
 
     bool isDrawing() override
     {
+        if (!mDrawIssued)
+        {
+            return false;
+        }
+        bool done = false;
+        esp_err_t err = led_strip_refresh_is_done(mStrip, &done);
+        if (err == ESP_ERR_NOT_SUPPORTED)
+        {
+            // The SPI backend can't poll, so finish the draw here.
+            waitDone();
+            return false;
+        }
+        ESP_ERROR_CHECK(err);
+        if (done)
+        {
+            mDrawIssued = false;
+        }
         return mDrawIssued;
     }
 
@@ -175,11 +189,21 @@ IRmtStrip *IRmtStrip::Create(
     uint32_t th0, uint32_t tl0, uint32_t th1, uint32_t tl1, uint32_t reset,
     DmaMode dma_config, uint8_t interrupt_priority, uint8_t* external_pixel_buf)
 {
-    return new RmtStrip(
+    bool with_dma;
+    if (dma_config == DMA_AUTO) {
+        // DMA is buggy on ESP32S3
+        with_dma = false;
+    } else {
+        with_dma = dma_config == DMA_ENABLED;
+    }
+    led_strip_handle_t strip = configure_led_with_timings(
         pin, led_count, is_rgbw,
         th0, tl0, th1, tl1, reset,
-        dma_config, interrupt_priority, external_pixel_buf
-    );
+        with_dma, interrupt_priority, external_pixel_buf);
+    if (!strip) {
+        return nullptr;
+    }
+    return new RmtStrip(strip, led_count, is_rgbw);
 }
 
 } // namespace fl
@@ -17,6 +17,7 @@ public:
         DMA_DISABLED,
     };
 
+    // Returns nullptr if the RMT device could not be created.
     static IRmtStrip* Create(
         int pin, uint32_t led_count, bool is_rgbw,
         uint32_t th0, uint32_t tl0, uint32_t th1, uint32_t tl1, uint32_t reset,
@@ -33,6 +34,8 @@ public:
     }
     virtual void drawAsync() = 0;
     virtual void waitDone() = 0;
+    // Until the last drawAsync() has finished. Does not block, except on a
+    // backend that can't poll, where it waits for the draw and returns false.
     virtual bool isDrawing() = 0;
     virtual void fill(uint8_t red, uint8_t green, uint8_t blue) = 0;
     virtual void fillRGBW(uint8_t red, uint8_t green, uint8_t blue, uint8_t white) = 0;
@@ -4,13 +4,10 @@
 #include "fl/namespace.h"
 #include "fl/str.h"
 #include "fl/json.h"
+#include "fl/json_writer.h"
 #include "fl/unused.h"
 // CLEDController is forward declared in header - no include needed
 
-#if FASTLED_ENABLE_JSON
-#include "third_party/arduinojson/json.h"
-#endif
-
 namespace fl {
 
 ActiveStripData &ActiveStripData::Instance() {
@@ -73,34 +70,20 @@ bool ActiveStripData::parseStripJsonInfo(const char* jsonStr) {
 }
 
 fl::string ActiveStripData::infoJsonString() {
-    // LEGACY API - WORKING: Create strip info JSON using ArduinoJSON
-#if FASTLED_ENABLE_JSON
-    FLArduinoJson::JsonDocument doc;
-    auto array = doc.to<FLArduinoJson::JsonArray>();
-
+    // Written straight into the result: no JSON document is built.
+    fl::string out;
+    out.reserve(2 + mStripMap.size() * 36);
+    fl::JsonWriter writer(out);
+    writer.beginArray();
     for (const auto &[stripIndex, stripData] : mStripMap) {
-        auto obj = array.add<FLArduinoJson::JsonObject>();
-        obj["strip_id"] = stripIndex;
-        obj["type"] = "r8g8b8";
-    }
-
-    fl::string jsonBuffer;
-    serializeJson(doc, jsonBuffer);
-    
-    // Ensure we always return a valid JSON array, even if empty
-    if (jsonBuffer.empty()) {
-        return fl::string("[]");
-    }
-    
-    // Verify the JSON starts with [ to ensure it's an array
-    if (jsonBuffer.length() == 0 || jsonBuffer[0] != '[') {
-        return fl::string("[]");
+        writer.beginObject();
+        writer.key("strip_id").value(static_cast<int64_t>(stripIndex));
+        writer.key("type").value("r8g8b8");
+        writer.endObject();
     }
-    
-    return jsonBuffer;
-#else
-    return fl::string("[]");
-#endif
+    writer.endArray();
+    writer.flush();
+    return out;
 }
 
 fl::string ActiveStripData::infoJsonStringNew() {
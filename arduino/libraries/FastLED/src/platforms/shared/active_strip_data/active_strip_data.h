@@ -30,7 +30,7 @@ class ActiveStripData : public fl::EngineEvents::Listener {
     void updateScreenMap(int id, const ScreenMap &screenmap);
 
     // JSON creation methods
-    fl::string infoJsonString(); // Legacy implementation (working)
+    fl::string infoJsonString(); // Streams straight out with fl::JsonWriter
     fl::string infoJsonStringNew(); // New fl::Json API (when creation is fixed)
 
     // JSON parsing methods (NEW - using working fl::Json parsing API)
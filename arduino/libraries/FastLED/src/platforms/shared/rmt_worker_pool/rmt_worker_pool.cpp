@@ -0,0 +1,228 @@
+#include "rmt_worker_pool.h"
+
+namespace fl {
+
+RmtWorkerPool::~RmtWorkerPool() {
+    flush();
+    for (fl::size i = 0; i < mWorkers.size(); ++i) {
+        delete mWorkers[i].channel;
+    }
+    for (fl::size i = 0; i < mStrips.size(); ++i) {
+        delete mStrips[i];
+    }
+}
+
+void RmtWorkerPool::addChannel(IRmtWorkerChannel *channel) {
+    Worker worker;
+    worker.channel = channel;
+    mWorkers.push_back(worker);
+}
+
+int RmtWorkerPool::addStrip() {
+    for (fl::size i = 0; i < mStrips.size(); ++i) {
+        if (!mStrips[i]) {
+            mStrips[i] = new Strip();
+            return int(i);
+        }
+    }
+    mStrips.push_back(new Strip());
+    return int(mStrips.size() - 1);
+}
+
+void RmtWorkerPool::removeStrip(int strip) {
+    if (!valid(strip)) {
+        return;
+    }
+    wait(strip);
+    unbind(strip);
+    delete mStrips[strip];
+    mStrips[strip] = nullptr;
+}
+
+fl::size RmtWorkerPool::stripCount() const {
+    fl::size count = 0;
+    for (fl::size i = 0; i < mStrips.size(); ++i) {
+        count += mStrips[i] ? 1 : 0;
+    }
+    return count;
+}
+
+bool RmtWorkerPool::valid(int strip) const {
+    return strip >= 0 && fl::size(strip) < mStrips.size() && mStrips[strip];
+}
+
+fl::span<fl::u8> RmtWorkerPool::buffer(int strip, const RmtWorkerConfig &config) {
+    if (!valid(strip)) {
+        return fl::span<fl::u8>();
+    }
+    wait(strip);
+    Strip &s = *mStrips[strip];
+    if (s.config != config || s.pixels.size() != config.bytes()) {
+        s.config = config;
+        s.pixels.resize(config.bytes());
+        s.dirty = true;
+    }
+    return fl::span<fl::u8>(s.pixels.data(), s.pixels.size());
+}
+
+void RmtWorkerPool::show(int strip) {
+    if (submit(strip)) {
+        return;
+    }
+    // Only strips that found every channel busy get here.
+    while (isQueued(strip)) {
+        idle();
+        poll();
+    }
+}
+
+bool RmtWorkerPool::submit(int strip) {
+    if (!valid(strip)) {
+        return false;
+    }
+    // Strips already waiting go first.
+    poll();
+    Strip &s = *mStrips[strip];
+    if (s.queued) {
+        return false;
+    }
+    if (s.pixels.empty()) {
+        return true;
+    }
+    const int worker = s.sending < 0 ? pickWorker(strip) : -1;
+    if (worker >= 0) {
+        start(strip, worker);
+        return true;
+    }
+    s.queued = true;
+    mQueue.push_back(strip);
+    ++mStats.queued;
+    return false;
+}
+
+void RmtWorkerPool::poll() {
+    reap();
+    startQueued();
+}
+
+void RmtWorkerPool::wait(int strip) {
+    while (isBusy(strip)) {
+        poll();
+        if (!isBusy(strip)) {
+            break;
+        }
+        idle();
+    }
+}
+
+void RmtWorkerPool::flush() {
+    for (fl::size i = 0; i < mStrips.size(); ++i) {
+        wait(int(i));
+    }
+}
+
+bool RmtWorkerPool::isBusy(int strip) const {
+    return valid(strip) && (mStrips[strip]->queued || mStrips[strip]->sending >= 0);
+}
+
+bool RmtWorkerPool::isQueued(int strip) const {
+    return valid(strip) && mStrips[strip]->queued;
+}
+
+int RmtWorkerPool::channelOf(int strip) const {
+    return valid(strip) ? mStrips[strip]->sending : -1;
+}
+
+// A free channel for `strip`: its own if that is free, then one bound to
+// no strip, then the one idle the longest.
+int RmtWorkerPool::pickWorker(int strip) const {
+    int best = -1;
+    for (fl::size i = 0; i < mWorkers.size(); ++i) {
+        const Worker &w = mWorkers[i];
+        if (w.sending >= 0) {
+            continue;
+        }
+        if (w.bound == strip) {
+            return int(i);
+        }
+        if (best < 0) {
+            best = int(i);
+            continue;
+        }
+        const Worker &b = mWorkers[best];
+        if (b.bound >= 0 && (w.bound < 0 || w.lastUsed < b.lastUsed)) {
+            best = int(i);
+        }
+    }
+    return best;
+}
+
+void RmtWorkerPool::start(int strip, int worker) {
+    Strip &s = *mStrips[strip];
+    Worker &w = mWorkers[worker];
+    if (w.bound != strip || s.dirty) {
+        // The strip's buffer is bound to one channel at a time, so that a
+        // change of config cannot leave a stale binding behind.
+        unbind(strip);
+        w.bound = -1;
+        ++mStats.reconfigured;
+        if (!w.channel->configure(s.config, fl::span<const fl::u8>(s.pixels.data(), s.pixels.size()))) {
+            ++mStats.failed;
+            return;
+        }
+        w.bound = strip;
+        s.dirty = false;
+    }
+    w.channel->transmit();
+    w.sending = strip;
+    w.lastUsed = ++mTick;
+    s.sending = worker;
+    ++mStats.sent;
+}
+
+void RmtWorkerPool::reap() {
+    for (fl::size i = 0; i < mWorkers.size(); ++i) {
+        Worker &w = mWorkers[i];
+        if (w.sending >= 0 && w.channel->isDone()) {
+            if (valid(w.sending)) {
+                mStrips[w.sending]->sending = -1;
+            }
+            w.sending = -1;
+        }
+    }
+}
+
+void RmtWorkerPool::startQueued() {
+    for (fl::size i = 0; i < mQueue.size();) {
+        const int strip = mQueue[i];
+        Strip &s = *mStrips[strip];
+        if (s.sending >= 0) {
+            // Still sending its previous frame; keeps its place.
+            ++i;
+            continue;
+        }
+        const int worker = pickWorker(strip);
+        if (worker < 0) {
+            break;
+        }
+        mQueue.erase(mQueue.begin() + i);
+        s.queued = false;
+        start(strip, worker);
+    }
+}
+
+void RmtWorkerPool::idle() {
+    if (mIdle) {
+        mIdle();
+    }
+}
+
+void RmtWorkerPool::unbind(int strip) {
+    for (fl::size i = 0; i < mWorkers.size(); ++i) {
+        if (mWorkers[i].bound == strip) {
+            mWorkers[i].bound = -1;
+        }
+    }
+}
+
+} // namespace fl
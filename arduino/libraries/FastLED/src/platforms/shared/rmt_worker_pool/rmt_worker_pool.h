@@ -0,0 +1,140 @@
+#pragma once
+
+#include "fl/function.h"
+#include "fl/int.h"
+#include "fl/span.h"
+#include "fl/vector.h"
+
+namespace fl {
+
+// Everything a transmit channel needs to know to drive one strip. Two
+// strips with the same config still need a rebuild to swap, since the
+// channel sends straight out of each strip's own buffer.
+struct RmtWorkerConfig {
+    int pin = -1;
+    fl::u32 ledCount = 0;
+    bool isRgbw = false;
+    fl::u32 t0h = 0, t0l = 0, t1h = 0, t1l = 0, reset = 0; // channel ticks
+    int dmaMode = 0;
+
+    fl::size bytes() const { return fl::size(ledCount) * (isRgbw ? 4 : 3); }
+    bool operator==(const RmtWorkerConfig &o) const {
+        return pin == o.pin && ledCount == o.ledCount && isRgbw == o.isRgbw &&
+               t0h == o.t0h && t0l == o.t0l && t1h == o.t1h && t1l == o.t1l &&
+               reset == o.reset && dmaMode == o.dmaMode;
+    }
+    bool operator!=(const RmtWorkerConfig &o) const { return !(*this == o); }
+};
+
+// One hardware transmit channel. On ESP32 this is an RMT channel behind the
+// led_strip driver; the tests drive the pool with a fake.
+class IRmtWorkerChannel {
+  public:
+    virtual ~IRmtWorkerChannel() {}
+    // Binds the channel to a strip. Only called while the channel is idle.
+    // `pixels` holds the strip's wire ordered bytes and stays where it is
+    // until the next configure(). Returns false if the channel could not be
+    // set up, e.g. for lack of RMT memory.
+    virtual bool configure(const RmtWorkerConfig &config, fl::span<const fl::u8> pixels) = 0;
+    // Starts sending the bound pixels and returns at once.
+    virtual void transmit() = 0;
+    // True once the last transmit() has finished. Must not block.
+    virtual bool isDone() = 0;
+};
+
+struct RmtWorkerPoolStats {
+    fl::u32 sent = 0;         // transmissions started
+    fl::u32 queued = 0;       // of those, how many waited for a channel
+    fl::u32 reconfigured = 0; // channel rebuilds to switch strips
+    fl::u32 failed = 0;       // frames dropped because configure() failed
+};
+
+// Shares K transmit channels between N strips.
+//
+// Every strip keeps its pixels in a buffer owned by the pool, so a strip
+// that is waiting for a channel loses nothing and channels send straight
+// out of the strip buffers. A channel stays bound to the last strip it
+// sent; strips go back to their own channel whenever it is free, so with
+// N <= K nothing is ever rebuilt and show() never waits. With N > K a
+// strip that finds every channel busy queues, and queued strips get
+// channels in the order they were shown as transmissions finish.
+//
+// The pool is driven by the task that calls show(); completion is found by
+// polling the channels, so nothing here runs in an interrupt. While it has
+// to wait, the pool calls the idle function between polls.
+class RmtWorkerPool {
+  public:
+    RmtWorkerPool() = default;
+    ~RmtWorkerPool();
+    RmtWorkerPool(const RmtWorkerPool &) = delete;
+    RmtWorkerPool &operator=(const RmtWorkerPool &) = delete;
+
+    // Takes ownership of `channel`.
+    void addChannel(IRmtWorkerChannel *channel);
+    fl::size channelCount() const { return mWorkers.size(); }
+    void setIdle(fl::function<void()> idle) { mIdle = idle; }
+
+    // Strips are identified by small integers, reused after removeStrip().
+    int addStrip();
+    // Waits for the strip's transmission and frees its buffer and channel.
+    void removeStrip(int strip);
+    fl::size stripCount() const;
+
+    // The strip's pixel buffer, sized for `config`, to be filled with wire
+    // ordered bytes. Waits until the channel has finished reading it.
+    fl::span<fl::u8> buffer(int strip, const RmtWorkerConfig &config);
+
+    // Sends the strip's buffer: starts it if a channel is free, otherwise
+    // queues it and waits for its turn. Returns once the transmission has
+    // started.
+    void show(int strip);
+    // Like show() but never waits; a queued strip starts from a later
+    // poll(). Returns true if it started at once.
+    bool submit(int strip);
+    // Reaps finished channels and starts queued strips on them.
+    void poll();
+    // Waits until the strip's buffer is no longer queued or being sent.
+    void wait(int strip);
+    // Waits for every strip.
+    void flush();
+
+    bool isBusy(int strip) const;
+    bool isQueued(int strip) const;
+    // The channel the strip is sending on, or -1.
+    int channelOf(int strip) const;
+    const RmtWorkerPoolStats &stats() const { return mStats; }
+    void resetStats() { mStats = RmtWorkerPoolStats(); }
+
+  private:
+    struct Worker {
+        IRmtWorkerChannel *channel = nullptr;
+        int bound = -1;   // strip the channel is configured for
+        int sending = -1; // strip being sent, or -1 if idle
+        fl::u32 lastUsed = 0;
+    };
+    struct Strip {
+        bool used = false;
+        bool queued = false;
+        int sending = -1; // worker index
+        bool dirty = true; // config or buffer changed since last bound
+        RmtWorkerConfig config;
+        fl::vector<fl::u8> pixels;
+    };
+
+    bool valid(int strip) const;
+    int pickWorker(int strip) const;
+    void start(int strip, int worker);
+    void reap();
+    void startQueued();
+    void idle();
+    void unbind(int strip);
+
+    fl::vector<Worker> mWorkers;
+    fl::vector<Strip *> mStrips; // heap allocated so buffers never move
+    fl::vector<int> mQueue; // strips in the order they were shown
+    fl::function<void()> mIdle;
+    fl::u32 mTick = 0;
+    RmtWorkerPoolStats mStats;
+};
+
+} // namespace fl
@@ -5,6 +5,7 @@
 #include "fl/namespace.h"
 #include "fl/memory.h"
 #include "fl/str.h"
+#include "fl/symbol.h"
 #include "fl/mutex.h"
 #include "fl/unused.h"
 
@@ -20,12 +21,15 @@ class JsonUiInternal {
     // Constructor: Initializes the base JsonUiInternal with name.
     // This constructor is protected because JsonUiInternal is now an abstract base class.
     public:
-    JsonUiInternal(const fl::string &name) : mName(name), mId(nextId()) {}
+    JsonUiInternal(const fl::string &name)
+        : mName(name), mNameSymbol(name), mId(nextId()) {}
 
   public:
     virtual ~JsonUiInternal() = default;
 
     const fl::string &name() const;
+    // The name interned, for lookups by name.
+    Symbol nameSymbol() const { return mNameSymbol; }
     virtual void updateInternal(const fl::Json &json) { FL_UNUSED(json); }
     virtual void toJson(fl::Json &json) const { FL_UNUSED(json); }
     int id() const;
@@ -42,6 +46,7 @@ class JsonUiInternal {
   private:
     static int nextId();
     fl::string mName;
+    Symbol mNameSymbol;
     int mId;
     fl::string mGroup;
     mutable fl::mutex mMutex;
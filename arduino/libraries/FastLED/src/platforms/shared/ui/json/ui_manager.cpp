@@ -1,5 +1,6 @@
 #include "fl/json.h"
 #include "fl/json.h"
+#include "fl/json_writer.h"
 #include "fl/map.h"
 #include "fl/mutex.h"
 #include "fl/namespace.h"
@@ -89,9 +90,12 @@ void JsonUiManager::processPendingUpdates() {
     if (shouldUpdate) {
         fl::Json doc = fl::Json::array();
         toJson(doc);
-        fl::string jsonStr = doc.to_string();
-        //FL_WARN("*** SENDING UI TO FRONTEND: " << jsonStr.substr(0, 100).c_str() << "...");
-        mUpdateJs(jsonStr.c_str());
+        mJsonOut.clear();
+        {
+            fl::JsonWriter writer(mJsonOut);
+            doc.write(writer);
+        }
+        mUpdateJs(mJsonOut.c_str());
 
         // Clear the changed flag for all components after sending the update
         fl::lock_guard<fl::mutex> lock(mMutex); // Acquire lock again for modifying mComponents
@@ -126,24 +130,48 @@ fl::vector<JsonUiInternalPtr> JsonUiManager::getComponents() {
     return out;
 }
 
+namespace {
+
+// Parses the decimal form of a component id, as written by toJson(). Returns
+// -1 for anything else, such as names or ids with leading zeros.
+int parseComponentId(const char *text) {
+    if (!text || !*text || (text[0] == '0' && text[1] != '\0')) {
+        return -1;
+    }
+    long value = 0;
+    for (const char *p = text; *p; ++p) {
+        if (*p < '0' || *p > '9' || value > 0x7fffffff / 10) {
+            return -1;
+        }
+        value = value * 10 + (*p - '0');
+    }
+    return value > 0x7fffffff ? -1 : static_cast<int>(value);
+}
+
+} // namespace
+
 JsonUiInternalPtr JsonUiManager::findUiComponent(const char* id_or_name) {
     auto components = getComponents();
-    
-    for (auto &component : components) {
-        int id = component->id();
-        string componentIdStr;
-        componentIdStr.append(id);
-        
-        if (fl::string::strcmp(componentIdStr.c_str(), id_or_name) == 0) {
-            //FL_WARN("*** Found component with ID " << id);
-            return component;
+
+    // Ids are compared as numbers and names as interned symbols, so no
+    // string is built or compared per component.
+    const int id = parseComponentId(id_or_name);
+    if (id >= 0) {
+        for (auto &component : components) {
+            if (component->id() == id) {
+                return component;
+            }
         }
     }
 
-    // If we didn't find it by id, try to find it by name
-    for (auto &component : components) {
-        if (fl::string::strcmp(component->name().c_str(), id_or_name) == 0) {
-            return component;
+    // If we didn't find it by id, try to find it by name. A name that was
+    // never interned cannot belong to any component.
+    const Symbol name = Symbol::find(id_or_name);
+    if (!name.empty() || (id_or_name && !*id_or_name)) {
+        for (auto &component : components) {
+            if (component->nameSymbol() == name) {
+                return component;
+            }
         }
     }
     
@@ -54,6 +54,9 @@ class JsonUiManager : fl::EngineEvents::Listener {
     bool mItemsAdded = false;
     fl::Json mPendingJsonUpdate;
     bool mHasPendingUpdate = false;
+    // Serialized UI state sent to the frontend. Kept between frames so its
+    // capacity is reused.
+    fl::string mJsonOut;
 };
 
 } // namespace fl
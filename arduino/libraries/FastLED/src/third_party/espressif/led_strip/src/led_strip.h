@@ -85,6 +85,18 @@ esp_err_t led_strip_refresh_async(led_strip_handle_t strip);
 
 esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip);
 
+/**
+ * @brief Check, without blocking, whether an asynchronous refresh has finished
+ *
+ * @param strip: LED strip
+ * @param done: set to true once the refresh is done, the same state led_strip_refresh_wait_done() leaves
+ *
+ * @return
+ *      - ESP_OK: `done` is valid
+ *      - ESP_ERR_NOT_SUPPORTED: the backend can only wait
+ */
+esp_err_t led_strip_refresh_is_done(led_strip_handle_t strip, bool *done);
+
 /**
  * @brief Clear LED strip (turn off all LEDs)
  *
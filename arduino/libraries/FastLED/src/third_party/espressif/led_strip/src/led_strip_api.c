@@ -81,6 +81,15 @@ esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip)
     return strip->refresh_wait_done(strip);
 }
 
+esp_err_t led_strip_refresh_is_done(led_strip_handle_t strip, bool *done)
+{
+    ESP_RETURN_ON_FALSE(strip && done, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (!strip->refresh_is_done) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return strip->refresh_is_done(strip, done);
+}
+
 esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
 {
     ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
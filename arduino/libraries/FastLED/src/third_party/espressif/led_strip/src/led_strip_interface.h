@@ -69,6 +69,7 @@ struct led_strip_t {
 
     esp_err_t (*refresh_async)(led_strip_t *strip);
     esp_err_t (*refresh_wait_done)(led_strip_t *strip);
+    esp_err_t (*refresh_is_done)(led_strip_t *strip, bool *done); // optional, never blocks
 
     /**
      * @brief Clear LED strip (turn off all LEDs)
@@ -113,6 +113,20 @@ static esp_err_t led_strip_rmt_wait_for_done(led_strip_t *strip)
     return ESP_OK;
 }
 
+static esp_err_t led_strip_rmt_is_done(led_strip_t *strip, bool *done)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    esp_err_t err = rmt_tx_wait_all_done(rmt_strip->rmt_chan, 0);
+    if (err == ESP_ERR_TIMEOUT) {
+        *done = false;
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(err, TAG, "poll RMT done failed");
+    ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    *done = true;
+    return ESP_OK;
+}
+
 static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
 {
     ESP_RETURN_ON_ERROR(led_strip_rmt_refresh_async(strip), TAG, "refresh async failed");
@@ -221,6 +235,7 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     rmt_strip->base.refresh = led_strip_rmt_refresh;
     rmt_strip->base.refresh_async = led_strip_rmt_refresh_async;
     rmt_strip->base.refresh_wait_done = led_strip_rmt_wait_for_done;
+    rmt_strip->base.refresh_is_done = led_strip_rmt_is_done;
     rmt_strip->base.clear = led_strip_rmt_clear;
     rmt_strip->base.del = led_strip_rmt_del;
 
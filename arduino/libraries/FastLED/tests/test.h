@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "crgb.h"
+#include "fl/allocator.h"
 #include "fl/hash_set.h"
 #include "fl/lut.h"
 #include "fl/optional.h"
@@ -47,6 +48,14 @@
 
 using namespace fl;
 
+// Counts heap calls while installed with SetMallocFreeHook().
+struct CountingMallocHook : public MallocFreeHook {
+    void onMalloc(void *, fl::size) override { ++mallocs; }
+    void onFree(void *) override { ++frees; }
+    int mallocs = 0;
+    int frees = 0;
+};
+
 namespace doctest {
 template <> struct StringMaker<CRGB> {
     static String convert(const CRGB &value) {
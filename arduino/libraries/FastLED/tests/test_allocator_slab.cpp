@@ -2,8 +2,12 @@
 
 #include "test.h"
 #include "fl/allocator.h"
+#include "fl/bitset.h"
+#include "fl/mutex.h"
 #include "fl/vector.h"
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 using namespace fl;
 
@@ -144,3 +148,398 @@ TEST_CASE("SlabAllocator - Edge cases") {
         allocator.deallocate(huge_ptr, 1000);
     }
 } 
+
+TEST_CASE("SlabAllocator - Free list reuse") {
+    SlabAllocator<TestObject, 8> allocator;
+
+    SUBCASE("Freed block is handed out again") {
+        TestObject* a = allocator.allocate();
+        TestObject* b = allocator.allocate();
+        allocator.deallocate(a);
+        TestObject* c = allocator.allocate();
+        CHECK_EQ(c, a);
+        CHECK_EQ(c->data[0], 0);  // reused blocks are zeroed again
+        allocator.deallocate(b);
+        allocator.deallocate(c);
+    }
+
+    SUBCASE("Size classes do not overlap") {
+        fl::vector<TestObject*> singles;
+        for (int i = 0; i < 3; ++i) {
+            singles.push_back(allocator.allocate());
+        }
+        TestObject* pair = allocator.allocate(2);
+        TestObject* quad = allocator.allocate(3);  // rounded up to 4 blocks
+        REQUIRE(pair != nullptr);
+        REQUIRE(quad != nullptr);
+        for (int i = 0; i < 3; ++i) {
+            quad[i].data[0] = 100 + i;
+        }
+        pair[0].data[0] = 1;
+        pair[1].data[0] = 2;
+        for (TestObject* p : singles) {
+            p->data[0] = 7;
+        }
+        CHECK_EQ(quad[0].data[0], 100);
+        CHECK_EQ(quad[2].data[0], 102);
+        CHECK_EQ(pair[1].data[0], 2);
+
+        SlabAllocatorStats stats = allocator.getStats();
+        CHECK_EQ(stats.liveAllocations, 5);
+        CHECK_EQ(stats.liveBlocks, 8);
+        CHECK_EQ(stats.reservedBlocks, 9);
+
+        allocator.deallocate(quad, 3);
+        allocator.deallocate(pair, 2);
+        for (TestObject* p : singles) {
+            allocator.deallocate(p);
+        }
+        CHECK_EQ(allocator.getActiveAllocations(), 0);
+    }
+
+    SUBCASE("Large free runs are split for small requests") {
+        TestObject* run = allocator.allocate(8);
+        allocator.deallocate(run, 8);
+        // The whole slab is free again, no new slab is needed for singles.
+        for (int i = 0; i < 8; ++i) {
+            allocator.allocate();
+        }
+        CHECK_EQ(allocator.getSlabCount(), 1);
+    }
+
+    SUBCASE("Neighbouring free runs merge before a new slab is made") {
+        fl::vector<TestObject*> singles;
+        for (int i = 0; i < 32; ++i) {
+            singles.push_back(allocator.allocate());
+        }
+        CHECK_EQ(allocator.getSlabCount(), 4);
+        for (TestObject* p : singles) {
+            allocator.deallocate(p);
+        }
+        // Only single block runs are free; joined they fill whole slabs.
+        fl::vector<TestObject*> runs;
+        for (int i = 0; i < 4; ++i) {
+            runs.push_back(allocator.allocate(8));
+        }
+        CHECK_EQ(allocator.getSlabCount(), 4);
+        for (TestObject* p : runs) {
+            allocator.deallocate(p, 8);
+        }
+
+        // Mixed sizes churning in a fixed footprint do not grow it.
+        fl::vector<TestObject*> live(24, nullptr);
+        for (int i = 0; i < 2000; ++i) {
+            const fl::size slot = (i * 7) % live.size();
+            if (live[slot]) {
+                allocator.deallocate(live[slot], fl::size(1) << (slot % 3));
+            }
+            live[slot] = allocator.allocate(fl::size(1) << (slot % 3));
+            REQUIRE(live[slot] != nullptr);
+        }
+        CHECK_LE(allocator.getSlabCount(), 8);
+        for (fl::size slot = 0; slot < live.size(); ++slot) {
+            allocator.deallocate(live[slot], fl::size(1) << (slot % 3));
+        }
+        CHECK_EQ(allocator.getActiveAllocations(), 0);
+    }
+
+    SUBCASE("A merge that does not help is not repeated for every new slab") {
+        // Single block holes with live neighbours, which can never join.
+        fl::vector<TestObject*> singles;
+        for (int i = 0; i < 8; ++i) {
+            singles.push_back(allocator.allocate());
+        }
+        for (int i = 0; i < 8; i += 2) {
+            allocator.deallocate(singles[i]);
+        }
+        fl::vector<TestObject*> pairs;
+        for (int i = 0; i < 64; ++i) {
+            // A free since the last merge, then a request the holes can't
+            // serve. Each slab holds four pairs.
+            allocator.deallocate(allocator.allocate());
+            pairs.push_back(allocator.allocate(2));
+            REQUIRE(pairs.back() != nullptr);
+        }
+        CHECK_EQ(allocator.getSlabCount(), 17);
+        // Without backing off this would be one merge per new slab.
+        CHECK_LE(allocator.getStats().merges, 6);
+        for (TestObject* p : pairs) {
+            allocator.deallocate(p, 2);
+        }
+        for (int i = 1; i < 8; i += 2) {
+            allocator.deallocate(singles[i]);
+        }
+        CHECK_EQ(allocator.getActiveAllocations(), 0);
+    }
+}
+
+TEST_CASE("SlabAllocator - Statistics") {
+    SlabAllocator<TestObject, 8> allocator;
+    fl::vector<TestObject*> ptrs;
+    for (int i = 0; i < 20; ++i) {
+        ptrs.push_back(allocator.allocate());
+    }
+    TestObject* large = allocator.allocate(50);
+
+    SlabAllocatorStats stats = allocator.getStats();
+    CHECK_EQ(stats.liveAllocations, 20);
+    CHECK_EQ(stats.liveBlocks, 20);
+    CHECK_EQ(stats.peakLiveBlocks, 20);
+    CHECK_EQ(stats.slabCount, 3);
+    CHECK_EQ(stats.capacityBlocks, 24);
+    CHECK_EQ(stats.freeBlocks, 4);
+    CHECK_EQ(stats.largeAllocations, 1);
+    CHECK_EQ(stats.fragmentationPercent(), 16);
+
+    for (int i = 0; i < 10; ++i) {
+        allocator.deallocate(ptrs[i]);
+    }
+    allocator.deallocate(large, 50);
+    stats = allocator.getStats();
+    CHECK_EQ(stats.liveBlocks, 10);
+    CHECK_EQ(stats.peakLiveBlocks, 20);  // high-water mark is kept
+    CHECK_EQ(stats.freeBlocks, 14);
+    CHECK_EQ(stats.largeAllocations, 0);
+
+    for (int i = 10; i < 20; ++i) {
+        allocator.deallocate(ptrs[i]);
+    }
+}
+
+TEST_CASE("SlabAllocator - Empty slab reclamation") {
+    SlabAllocator<TestObject, 8> allocator;
+    fl::vector<TestObject*> ptrs;
+    for (int i = 0; i < 80; ++i) {
+        ptrs.push_back(allocator.allocate());
+    }
+    CHECK_EQ(allocator.getSlabCount(), 10);
+
+    SUBCASE("trim() releases empty slabs but keeps one spare") {
+        for (TestObject* p : ptrs) {
+            allocator.deallocate(p);
+        }
+        // deallocate() never hands memory back on its own.
+        SlabAllocatorStats stats = allocator.getStats();
+        CHECK_EQ(stats.liveBlocks, 0);
+        CHECK_EQ(stats.slabCount, 10);
+        CHECK_EQ(stats.releasedSlabs, 0);
+
+        CHECK_EQ(allocator.trim(), 9);
+        CHECK_EQ(allocator.getSlabCount(), 1);
+        CHECK_EQ(allocator.getStats().releasedSlabs, 9);
+        CHECK_EQ(allocator.getStats().peakSlabCount, 10);
+
+        // The retained slab serves the next allocations.
+        TestObject* p = allocator.allocate();
+        CHECK_EQ(allocator.getSlabCount(), 1);
+        allocator.deallocate(p);
+    }
+
+    SUBCASE("Slabs with live blocks survive trim") {
+        // Free everything except one block in every other slab.
+        for (size_t i = 0; i < ptrs.size(); ++i) {
+            if (i % 16 != 0) {
+                allocator.deallocate(ptrs[i]);
+            }
+        }
+        allocator.trim();
+        CHECK_EQ(allocator.getSlabCount(), 6);  // 5 in use + 1 spare
+        for (size_t i = 0; i < ptrs.size(); i += 16) {
+            ptrs[i]->data[0] = 42;
+            CHECK_EQ(ptrs[i]->data[0], 42);
+        }
+        // Everything still handed out comes from the remaining slabs.
+        fl::vector<TestObject*> more;
+        for (int i = 0; i < 43; ++i) {
+            more.push_back(allocator.allocate());
+        }
+        CHECK_EQ(allocator.getSlabCount(), 6);
+        for (TestObject* p : more) {
+            allocator.deallocate(p);
+        }
+        for (size_t i = 0; i < ptrs.size(); i += 16) {
+            allocator.deallocate(ptrs[i]);
+        }
+        CHECK_EQ(allocator.getActiveAllocations(), 0);
+    }
+}
+
+namespace {
+// Its own type, so the test sees a shared pool no other test uses.
+struct SharedPoolObject {
+    int data[4];
+};
+} // namespace
+
+TEST_CASE("allocator_slab - cleanup() leaves the shared pool alone") {
+    typedef allocator_slab<SharedPoolObject, 8> Alloc;
+    Alloc a;
+    Alloc b;
+    fl::vector<SharedPoolObject*> ptrs;
+    for (int i = 0; i < 32; ++i) {
+        ptrs.push_back(a.allocate(1));
+    }
+    SharedPoolObject* kept = b.allocate(1);
+    for (SharedPoolObject* p : ptrs) {
+        a.deallocate(p, 1);
+    }
+    CHECK_EQ(Alloc::stats().slabCount, 5);
+
+    // What a container does when it is cleared or destroyed.
+    a.cleanup();
+    SlabAllocatorStats stats = Alloc::stats();
+    CHECK_EQ(stats.slabCount, 5);
+    CHECK_EQ(stats.merges, 0);
+    CHECK_EQ(stats.liveAllocations, 1);
+
+    // Releasing memory is the caller's explicit choice.
+    CHECK_EQ(Alloc::trim(), 3);
+    CHECK_EQ(Alloc::stats().slabCount, 2);
+    kept->data[0] = 7;
+    CHECK_EQ(kept->data[0], 7);
+    b.deallocate(kept, 1);
+}
+
+TEST_CASE("SlabAllocatorThreadSafe - Concurrent allocation") {
+    SlabAllocatorThreadSafe<TestObject, 8> allocator;
+    auto worker = [&allocator]() {
+        fl::vector<TestObject*> ptrs;
+        for (int round = 0; round < 50; ++round) {
+            for (int i = 0; i < 40; ++i) {
+                TestObject* p = allocator.allocate();
+                p->data[0] = i;
+                ptrs.push_back(p);
+            }
+            for (TestObject* p : ptrs) {
+                allocator.deallocate(p);
+            }
+            ptrs.clear();
+        }
+    };
+    std::thread a(worker);
+    std::thread b(worker);
+    a.join();
+    b.join();
+    CHECK_EQ(allocator.getActiveAllocations(), 0);
+    CHECK_EQ(allocator.getTotalAllocated(), 2 * 50 * 40);
+}
+
+namespace {
+
+// The SlabAllocator this one replaced, kept for the benchmark: one bitmap
+// per slab, searched with find_run() across every slab on allocate() and
+// deallocate().
+template <typename T, fl::size SLAB_SIZE> class BitmapSlabAllocator {
+  public:
+    BitmapSlabAllocator() = default;
+    BitmapSlabAllocator(const BitmapSlabAllocator &) = delete;
+    BitmapSlabAllocator &operator=(const BitmapSlabAllocator &) = delete;
+    ~BitmapSlabAllocator() {
+        while (mSlabs) {
+            Slab *next = mSlabs->next;
+            free(mSlabs->memory);
+            delete mSlabs;
+            mSlabs = next;
+        }
+    }
+
+    T *allocate(fl::size n = 1) {
+        for (Slab *slab = mSlabs; slab; slab = slab->next) {
+            if (void *ptr = take(slab, n)) {
+                return static_cast<T *>(ptr);
+            }
+        }
+        Slab *slab = new Slab();
+        slab->memory = static_cast<u8 *>(malloc(kBlockSize * SLAB_SIZE));
+        slab->next = mSlabs;
+        mSlabs = slab;
+        return static_cast<T *>(take(slab, n));
+    }
+
+    void deallocate(T *ptr, fl::size n = 1) {
+        u8 *block = reinterpret_cast<u8 *>(ptr);
+        for (Slab *slab = mSlabs; slab; slab = slab->next) {
+            if (block >= slab->memory && block < slab->memory + kBlockSize * SLAB_SIZE) {
+                const fl::size index = (block - slab->memory) / kBlockSize;
+                for (fl::size i = 0; i < n; ++i) {
+                    slab->used.set(static_cast<fl::u32>(index + i), false);
+                }
+                return;
+            }
+        }
+    }
+
+  private:
+    static constexpr fl::size kBlockSize = sizeof(T) > sizeof(void *) ? sizeof(T) : sizeof(void *);
+    struct Slab {
+        Slab *next = nullptr;
+        u8 *memory = nullptr;
+        fl::bitset_fixed<SLAB_SIZE> used;
+    };
+
+    static void *take(Slab *slab, fl::size n) {
+        const fl::i32 start = slab->used.find_run(false, static_cast<fl::u32>(n));
+        if (start < 0) {
+            return nullptr;
+        }
+        for (fl::size i = 0; i < n; ++i) {
+            slab->used.set(static_cast<fl::u32>(start + i), true);
+        }
+        void *ptr = slab->memory + static_cast<fl::size>(start) * kBlockSize;
+        fl::memfill(ptr, 0, sizeof(T) * n);
+        return ptr;
+    }
+
+    Slab *mSlabs = nullptr;
+};
+
+struct MallocAllocator {
+    TestObject *allocate() { return static_cast<TestObject *>(malloc(sizeof(TestObject))); }
+    void deallocate(TestObject *p) { free(p); }
+};
+
+// Keeps `live` objects allocated and then churns one free and one
+// allocation at a time, so the allocator has to find a hole among many
+// live slabs on every call. Returns microseconds.
+template <typename Allocator> long long churn_us(Allocator &allocator, size_t live) {
+    const size_t kChurn = 20000;
+    fl::vector<TestObject *> ptrs;
+    ptrs.reserve(live);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < live; ++i) {
+        ptrs.push_back(allocator.allocate());
+    }
+    for (size_t i = 0; i < kChurn; ++i) {
+        size_t idx = (i * 7919) % live;
+        allocator.deallocate(ptrs[idx]);
+        ptrs[idx] = allocator.allocate();
+    }
+    bool all_allocated = true;
+    for (TestObject *p : ptrs) {
+        all_allocated = all_allocated && p != nullptr;
+        allocator.deallocate(p);
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    CHECK(all_allocated);
+    return us;
+}
+
+} // namespace
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("SlabAllocator - Benchmark against the bitmap allocator and malloc" * doctest::skip()) {
+    const size_t counts[] = {64, 1024, 16384};
+    for (size_t live : counts) {
+        SlabAllocator<TestObject, 8> slab;
+        const long long slabUs = churn_us(slab, live);
+        CHECK_EQ(slab.getActiveAllocations(), 0);
+        BitmapSlabAllocator<TestObject, 8> bitmap;
+        const long long bitmapUs = churn_us(bitmap, live);
+        MallocAllocator heap;
+        const long long mallocUs = churn_us(heap, live);
+        MESSAGE(live << " live objects: slab " << slabUs << " us, bitmap slab "
+                     << bitmapUs << " us, malloc " << mallocUs << " us");
+    }
+}
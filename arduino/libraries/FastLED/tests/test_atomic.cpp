@@ -14,3 +14,40 @@ TEST_CASE("atomic") {
   atomic.store(3);
   REQUIRE(atomic.load() == 3);
 }
+
+TEST_CASE("atomic - memory orders and read-modify-write") {
+  fl::atomic<int> value(5);
+  value.store(7, fl::memory_order_release);
+  REQUIRE(value.load(fl::memory_order_acquire) == 7);
+  REQUIRE(value.fetch_add(3, fl::memory_order_relaxed) == 7);
+  REQUIRE(value.exchange(1) == 10);
+  int expected = 2;
+  REQUIRE_FALSE(value.compare_exchange_strong(expected, 3));
+  REQUIRE(expected == 1);
+  REQUIRE(value.compare_exchange_strong(expected, 3));
+  REQUIRE(value.load() == 3);
+}
+
+#if FL_HAS_ATOMIC_BUILTINS
+TEST_CASE("AtomicBuiltin") {
+  fl::AtomicBuiltin<fl::u32> value(1);
+  REQUIRE(++value == 2);
+  REQUIRE(value++ == 2);
+  REQUIRE((value += 10) == 13);
+  REQUIRE((value -= 3) == 10);
+  REQUIRE(value.fetch_or(0x100) == 10);
+  REQUIRE((value &= 0xF00) == 0x100);
+  fl::u32 expected = 0x100;
+  // The weak form may fail spuriously.
+  while (!value.compare_exchange_weak(expected, 5, fl::memory_order_acq_rel)) {
+    REQUIRE(expected == 0x100);
+  }
+  REQUIRE(value.load(fl::memory_order_acquire) == 5);
+
+  int a = 0;
+  int b = 0;
+  fl::AtomicBuiltin<int*> ptr(&a);
+  REQUIRE(ptr.exchange(&b) == &a);
+  REQUIRE(ptr.load() == &b);
+}
+#endif
@@ -0,0 +1,145 @@
+// Unit tests for fl::AudioAnalyzer, the streaming overlapped-window analyser
+
+#include "test.h"
+
+#include "fl/allocator.h"
+#include "fl/audio_analyzer.h"
+#include "fl/fft_impl.h"
+#include "fl/math_macros.h"
+#include "fl/vector.h"
+#include <math.h>
+
+using namespace fl;
+
+namespace {
+
+fl::vector<i16> make_sine(fl::size n, float hz, int sample_rate, float amplitude = 12000.0f) {
+    fl::vector<i16> out;
+    out.reserve(n);
+    for (fl::size i = 0; i < n; ++i) {
+        const float phase = 2.0f * float(PI) * hz * float(i) / float(sample_rate);
+        out.push_back(static_cast<i16>(amplitude * sinf(phase)));
+    }
+    return out;
+}
+
+int loudest_band(const fl::vector<float> &bins) {
+    int best = 0;
+    for (fl::size i = 1; i < bins.size(); ++i) {
+        if (bins[i] > bins[best]) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+TEST_CASE("AudioAnalyzer - frames fire at the hop rate") {
+    const fl::vector<i16> pcm = make_sine(4096, 1000.0f, 44100);
+    // 512 window at a 256 hop: one frame once the window fills, then one per
+    // hop.
+    const u32 expected = 1 + (4096 - 512) / 256;
+
+    const fl::size block_sizes[] = {1, 37, 256, 512, 1000, 4096};
+    fl::vector<float> reference;
+    for (fl::size block : block_sizes) {
+        AudioAnalyzer analyzer;
+        u32 callbacks = 0;
+        analyzer.onFrame([&callbacks](const AudioAnalysisFrame &) { ++callbacks; });
+        fl::size frames = 0;
+        for (fl::size pos = 0; pos < pcm.size(); pos += block) {
+            const fl::size n = pcm.size() - pos < block ? pcm.size() - pos : block;
+            frames += analyzer.feed(fl::span<const i16>(pcm.data() + pos, n), 0);
+        }
+        CHECK_EQ(frames, expected);
+        CHECK_EQ(callbacks, expected);
+        CHECK_EQ(analyzer.frameCount(), expected);
+        const AudioAnalysisFrame &frame = analyzer.latest();
+        CHECK_EQ(frame.sequence, expected);
+        REQUIRE_EQ(frame.bins.size(), 16u);
+        // Same windows, so the same result whatever the block size.
+        if (reference.empty()) {
+            reference = frame.bins;
+        }
+        for (fl::size i = 0; i < reference.size(); ++i) {
+            CHECK_EQ(frame.bins[i], reference[i]);
+        }
+    }
+}
+
+TEST_CASE("AudioAnalyzer - overlap and window options") {
+    const fl::vector<i16> pcm = make_sine(4096, 1000.0f, 44100);
+    AudioAnalyzerConfig config;
+    config.hopSize = 128; // 75% overlap
+    AudioAnalyzer quarter(config);
+    CHECK_EQ(quarter.feed(pcm, 0), 1u + (4096 - 512) / 128);
+
+    config.hopSize = 512; // back to back
+    config.window = AudioAnalyzerConfig::kRectangular;
+    AudioAnalyzer rect(config);
+    CHECK_EQ(rect.feed(pcm, 0), 4096u / 512);
+
+    // Without a taper a window is the plain FFT of the same samples.
+    FFTImpl fft(FFT_Args(512));
+    FFTBins bins(16);
+    fft.run(fl::span<const i16>(pcm.data() + 4096 - 512, 512), &bins);
+    const AudioAnalysisFrame &frame = rect.latest();
+    for (fl::size i = 0; i < 16; ++i) {
+        CHECK_EQ(frame.bins[i], bins.bins_raw[i]);
+    }
+
+    // Hann tapering keeps the tone in the same band.
+    CHECK_EQ(loudest_band(quarter.latest().bins), loudest_band(frame.bins));
+
+    config.hopSize = 0;
+    AudioAnalyzer fixed(config);
+    CHECK_EQ(fixed.config().hopSize, 256);
+}
+
+TEST_CASE("AudioAnalyzer - latest frame and timestamps") {
+    AudioAnalyzer analyzer;
+    CHECK_EQ(analyzer.latest().sequence, 0u);
+
+    const fl::vector<i16> pcm = make_sine(1024, 440.0f, 44100);
+    CHECK_EQ(analyzer.feed(fl::span<const i16>(pcm.data(), 511), 1000), 0u);
+    CHECK_EQ(analyzer.latest().sequence, 0u);
+    // The window completes with the first sample of this block.
+    CHECK_EQ(analyzer.feed(fl::span<const i16>(pcm.data() + 511, 200), 1011), 1u);
+    const AudioAnalysisFrame &first = analyzer.latest();
+    CHECK_EQ(first.sequence, 1u);
+    CHECK_EQ(first.timestamp, 1011u);
+    CHECK_GT(first.rms, 1000.0f);
+    CHECK_LE(first.peak, 12000.0f);
+    CHECK_GT(first.peak, 11000.0f);
+
+    // The next hop ends 57 samples into the following block.
+    CHECK_EQ(analyzer.feed(fl::span<const i16>(pcm.data() + 711, 100), 2000), 1u);
+    CHECK_EQ(analyzer.latest().sequence, 2u);
+    CHECK_EQ(analyzer.latest().timestamp, 2000u + 56 * 1000 / 44100);
+
+    // reset() waits for a whole new window.
+    analyzer.reset();
+    CHECK_EQ(analyzer.feed(fl::span<const i16>(pcm.data(), 511), 0), 0u);
+    CHECK_EQ(analyzer.feed(fl::span<const i16>(pcm.data(), 1), 0), 1u);
+}
+
+TEST_CASE("AudioAnalyzer - analysis does not allocate") {
+    AudioAnalyzer analyzer;
+    const fl::vector<i16> pcm = make_sine(2048, 2000.0f, 44100);
+    analyzer.feed(pcm, 0);
+
+    CountingMallocHook hook;
+    SetMallocFreeHook(&hook);
+    const fl::size frames = analyzer.feed(pcm, 0);
+    analyzer.latest();
+    ClearMallocFreeHook();
+    CHECK_EQ(frames, 8u);
+    CHECK_EQ(hook.mallocs, 0);
+
+    // Whereas configuring does, which shows the hook sees the buffers.
+    SetMallocFreeHook(&hook);
+    analyzer.configure(analyzer.config());
+    ClearMallocFreeHook();
+    CHECK_GT(hook.mallocs, 0);
+}
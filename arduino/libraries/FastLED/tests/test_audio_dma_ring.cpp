@@ -0,0 +1,177 @@
+// Unit tests for fl::AudioDmaRing with a simulated DMA producer
+
+#include "test.h"
+
+#include "fl/audio_dma_ring.h"
+
+#if FASTLED_MULTITHREADED
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace fl;
+
+namespace {
+
+// Stands in for the I2S driver: fills the next free buffer with a ramp
+// starting at `first`. Returns false if no buffer was free.
+bool dma_fill(AudioDmaRing &ring, i16 first, fl::size count, u32 timestamp) {
+    fl::span<i16> buf = ring.acquire();
+    if (buf.empty()) {
+        return false;
+    }
+    for (fl::size i = 0; i < count && i < buf.size(); ++i) {
+        buf[i] = i16(first + i16(i));
+    }
+    ring.commit(count, timestamp);
+    return true;
+}
+
+bool points_into(const AudioSample &sample, const AudioDmaRing &ring,
+                 const i16 *base) {
+    const i16 *p = sample.pcm().data();
+    return p >= base && p < base + ring.bufferCount() * ring.samplesPerBuffer();
+}
+
+} // namespace
+
+TEST_CASE("AudioDmaRing - samples use the buffers in place") {
+    AudioDmaRing ring(4, 64);
+    CHECK_EQ(ring.bufferCount(), 4u);
+    CHECK_EQ(ring.samplesPerBuffer(), 64u);
+    CHECK_EQ(ring.available(), 4u);
+    CHECK_FALSE(ring.pop().isValid());
+
+    const i16 *base = ring.acquire().data();
+    ring.commit(0, 0); // nothing read, buffer goes straight back
+    CHECK_EQ(ring.available(), 4u);
+    CHECK_EQ(ring.ready(), 0u);
+
+    REQUIRE(dma_fill(ring, 100, 48, 7));
+    CHECK_EQ(ring.ready(), 1u);
+    CHECK_EQ(ring.available(), 3u);
+    {
+        AudioSample sample = ring.pop();
+        REQUIRE(sample.isValid());
+        CHECK(points_into(sample, ring, base));
+        CHECK_EQ(sample.size(), 48u);
+        CHECK_EQ(sample.timestamp(), 7u);
+        CHECK_EQ(sample[0], 100);
+        CHECK_EQ(sample[47], 147);
+        CHECK_EQ(sample.stats().peak, 147);
+        CHECK_EQ(ring.available(), 3u);
+
+        // Copies share the buffer; it is returned after the last one goes.
+        AudioSample copy = sample;
+        sample = AudioSample();
+        CHECK_EQ(ring.available(), 3u);
+        CHECK_EQ(copy[1], 101);
+    }
+    CHECK_EQ(ring.available(), 4u);
+
+    // A sample built the usual way still owns a copy.
+    fl::vector<i16> data(16, 5);
+    AudioSample owned(data);
+    data[0] = 9;
+    CHECK_EQ(owned[0], 5);
+}
+
+TEST_CASE("AudioDmaRing - overrun while the reader holds every buffer") {
+    AudioDmaRing ring(3, 32);
+    fl::vector<AudioSample> held;
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(dma_fill(ring, i16(i * 1000), 32, u32(i)));
+        held.push_back(ring.pop());
+    }
+    CHECK_EQ(ring.available(), 0u);
+    CHECK_FALSE(dma_fill(ring, 0, 32, 3));
+    CHECK_FALSE(dma_fill(ring, 0, 32, 4));
+    CHECK_EQ(ring.overruns(), 2u);
+    // Held audio was not overwritten.
+    CHECK_EQ(held[0][0], 0);
+    CHECK_EQ(held[1][0], 1000);
+    CHECK_EQ(held[2][0], 2000);
+
+    held.erase(held.begin() + 1);
+    CHECK_EQ(ring.available(), 1u);
+    REQUIRE(dma_fill(ring, 7, 32, 5));
+    AudioSample next = ring.pop();
+    CHECK_EQ(next[0], 7);
+    CHECK_EQ(held[0][0], 0);
+    CHECK_EQ(held[1][0], 2000);
+}
+
+TEST_CASE("AudioDmaRing - published order and samples outliving the ring") {
+    AudioSample survivor;
+    {
+        AudioDmaRing ring(4, 16);
+        REQUIRE(dma_fill(ring, 1, 16, 10));
+        REQUIRE(dma_fill(ring, 2, 8, 20));
+        REQUIRE(dma_fill(ring, 3, 99, 30)); // count clamped to the buffer
+        CHECK_EQ(ring.ready(), 3u);
+        CHECK_EQ(ring.pop().timestamp(), 10u);
+        AudioSample second = ring.pop();
+        CHECK_EQ(second.timestamp(), 20u);
+        CHECK_EQ(second.size(), 8u);
+        survivor = ring.pop();
+        CHECK_EQ(survivor.size(), 16u);
+        CHECK_EQ(ring.available(), 2u);
+    }
+    CHECK_EQ(survivor[0], 3);
+    CHECK_EQ(survivor[15], 18);
+    survivor = AudioSample();
+}
+
+#if FASTLED_MULTITHREADED
+
+namespace {
+
+const int kBlocks = 20000;
+
+struct StressState {
+    AudioDmaRing ring{4, 32};
+    int produced = 0;
+};
+
+void *dma_task(void *arg) {
+    StressState *state = static_cast<StressState *>(arg);
+    while (state->produced < kBlocks) {
+        if (dma_fill(state->ring, i16(state->produced), 32, u32(state->produced))) {
+            ++state->produced;
+        } else {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("AudioDmaRing - producer and consumer threads") {
+    StressState state;
+    pthread_t producer;
+    REQUIRE_EQ(pthread_create(&producer, nullptr, dma_task, &state), 0);
+
+    int expected = 0;
+    bool intact = true;
+    AudioSample previous; // hold one block back, as a reader might
+    while (expected < kBlocks) {
+        AudioSample sample = state.ring.pop();
+        if (!sample.isValid()) {
+            continue;
+        }
+        intact = intact && sample.timestamp() == u32(expected) &&
+                 sample[0] == i16(expected) && sample[31] == i16(expected + 31);
+        if (previous.isValid()) {
+            intact = intact && previous[0] == i16(expected - 1);
+        }
+        previous = sample;
+        ++expected;
+    }
+    pthread_join(producer, nullptr);
+    CHECK(intact);
+    previous = AudioSample();
+    CHECK_EQ(state.ring.available(), 4u);
+}
+
+#endif // FASTLED_MULTITHREADED
@@ -0,0 +1,458 @@
+// Unit tests for the file and synthetic audio inputs and AudioBench
+
+#include "test.h"
+
+#include "FastLED.h"
+#include "fl/audio_bench.h"
+#include "fl/audio_input_stream.h"
+#include "fl/time.h"
+#include "platforms/stub/time_stub.h"
+#include "fl/vector.h"
+#include <chrono> // ok include
+
+using namespace fl;
+
+namespace {
+
+fl::vector<i16> read_all(PcmStreamInput &input, fl::vector<u32> *timestamps = nullptr) {
+    fl::vector<i16> out;
+    input.start();
+    while (true) {
+        AudioSample sample = input.read();
+        if (!sample.isValid()) {
+            break;
+        }
+        for (i16 s : sample.pcm()) {
+            out.push_back(s);
+        }
+        if (timestamps) {
+            timestamps->push_back(sample.timestamp());
+        }
+    }
+    return out;
+}
+
+u32 crossings(const i16 *p, fl::size n) {
+    return AudioStats::compute(fl::span<const i16>(p, n)).zeroCrossings;
+}
+
+void put16(fl::vector<u8> *out, u32 v) {
+    out->push_back(u8(v));
+    out->push_back(u8(v >> 8));
+}
+
+void put32(fl::vector<u8> *out, u32 v) {
+    put16(out, v & 0xffff);
+    put16(out, v >> 16);
+}
+
+void put_tag(fl::vector<u8> *out, const char *tag) {
+    for (int i = 0; i < 4; ++i) {
+        out->push_back(u8(tag[i]));
+    }
+}
+
+// A WAV with an odd sized chunk before the data, as some editors write.
+fl::vector<u8> make_wav(u16 format, u16 channels, u32 rate, u16 bits,
+                        const fl::vector<u8> &data) {
+    fl::vector<u8> out;
+    put_tag(&out, "RIFF");
+    put32(&out, 0); // not checked
+    put_tag(&out, "WAVE");
+    put_tag(&out, "fmt ");
+    put32(&out, 16);
+    put16(&out, format);
+    put16(&out, channels);
+    put32(&out, rate);
+    put32(&out, rate * channels * bits / 8);
+    put16(&out, channels * bits / 8);
+    put16(&out, bits);
+    put_tag(&out, "LIST");
+    put32(&out, 3);
+    out.push_back('a');
+    out.push_back('b');
+    out.push_back('c');
+    out.push_back(0); // pad
+    put_tag(&out, "data");
+    put32(&out, u32(data.size()));
+    for (u8 b : data) {
+        out.push_back(b);
+    }
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("SynthAudioInput - blocks, length and timestamps") {
+    u32 now = 1000;
+    fl::inject_time_provider([&now]() { return now; });
+
+    SynthAudioConfig config;
+    config.sampleRate = 8000;
+    config.blockSize = 256;
+    config.seconds = 0.1f; // 800 samples: three full blocks and 32 more
+    SynthAudioInput input(config);
+    CHECK_FALSE(input.read().isValid()); // not started
+
+    fl::vector<u32> timestamps;
+    const fl::vector<i16> pcm = read_all(input, &timestamps);
+    CHECK_EQ(pcm.size(), 800u);
+    CHECK(input.finished());
+    REQUIRE_EQ(timestamps.size(), 4u);
+    CHECK_EQ(timestamps[0], 1000u); // 256 samples = 32 ms
+    CHECK_EQ(timestamps[1], 1032u);
+    CHECK_EQ(timestamps[2], 1064u);
+    CHECK_EQ(timestamps[3], 1096u);
+
+    // Deterministic, and start() begins again.
+    SynthAudioInput again(config);
+    CHECK(read_all(again) == pcm);
+    CHECK(read_all(input) == pcm);
+    CHECK_FALSE(input.error());
+    fl::clear_time_provider();
+}
+
+TEST_CASE("SynthAudioInput - signals") {
+    SynthAudioConfig config;
+    config.sampleRate = 44100;
+    config.seconds = 1.0f;
+    config.frequency = 1000.0f;
+    config.amplitude = 0.5f;
+
+    SynthAudioInput sine(config);
+    fl::vector<i16> pcm = read_all(sine);
+    REQUIRE_EQ(pcm.size(), 44100u);
+    const AudioStats stats = AudioStats::compute(pcm);
+    CHECK(stats.zeroCrossings >= 1998u);
+    CHECK(stats.zeroCrossings <= 2001u);
+    CHECK(stats.peak >= 16380);
+    CHECK(stats.peak <= 16384);
+    CHECK(stats.rms() == doctest::Approx(16383.5f / 1.41421f).epsilon(0.01));
+
+    config.signal = SynthAudioConfig::kSweep;
+    config.frequency = 100.0f;
+    config.endFrequency = 10000.0f;
+    config.sweepSeconds = 1.0f;
+    SynthAudioInput sweep(config);
+    pcm = read_all(sweep);
+    // Rising pitch: more crossings in every later tenth.
+    u32 prev = 0;
+    for (int part = 0; part < 10; ++part) {
+        const u32 c = crossings(pcm.data() + part * 4410, 4410);
+        CHECK(c > prev);
+        prev = c;
+    }
+
+    config.signal = SynthAudioConfig::kClicks;
+    config.bpm = 120.0f;
+    SynthAudioInput clicks(config);
+    pcm = read_all(clicks);
+    // Two beats, at 0 and 0.5 s, and silence in between.
+    CHECK(AudioStats::compute(fl::span<const i16>(pcm.data(), 441)).peak > 5000);
+    CHECK(AudioStats::compute(fl::span<const i16>(pcm.data() + 22050, 441)).peak > 5000);
+    CHECK_EQ(AudioStats::compute(fl::span<const i16>(pcm.data() + 1000, 21000)).peak, 0);
+
+    config.signal = SynthAudioConfig::kPinkNoise;
+    SynthAudioInput pink(config);
+    pcm = read_all(pink);
+    const AudioStats noise = AudioStats::compute(pcm);
+    CHECK(noise.rms() > 1000.0f);
+    CHECK(noise.rms() < 12000.0f);
+    // Weighted to low frequencies: far fewer crossings than white noise,
+    // which crosses about every other sample.
+    CHECK(noise.zcf() < 0.25f);
+
+    config.signal = SynthAudioConfig::kSilence;
+    SynthAudioInput silence(config);
+    CHECK_EQ(AudioStats::compute(read_all(silence)).peak, 0);
+}
+
+TEST_CASE("PcmStreamInput - real time pacing") {
+    u32 now = 0;
+    fl::inject_time_provider([&now]() { return now; });
+    SynthAudioConfig config;
+    config.sampleRate = 16000;
+    config.blockSize = 160; // 10 ms
+    config.realTime = true;
+    SynthAudioInput input(config);
+    input.start();
+    CHECK_FALSE(input.read().isValid());
+    now = 9;
+    CHECK_FALSE(input.read().isValid());
+    now = 10;
+    AudioSample first = input.read();
+    REQUIRE(first.isValid());
+    CHECK_EQ(first.timestamp(), 0u);
+    CHECK_FALSE(input.read().isValid());
+    // Late reads catch up one block at a time with exact timestamps.
+    now = 35;
+    CHECK_EQ(input.read().timestamp(), 10u);
+    CHECK_EQ(input.read().timestamp(), 20u);
+    CHECK_FALSE(input.read().isValid());
+    fl::clear_time_provider();
+}
+
+TEST_CASE("PcmFileInput - wav and raw") {
+    // Stereo 16 bit, left and right averaged.
+    fl::vector<u8> data;
+    for (int i = 0; i < 300; ++i) {
+        put16(&data, u16(i16(i * 100)));
+        put16(&data, u16(i16(-i * 20)));
+    }
+    const fl::vector<u8> wav = make_wav(1, 2, 22050, 16, data);
+    PcmFileConfig config;
+    config.blockSize = 128;
+    fl::string error;
+    fl::shared_ptr<PcmFileInput> input = PcmFileInput::open(wav, config, &error);
+    REQUIRE(input);
+    CHECK(error.empty());
+    CHECK_EQ(input->sampleRate(), 22050);
+    CHECK_EQ(input->channels(), 2);
+    CHECK_EQ(input->frames(), 300u);
+    fl::vector<i16> pcm = read_all(*input);
+    REQUIRE_EQ(pcm.size(), 300u);
+    for (int i = 0; i < 300; ++i) {
+        CHECK_EQ(pcm[i], i16(i * 40));
+    }
+
+    // Looping keeps going past the end.
+    config.loop = true;
+    input = PcmFileInput::open(wav, config);
+    input->start();
+    for (int i = 0; i < 5; ++i) {
+        CHECK_EQ(input->read().size(), 128u);
+    }
+    CHECK_FALSE(input->finished());
+
+    // 8 bit unsigned mono.
+    fl::vector<u8> bytes;
+    bytes.push_back(0);
+    bytes.push_back(128);
+    bytes.push_back(255);
+    input = PcmFileInput::open(make_wav(1, 1, 8000, 8, bytes));
+    REQUIRE(input);
+    pcm = read_all(*input);
+    REQUIRE_EQ(pcm.size(), 3u);
+    CHECK_EQ(pcm[0], -32768);
+    CHECK_EQ(pcm[1], 0);
+    CHECK_EQ(pcm[2], 32512);
+
+    // Float WAVs are rejected.
+    CHECK_FALSE(PcmFileInput::open(make_wav(3, 1, 8000, 32, bytes), PcmFileConfig(), &error));
+    CHECK_FALSE(error.empty());
+
+    // No header: raw 16 bit mono at the configured rate.
+    fl::vector<u8> raw;
+    put16(&raw, 1234);
+    put16(&raw, u16(i16(-5)));
+    raw.push_back(7); // odd trailing byte is ignored
+    config = PcmFileConfig();
+    config.rawSampleRate = 16000;
+    input = PcmFileInput::open(raw, config);
+    REQUIRE(input);
+    CHECK_EQ(input->sampleRate(), 16000);
+    pcm = read_all(*input);
+    REQUIRE_EQ(pcm.size(), 2u);
+    CHECK_EQ(pcm[0], 1234);
+    CHECK_EQ(pcm[1], -5);
+}
+
+namespace {
+
+AudioBench::Clock steady_micros() {
+    using clock = std::chrono::steady_clock;
+    const clock::time_point origin = clock::now();
+    return [origin]() {
+        return u64(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - origin).count());
+    };
+}
+
+const char *const kBenchSignalNames[] = {"clicks", "sweep", "pink"};
+const SynthAudioConfig::Signal kBenchSignals[] = {SynthAudioConfig::kClicks,
+                                                  SynthAudioConfig::kSweep,
+                                                  SynthAudioConfig::kPinkNoise};
+
+// Five seconds of `signal` through AudioReactive and a 256 LED effect.
+AudioBenchReport run_effect_bench(SynthAudioConfig::Signal signal, bool streaming) {
+    CRGB leds[256];
+    AudioBench::Effect effect = [&leds](const AudioReactive &audio) {
+        const AudioData &data = audio.getSmoothedData();
+        for (int i = 0; i < 256; ++i) {
+            const float bin = data.frequencyBins[i & 15];
+            leds[i] = CHSV(u8(i + bin), 255, u8(bin > 255.0f ? 255.0f : bin));
+        }
+        if (data.beatDetected) {
+            fill_solid(leds, 16, CRGB::White);
+        }
+    };
+
+    SynthAudioConfig synth;
+    synth.signal = signal;
+    synth.sampleRate = 22050;
+    synth.seconds = 5.0f;
+    SynthAudioInput input(synth);
+
+    AudioReactive audio;
+    AudioReactiveConfig config;
+    config.sampleRate = 22050;
+    if (streaming) {
+        config.fftSize = 512;
+        config.hopSize = 256;
+    }
+    audio.begin(config);
+
+    AudioBench bench(input, audio, steady_micros());
+    bench.setEffect(effect);
+    return bench.run();
+}
+
+// Fails before handing out any audio, like a file in an unsupported format.
+class BrokenInput : public PcmStreamInput {
+  public:
+    BrokenInput() : PcmStreamInput(8000, 64, false) { setError("unsupported format"); }
+
+  protected:
+    fl::size generate(fl::i16 *dst, fl::size n) override {
+        for (fl::size i = 0; i < n; ++i) {
+            dst[i] = 0;
+        }
+        return n;
+    }
+};
+
+} // namespace
+
+TEST_CASE("AudioBench - AudioReactive and an effect end to end") {
+    for (int s = 0; s < 3; ++s) {
+        for (int streaming = 0; streaming < 2; ++streaming) {
+            INFO(kBenchSignalNames[s] << (streaming ? " streaming" : " per block"));
+            const AudioBenchReport report = run_effect_bench(kBenchSignals[s], streaming != 0);
+            CHECK(report.audioSeconds == doctest::Approx(5.0f));
+            CHECK_EQ(report.blocks, (5 * 22050 + 511) / 512);
+            CHECK(report.maxBlockUs >= u32(report.meanBlockUs));
+            CHECK(report.error.empty());
+        }
+    }
+
+    // A time limit stops an endless input.
+    SynthAudioInput endless;
+    AudioReactive audio;
+    audio.begin();
+    AudioBench bench(endless, audio, steady_micros());
+    const AudioBenchReport report = bench.run(0.5f);
+    CHECK(report.audioSeconds >= 0.5f);
+    CHECK(report.audioSeconds < 0.52f);
+}
+
+TEST_CASE("AudioBench - a failed input ends the run") {
+    BrokenInput input;
+    AudioReactive audio;
+    audio.begin();
+    AudioBench bench(input, audio);
+    const AudioBenchReport report = bench.run(1.0f);
+    CHECK_EQ(report.blocks, 0u);
+    CHECK_EQ(report.error, "unsupported format");
+}
+
+TEST_CASE("AudioBench - real time input sleeps between blocks") {
+    u32 now = 0;
+    fl::inject_time_provider([&now]() { return now; });
+    int sleeps = 0;
+    setDelayFunction([&now, &sleeps](u32 ms) {
+        now += ms;
+        ++sleeps;
+    });
+
+    SynthAudioConfig synth;
+    synth.sampleRate = 16000;
+    synth.blockSize = 160; // 10 ms
+    synth.seconds = 1.0f;
+    synth.realTime = true;
+    SynthAudioInput input(synth);
+    AudioReactive audio;
+    AudioReactiveConfig config;
+    config.sampleRate = 16000;
+    audio.begin(config);
+    AudioBench bench(input, audio);
+    const AudioBenchReport report = bench.run();
+    CHECK_EQ(report.blocks, 100u);
+    // One sleep until each block is due, not a spin, plus the wait for
+    // the block after the last that finds the end of the stream.
+    CHECK_EQ(sleeps, 101);
+    CHECK_EQ(now, 1010u);
+
+    setDelayFunction(fl::function<void(u32)>());
+    fl::clear_time_provider();
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("AudioBench - AudioReactive and an effect, timing" * doctest::skip()) {
+    for (int s = 0; s < 3; ++s) {
+        for (int streaming = 0; streaming < 2; ++streaming) {
+            const AudioBenchReport report = run_effect_bench(kBenchSignals[s], streaming != 0);
+            fl::StrStream line;
+            line << kBenchSignalNames[s] << (streaming ? " streaming" : " per block") << ": "
+                 << report.cpuMsPerAudioSecond() << " ms cpu per audio second ("
+                 << report.cpuPercent() << "%), per block mean "
+                 << report.meanBlockUs << " us max " << report.maxBlockUs << " us";
+            MESSAGE(line.str());
+        }
+    }
+}
+
+namespace {
+
+const char *const kStageBenchNames[] = {"all", "volume", "bins", "beat", "tempo"};
+const u32 kStageBenchFeatures[] = {kAudioAllFeatures, kAudioVolume, kAudioFrequencyBins,
+                                   kAudioBeat, kAudioTempo};
+
+// Five seconds of pink noise, streaming, with one subscription.
+AudioBenchReport run_stage_bench(u32 features) {
+    SynthAudioConfig synth;
+    synth.signal = SynthAudioConfig::kPinkNoise;
+    synth.sampleRate = 22050;
+    synth.seconds = 5.0f;
+    SynthAudioInput input(synth);
+
+    AudioReactive audio;
+    AudioReactiveConfig config;
+    config.sampleRate = 22050;
+    config.fftSize = 512;
+    config.hopSize = 256;
+    audio.begin(config);
+    audio.subscribe(features);
+
+    AudioBench bench(input, audio, steady_micros());
+    return bench.run();
+}
+
+} // namespace
+
+TEST_CASE("AudioBench - stages run by subscription") {
+    for (int f = 0; f < 5; ++f) {
+        INFO(kStageBenchNames[f]);
+        const AudioBenchReport report = run_stage_bench(kStageBenchFeatures[f]);
+        CHECK_EQ(report.blocks, (5 * 22050 + 511) / 512);
+        const bool fft = report.stages.runs[kAudioStageSpectrum] > 0;
+        CHECK_EQ(fft, kStageBenchFeatures[f] != kAudioVolume);
+        // Spectral flux onsets are part of the beat.
+        const bool flux = report.stages.runs[kAudioStageSpectralFlux] > 0;
+        CHECK_EQ(flux, (kStageBenchFeatures[f] & (kAudioBeat | kAudioTempo)) != 0);
+    }
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("AudioBench - cost per stage by subscription" * doctest::skip()) {
+    for (int f = 0; f < 5; ++f) {
+        const AudioBenchReport report = run_stage_bench(kStageBenchFeatures[f]);
+        fl::StrStream line;
+        line << kStageBenchNames[f] << ": " << report.cpuMsPerAudioSecond() << " ms cpu per audio second";
+        for (int stage = 0; stage < kAudioStageCount; ++stage) {
+            if (report.stages.runs[stage]) {
+                line << ", " << AudioStageProfile::name(static_cast<AudioStage>(stage))
+                     << " " << float(report.stages.us[stage]) / 1000.0f / report.audioSeconds;
+            }
+        }
+        MESSAGE(line.str());
+    }
+}
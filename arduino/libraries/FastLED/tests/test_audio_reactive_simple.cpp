@@ -298,6 +298,215 @@ TEST_CASE("AudioReactive configuration validation") {
     CHECK_FALSE(audio.isTrebleBeat());
 }
 
+TEST_CASE("AudioReactive streaming analysis") {
+    AudioReactive audio;
+    AudioReactiveConfig config;
+    config.sampleRate = 22050;
+    config.agcEnabled = false;
+    config.fftSize = 512;   // 50% overlap by default
+    audio.begin(config);
+    REQUIRE(audio.getAnalyzer() != nullptr);
+    CHECK_EQ(audio.getAnalyzer()->config().hopSize, 256);
+
+    // Blocks of 100 samples, 10 ms apart: results follow the 256 sample hop,
+    // not the block size.
+    fl::vector<int16_t> block(100);
+    int n = 0;
+    for (int b = 0; b < 30; ++b) {
+        for (int i = 0; i < 100; ++i, ++n) {
+            float phase = 2.0f * M_PI * 1000.0f * n / 22050.0f;
+            block[i] = static_cast<int16_t>(8000.0f * sinf(phase));
+        }
+        AudioSample sample(block, 1000 + b * 10);
+        audio.processSample(sample);
+        if (b == 4) {
+            // 500 samples buffered, the first window is not full yet.
+            CHECK_EQ(audio.getAnalyzer()->frameCount(), 0u);
+            CHECK_EQ(audio.getVolume(), 0.0f);
+        }
+    }
+    CHECK_EQ(audio.getAnalyzer()->frameCount(), 1u + (3000 - 512) / 256);
+    CHECK(audio.getVolume() > 0.0f);
+    CHECK_EQ(audio.getData().timestamp, audio.getAnalyzer()->latest().timestamp);
+
+    // Back to one FFT per sample.
+    config.fftSize = 0;
+    audio.begin(config);
+    CHECK(audio.getAnalyzer() == nullptr);
+}
+
+namespace {
+
+fl::vector<int16_t> sine_block(int offset, fl::size n) {
+    fl::vector<int16_t> block(n);
+    for (fl::size i = 0; i < n; ++i) {
+        float phase = 2.0f * M_PI * 1000.0f * (offset + i) / 22050.0f;
+        block[i] = static_cast<int16_t>(8000.0f * sinf(phase));
+    }
+    return block;
+}
+
+// Two loud noise blocks out of every eleven over a quiet tone, so beats,
+// band beats and a tempo come out of the analysis.
+fl::vector<int16_t> pulse_block(int b, fl::size n) {
+    fl::vector<int16_t> block = sine_block(b * int(n), n);
+    const bool loud = b % 11 < 2;
+    fl::u32 seed = fl::u32(b) * 2654435761u + 1;
+    for (fl::size i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const int noise = int(seed >> 20) - 2048;
+        const int v = block[i] / 8 + (loud ? noise * 6 : noise / 4);
+        block[i] = static_cast<int16_t>(v);
+    }
+    return block;
+}
+
+} // namespace
+
+TEST_CASE("AudioReactive feature subscriptions") {
+    AudioReactive audio;
+    AudioReactiveConfig config;
+    config.sampleRate = 22050;
+    config.fftSize = 512;
+    audio.begin(config);
+
+    // Without subscriptions everything runs.
+    CHECK_EQ(audio.getFeatures(), static_cast<fl::u32>(kAudioAllFeatures));
+    for (int stage = 0; stage < kAudioStageCount; ++stage) {
+        CHECK(audio.runsStage(static_cast<AudioStage>(stage)));
+    }
+
+    // Volume only: no FFT, not even the streaming analyser.
+    const fl::u32 volume = audio.subscribe(kAudioVolume);
+    CHECK_FALSE(audio.runsStage(kAudioStageSpectrum));
+    CHECK_FALSE(audio.runsStage(kAudioStageWeighting));
+    CHECK(audio.runsStage(kAudioStageVolume));
+    for (int b = 0; b < 10; ++b) {
+        audio.processSample(AudioSample(sine_block(b * 512, 512), b * 23));
+    }
+    CHECK_EQ(audio.getAnalyzer()->frameCount(), 0u);
+    CHECK(audio.getVolume() > 0.0f);
+    for (int i = 0; i < 16; ++i) {
+        CHECK_EQ(audio.getData().frequencyBins[i], 0.0f);
+    }
+
+    // Subscriptions add up and can be dropped independently.
+    const fl::u32 tempo = audio.subscribe(kAudioTempo);
+    CHECK_EQ(audio.getFeatures(), static_cast<fl::u32>(kAudioVolume | kAudioTempo));
+    CHECK(audio.runsStage(kAudioStageSpectrum));
+    CHECK(audio.runsStage(kAudioStageSpectralFlux));
+    CHECK(audio.runsStage(kAudioStageTempo));
+    CHECK_FALSE(audio.runsStage(kAudioStageScaling));
+    CHECK_FALSE(audio.runsStage(kAudioStageBeat));
+    audio.unsubscribe(tempo);
+    CHECK_FALSE(audio.runsStage(kAudioStageSpectrum));
+    audio.unsubscribe(volume);
+    CHECK_EQ(audio.getFeatures(), static_cast<fl::u32>(kAudioAllFeatures));
+
+    // Beats from spectral flux need the spectrum, plain volume beats do not.
+    const fl::u32 beat = audio.subscribe(kAudioBeat);
+    CHECK(audio.runsStage(kAudioStageSpectrum));
+    config.enableSpectralFlux = false;
+    audio.setConfig(config);
+    CHECK_FALSE(audio.runsStage(kAudioStageSpectrum));
+    CHECK(audio.runsStage(kAudioStageBeat));
+    audio.unsubscribe(beat);
+}
+
+TEST_CASE("AudioReactive subscribed fields match a full analysis") {
+    AudioReactiveConfig config;
+    config.sampleRate = 22050;
+    config.enableTempo = true;
+    AudioReactive full;
+    full.begin(config);
+    AudioReactive volumeOnly;
+    volumeOnly.begin(config);
+    volumeOnly.subscribe(kAudioVolume);
+    AudioReactive binsOnly;
+    binsOnly.begin(config);
+    binsOnly.subscribe(kAudioFrequencyBins);
+    AudioReactive beatOnly;
+    beatOnly.begin(config);
+    beatOnly.subscribe(kAudioBeat);
+    AudioReactive bandBeatsOnly;
+    bandBeatsOnly.begin(config);
+    bandBeatsOnly.subscribe(kAudioBandBeats);
+    AudioReactive tempoOnly;
+    tempoOnly.begin(config);
+    tempoOnly.subscribe(kAudioTempo);
+
+    int beats = 0;
+    int bandBeats = 0;
+    for (int b = 0; b < 200; ++b) {
+        fl::vector<int16_t> block;
+        if (b < 20) {
+            // Rising level so the AGC keeps moving.
+            block = sine_block(b * 512, 512);
+            for (fl::size i = 0; i < block.size(); ++i) {
+                block[i] = static_cast<int16_t>(block[i] * (b + 1) / 20);
+            }
+        } else {
+            block = pulse_block(b, 512);
+        }
+        AudioSample sample(block, b * 23);
+        full.processSample(sample);
+        volumeOnly.processSample(sample);
+        binsOnly.processSample(sample);
+        beatOnly.processSample(sample);
+        bandBeatsOnly.processSample(sample);
+        tempoOnly.processSample(sample);
+        const AudioData& expected = full.getData();
+        INFO("block " << b);
+        CHECK_EQ(volumeOnly.getData().volume, expected.volume);
+        CHECK_EQ(volumeOnly.getData().peak, expected.peak);
+        CHECK_EQ(volumeOnly.getSmoothedData().volume, full.getSmoothedData().volume);
+        for (int i = 0; i < 16; ++i) {
+            CHECK_EQ(binsOnly.getData().frequencyBins[i], expected.frequencyBins[i]);
+        }
+        CHECK_EQ(beatOnly.getData().beatDetected, expected.beatDetected);
+        CHECK_EQ(bandBeatsOnly.getData().bassBeatDetected, expected.bassBeatDetected);
+        CHECK_EQ(bandBeatsOnly.getData().midBeatDetected, expected.midBeatDetected);
+        CHECK_EQ(bandBeatsOnly.getData().trebleBeatDetected, expected.trebleBeatDetected);
+        CHECK_EQ(tempoOnly.getData().bpm, expected.bpm);
+        CHECK_EQ(tempoOnly.getData().tempoConfidence, expected.tempoConfidence);
+        CHECK_EQ(tempoOnly.getData().beatPhase, expected.beatPhase);
+        CHECK_EQ(tempoOnly.getData().nextBeatTime, expected.nextBeatTime);
+        beats += expected.beatDetected ? 1 : 0;
+        bandBeats += (expected.bassBeatDetected || expected.midBeatDetected ||
+                      expected.trebleBeatDetected) ? 1 : 0;
+    }
+    // The comparison means something only if there was something to find.
+    CHECK_GT(beats, 5);
+    CHECK_GT(bandBeats, 5);
+    CHECK_GT(full.getData().bpm, 0.0f);
+}
+
+TEST_CASE("AudioReactive stage profile") {
+    AudioReactive audio;
+    AudioReactiveConfig config;
+    config.sampleRate = 22050;
+    audio.begin(config);
+    audio.subscribe(kAudioVolume);
+    // A fake clock advancing 1 us per reading: two readings per stage run.
+    fl::u64 ticks = 0;
+    audio.setStageClock([&ticks]() { return ticks++; });
+    for (int b = 0; b < 10; ++b) {
+        audio.processSample(AudioSample(sine_block(b * 512, 512), b * 23));
+    }
+    const AudioStageProfile& profile = audio.getStageProfile();
+    CHECK_EQ(profile.runs[kAudioStageSpectrum], 0u);
+    CHECK_EQ(profile.runs[kAudioStageVolume], 10u);
+    CHECK_EQ(profile.runs[kAudioStageGain], 10u);
+    CHECK_EQ(profile.runs[kAudioStageSmoothing], 10u);
+    CHECK_EQ(profile.runs[kAudioStageBeat], 0u);
+    CHECK_EQ(profile.us[kAudioStageVolume], 10u);
+    CHECK_EQ(profile.totalUs(), 30u);
+    CHECK_EQ(fl::string(AudioStageProfile::name(kAudioStageSpectralFlux)), "spectral flux");
+
+    audio.resetStageProfile();
+    CHECK_EQ(audio.getStageProfile().totalUs(), 0u);
+}
+
 TEST_CASE("AudioReactive CircularBuffer functionality") {
     // Test the CircularBuffer template directly
     StaticCircularBuffer<float, 8> buffer;
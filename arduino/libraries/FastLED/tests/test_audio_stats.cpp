@@ -0,0 +1,150 @@
+// Unit tests for fl::AudioStats, the single pass PCM statistics
+
+#include "test.h"
+
+#include "fl/audio.h"
+#include "fl/audio_stats.h"
+#include "fl/vector.h"
+#include <chrono> // ok include
+#include <math.h>
+
+using namespace fl;
+
+namespace {
+
+fl::vector<i16> make_pcm(fl::size n, u32 seed) {
+    fl::vector<i16> out;
+    out.resize(n);
+    for (fl::size i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        out[i] = static_cast<i16>(seed >> 16);
+    }
+    return out;
+}
+
+// Scalar version of what the separate passes used to compute.
+AudioStats reference(const i16 *p, fl::size n) {
+    AudioStats stats;
+    for (fl::size i = 0; i < n; ++i) {
+        const i32 x = p[i];
+        stats.sumSquares += u64(x * x);
+        stats.sum += x;
+        const i32 mag = x < 0 ? -x : x;
+        if (mag > stats.peak) {
+            stats.peak = static_cast<u16>(mag);
+        }
+        if (i > 0 && ((p[i - 1] < 0) != (x < 0))) {
+            ++stats.zeroCrossings;
+        }
+    }
+    stats.count = static_cast<u32>(n);
+    stats.last = n ? p[n - 1] : 0;
+    return stats;
+}
+
+void check_same(const AudioStats &a, const AudioStats &b) {
+    CHECK_EQ(a.sumSquares, b.sumSquares);
+    CHECK_EQ(a.sum, b.sum);
+    CHECK_EQ(a.count, b.count);
+    CHECK_EQ(a.zeroCrossings, b.zeroCrossings);
+    CHECK_EQ(a.peak, b.peak);
+    CHECK_EQ(a.last, b.last);
+}
+
+} // namespace
+
+TEST_CASE("AudioStats - matches separate passes") {
+    const fl::vector<i16> pcm = make_pcm(70000, 1);
+    // Every length around the vector width and a few unaligned starts.
+    for (fl::size start = 0; start < 4; ++start) {
+        for (fl::size n = 0; n < 40; ++n) {
+            check_same(AudioStats::compute(fl::span<const i16>(pcm.data() + start, n)),
+                       reference(pcm.data() + start, n));
+        }
+    }
+    // Long enough to flush the SIMD lane counters.
+    check_same(AudioStats::compute(pcm), reference(pcm.data(), pcm.size()));
+}
+
+TEST_CASE("AudioStats - extremes") {
+    fl::vector<i16> pcm;
+    for (int i = 0; i < 40000; ++i) {
+        pcm.push_back(i & 1 ? -32768 : 32767);
+    }
+    const AudioStats stats = AudioStats::compute(pcm);
+    check_same(stats, reference(pcm.data(), pcm.size()));
+    CHECK_EQ(stats.peak, 32768);
+    CHECK_EQ(stats.zeroCrossings, 39999u);
+    CHECK(stats.zcf() == doctest::Approx(1.0f));
+    CHECK(stats.dcOffset() == doctest::Approx(-0.5f));
+
+    const AudioStats silence = AudioStats::compute(fl::vector<i16>(100, 0));
+    CHECK_EQ(silence.rms(), 0.0f);
+    CHECK_EQ(silence.zcf(), 0.0f);
+    CHECK(silence.dbfs() == doctest::Approx(-120.0));
+
+    const AudioStats empty;
+    CHECK_EQ(empty.rms(), 0.0f);
+    CHECK_EQ(empty.dcOffset(), 0.0f);
+}
+
+TEST_CASE("AudioStats - pieces add up to the whole") {
+    const fl::vector<i16> pcm = make_pcm(1000, 2);
+    const fl::size cuts[] = {0, 1, 13, 14, 300, 301, 999, 1000};
+    AudioStats pieces;
+    for (fl::size i = 0; i + 1 < sizeof(cuts) / sizeof(cuts[0]); ++i) {
+        pieces.add(fl::span<const i16>(pcm.data() + cuts[i], cuts[i + 1] - cuts[i]));
+    }
+    check_same(pieces, AudioStats::compute(pcm));
+}
+
+TEST_CASE("AudioStats - feeds AudioSample and SoundLevelMeter") {
+    const fl::vector<i16> pcm = make_pcm(512, 3);
+    AudioSample sample(pcm);
+    const AudioStats expected = reference(pcm.data(), pcm.size());
+    check_same(sample.stats(), expected);
+    CHECK(sample.rms() == doctest::Approx(sqrt(double(expected.sumSquares) / 512.0)));
+    CHECK(sample.zcf() == doctest::Approx(float(expected.zeroCrossings) / 511.0f));
+    CHECK_EQ(AudioSample().stats().count, 0u);
+
+    double sum_sq = 0.0;
+    for (i16 s : pcm) {
+        sum_sq += (s / 32768.0) * (s / 32768.0);
+    }
+    SoundLevelMeter from_block;
+    SoundLevelMeter from_stats;
+    from_block.processBlock(pcm.data(), pcm.size());
+    from_stats.processStats(sample.stats());
+    CHECK(from_block.getDBFS() == doctest::Approx(10.0 * log10(sum_sq / 512.0 + 1e-12)));
+    CHECK_EQ(from_stats.getDBFS(), from_block.getDBFS());
+    CHECK_EQ(from_stats.getSPL(), from_block.getSPL());
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("AudioStats - benchmark" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    auto us = [](clock::duration d) {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()) / 1000.0;
+    };
+    const fl::vector<i16> input = make_pcm(512, 4);
+    fl::vector<i16> pcm = input;
+    const int kRuns = 20000;
+    u64 sink = 0;
+    auto t0 = clock::now();
+    for (int r = 0; r < kRuns; ++r) {
+        pcm[r & 511] ^= 1;
+        const AudioStats stats = reference(pcm.data(), pcm.size());
+        sink += stats.sumSquares + stats.peak + stats.zeroCrossings;
+    }
+    auto t1 = clock::now();
+    pcm = input;
+    for (int r = 0; r < kRuns; ++r) {
+        pcm[r & 511] ^= 1;
+        const AudioStats stats = AudioStats::compute(pcm);
+        sink -= stats.sumSquares + stats.peak + stats.zeroCrossings;
+    }
+    auto t2 = clock::now();
+    CHECK_EQ(sink, 0u);
+    MESSAGE("stats of 512 samples: separate passes " << us(t1 - t0) / kRuns
+            << " us, AudioStats " << us(t2 - t1) / kRuns << " us");
+}
@@ -0,0 +1,214 @@
+// Unit tests for fl::TempoTracker and tempo tracking in AudioReactive
+
+#include "test.h"
+
+#include "fl/audio_input_stream.h"
+#include "fl/audio_reactive.h"
+#include "fl/audio_tempo.h"
+#include "fl/time.h"
+#include <math.h>
+
+using namespace fl;
+
+namespace {
+
+// A frame based onset detector listening to a click track: each frame
+// reports 1 if a beat fell inside it, plus a little noise. Frames are
+// passed to the tracker at their centre, as AudioReactive does.
+struct ClickFrames {
+    double startMs = 1000.0;
+    double firstBeatMs = 137.0; // after startMs
+    double frameMs = 23.2;
+    double periodMs = 500.0;
+    fl::u32 noise = 12345;
+    fl::u32 frames = 0;
+
+    double frameStart(fl::u32 f) const { return startMs + f * frameMs; }
+    double nowMs() const { return frameStart(frames); }
+
+    void run(TempoTracker &tracker, double seconds) {
+        const fl::u32 last = frames + fl::u32(seconds * 1000.0 / frameMs);
+        for (; frames < last; ++frames) {
+            const double a = frameStart(frames) - startMs - firstBeatMs;
+            const double b = a + frameMs;
+            const bool beat = floor(b / periodMs) > floor(a / periodMs) || fmod(a, periodMs) == 0.0;
+            noise = noise * 1664525u + 1013904223u;
+            const float onset = (beat ? 1.0f : 0.0f) + float(noise >> 8) / 16777216.0f * 0.1f;
+            tracker.update(onset, fl::u32(frameStart(frames) + frameMs / 2.0));
+        }
+    }
+
+    // Signed distance from `predictedMs` to the nearest true beat.
+    double error(fl::u32 predictedMs) const {
+        const double t = double(predictedMs) - startMs - firstBeatMs;
+        double e = fmod(t, periodMs);
+        if (e < 0.0) {
+            e += periodMs;
+        }
+        return e > periodMs / 2.0 ? e - periodMs : e;
+    }
+};
+
+} // namespace
+
+TEST_CASE("TempoTracker - not locked without enough audio") {
+    TempoTracker tracker;
+    ClickFrames clicks;
+    clicks.run(tracker, 1.0);
+    CHECK_FALSE(tracker.locked());
+    CHECK_EQ(tracker.bpm(), 0.0f);
+    CHECK_EQ(tracker.nextBeatMs(2000), 0u);
+    CHECK_EQ(tracker.phase(2000), 0.0f);
+
+    // Silence never locks.
+    TempoTracker quiet;
+    for (fl::u32 t = 0; t < 10000; t += 23) {
+        quiet.update(0.0f, t);
+    }
+    CHECK_FALSE(quiet.locked());
+}
+
+TEST_CASE("TempoTracker - tempo and next beat from frame onsets") {
+    const float tempos[] = {75.0f, 90.0f, 120.0f, 128.0f, 140.0f, 174.0f};
+    const double frameSizes[] = {23.2, 11.6};
+    for (double frameMs : frameSizes) {
+        for (float bpm : tempos) {
+            TempoTracker tracker;
+            ClickFrames clicks;
+            clicks.frameMs = frameMs;
+            clicks.periodMs = 60000.0 / bpm;
+            clicks.run(tracker, 8.0);
+            INFO("bpm " << bpm << " frame " << frameMs);
+            REQUIRE(tracker.locked());
+            CHECK(tracker.bpm() == doctest::Approx(bpm).epsilon(0.015));
+            CHECK(tracker.confidence() > 0.3f);
+
+            // Predictions made between frames, for the next few beats.
+            double worst = 0.0;
+            for (int i = 0; i < 40; ++i) {
+                clicks.run(tracker, 0.1);
+                const fl::u32 now = fl::u32(clicks.nowMs());
+                const fl::u32 next = tracker.nextBeatMs(now);
+                CHECK(next >= now);
+                CHECK(double(next - now) <= clicks.periodMs + 1.0);
+                worst = fmax(worst, fabs(clicks.error(next)));
+            }
+            CHECK(worst <= 15.0);
+        }
+    }
+}
+
+TEST_CASE("TempoTracker - phase and tempo changes") {
+    TempoTracker tracker;
+    ClickFrames clicks;
+    clicks.periodMs = 600.0; // 100 BPM
+    clicks.run(tracker, 8.0);
+    CHECK(tracker.bpm() == doctest::Approx(100.0f).epsilon(0.015));
+
+    const fl::u32 beat = tracker.nextBeatMs(fl::u32(clicks.nowMs()));
+    CHECK(fabs(clicks.error(beat)) <= 15.0);
+    CHECK(fmin(tracker.phase(beat), 1.0f - tracker.phase(beat)) < 0.01f);
+    CHECK(tracker.phase(beat + 300) == doctest::Approx(0.5f).epsilon(0.02));
+    CHECK_EQ(tracker.nextBeatMs(beat), beat);
+
+    // Speeds up: follows within the memory of the tracker.
+    clicks.startMs = clicks.nowMs();
+    clicks.frames = 0;
+    clicks.periodMs = 60000.0 / 130.0;
+    clicks.run(tracker, 10.0);
+    CHECK(tracker.bpm() == doctest::Approx(130.0f).epsilon(0.015));
+    CHECK(fabs(clicks.error(tracker.nextBeatMs(fl::u32(clicks.nowMs())))) <= 15.0);
+
+    // A long gap starts over.
+    tracker.update(1.0f, fl::u32(clicks.nowMs()) + 5000);
+    CHECK_FALSE(tracker.locked());
+}
+
+TEST_CASE("AudioReactive - beat prediction on click tracks") {
+    u32 now = 0;
+    fl::inject_time_provider([&now]() { return now; });
+
+    const float tempos[] = {96.0f, 120.0f};
+    for (float bpm : tempos) {
+        for (int streaming = 0; streaming < 2; ++streaming) {
+            SynthAudioConfig synth;
+            synth.signal = SynthAudioConfig::kClicks;
+            synth.bpm = bpm;
+            synth.sampleRate = 22050;
+            synth.seconds = 12.0f;
+            SynthAudioInput input(synth);
+            input.start(); // clicks at 0, period, 2 * period, ...
+
+            AudioReactive audio;
+            AudioReactiveConfig config;
+            config.sampleRate = 22050;
+            config.enableTempo = true;
+            if (streaming) {
+                config.fftSize = 512;
+                config.hopSize = 256;
+            }
+            audio.begin(config);
+
+            const double period = 60000.0 / bpm;
+            const double blockMs = 512 * 1000.0 / 22050.0;
+            double predictionError = 0.0;
+            double bias = 0.0;
+            double worstPrediction = 0.0;
+            int predictions = 0;
+            double worstLatency = 0.0;
+            int detections = 0;
+            int clicks = 0;
+            double lastClick = -1.0;
+            while (true) {
+                AudioSample sample = input.read();
+                if (!sample.isValid()) {
+                    break;
+                }
+                audio.processSample(sample);
+                // The block is available once its last sample is captured.
+                const double available = sample.timestamp() + blockMs;
+                if (available < 6000.0) {
+                    continue;
+                }
+                const double predicted = audio.getNextBeatTime(u32(available));
+                CHECK(predicted >= available - 1.0);
+                // From the nearest click; the next one if the prediction
+                // is right at the last moment.
+                double err = fmod(predicted, period);
+                err = err > period / 2.0 ? err - period : err;
+                bias += err;
+                predictionError += fabs(err);
+                worstPrediction = fmax(worstPrediction, fabs(err));
+                ++predictions;
+                // isBeat() latency: from the click to the end of the block
+                // that reports it, which is when an effect sees it.
+                const double click = floor(available / period) * period;
+                if (click != lastClick) {
+                    lastClick = click;
+                    ++clicks;
+                }
+                if (audio.isBeat()) {
+                    worstLatency = fmax(worstLatency, available - click);
+                    ++detections;
+                }
+            }
+            INFO("bpm " << bpm << " streaming " << streaming);
+            CHECK(audio.getBPM() == doctest::Approx(bpm).epsilon(0.02));
+            REQUIRE(predictions > 0);
+            predictionError /= predictions;
+            CHECK(predictionError < 10.0);
+            CHECK(worstPrediction < 25.0);
+
+            CHECK(fabs(bias / predictions) < 10.0);
+
+            // isBeat() fires for every click, including in streaming mode
+            // where one block completes several windows, and no later than
+            // the end of the block holding the click. The first click was
+            // before the measured stretch.
+            CHECK_GE(detections, clicks - 1);
+            CHECK_LE(detections, clicks);
+            CHECK(worstLatency <= blockMs + 1.0);
+        }
+    }
+    fl::clear_time_provider();
+}
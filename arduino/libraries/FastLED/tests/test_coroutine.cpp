@@ -0,0 +1,173 @@
+// Unit tests for the coroutine front-end of fl::promise and its building
+// blocks. The coroutine cases only build with C++20.
+
+#include "fl/async.h"
+#include "fl/coroutine.h"
+#include "fl/promise.h"
+#include "fl/task.h"
+#include "fl/time.h"
+#include "test.h"
+
+using namespace fl;
+
+namespace {
+
+struct ClockFixture {
+    MockTimeProvider clock{5000};
+
+    ClockFixture() {
+        Scheduler::instance().clear_all_tasks();
+        inject_time_provider([this]() -> u32 { return clock.current_time(); });
+    }
+    ~ClockFixture() {
+        Scheduler::instance().clear_all_tasks();
+        clear_time_provider();
+    }
+
+    void advance(u32 ms) {
+        clock.advance(ms);
+        Scheduler::instance().update();
+    }
+};
+
+} // namespace
+
+TEST_CASE("task::after_ms runs once after the delay") {
+    ClockFixture fx;
+    int runs = 0;
+    auto t = task::after_ms(30).then([&runs]() { ++runs; });
+    CHECK_EQ(t.type(), TaskType::kAfterMs);
+    Scheduler::instance().update();
+    CHECK_EQ(runs, 0);
+    fx.advance(29);
+    CHECK_EQ(runs, 0);
+    fx.advance(1);
+    CHECK_EQ(runs, 1);
+    fx.advance(100);
+    CHECK_EQ(runs, 1);
+    CHECK_EQ(Scheduler::instance().task_count(), 0u);
+
+    auto now = task::after_ms(0).then([&runs]() { ++runs; });
+    Scheduler::instance().update();
+    CHECK_EQ(runs, 2);
+
+    auto cancelled = task::after_ms(5).then([&runs]() { ++runs; });
+    cancelled.cancel();
+    fx.advance(10);
+    CHECK_EQ(runs, 2);
+}
+
+TEST_CASE("coroutine frame pool") {
+    const fl::size live = detail::coroutine_frames_live();
+    void* small = detail::coroutine_frame_allocate(40);
+    void* medium = detail::coroutine_frame_allocate(700);
+    void* large = detail::coroutine_frame_allocate(10000);
+    REQUIRE(small);
+    REQUIRE(medium);
+    REQUIRE(large);
+    CHECK_EQ(reinterpret_cast<fl::uptr>(small) % 16, 0u);
+    CHECK_EQ(reinterpret_cast<fl::uptr>(medium) % 16, 0u);
+    CHECK_EQ(detail::coroutine_frames_live(), live + 3);
+    detail::coroutine_frame_deallocate(medium, 700);
+    // A freed frame is handed to the next coroutine of the same size class.
+    void* again = detail::coroutine_frame_allocate(650);
+    CHECK_EQ(again, medium);
+    detail::coroutine_frame_deallocate(again, 650);
+    detail::coroutine_frame_deallocate(small, 40);
+    detail::coroutine_frame_deallocate(large, 10000);
+    CHECK_EQ(detail::coroutine_frames_live(), live);
+}
+
+#if FASTLED_HAS_COROUTINES
+
+namespace {
+
+promise<int> add_later(promise<int> a, promise<int> b) {
+    result<int> x = co_await a;
+    result<int> y = co_await b;
+    if (!x.ok() || !y.ok()) {
+        co_return Error("missing operand");
+    }
+    co_return x.value() + y.value();
+}
+
+promise<fl::string> timed_sequence(fl::vector<u32>* stamps) {
+    stamps->push_back(fl::time());
+    co_await sleep_ms(100);
+    stamps->push_back(fl::time());
+    co_await next_frame();
+    stamps->push_back(fl::time());
+    co_await sleep_ms(50);
+    stamps->push_back(fl::time());
+    co_return "done";
+}
+
+promise<int> immediate() { co_return 7; }
+
+} // namespace
+
+TEST_CASE("coroutine - co_await promises") {
+    ClockFixture fx;
+    const fl::size live = detail::coroutine_frames_live();
+    promise<int> a = promise<int>::create();
+    promise<int> b = promise<int>::create();
+    promise<int> sum = add_later(a, b);
+    CHECK_FALSE(sum.is_completed());
+    CHECK_EQ(detail::coroutine_frames_live(), live + 1);
+
+    a.complete_with_value(2);
+    // Resumed by the scheduler, not inside complete_with_value().
+    Scheduler::instance().update();
+    CHECK_FALSE(sum.is_completed());
+    b.complete_with_value(40);
+    Scheduler::instance().update();
+    REQUIRE(sum.is_resolved());
+    CHECK_EQ(sum.value(), 42);
+    CHECK_EQ(detail::coroutine_frames_live(), live);
+
+    // Already completed promises do not suspend.
+    promise<int> direct = add_later(promise<int>::resolve(1), immediate());
+    REQUIRE(direct.is_resolved());
+    CHECK_EQ(direct.value(), 8);
+
+    // Errors come back as a rejected result.
+    promise<int> failed = add_later(promise<int>::reject(Error("nope")), promise<int>::resolve(1));
+    REQUIRE(failed.is_rejected());
+    CHECK_EQ(failed.error().message, "missing operand");
+
+    // Coroutines can be waited on like any promise.
+    promise<int> c = promise<int>::create();
+    promise<int> late = add_later(c, promise<int>::resolve(1));
+    c.complete_with_value(1);
+    result<int> r = await_top_level(late);
+    REQUIRE(r.ok());
+    CHECK_EQ(r.value(), 2);
+}
+
+TEST_CASE("coroutine - sleep and frame suspension") {
+    ClockFixture fx;
+    fl::vector<u32> stamps;
+    promise<fl::string> seq = timed_sequence(&stamps);
+    REQUIRE_EQ(stamps.size(), 1u);
+    CHECK_EQ(stamps[0], 5000u);
+
+    fx.advance(99);
+    CHECK_EQ(stamps.size(), 1u);
+    fx.advance(1);
+    REQUIRE_EQ(stamps.size(), 2u);
+    CHECK_EQ(stamps[1], 5100u);
+
+    // Waits for the frame, however much time passes.
+    fx.advance(500);
+    CHECK_EQ(stamps.size(), 2u);
+    Scheduler::instance().update_after_frame_tasks();
+    REQUIRE_EQ(stamps.size(), 3u);
+    CHECK_EQ(stamps[2], 5600u);
+
+    fx.advance(50);
+    REQUIRE_EQ(stamps.size(), 4u);
+    REQUIRE(seq.is_resolved());
+    CHECK_EQ(seq.value(), "done");
+}
+
+#endif // FASTLED_HAS_COROUTINES
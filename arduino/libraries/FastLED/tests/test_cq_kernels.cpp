@@ -0,0 +1,205 @@
+// Unit tests for fl::CqKernelBank, the cached constant-Q kernel tables
+
+#include "test.h"
+
+#include "third_party/cq_kernel/cq_kernel.h"
+
+#include "fl/cq_kernels.h"
+#include "fl/fft.h"
+#include "fl/fft_impl.h"
+#include "fl/vector.h"
+#include <chrono> // ok include
+#include <math.h>
+
+using namespace fl;
+
+namespace {
+
+CqKernelParams make_params(int samples, int bands) {
+    CqKernelParams params;
+    params.samples = samples;
+    params.bands = bands;
+    return params;
+}
+
+cq_kernel_cfg to_cfg(const CqKernelParams &params) {
+    cq_kernel_cfg cfg = {};
+    cfg.samples = params.samples;
+    cfg.bands = params.bands;
+    cfg.fmin = params.fmin;
+    cfg.fmax = params.fmax;
+    cfg.fs = params.fs;
+    cfg.window_type = HAMMING;
+    cfg.min_val = params.minVal;
+    return cfg;
+}
+
+// The kiss_fftr spectrum of a mix of tones and noise.
+fl::vector<kiss_fft_cpx> make_spectrum(int samples, u32 seed) {
+    fl::vector<i16> pcm(samples);
+    for (int i = 0; i < samples; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const float t = float(i) / 44100.0f;
+        const float v = 9000.0f * sinf(2.0f * 3.14159265f * 440.0f * t) +
+                        6000.0f * sinf(2.0f * 3.14159265f * 2500.0f * t) +
+                        float(i32(seed >> 20) - 2048);
+        pcm[i] = static_cast<i16>(v);
+    }
+    fl::vector<kiss_fft_cpx> spectrum(samples);
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(samples, 0, nullptr, nullptr);
+    kiss_fftr(cfg, pcm.data(), spectrum.data());
+    kiss_fftr_free(cfg);
+    return spectrum;
+}
+
+} // namespace
+
+TEST_CASE("CqKernelBank - matches apply_kernels exactly") {
+    const int shapes[][2] = {{512, 16}, {256, 16}, {1024, 32}};
+    for (const auto &shape : shapes) {
+        const CqKernelParams params = make_params(shape[0], shape[1]);
+        const cq_kernel_cfg cfg = to_cfg(params);
+        cq_kernels_t reference = generate_kernels(cfg);
+        fl::shared_ptr<const CqKernelBank> bank = CqKernelBank::generate(params);
+        REQUIRE_EQ(bank->bandCount(), fl::size(shape[1]));
+
+        for (u32 seed = 1; seed <= 4; ++seed) {
+            fl::vector<kiss_fft_cpx> spectrum = make_spectrum(shape[0], seed);
+            fl::vector<kiss_fft_cpx> expected(shape[1]);
+            fl::vector<kiss_fft_cpx> actual(shape[1]);
+            for (int i = 0; i < shape[1]; ++i) {
+                expected[i].r = expected[i].i = 0;
+            }
+            apply_kernels(spectrum.data(), expected.data(), reference, cfg);
+            bank->apply(reinterpret_cast<const i16 *>(spectrum.data()),
+                        reinterpret_cast<i16 *>(actual.data()));
+            for (int i = 0; i < shape[1]; ++i) {
+                CHECK_EQ(actual[i].r, expected[i].r);
+                CHECK_EQ(actual[i].i, expected[i].i);
+            }
+        }
+        free_kernels(reference, cfg);
+    }
+}
+
+TEST_CASE("CqKernelBank - cache shares banks while in use") {
+    CqKernelBank::clearCache();
+    const CqKernelParams params = make_params(512, 16);
+    fl::shared_ptr<const CqKernelBank> a = CqKernelBank::get(params);
+    fl::shared_ptr<const CqKernelBank> b = CqKernelBank::get(params);
+    CHECK_EQ(a.get(), b.get());
+    CHECK_NE(CqKernelBank::get(make_params(256, 16)).get(), a.get());
+
+    // FFTs of the same shape share the bank too.
+    FFTImpl fft1(FFT_Args(512, 16));
+    FFTImpl fft2(FFT_Args(512, 16));
+    CHECK_EQ(CqKernelBank::get(params).get(), a.get());
+
+    // Once nothing holds it, it is freed and generated again on demand.
+    fl::weak_ptr<const CqKernelBank> weak = a;
+    a.reset();
+    b.reset();
+    CHECK_FALSE(weak.expired()); // still held by fft1 / fft2
+    CqKernelBank::clearCache();
+}
+
+TEST_CASE("CqKernelBank - blobs") {
+    const CqKernelParams params = make_params(512, 16);
+    fl::shared_ptr<const CqKernelBank> bank = CqKernelBank::generate(params);
+    fl::vector<u8> bytes = bank->toBlob();
+    // fl::vector storage comes from malloc, so it is aligned.
+    fl::span<const u8> blob(bytes.data(), bytes.size());
+
+    fl::shared_ptr<const CqKernelBank> loaded = CqKernelBank::fromBlob(blob);
+    REQUIRE(loaded);
+    CHECK(loaded->params() == params);
+    CHECK_EQ(loaded->coefficientCount(), bank->coefficientCount());
+    fl::vector<kiss_fft_cpx> spectrum = make_spectrum(512, 9);
+    i16 expected[32];
+    i16 actual[32];
+    bank->apply(reinterpret_cast<const i16 *>(spectrum.data()), expected);
+    loaded->apply(reinterpret_cast<const i16 *>(spectrum.data()), actual);
+    for (int i = 0; i < 32; ++i) {
+        CHECK_EQ(actual[i], expected[i]);
+    }
+
+    // Rejected: truncated, misaligned, wrong magic.
+    CHECK_FALSE(CqKernelBank::fromBlob(fl::span<const u8>(bytes.data(), bytes.size() - 1)));
+    fl::vector<u8> shifted(bytes.size() + 2);
+    for (fl::size i = 0; i < bytes.size(); ++i) {
+        shifted[i + 2] = bytes[i];
+    }
+    CHECK_FALSE(CqKernelBank::fromBlob(fl::span<const u8>(shifted.data() + 2, bytes.size())));
+    fl::vector<u8> corrupt = bytes;
+    corrupt[0] ^= 0xff;
+    CHECK_FALSE(CqKernelBank::fromBlob(fl::span<const u8>(corrupt.data(), corrupt.size())));
+
+    // A preloaded blob is used in place by get() and by FFTs.
+    CqKernelBank::clearCache();
+    REQUIRE(CqKernelBank::preload(blob));
+    fl::shared_ptr<const CqKernelBank> cached = CqKernelBank::get(params);
+    const u8 *band0 = reinterpret_cast<const u8 *>(&cached->band(0));
+    CHECK(band0 >= bytes.data());
+    CHECK(band0 < bytes.data() + bytes.size());
+    FFTImpl fft(FFT_Args(512, 16));
+    FFTBins bins(16);
+    fl::vector<i16> silence(512, 0);
+    CHECK(fft.run(silence, &bins).ok);
+    CqKernelBank::clearCache();
+
+    const fl::string source = bank->toCSource("kCqKernels");
+    CHECK(source.find("alignas(4) const unsigned char kCqKernels[") != fl::string::npos);
+    CHECK(source.find("0x43, 0x51, 0x4b, 0x31,") != fl::string::npos); // "CQK1"
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("CqKernelBank - benchmark" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    const CqKernelParams params = make_params(512, 16);
+    const cq_kernel_cfg cfg = to_cfg(params);
+    CqKernelBank::clearCache();
+
+    auto t0 = clock::now();
+    fl::shared_ptr<const CqKernelBank> bank = CqKernelBank::get(params);
+    auto t1 = clock::now();
+    for (int i = 0; i < 100; ++i) {
+        CqKernelBank::get(params);
+    }
+    auto t2 = clock::now();
+
+    cq_kernels_t reference = generate_kernels(cfg);
+    const fl::vector<kiss_fft_cpx> input = make_spectrum(512, 3);
+    fl::vector<kiss_fft_cpx> spectrum = input;
+    kiss_fft_cpx cq[16];
+    const int kRuns = 20000;
+    int sink = 0;
+    auto t3 = clock::now();
+    for (int r = 0; r < kRuns; ++r) {
+        for (int i = 0; i < 16; ++i) {
+            cq[i].r = cq[i].i = 0;
+        }
+        spectrum[r & 63].r ^= 1;
+        apply_kernels(spectrum.data(), cq, reference, cfg);
+        sink += cq[r & 15].r;
+    }
+    auto t4 = clock::now();
+    spectrum = input;
+    for (int r = 0; r < kRuns; ++r) {
+        spectrum[r & 63].r ^= 1;
+        bank->apply(reinterpret_cast<const i16 *>(spectrum.data()),
+                    reinterpret_cast<i16 *>(cq));
+        sink -= cq[r & 15].r;
+    }
+    auto t5 = clock::now();
+    free_kernels(reference, cfg);
+    CHECK_EQ(sink, 0);
+
+    auto us = [](clock::duration d) {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()) / 1000.0;
+    };
+    MESSAGE("cq kernels 512/16: generate " << us(t1 - t0) << " us, cached get "
+            << us(t2 - t1) / 100 << " us");
+    MESSAGE("apply x" << kRuns << ": apply_kernels " << us(t4 - t3) / 1000
+            << " ms, CqKernelBank " << us(t5 - t4) / 1000 << " ms");
+    CqKernelBank::clearCache();
+}
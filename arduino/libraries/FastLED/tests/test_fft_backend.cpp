@@ -0,0 +1,193 @@
+// Unit tests for the pluggable real FFT backends in fl/fft_backend.h
+
+#include "test.h"
+
+#include "fl/fft.h"
+#include "fl/fft_backend.h"
+#include "fl/fft_impl.h"
+#include "fl/vector.h"
+#include <chrono> // ok include
+#include <math.h>
+
+using namespace fl;
+
+namespace {
+
+const FFTBackendType kBackends[] = {FFTBackendType::Kiss,
+                                    FFTBackendType::Radix4Fixed,
+                                    FFTBackendType::Radix4Float};
+
+fl::vector<i16> make_signal(int n, u32 seed) {
+    fl::vector<i16> out;
+    out.resize(n);
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const double t = double(i) / n;
+        const double v = 9000.0 * sin(2.0 * PI * 5.0 * t) +
+                         6000.0 * cos(2.0 * PI * (n / 7) * t + 0.3) +
+                         4000.0 * sin(2.0 * PI * (n / 3) * t) +
+                         double(i32(seed >> 16) - 32768) / 8.0;
+        out[i] = static_cast<i16>(v);
+    }
+    return out;
+}
+
+struct Error {
+    double max = 0.0;
+    double rms = 0.0;
+};
+
+// Against a double precision DFT scaled by 1 / n, in Q15 LSBs.
+Error measure(IFFTBackend &fft, const fl::vector<i16> &in) {
+    const int n = fft.size();
+    fl::vector<i16> out;
+    out.resize(n + 2);
+    fft.forward(in.data(), out.data());
+    Error err;
+    for (int k = 0; k <= n / 2; ++k) {
+        double re = 0.0, im = 0.0;
+        for (int i = 0; i < n; ++i) {
+            const double phase = -2.0 * PI * double((i64(k) * i) % n) / n;
+            re += in[i] * cos(phase);
+            im += in[i] * sin(phase);
+        }
+        const double dr = out[2 * k] - re / n;
+        const double di = out[2 * k + 1] - im / n;
+        err.max = fmax(err.max, fmax(fabs(dr), fabs(di)));
+        err.rms += dr * dr + di * di;
+    }
+    err.rms = sqrt(err.rms / double(n + 2));
+    return err;
+}
+
+} // namespace
+
+TEST_CASE("FFT backends - accuracy against a reference DFT") {
+    for (int n = 64; n <= 4096; n *= 2) {
+        const fl::vector<i16> in = make_signal(n, u32(n));
+        for (FFTBackendType type : kBackends) {
+            fl::unique_ptr<IFFTBackend> fft = make_fft_backend(type, n);
+            REQUIRE(fft);
+            CHECK(fft->type() == type);
+            CHECK_EQ(fft->size(), n);
+            const Error err = measure(*fft, in);
+            fl::StrStream line;
+            line << fft->name() << " n=" << n << ": max " << err.max
+                 << " lsb, rms " << err.rms << " lsb";
+            MESSAGE(line.str());
+            // Float only rounds the output; the fixed point radix-4 rounds
+            // once per pass from 32 bits, kiss_fftr twice per butterfly.
+            if (type == FFTBackendType::Radix4Float) {
+                CHECK_LE(err.max, 0.51);
+            } else if (type == FFTBackendType::Radix4Fixed) {
+                CHECK_LE(err.max, 1.5);
+                CHECK_LE(err.rms, 0.5);
+            } else {
+                CHECK_LE(err.max, 8.0);
+                CHECK_LE(err.rms, 1.5);
+            }
+        }
+    }
+}
+
+TEST_CASE("FFT backends - unsupported sizes fall back to kiss") {
+    CHECK(fft_backend_supports(FFTBackendType::Radix4Fixed, 64));
+    CHECK(fft_backend_supports(FFTBackendType::Radix4Float, 4096));
+    CHECK_FALSE(fft_backend_supports(FFTBackendType::Radix4Fixed, 32));
+    CHECK_FALSE(fft_backend_supports(FFTBackendType::Radix4Float, 8192));
+    CHECK_FALSE(fft_backend_supports(FFTBackendType::Radix4Float, 96));
+    CHECK(fft_backend_supports(FFTBackendType::Kiss, 96));
+
+    fl::unique_ptr<IFFTBackend> fft = make_fft_backend(FFTBackendType::Radix4Fixed, 96);
+    REQUIRE(fft);
+    CHECK(fft->type() == FFTBackendType::Kiss);
+    CHECK_EQ(fft->size(), 96);
+}
+
+TEST_CASE("FFT backends - plans are shared per size") {
+    const fl::size before = fft_backend_plans_live();
+    {
+        fl::unique_ptr<IFFTBackend> a = make_fft_backend(FFTBackendType::Radix4Fixed, 256);
+        fl::unique_ptr<IFFTBackend> b = make_fft_backend(FFTBackendType::Radix4Fixed, 256);
+        CHECK_EQ(fft_backend_plans_live(), before + 1);
+        fl::unique_ptr<IFFTBackend> c = make_fft_backend(FFTBackendType::Radix4Float, 256);
+        fl::unique_ptr<IFFTBackend> d = make_fft_backend(FFTBackendType::Radix4Fixed, 1024);
+        CHECK_EQ(fft_backend_plans_live(), before + 3);
+
+        // Two instances of one plan still give identical results.
+        const fl::vector<i16> in = make_signal(256, 7);
+        fl::vector<i16> out_a, out_b;
+        out_a.resize(258);
+        out_b.resize(258);
+        a->forward(in.data(), out_a.data());
+        b->forward(in.data(), out_b.data());
+        CHECK(out_a == out_b);
+    }
+    CHECK_EQ(fft_backend_plans_live(), before);
+}
+
+TEST_CASE("FFT backends - selectable through FFT_Args and the default") {
+    const fl::vector<i16> in = make_signal(512, 11);
+    span<const i16> pcm(in.data(), in.size());
+
+    // The constant-Q bands of this signal are small, so a few LSBs of FFT
+    // error show up as a few percent; compare in absolute terms.
+    FFTBins kiss(16);
+    FFTImpl(FFT_Args(512, 16)).run(pcm, &kiss);
+    for (FFTBackendType type : kBackends) {
+        FFTBins bins(16);
+        FFT_Args args(512, 16, FFT_Args::DefaultMinFrequency(),
+                      FFT_Args::DefaultMaxFrequency(),
+                      FFT_Args::DefaultSampleRate(), type);
+        FFTImpl(args).run(pcm, &bins);
+        REQUIRE_EQ(bins.bins_raw.size(), kiss.bins_raw.size());
+        for (fl::size i = 0; i < bins.bins_raw.size(); ++i) {
+            CHECK_LE(fabs(bins.bins_raw[i] - kiss.bins_raw[i]), 4.0);
+        }
+    }
+
+    // Default follows set_fft_default_backend(), and FFT caches one impl per
+    // resolved backend.
+    CHECK(fft_default_backend() == FFTBackendType::Kiss);
+    FFT fft;
+    FFTBins bins(16);
+    fft.run(pcm, &bins);
+    CHECK_EQ(fft.size(), 1);
+    set_fft_default_backend(FFTBackendType::Radix4Fixed);
+    CHECK(fft_default_backend() == FFTBackendType::Radix4Fixed);
+    fft.run(pcm, &bins);
+    CHECK_EQ(fft.size(), 2);
+    set_fft_default_backend(FFTBackendType::Default);
+    CHECK(fft_default_backend() == FFTBackendType::Kiss);
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("FFT backends - benchmark" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    auto us = [](clock::duration d) {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()) / 1000.0;
+    };
+    const int sizes[] = {256, 512, 1024, 4096};
+    for (int n : sizes) {
+        fl::vector<i16> in = make_signal(n, 3);
+        fl::vector<i16> out;
+        out.resize(n + 2);
+        const int runs = 400000 / n;
+        fl::StrStream line;
+        line << "fft n=" << n << ":";
+        for (FFTBackendType type : kBackends) {
+            fl::unique_ptr<IFFTBackend> fft = make_fft_backend(type, n);
+            int sink = 0;
+            auto t0 = clock::now();
+            for (int r = 0; r < runs; ++r) {
+                in[r & 15] ^= 1;
+                fft->forward(in.data(), out.data());
+                sink += out[2 * (r & 7)];
+            }
+            auto t1 = clock::now();
+            line << " " << fft->name() << " " << us(t1 - t0) / runs << " us";
+            CHECK(sink != 0x7fffffff);
+        }
+        MESSAGE(line.str());
+    }
+}
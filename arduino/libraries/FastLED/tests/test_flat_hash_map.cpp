@@ -0,0 +1,280 @@
+// Unit tests and benchmarks for FlatHashMap
+
+#include <chrono>
+#include <unordered_map>
+
+#include "fl/flat_hash_map.h"
+#include "fl/hash_map.h"
+#include "fl/str.h"
+#include "fl/vector.h"
+#include "test.h"
+
+using namespace fl;
+
+namespace {
+
+u32 lcg(u32 &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+} // namespace
+
+TEST_CASE("FlatHashMap - insert, find, overwrite, erase") {
+    FlatHashMap<int, int> m;
+    CHECK(m.empty());
+    CHECK(m.begin() == m.end());
+    CHECK(m.find_value(1) == nullptr);
+
+    m.insert(1, 10);
+    m.insert(2, 20);
+    m.insert(1, 11);
+    CHECK_EQ(m.size(), 2u);
+    REQUIRE(m.find_value(1));
+    CHECK_EQ(*m.find_value(1), 11);
+    CHECK(m.contains(2));
+    CHECK_FALSE(m.contains(3));
+
+    m[3] += 5;
+    CHECK_EQ(m[3], 5);
+    CHECK_EQ(m.size(), 3u);
+
+    CHECK(m.erase(2));
+    CHECK_FALSE(m.erase(2));
+    CHECK_FALSE(m.contains(2));
+    CHECK_EQ(m.size(), 2u);
+
+    int sum = 0;
+    for (auto &kv : m) {
+        sum += kv.second;
+    }
+    CHECK_EQ(sum, 16);
+
+    auto it = m.find(1);
+    REQUIRE(it != m.end());
+    CHECK_EQ(it->first, 1);
+    it->second = 100;
+    CHECK_EQ(m[1], 100);
+
+    m.clear();
+    CHECK(m.empty());
+    CHECK_FALSE(m.contains(1));
+}
+
+TEST_CASE("FlatHashMap - erase while iterating") {
+    FlatHashMap<int, int> m;
+    for (int i = 0; i < 100; ++i) {
+        m.insert(i, i);
+    }
+    for (auto it = m.begin(); it != m.end();) {
+        if (it->first % 2 == 0) {
+            it = m.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    CHECK_EQ(m.size(), 50u);
+    for (int i = 0; i < 100; ++i) {
+        CHECK_EQ(m.contains(i), i % 2 == 1);
+    }
+}
+
+TEST_CASE("FlatHashMap - matches std::unordered_map under random churn") {
+    FlatHashMap<u32, u32> m;
+    std::unordered_map<u32, u32> ref;
+    u32 state = 1;
+    for (int op = 0; op < 50000; ++op) {
+        // Small key range so inserts and erases keep hitting each other.
+        u32 key = lcg(state) % 2000;
+        u32 action = lcg(state) % 3;
+        if (action == 0) {
+            CHECK_EQ(m.erase(key), ref.erase(key) == 1);
+        } else {
+            m.insert(key, op);
+            ref[key] = op;
+        }
+    }
+    REQUIRE_EQ(m.size(), ref.size());
+    for (const auto &kv : ref) {
+        const u32 *v = m.find_value(kv.first);
+        REQUIRE(v);
+        CHECK_EQ(*v, kv.second);
+    }
+    fl::size visited = 0;
+    for (const auto &kv : m) {
+        CHECK_EQ(ref[kv.first], kv.second);
+        ++visited;
+    }
+    CHECK_EQ(visited, ref.size());
+}
+
+TEST_CASE("FlatHashMap - erase keeps the table from filling up") {
+    // Without tombstones, a long run of insert/erase pairs never grows the
+    // table past what the live keys need.
+    FlatHashMap<u32, u32> m;
+    for (u32 i = 0; i < 10; ++i) {
+        m.insert(i, i);
+    }
+    const fl::size capacity = m.capacity();
+    for (u32 i = 10; i < 100000; ++i) {
+        m.insert(i, i);
+        CHECK(m.erase(i - 10));
+    }
+    CHECK_EQ(m.size(), 10u);
+    CHECK_EQ(m.capacity(), capacity);
+    for (u32 i = 100000 - 10; i < 100000; ++i) {
+        CHECK(m.contains(i));
+    }
+}
+
+namespace {
+// Every key starts probing at group 0.
+struct SameGroupHash {
+    u32 operator()(u32 key) const { return key & 0x7f; }
+};
+} // namespace
+
+TEST_CASE("FlatHashMap - saturated overflow counts are rebuilt under churn") {
+    FlatHashMap<u32, u32, SameGroupHash> m(2000);
+    const fl::size capacity = m.capacity();
+    // 400 keys probing past group 0 saturate its count.
+    for (u32 i = 0; i < 400; ++i) {
+        m.insert(i, i);
+    }
+    CountingMallocHook hook;
+    SetMallocFreeHook(&hook);
+    for (u32 i = 400; i < 2000; ++i) {
+        CHECK(m.erase(i - 400));
+        CHECK(m.insert(i, i));
+    }
+    ClearMallocFreeHook();
+    // Rebuilt in place to clear the stale counts, without growing.
+    CHECK_GT(hook.mallocs, 0);
+    CHECK_EQ(m.capacity(), capacity);
+    CHECK_EQ(m.size(), 400u);
+    for (u32 i = 0; i < 2000; ++i) {
+        CHECK_EQ(m.contains(i), i >= 1600);
+    }
+}
+
+TEST_CASE("FlatHashMap - string keys with const char* lookup") {
+    FlatHashMap<fl::string, int> m;
+    m.insert(fl::string("alpha"), 1);
+    m["beta"] = 2;
+    CHECK(m.contains("alpha"));
+    CHECK_FALSE(m.contains("alph"));
+    const char *key = "beta";
+    REQUIRE(m.find_value(key));
+    CHECK_EQ(*m.find_value(key), 2);
+    CHECK(m.find(fl::string("beta")) == m.find("beta"));
+    CHECK(m.erase("alpha"));
+    CHECK_EQ(m.size(), 1u);
+}
+
+TEST_CASE("FlatHashMap - copy and move") {
+    FlatHashMap<int, fl::string> a;
+    for (int i = 0; i < 40; ++i) {
+        a.insert(i, fl::string("v") + i);
+    }
+    FlatHashMap<int, fl::string> b = a;
+    CHECK_EQ(b.size(), 40u);
+    CHECK_EQ(*b.find_value(7), fl::string("v7"));
+    FlatHashMap<int, fl::string> c = fl::move(a);
+    CHECK_EQ(c.size(), 40u);
+    CHECK(a.empty());
+    CHECK_EQ(*c.find_value(39), fl::string("v39"));
+}
+
+TEST_CASE("FlatHashMap - SWAR group matches the byte-wise answer") {
+    u32 state = 7;
+    for (int round = 0; round < 1000; ++round) {
+        u8 ctrl[16];
+        for (u8 &c : ctrl) {
+            c = (lcg(state) % 4 == 0) ? 0x80 : static_cast<u8>(lcg(state) % 8);
+        }
+        const u8 tag = static_cast<u8>(lcg(state) % 8);
+        flat_hash_map_detail::GroupSwar group(ctrl);
+        u32 expectedMatch = 0;
+        u32 expectedEmpty = 0;
+        for (u32 i = 0; i < 16; ++i) {
+            expectedMatch |= u32(ctrl[i] == tag) << i;
+            expectedEmpty |= u32(ctrl[i] == 0x80) << i;
+        }
+        CHECK_EQ(group.matchEmpty().bits(), expectedEmpty);
+        // SWAR may report extra candidates, but never misses one.
+        const u32 got = group.match(tag).bits();
+        CHECK_EQ(got & expectedMatch, expectedMatch);
+        CHECK_EQ(got & expectedEmpty, 0u);
+    }
+}
+
+namespace {
+
+template <typename Map> struct BenchResult {
+    long long insertUs, hitUs, missUs, eraseUs;
+};
+
+template <typename Map> BenchResult<Map> runBench(const fl::vector<u32> &keys) {
+    using clock = std::chrono::steady_clock;
+    auto us = [](clock::time_point a, clock::time_point b) {
+        return (long long)std::chrono::duration_cast<std::chrono::microseconds>(
+                   b - a)
+            .count();
+    };
+    BenchResult<Map> r;
+    Map m;
+    auto t0 = clock::now();
+    for (u32 k : keys) {
+        m.insert(k, k);
+    }
+    auto t1 = clock::now();
+    u32 found = 0;
+    for (u32 k : keys) {
+        found += m.find_value(k) != nullptr;
+    }
+    auto t2 = clock::now();
+    for (u32 k : keys) {
+        found += m.find_value(k + 0x40000000u) != nullptr;
+    }
+    auto t3 = clock::now();
+    for (u32 k : keys) {
+        m.erase(k);
+    }
+    auto t4 = clock::now();
+    CHECK_EQ(found, keys.size());
+    CHECK(m.empty());
+    r.insertUs = us(t0, t1);
+    r.hitUs = us(t1, t2);
+    r.missUs = us(t2, t3);
+    r.eraseUs = us(t3, t4);
+    return r;
+}
+
+} // namespace
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("FlatHashMap - benchmark against HashMap" * doctest::skip()) {
+    const fl::size counts[] = {1000, 10000};
+    for (fl::size n : counts) {
+        fl::vector<u32> keys;
+        u32 state = 42;
+        for (fl::size i = 0; i < n; ++i) {
+            keys.push_back(lcg(state) & 0x3fffffffu);
+        }
+        // Duplicates would skew the erase count.
+        FlatHashMap<u32, bool> seen;
+        fl::vector<u32> unique;
+        for (u32 k : keys) {
+            if (!seen.contains(k)) {
+                seen.insert(k, true);
+                unique.push_back(k);
+            }
+        }
+        auto flat = runBench<FlatHashMap<u32, u32>>(unique);
+        auto old = runBench<HashMap<u32, u32>>(unique);
+        MESSAGE(n << " keys, insert/find-hit/find-miss/erase us: FlatHashMap "
+                  << flat.insertUs << "/" << flat.hitUs << "/" << flat.missUs
+                  << "/" << flat.eraseUs << ", HashMap " << old.insertUs << "/"
+                  << old.hitUs << "/" << old.missUs << "/" << old.eraseUs);
+    }
+}
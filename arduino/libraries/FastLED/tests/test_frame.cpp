@@ -50,3 +50,25 @@ TEST_CASE("test blend by black") {
     frame->draw(&out, DRAW_MODE_BLEND_BY_MAX_BRIGHTNESS);
     CHECK(out == CRGB(64, 0, 0));
 }
+
+TEST_CASE("test frame interpolate matches CRGB::blend") {
+    // 7 pixels == 21 bytes, which exercises both the word loop and the tail.
+    const int kPixels = 7;
+    FramePtr frame1 = fl::make_shared<Frame>(kPixels);
+    FramePtr frame2 = fl::make_shared<Frame>(kPixels);
+    for (int i = 0; i < kPixels; ++i) {
+        frame1->rgb()[i] = CRGB(i * 37, 255 - i * 11, i * 5);
+        frame2->rgb()[i] = CRGB(255 - i * 29, i * 41, 255);
+    }
+    frame1->rgb()[0] = CRGB(255, 255, 255);
+    frame2->rgb()[0] = CRGB(0, 0, 0);
+    for (int amount = 0; amount < 256; ++amount) {
+        CRGB out[kPixels];
+        Frame::interpolate(*frame1, *frame2, amount, out);
+        for (int i = 0; i < kPixels; ++i) {
+            CRGB expected =
+                CRGB::blend(frame1->rgb()[i], frame2->rgb()[i], amount);
+            REQUIRE_EQ(out[i], expected);
+        }
+    }
+}
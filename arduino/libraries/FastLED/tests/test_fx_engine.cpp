@@ -208,3 +208,79 @@ TEST_CASE("test_fixed_fps") {
     CHECK_EQ(2, fake.mFrameCounter);
     CHECK_EQ(leds[0], CRGB(127, 0, 0));
 }
+
+namespace {
+
+// Reports a render cost that halves with each quality level, by advancing a
+// fake microsecond clock while drawing.
+class CostlyFx : public Fx {
+  public:
+    CostlyFx(uint16_t numLeds, fl::u32 *clock, fl::u32 costUs)
+        : Fx(numLeds), mCostUs(costUs), mClock(clock) {}
+
+    void draw(DrawContext ctx) override {
+        (void)ctx;
+        *mClock += mCostUs >> mQualityLevel;
+    }
+    fl::u8 getMaxQualityLevel() const override { return 3; }
+    Str fxName() const override { return "CostlyFx"; }
+
+    fl::u32 mCostUs;
+    fl::u32 mLevelChanges = 0;
+
+  protected:
+    void onQualityLevelChanged(fl::u8) override { ++mLevelChanges; }
+
+  private:
+    fl::u32 *mClock;
+};
+
+} // namespace
+
+TEST_CASE("FxEngine quality governor steps quality down and back up") {
+    constexpr uint16_t NUM_LEDS = 10;
+    FxEngine engine(NUM_LEDS, false);
+    CRGB leds[NUM_LEDS];
+    fl::u32 now = 0;
+    fl::u32 clock = 0;
+    engine.setRenderClock([&clock]() { return clock; });
+    fl::shared_ptr<CostlyFx> fx = fl::make_shared<CostlyFx>(NUM_LEDS, &clock, 40000);
+    int id = engine.addFx(fx);
+
+    // Without a budget the cost is measured but quality is untouched.
+    for (int i = 0; i < 20; ++i) {
+        engine.draw(now += 16, leds);
+    }
+    FxQualityTelemetry telemetry;
+    REQUIRE(engine.getQualityTelemetry(id, &telemetry));
+    CHECK_EQ(telemetry.lastRenderUs, 40000);
+    CHECK_EQ(telemetry.level, 0);
+    CHECK_EQ(telemetry.maxLevel, 3);
+    CHECK_FALSE(engine.getQualityTelemetry(id + 1, &telemetry));
+
+    // 40ms against a 16ms budget: two halvings bring it to 10ms.
+    engine.setFrameBudget(16000);
+    for (int i = 0; i < 100; ++i) {
+        engine.draw(now += 16, leds);
+    }
+    REQUIRE(engine.getQualityTelemetry(id, &telemetry));
+    CHECK_EQ(fx->getQualityLevel(), 2);
+    CHECK_EQ(telemetry.level, 2);
+    CHECK_EQ(telemetry.stepDowns, 2);
+    CHECK_EQ(telemetry.stepUps, 0);
+    CHECK_EQ(fx->mLevelChanges, 2);
+
+    // The effect gets cheaper, so quality returns once there is headroom.
+    fx->mCostUs = 4000;
+    for (int i = 0; i < 400; ++i) {
+        engine.draw(now += 16, leds);
+    }
+    REQUIRE(engine.getQualityTelemetry(id, &telemetry));
+    CHECK_EQ(fx->getQualityLevel(), 0);
+    CHECK_EQ(telemetry.stepUps, 2);
+    CHECK_EQ(telemetry.averageRenderUs, 4000);
+
+    // Removing the effect drops its governor.
+    CHECK(engine.removeFx(id) == fx);
+    CHECK_FALSE(engine.getQualityTelemetry(id, &telemetry));
+}
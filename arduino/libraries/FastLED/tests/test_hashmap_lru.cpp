@@ -4,6 +4,7 @@
 #include <vector>
 #include <set>
 #include <unordered_map>
+#include <chrono> // ok include
 
 #include "fl/hash_map_lru.h"
 #include "fl/str.h"
@@ -149,3 +150,112 @@ TEST_CASE("Test HashMapLRU") {
         CHECK(*lru.find_value(4) == 400);
     }
 }
+
+TEST_CASE("HashMapLru - recency order and removal") {
+    HashMapLru<int, int> lru(3);
+    lru.insert(1, 10);
+    lru.insert(2, 20);
+    lru.insert(3, 30);
+    lru[1] += 1;             // 1 is now the most recently used
+    CHECK(lru.find_value(2)); // then 2, leaving 3 as the oldest
+    lru.insert(4, 40);
+    CHECK(lru.find_value(3) == nullptr);
+    CHECK_EQ(*lru.find_value(1), 11);
+
+    // Freed nodes are reused without disturbing the order.
+    CHECK(lru.remove(2));
+    CHECK_FALSE(lru.remove(2));
+    lru.insert(5, 50);
+    lru.insert(6, 60); // evicts 4, the oldest left
+    CHECK(lru.find_value(4) == nullptr);
+    CHECK_EQ(lru.size(), 3u);
+    CHECK_EQ(*lru.find_value(5), 50);
+    CHECK_EQ(*lru.find_value(6), 60);
+
+    // Shrinking evicts the oldest, growing keeps everything.
+    lru.setMaxSize(1);
+    CHECK_EQ(lru.size(), 1u);
+    CHECK(lru.find_value(6));
+    lru.setMaxSize(4);
+    lru.insert(7, 70);
+    lru.insert(8, 80);
+    CHECK_EQ(lru.size(), 3u);
+    CHECK_EQ(lru.capacity(), 4u);
+}
+
+TEST_CASE("HashMapLru - byte budget") {
+    HashMapLru<int, fl::string> cache(100);
+    cache.setMaxBytes(100);
+    cache.insert(1, "a", 40);
+    cache.insert(2, "b", 40);
+    CHECK_EQ(cache.bytes(), 80u);
+    cache.insert(3, "c", 40); // over budget, 1 goes
+    CHECK_EQ(cache.size(), 2u);
+    CHECK_EQ(cache.bytes(), 80u);
+    CHECK(cache.find_value(1) == nullptr);
+
+    // Updating an entry replaces its cost.
+    cache.insert(2, "b2", 10);
+    CHECK_EQ(cache.bytes(), 50u);
+
+    // One entry bigger than the budget still stays, on its own.
+    cache.insert(4, "huge", 500);
+    CHECK_EQ(cache.size(), 1u);
+    CHECK_EQ(cache.bytes(), 500u);
+    CHECK_EQ(*cache.find_value(4), "huge");
+
+    cache.remove(4);
+    CHECK_EQ(cache.bytes(), 0u);
+    CHECK(cache.empty());
+}
+
+TEST_CASE("HashMapLru - statistics") {
+    HashMapLru<int, int> lru(2);
+    lru.insert(1, 1);
+    lru.insert(2, 2);
+    lru.insert(3, 3); // evicts 1
+    CHECK(lru.find_value(3));
+    CHECK(lru.find_value(1) == nullptr);
+    lru[2] = 5;
+    lru[4] = 4; // miss, evicts 3
+    CHECK_EQ(lru.hits(), 2u);
+    CHECK_EQ(lru.misses(), 2u);
+    CHECK_EQ(lru.evictions(), 2u);
+
+    // The const lookup neither counts nor changes the order.
+    const HashMapLru<int, int> &view = lru;
+    CHECK(view.find_value(2));
+    CHECK_EQ(lru.hits(), 2u);
+    lru.insert(5, 5); // 2 is still the oldest
+    CHECK(lru.find_value(2) == nullptr);
+
+    lru.resetStats();
+    CHECK_EQ(lru.hits(), 0u);
+    CHECK_EQ(lru.evictions(), 0u);
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("HashMapLru - benchmark" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    const int kCapacity = 1024;
+    const int kOps = 200000;
+    HashMapLru<u32, u32> lru(kCapacity);
+    u32 state = 1;
+    u32 found = 0;
+    auto t0 = clock::now();
+    for (int i = 0; i < kOps; ++i) {
+        state = state * 1664525u + 1013904223u;
+        // Skewed towards low keys so about half of the lookups hit.
+        const u32 key = (state >> 8) % ((state & 0x80) ? 512 : 4096);
+        if (u32 *v = lru.find_value(key)) {
+            found += *v;
+        } else {
+            lru.insert(key, key);
+        }
+    }
+    auto t1 = clock::now();
+    CHECK_EQ(lru.size(), static_cast<fl::size>(kCapacity));
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    MESSAGE(kOps << " lookups/inserts on a " << kCapacity
+            << " entry cache, us: " << us << " (checksum " << found << ")");
+}
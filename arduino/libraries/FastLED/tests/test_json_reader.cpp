@@ -0,0 +1,451 @@
+// Unit tests for the JsonReader pull/SAX parser and the JsonValue tree it
+// builds.
+
+#include <chrono> // ok include
+
+#include "fl/json.h"
+#include "fl/json_arduinojson.h"
+#include "fl/json_reader.h"
+#include "fl/str.h"
+#include "fl/vector.h"
+#include "test.h"
+
+using namespace fl;
+
+namespace {
+
+fl::string tokens(const char *json) {
+    JsonReader reader(json);
+    fl::string out;
+    for (;;) {
+        const JsonToken t = reader.next();
+        switch (t) {
+        case JsonToken::BeginObject: out += "{"; break;
+        case JsonToken::EndObject: out += "}"; break;
+        case JsonToken::BeginArray: out += "["; break;
+        case JsonToken::EndArray: out += "]"; break;
+        case JsonToken::Key: out += "K:"; out += reader.string().str(); break;
+        case JsonToken::String: out += "S:"; out += reader.string().str(); break;
+        case JsonToken::Int: out += "I:"; out += reader.intValue(); break;
+        case JsonToken::Float: out += "F"; break;
+        case JsonToken::Bool: out += reader.boolValue() ? "true" : "false"; break;
+        case JsonToken::Null: out += "null"; break;
+        case JsonToken::End: return out;
+        case JsonToken::Error: out += "!"; return out;
+        }
+        out += " ";
+    }
+}
+
+bool nearlyEqual(float a, float b) {
+    const float diff = a > b ? a - b : b - a;
+    const float scale = (a < 0 ? -a : a) + (b < 0 ? -b : b);
+    return diff <= 1e-6f * scale || diff < 1e-30f;
+}
+
+template <typename T>
+bool sameNumbers(const fl::vector<T> &a, const fl::vector<T> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (fl::size i = 0; i < a.size(); ++i) {
+        if (!nearlyEqual(static_cast<float>(a[i]), static_cast<float>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same shape, types and values (floats within rounding).
+bool sameTree(const JsonValue &a, const JsonValue &b) {
+    if (a.data.tag() != b.data.tag()) {
+        return false;
+    }
+    if (a.data.is<bool>()) {
+        return *a.data.ptr<bool>() == *b.data.ptr<bool>();
+    }
+    if (a.data.is<int64_t>()) {
+        return *a.data.ptr<int64_t>() == *b.data.ptr<int64_t>();
+    }
+    if (a.data.is<float>()) {
+        return nearlyEqual(*a.data.ptr<float>(), *b.data.ptr<float>());
+    }
+    if (a.data.is<fl::string>()) {
+        return *a.data.ptr<fl::string>() == *b.data.ptr<fl::string>();
+    }
+    if (a.data.is<fl::vector<uint8_t>>()) {
+        return sameNumbers(*a.data.ptr<fl::vector<uint8_t>>(),
+                           *b.data.ptr<fl::vector<uint8_t>>());
+    }
+    if (a.data.is<fl::vector<int16_t>>()) {
+        return sameNumbers(*a.data.ptr<fl::vector<int16_t>>(),
+                           *b.data.ptr<fl::vector<int16_t>>());
+    }
+    if (a.data.is<fl::vector<float>>()) {
+        return sameNumbers(*a.data.ptr<fl::vector<float>>(),
+                           *b.data.ptr<fl::vector<float>>());
+    }
+    if (a.data.is<JsonArray>()) {
+        const JsonArray &x = *a.data.ptr<JsonArray>();
+        const JsonArray &y = *b.data.ptr<JsonArray>();
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (fl::size i = 0; i < x.size(); ++i) {
+            if (!sameTree(*x[i], *y[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (a.data.is<JsonObject>()) {
+        const JsonObject &x = *a.data.ptr<JsonObject>();
+        const JsonObject &y = *b.data.ptr<JsonObject>();
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (auto it = x.begin(); it != x.end(); ++it) {
+            auto other = y.find(it->first);
+            if (other == y.end() || !sameTree(*it->second, *other->second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return true; // null
+}
+
+// Documents shaped like the ones the library exchanges.
+const char *const kCorpus[] = {
+    "{\"name\":\"bob\",\"value\":21}",
+    "[1, 2.5, \"string\", true, null]",
+    "{\"int\": 42, \"float\": 3.14, \"string\": \"value\", \"bool\": false, "
+    "\"null\": null}",
+    "[100000.5, 200000.7, 300000.14159, 400000.1, 500000.5]",
+    "[0, 255, 128, 1]",
+    "[-32768, 32767, 0, 1000]",
+    "[1, 2, 3, 70000, 16777217]",
+    "[1.5, \"x\", 2, [3, 4], {\"a\": [-1.25e2, 0.0, 1E-3]}]",
+    "{\"strKey\": \"stringValue\", \"intKey\": 42, \"floatKey\": 3.14, "
+    "\"arrayKey\": [1, 2, 3]}",
+    "{\"map\":{\"strip1\":{\"x\":[0,1,2,3],\"y\":[0.5,1.5,2.5,3.5],"
+    "\"diameter\":0.2},\"strip2\":{\"x\":[10,20],\"y\":[-1,-2]}}}",
+    "[{\"name\":\"slider\",\"id\":1,\"type\":\"slider\",\"value\":128,"
+    "\"min\":0,\"max\":255,\"step\":1},{\"name\":\"check\",\"id\":2,"
+    "\"type\":\"checkbox\",\"value\":true}]",
+    "{\"text\": \"tab\\there \\\"quoted\\\" \\u00e9 \\ud83d\\ude00\"}",
+    "9223372036854775807",
+    "-9223372036854775808",
+    "[]",
+    "{}",
+};
+
+fl::string screenMapDocument(int strips, int points) {
+    fl::string out = "{\"map\":{";
+    for (int s = 0; s < strips; ++s) {
+        if (s) {
+            out += ",";
+        }
+        out += "\"strip";
+        out += s;
+        out += "\":{\"x\":[";
+        for (int i = 0; i < points; ++i) {
+            if (i) {
+                out += ",";
+            }
+            out += i * 0.5f;
+        }
+        out += "],\"y\":[";
+        for (int i = 0; i < points; ++i) {
+            if (i) {
+                out += ",";
+            }
+            out += (i * 7) % 300;
+        }
+        out += "],\"diameter\":0.25}";
+    }
+    out += "}}";
+    return out;
+}
+
+fl::string uiDocument(int components) {
+    fl::string out = "[";
+    for (int i = 0; i < components; ++i) {
+        if (i) {
+            out += ",";
+        }
+        out += "{\"name\":\"Slider ";
+        out += i;
+        out += "\",\"group\":\"Controls\",\"id\":";
+        out += i;
+        out += ",\"type\":\"slider\",\"value\":0.5,\"min\":0,\"max\":1,"
+               "\"step\":0.01,\"enabled\":true}";
+    }
+    out += "]";
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("JsonReader - token stream") {
+    CHECK_EQ(tokens("{\"a\": [1, true, null], \"b\": {}}"),
+             "{ K:a [ I:1 true null ] K:b { } } ");
+    CHECK_EQ(tokens("  \"str\"  "), "S:str ");
+    CHECK_EQ(tokens("-0"), "I:0 ");
+    CHECK_EQ(tokens("[1.0, 1e3]"), "[ F F ] ");
+}
+
+TEST_CASE("JsonReader - strings point into the source unless escaped") {
+    const char *json = "[\"plain\", \"esc\\naped\"]";
+    JsonReader reader(json);
+    REQUIRE(reader.next() == JsonToken::BeginArray);
+    REQUIRE(reader.next() == JsonToken::String);
+    CHECK_EQ(reader.string().data, json + 2);
+    CHECK(reader.string().equals("plain"));
+    REQUIRE(reader.next() == JsonToken::String);
+    CHECK(reader.string().equals("esc\naped"));
+    CHECK(reader.next() == JsonToken::EndArray);
+    CHECK(reader.next() == JsonToken::End);
+    CHECK(reader.next() == JsonToken::End);
+}
+
+TEST_CASE("JsonReader - unicode escapes become UTF-8") {
+    JsonReader reader("\"\\u0041\\u00e9\\u20ac\\ud83d\\ude00\"");
+    REQUIRE(reader.next() == JsonToken::String);
+    CHECK(reader.string().equals("A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"));
+}
+
+TEST_CASE("JsonReader - numbers") {
+    struct Case {
+        const char *text;
+        bool isInt;
+        double value;
+    };
+    const Case cases[] = {
+        {"0", true, 0},
+        {"-42", true, -42},
+        {"9223372036854775807", true, 9223372036854775807.0},
+        {"-9223372036854775808", true, -9223372036854775807.0 - 1},
+        {"9223372036854775808", false, 9223372036854775808.0},
+        {"3.141592653589793", false, 3.141592653589793},
+        {"1.23e-4", false, 1.23e-4},
+        {"-2.5E+2", false, -250},
+        {"18446744073709551616", false, 18446744073709551616.0},
+        {"1e300", false, 1e300},
+        {"0.000000000000000000000000001", false, 1e-27},
+    };
+    for (const Case &c : cases) {
+        JsonReader reader(c.text);
+        const JsonToken t = reader.next();
+        INFO(fl::string(c.text));
+        CHECK_EQ(t == JsonToken::Int, c.isInt);
+        if (c.isInt) {
+            CHECK_EQ(static_cast<double>(reader.intValue()), c.value);
+        } else {
+            REQUIRE(t == JsonToken::Float);
+            CHECK_EQ(reader.floatValue(), doctest::Approx(c.value));
+        }
+        CHECK(reader.next() == JsonToken::End);
+    }
+    JsonReader huge("1e400");
+    REQUIRE(huge.next() == JsonToken::Float);
+    CHECK_GT(huge.floatValue(), 1e308);
+    JsonReader minInt("-9223372036854775808");
+    REQUIRE(minInt.next() == JsonToken::Int);
+    CHECK_EQ(minInt.intValue(), -9223372036854775807LL - 1);
+}
+
+TEST_CASE("JsonReader - rejects malformed input") {
+    const char *const bad[] = {
+        "",        "{ invalid json }", "{\"incomplete\":", "[1, 2",
+        "[1,]",    "{\"a\" 1}",        "{\"a\":1,}",       "01",
+        "1.",      "-",                "1e",               "tru",
+        "\"open",  "\"bad \\x\"",      "\"\\ud800\"",      "[1] [2]",
+        "{1: 2}",  "'single'",         "\"tab\there\"",    "nul",
+    };
+    for (const char *text : bad) {
+        INFO(fl::string(text));
+        JsonReader reader(text);
+        JsonToken t = reader.next();
+        while (t != JsonToken::End && t != JsonToken::Error) {
+            t = reader.next();
+        }
+        CHECK(t == JsonToken::Error);
+        CHECK(reader.error() != nullptr);
+        CHECK(reader.next() == JsonToken::Error);
+    }
+    JsonReader reader("[1, x]");
+    while (reader.next() != JsonToken::Error) {
+    }
+    CHECK_EQ(reader.errorOffset(), 4);
+}
+
+TEST_CASE("JsonReader - nesting limit") {
+    fl::string deep;
+    for (int i = 0; i < FASTLED_JSON_MAX_DEPTH; ++i) {
+        deep += "[";
+    }
+    for (int i = 0; i < FASTLED_JSON_MAX_DEPTH; ++i) {
+        deep += "]";
+    }
+    JsonReader ok(deep.c_str(), deep.size());
+    JsonToken t = ok.next();
+    while (t != JsonToken::End && t != JsonToken::Error) {
+        t = ok.next();
+    }
+    CHECK(t == JsonToken::End);
+
+    fl::string tooDeep = "[";
+    tooDeep += deep;
+    tooDeep += "]";
+    JsonReader bad(tooDeep.c_str(), tooDeep.size());
+    t = bad.next();
+    while (t != JsonToken::End && t != JsonToken::Error) {
+        t = bad.next();
+    }
+    CHECK(t == JsonToken::Error);
+}
+
+TEST_CASE("JsonReader - skip") {
+    JsonReader reader("{\"big\": {\"a\": [1, 2, {\"b\": []}]}, \"want\": 7}");
+    REQUIRE(reader.next() == JsonToken::BeginObject);
+    REQUIRE(reader.next() == JsonToken::Key);
+    CHECK(reader.string().equals("big"));
+    CHECK(reader.skip(reader.next()));
+    REQUIRE(reader.next() == JsonToken::Key);
+    CHECK(reader.string().equals("want"));
+    REQUIRE(reader.next() == JsonToken::Int);
+    CHECK_EQ(reader.intValue(), 7);
+    CHECK(reader.next() == JsonToken::EndObject);
+    CHECK(reader.next() == JsonToken::End);
+}
+
+TEST_CASE("JsonReader - SAX handler") {
+    struct Summer : public JsonHandler {
+        bool onKey(const JsonStringRef &key) override {
+            inX = key.equals("x");
+            return true;
+        }
+        bool onInt(int64_t value) override {
+            if (inX) {
+                sum += value;
+            }
+            return true;
+        }
+        bool onEndArray() override {
+            inX = false;
+            ++arrays;
+            return arrays < stopAfter;
+        }
+        bool inX = false;
+        int64_t sum = 0;
+        int arrays = 0;
+        int stopAfter = 100;
+    };
+
+    const char *json = "{\"s1\": {\"x\": [1, 2, 3], \"y\": [9]}, "
+                       "\"s2\": {\"x\": [10, 20]}}";
+    Summer all;
+    JsonReader reader(json);
+    CHECK(reader.parse(all));
+    CHECK_EQ(all.sum, 36);
+    CHECK_EQ(all.arrays, 3);
+
+    // Stopping early.
+    Summer first;
+    first.stopAfter = 1;
+    JsonReader again(json);
+    CHECK_FALSE(again.parse(first));
+    CHECK(again.error() == nullptr);
+    CHECK_EQ(first.sum, 6);
+
+    Summer broken;
+    JsonReader bad("{\"x\": [1, 2");
+    CHECK_FALSE(bad.parse(broken));
+    CHECK(bad.error() != nullptr);
+}
+
+TEST_CASE("JsonValue::parse matches the ArduinoJson based parser") {
+    for (const char *text : kCorpus) {
+        INFO(fl::string(text));
+        fl::shared_ptr<JsonValue> native = JsonValue::parse(text);
+        fl::shared_ptr<JsonValue> legacy = detail::parse_arduinojson(text);
+        REQUIRE(native);
+        REQUIRE(legacy);
+        CHECK(sameTree(*native, *legacy));
+    }
+    const fl::string big[] = {screenMapDocument(4, 200), uiDocument(50)};
+    for (const fl::string &text : big) {
+        CHECK(sameTree(*JsonValue::parse(text), *detail::parse_arduinojson(text)));
+    }
+}
+
+TEST_CASE("JsonValue::parse - array specialization") {
+    CHECK(Json::parse("[0, 255]").is_bytes());
+    CHECK(Json::parse("[-1, 300]").is_audio());
+    CHECK(Json::parse("[0.5, 70000]").is_floats());
+    CHECK(Json::parse("[1, 16777217]").is_generic_array());
+    CHECK(Json::parse("[1, \"a\"]").is_generic_array());
+    CHECK(Json::parse("[]").is_generic_array());
+    CHECK(Json::parse("{\"a\": 1,}").is_null());
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("JsonValue::parse - benchmark against ArduinoJson" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    auto us = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(b - a)
+            .count();
+    };
+    struct Doc {
+        const char *name;
+        fl::string text;
+    };
+    const Doc docs[] = {
+        {"corpus", fl::string()},
+        {"screenmap", screenMapDocument(8, 500)},
+        {"ui", uiDocument(100)},
+    };
+    for (const Doc &doc : docs) {
+        const int iterations = 20;
+        int nodes = 0;
+        auto t0 = clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            if (doc.text.empty()) {
+                for (const char *text : kCorpus) {
+                    nodes += JsonValue::parse(text) ? 1 : 0;
+                }
+            } else {
+                nodes += JsonValue::parse(doc.text) ? 1 : 0;
+            }
+        }
+        auto t1 = clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            if (doc.text.empty()) {
+                for (const char *text : kCorpus) {
+                    nodes += detail::parse_arduinojson(text) ? 1 : 0;
+                }
+            } else {
+                nodes += detail::parse_arduinojson(doc.text) ? 1 : 0;
+            }
+        }
+        auto t2 = clock::now();
+        CHECK_GT(nodes, 0);
+
+        // Pull parsing alone, without building a tree.
+        int tokenCount = 0;
+        auto t3 = clock::now();
+        for (int i = 0; i < iterations && !doc.text.empty(); ++i) {
+            JsonReader reader(doc.text.c_str(), doc.text.size());
+            for (JsonToken t = reader.next(); t != JsonToken::End;
+                 t = reader.next()) {
+                ++tokenCount;
+            }
+        }
+        auto t4 = clock::now();
+        MESSAGE(fl::string(doc.name) << " (" << doc.text.size() << " bytes) x" << iterations
+                         << ", us: JsonValue::parse " << us(t0, t1)
+                         << ", parse_arduinojson " << us(t1, t2)
+                         << ", JsonReader tokens only " << us(t3, t4));
+    }
+}
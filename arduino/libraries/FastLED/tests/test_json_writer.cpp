@@ -0,0 +1,216 @@
+// Unit tests for the streaming JsonWriter
+
+#include <chrono> // ok include
+#include <stdio.h> // ok include
+
+#include "fl/json.h"
+#include "fl/json_writer.h"
+#include "fl/str.h"
+#include "test.h"
+
+using namespace fl;
+
+namespace {
+
+fl::string formatted(float value, int precision) {
+    char buf[48];
+    return fl::string(buf, JsonWriter::formatFloat(value, precision, buf));
+}
+
+fl::string printed(float value, int precision) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", precision, static_cast<double>(value));
+    return fl::string(buf);
+}
+
+} // namespace
+
+TEST_CASE("JsonWriter - streaming API") {
+    fl::string out;
+    {
+        JsonWriter w(out);
+        w.beginObject();
+        w.key("id").value(3);
+        w.key("name").value("strip");
+        w.key("on").value(true);
+        w.key("gain").value(0.5f);
+        w.key("list").beginArray().value(1).nullValue().beginObject().endObject();
+        w.endArray();
+        w.key("empty").beginArray().endArray();
+        w.endObject();
+    }
+    CHECK_EQ(out, "{\"id\":3,\"name\":\"strip\",\"on\":true,\"gain\":0.500,"
+                  "\"list\":[1,null,{}],\"empty\":[]}");
+}
+
+TEST_CASE("JsonWriter - escapes") {
+    fl::string out;
+    JsonWriter w(out);
+    w.value("q\"b\\n\nt\t\x01 \xC3\xA9");
+    w.flush();
+    CHECK_EQ(out, "\"q\\\"b\\\\n\\nt\\t\\u0001 \xC3\xA9\"");
+}
+
+TEST_CASE("JsonWriter - fixed buffer") {
+    char buf[8];
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray().value(1).value(2).endArray();
+    CHECK_FALSE(w.overflow());
+    CHECK_EQ(fl::string(buf), "[1,2]");
+
+    w.value("long string");
+    CHECK(w.overflow());
+    CHECK_EQ(fl::string(buf), "[1,2],\"");
+    CHECK_GT(w.size(), sizeof(buf));
+}
+
+TEST_CASE("JsonWriter - output longer than the internal chunk") {
+    fl::string expected = "[";
+    fl::string out;
+    {
+        JsonWriter w(out);
+        w.beginArray();
+        for (int i = 0; i < 500; ++i) {
+            w.value(i);
+            if (i) {
+                expected += ",";
+            }
+            expected += i;
+        }
+        w.endArray();
+    }
+    expected += "]";
+    CHECK_EQ(out, expected);
+}
+
+TEST_CASE("JsonWriter - integers") {
+    char buf[24];
+    CHECK_EQ(fl::string(buf, JsonWriter::formatInt(0, buf)), "0");
+    CHECK_EQ(fl::string(buf, JsonWriter::formatInt(-17, buf)), "-17");
+    CHECK_EQ(fl::string(buf, JsonWriter::formatInt(9223372036854775807LL, buf)),
+             "9223372036854775807");
+    CHECK_EQ(fl::string(buf, JsonWriter::formatInt(-9223372036854775807LL - 1, buf)),
+             "-9223372036854775808");
+}
+
+TEST_CASE("JsonWriter - floats match printf") {
+    const float samples[] = {0.0f,     -0.0f,    0.5f,      3.14159f, -2.5f,
+                             0.0625f,  0.1875f,  1e-4f,     -1e-4f,   123.456f,
+                             1e6f,     16777216.0f, 300000.14159f, 0.9995f,
+                             -0.0005f, 1e12f};
+    for (float v : samples) {
+        const int precisions[] = {0, 1, 3, 6};
+        for (int precision : precisions) {
+            INFO(printed(v, precision));
+            CHECK_EQ(formatted(v, precision), printed(v, precision));
+        }
+    }
+    // Pseudo random values across many magnitudes.
+    u32 state = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        const float mantissa = static_cast<float>(state >> 8) / 16777216.0f;
+        const int exponent = static_cast<int>(state % 24) - 8;
+        float v = mantissa;
+        for (int e = 0; e < exponent; ++e) {
+            v *= 10.0f;
+        }
+        for (int e = 0; e > exponent; --e) {
+            v /= 10.0f;
+        }
+        if (state & 0x10) {
+            v = -v;
+        }
+        const int precision = (i & 1) ? 3 : 6;
+        if (formatted(v, precision) != printed(v, precision)) {
+            INFO(printed(v, precision));
+            CHECK_EQ(formatted(v, precision), printed(v, precision));
+            break;
+        }
+    }
+}
+
+TEST_CASE("JsonWriter - floats without a fixed spelling") {
+    const float inf = 1e30f * 1e30f;
+    CHECK_EQ(formatted(inf, 3), "null");
+    CHECK_EQ(formatted(inf - inf, 3), "null");
+    // Past 2^64 exponent form with nine significant digits, valid JSON that
+    // reads back as the same float.
+    const float huge[] = {3e38f, -1.5e20f, 18446744073709551616.0f, 1.2345678e30f};
+    for (float v : huge) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%.8e", static_cast<double>(v));
+        CHECK_EQ(formatted(v, 3), fl::string(expected));
+    }
+}
+
+TEST_CASE("Json::to_string uses the streaming writer") {
+    Json json = Json::parse("{\"a\": [1, 2], \"b\": [0.5, 70000], \"c\": [-1, 300],"
+                            " \"d\": [\"x\", null], \"e\": 2.25, \"f\": 1e10}");
+    REQUIRE(json.is_object());
+    fl::string out = json.to_string();
+    Json back = Json::parse(out);
+    CHECK(back["a"].is_bytes());
+    CHECK(back["b"].is_floats());
+    CHECK(back["c"].is_audio());
+    CHECK_EQ(back["d"][0].as_or(fl::string()), "x");
+    CHECK(back["d"][1].is_null());
+    CHECK_EQ(back["e"].as_or(0.0f), 2.25f);
+    CHECK_EQ(Json::parse("[0.5, 70000]").to_string(), "[0.500000,70000.000000]");
+    CHECK_EQ(Json::parse("9223372036854775807").to_string(), "9223372036854775807");
+    CHECK_EQ(Json().to_string(), "null");
+
+    // Writing through Json::write gives the same text.
+    fl::string streamed;
+    {
+        JsonWriter w(streamed);
+        json.write(w);
+    }
+    CHECK_EQ(streamed, out);
+    CHECK_GE(JsonWriter::estimateSize(*JsonValue::parse("[1,2,3]")), 7);
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("JsonWriter - benchmark" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    fl::string text = "[";
+    for (int i = 0; i < 100; ++i) {
+        if (i) {
+            text += ",";
+        }
+        text += "{\"name\":\"Slider ";
+        text += i;
+        text += "\",\"group\":\"Controls\",\"id\":";
+        text += i;
+        text += ",\"type\":\"slider\",\"value\":0.5,\"min\":0,\"max\":1,"
+                "\"step\":0.01,\"enabled\":true,\"x\":[0.25,1.5,2.75]}";
+    }
+    text += "]";
+    Json doc = Json::parse(text);
+    REQUIRE(doc.is_array());
+
+    const int iterations = 50;
+    fl::size total = 0;
+    auto t0 = clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        total += doc.to_string().size();
+    }
+    auto t1 = clock::now();
+    fl::string reused;
+    for (int i = 0; i < iterations; ++i) {
+        reused.clear();
+        JsonWriter w(reused);
+        doc.write(w);
+        w.flush();
+        total += reused.size();
+    }
+    auto t2 = clock::now();
+    CHECK_GT(total, 0);
+    auto us = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(b - a)
+            .count();
+    };
+    MESSAGE("UI list of 100 components x" << iterations
+            << ", us: Json::to_string " << us(t0, t1)
+            << ", JsonWriter into a reused string " << us(t1, t2));
+}
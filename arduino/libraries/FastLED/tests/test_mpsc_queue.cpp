@@ -0,0 +1,101 @@
+// Unit tests for fl::mpsc_queue, including a multi-producer stress test
+
+#include "test.h"
+
+#include "fl/mpsc_queue.h"
+#include "fl/string.h"
+
+#if FASTLED_MULTITHREADED
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace fl;
+
+TEST_CASE("mpsc_queue - push and pop") {
+    mpsc_queue<int, 4> q;
+    CHECK(q.empty());
+    for (int i = 0; i < 4; ++i) {
+        CHECK(q.push(i));
+    }
+    CHECK_FALSE(q.push(4));
+    CHECK_EQ(q.size(), 4u);
+
+    int v = -1;
+    for (int round = 0; round < 10; ++round) {
+        REQUIRE(q.pop(v));
+        CHECK_EQ(v, round);
+        CHECK(q.push(round + 4)); // cells are reused on every lap
+    }
+    CHECK_EQ(q.size(), 4u);
+}
+
+TEST_CASE("mpsc_queue - non trivial elements") {
+    mpsc_queue<fl::string, 2> q;
+    CHECK(q.emplace("first element, long enough to need the heap"));
+    CHECK(q.push(fl::string("second")));
+    fl::string s;
+    CHECK(q.pop(s));
+    CHECK_EQ(s, "first element, long enough to need the heap");
+    // "second" is destroyed with the queue.
+}
+
+#if FASTLED_MULTITHREADED
+
+namespace {
+
+const int kProducers = 4;
+const u32 kItemsPerProducer = 50000;
+
+struct Producer {
+    mpsc_queue<u32, 128>* queue;
+    u32 id;
+};
+
+void* produce(void* arg) {
+    Producer* p = static_cast<Producer*>(arg);
+    for (u32 i = 0; i < kItemsPerProducer; ++i) {
+        // Producer id in the top byte, sequence number below.
+        while (!p->queue->push((p->id << 24) | i)) {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("mpsc_queue - many producer threads") {
+    mpsc_queue<u32, 128> queue;
+    Producer producers[kProducers];
+    pthread_t threads[kProducers];
+    for (int i = 0; i < kProducers; ++i) {
+        producers[i].queue = &queue;
+        producers[i].id = static_cast<u32>(i);
+        REQUIRE_EQ(pthread_create(&threads[i], nullptr, produce, &producers[i]), 0);
+    }
+
+    // Each producer's items must come out in the order it pushed them.
+    u32 next[kProducers] = {};
+    bool in_order = true;
+    u32 received = 0;
+    while (received < kProducers * kItemsPerProducer) {
+        u32 item;
+        if (!queue.pop(item)) {
+            continue;
+        }
+        const u32 id = item >> 24;
+        REQUIRE(id < static_cast<u32>(kProducers));
+        in_order = in_order && (item & 0xFFFFFF) == next[id];
+        ++next[id];
+        ++received;
+    }
+    for (int i = 0; i < kProducers; ++i) {
+        pthread_join(threads[i], nullptr);
+        CHECK_EQ(next[i], kItemsPerProducer);
+    }
+    CHECK(in_order);
+    CHECK(queue.empty());
+}
+
+#endif // FASTLED_MULTITHREADED
@@ -0,0 +1,175 @@
+// Unit tests for the structure-of-arrays particle engine and the Luminova
+// effect built on it.
+
+#include "test.h"
+
+#include <chrono>
+
+#include "FastLED.h"
+#include "fl/allocator.h"
+#include "fl/particles.h"
+#include "fx/2d/luminova.h"
+
+using namespace fl;
+
+namespace {
+
+// The float soft dot that Luminova used to draw per particle, used as the
+// reference for the splatter.
+void reference_soft_dot(CRGB *leds, const XYMap &xyMap, float fx, float fy,
+                        float s, u8 gain) {
+    float r = fl::clamp<float>(s * 0.5f, 1.0f, 3.0f);
+    int R = static_cast<int>(fl::ceil(r));
+    int cx = static_cast<int>(fx + (fx >= 0.0f ? 0.5f : -0.5f));
+    int cy = static_cast<int>(fy + (fy >= 0.0f ? 0.5f : -0.5f));
+    float r2 = r * r;
+    for (int dy = -R; dy <= R; ++dy) {
+        for (int dx = -R; dx <= R; ++dx) {
+            float d2 = static_cast<float>(dx * dx + dy * dy);
+            if (d2 > r2) {
+                continue;
+            }
+            float vf = 255.0f * (1.0f - (d2 / (r2 + 0.0001f)));
+            u8 v = static_cast<u8>(fl::clamp<float>(vf, 0.0f, 255.0f));
+            int x = cx + dx;
+            int y = cy + dy;
+            if (xyMap.has(x, y)) {
+                leds[xyMap.mapToIndex(x, y)] += CHSV(0, 0, scale8(v, gain));
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Particles2D decay and advance") {
+    Particles2D particles(4);
+    CHECK_EQ(particles.aliveCount(), 0);
+    particles.spawn(1, 0, 0, 0, 1, 0, Particles2D::kStrengthOne);
+    particles.spawn(2, 0, 0, 16384, 1, 0, Particles2D::kStrengthOne);
+    CHECK_EQ(particles.aliveCount(), 2);
+
+    particles.advance();
+    // Heading 0 moves along +x, a quarter turn moves along +y.
+    CHECK(particles.x()[1] > Particles2D::kPositionOne - 512);
+    CHECK(particles.y()[1] == 0);
+    CHECK(particles.x()[2] == 0);
+    CHECK(particles.y()[2] > Particles2D::kPositionOne - 512);
+
+    // Halving each step kills the particles after two steps.
+    particles.decay(32768, Particles2D::kStrengthOne / 3);
+    CHECK_EQ(particles.aliveCount(), 2);
+    particles.decay(32768, Particles2D::kStrengthOne / 3);
+    CHECK_EQ(particles.aliveCount(), 0);
+}
+
+TEST_CASE("ParticleSplatter matches per dot drawing") {
+    const u16 W = 21;
+    const u16 H = 13;
+    XYMap xyMap = XYMap::constructSerpentine(W, H);
+    const u8 gains[] = {255, 128, 40};
+    for (u8 gain : gains) {
+        Particles2D particles(40);
+        CRGB expected[W * H];
+        CRGB actual[W * H];
+        for (u32 i = 0; i < W * H; ++i) {
+            expected[i] = actual[i] = CRGB(i * 7, i * 3, 20);
+        }
+        for (u32 i = 0; i < particles.capacity(); ++i) {
+            // Integer positions and radii of 1, 2 and 3 are exact in both
+            // implementations. Some dots hang over the edges.
+            i32 x = static_cast<i32>((i * 7) % (W + 4)) - 2;
+            i32 y = static_cast<i32>((i * 5) % (H + 4)) - 2;
+            u16 s = static_cast<u16>(Particles2D::kStrengthOne * 2 * (1 + i % 3));
+            particles.spawn(i, x * Particles2D::kPositionOne,
+                            y * Particles2D::kPositionOne, 0, 1, 0, s);
+            reference_soft_dot(expected, xyMap, static_cast<float>(x),
+                               static_cast<float>(y),
+                               static_cast<float>(s) / Particles2D::kStrengthOne,
+                               gain);
+        }
+        ParticleSplatter splatter;
+        splatter.draw(particles, gain, xyMap, actual);
+        CHECK_EQ(splatter.lastSplatCount(), particles.capacity());
+        for (u32 i = 0; i < W * H; ++i) {
+            REQUIRE_EQ(actual[i], expected[i]);
+        }
+    }
+}
+
+TEST_CASE("ParticleSplatter clears between draws and skips far particles") {
+    XYMap xyMap = XYMap::constructRectangularGrid(16, 16);
+    Particles2D particles(2);
+    particles.spawn(0, 3 * Particles2D::kPositionOne, 3 * Particles2D::kPositionOne,
+                    0, 1, 0, Particles2D::kStrengthOne * 2);
+    particles.spawn(1, -10 * Particles2D::kPositionOne, 4 * Particles2D::kPositionOne,
+                    0, 1, 0, Particles2D::kStrengthOne * 2);
+    ParticleSplatter splatter;
+    CRGB leds[16 * 16];
+    splatter.draw(particles, 255, xyMap, leds);
+    CHECK_EQ(splatter.lastSplatCount(), 1);
+    CHECK_EQ(splatter.accumulated(3, 3), 255);
+
+    particles.kill(0);
+    splatter.draw(particles, 255, xyMap, leds);
+    CHECK_EQ(splatter.lastSplatCount(), 0);
+    CHECK_EQ(splatter.accumulated(3, 3), 0);
+}
+
+TEST_CASE("Luminova draws and does not allocate in steady state") {
+    XYMap xyMap = XYMap::constructRectangularGrid(32, 32);
+    Luminova::Params params;
+    params.max_particles = 64;
+    Luminova fx(xyMap, params);
+    CRGB leds[32 * 32];
+    for (u32 frame = 0; frame < 100; ++frame) {
+        fx.draw(Fx::DrawContext(frame * 16, leds));
+    }
+    CHECK_GT(fx.getParticles().aliveCount(), 0);
+    int lit = 0;
+    for (int i = 0; i < 32 * 32; ++i) {
+        lit += leds[i] != CRGB::Black ? 1 : 0;
+    }
+    CHECK_GT(lit, 0);
+
+    CountingMallocHook hook;
+    SetMallocFreeHook(&hook);
+    for (u32 frame = 100; frame < 200; ++frame) {
+        fx.draw(Fx::DrawContext(frame * 16, leds));
+    }
+    ClearMallocFreeHook();
+    CHECK_EQ(hook.mallocs, 0);
+    CHECK_EQ(hook.frees, 0);
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("Particle engine benchmark" * doctest::skip()) {
+    const u16 W = 128;
+    const u16 H = 128;
+    XYMap xyMap = XYMap::constructRectangularGrid(W, H);
+    fl::vector<CRGB> leds(W * H, CRGB::Black);
+    const u32 counts[] = {1000, 10000, 100000};
+    for (u32 count : counts) {
+        Particles2D particles(count);
+        ParticleSplatter splatter;
+        u32 seed = 1;
+        for (u32 i = 0; i < count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            i32 x = static_cast<i32>((seed >> 8) % (W * Particles2D::kPositionOne / 256)) * 256;
+            i32 y = static_cast<i32>((seed >> 4) % (H * Particles2D::kPositionOne / 256)) * 256;
+            particles.spawn(i, x, y, static_cast<u16>(seed), 1, 0,
+                            Particles2D::kStrengthOne * 3);
+        }
+        const int kFrames = 5;
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < kFrames; ++f) {
+            particles.decay(65339, 0);
+            particles.advance();
+            splatter.draw(particles, 128, xyMap, leds.data());
+        }
+        auto end = std::chrono::steady_clock::now();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        MESSAGE(count << " particles: " << (us / kFrames) << " us/frame");
+        CHECK_EQ(particles.aliveCount(), count);
+    }
+}
@@ -0,0 +1,129 @@
+// PixelIterator::writeRGB() / writeRGBW() against the per pixel
+// loadAndScale loop the RMT5 worker pool used to fill its strip buffers.
+
+#include "test.h"
+
+#include "FastLED.h"
+#include "pixel_controller.h"
+#include "pixel_iterator.h"
+#include "fl/strstream.h"
+#include "fl/vector.h"
+
+#include <chrono> // ok include
+
+using namespace fl;
+
+namespace {
+
+// RmtController5::loadPixelData() before writeRGB().
+void encode_per_pixel(PixelIterator &pixels, u8 *out) {
+    if (pixels.get_rgbw().active()) {
+        while (pixels.has(1)) {
+            pixels.loadAndScaleRGBW(out, out + 1, out + 2, out + 3);
+            out += 4;
+            pixels.advanceData();
+            pixels.stepDithering();
+        }
+    } else {
+        while (pixels.has(1)) {
+            pixels.loadAndScaleRGB(out, out + 1, out + 2);
+            out += 3;
+            pixels.advanceData();
+            pixels.stepDithering();
+        }
+    }
+}
+
+// And with it.
+void encode_batch(PixelIterator &pixels, u8 *out) {
+    if (pixels.get_rgbw().active()) {
+        pixels.writeRGBW(out);
+    } else {
+        pixels.writeRGB(out);
+    }
+}
+
+fl::vector<CRGB> make_leds(int count) {
+    fl::vector<CRGB> leds(count);
+    u32 seed = 7;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        leds[i] = CRGB(u8(seed >> 24), u8(seed >> 16), u8(seed >> 8));
+    }
+    return leds;
+}
+
+ColorAdjustment make_adjustment() {
+    ColorAdjustment adj;
+    adj.premixed = CRGB(200, 180, 150);
+#if FASTLED_HD_COLOR_MIXING
+    adj.color = CRGB(255, 230, 190);
+    adj.brightness = 200;
+#endif
+    return adj;
+}
+
+} // namespace
+
+TEST_CASE("PixelIterator - writeRGB matches the per pixel loop") {
+    const fl::vector<CRGB> leds = make_leds(97);
+    const Rgbw modes[] = {RgbwInvalid::value(), Rgbw(kRGBWDefaultColorTemp, kRGBWExactColors),
+                          Rgbw(kRGBWDefaultColorTemp, kRGBWBoostedWhite, W0)};
+    for (const Rgbw &rgbw : modes) {
+        // Dithering steps per pixel, so both paths start from one state.
+        PixelController<GRB> pc(leds.data(), int(leds.size()), make_adjustment(), BINARY_DITHER);
+        PixelController<GRB> a(pc);
+        PixelController<GRB> b(pc);
+        PixelIterator perPixel = a.as_iterator(rgbw);
+        PixelIterator batch = b.as_iterator(rgbw);
+
+        // One spare byte past the frame to catch overruns.
+        const fl::size bytes = leds.size() * (rgbw.active() ? 4 : 3);
+        fl::vector<u8> expected(bytes + 1, 0xAB);
+        fl::vector<u8> actual(bytes + 1, 0xAB);
+        encode_per_pixel(perPixel, expected.data());
+        encode_batch(batch, actual.data());
+
+        INFO("rgbw mode " << int(rgbw.rgbw_mode));
+        CHECK(expected == actual);
+        CHECK_EQ(actual[bytes], 0xAB);
+        CHECK_FALSE(batch.has(1)); // consumed, like the per pixel loop
+    }
+}
+
+// Timing only, so skipped by default; run with --no-skip. Host numbers
+// only: the ESP32 has a different cost per indirect call.
+TEST_CASE("PixelIterator - encode benchmark, per pixel vs writeRGB" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    const int sizes[] = {300, 1000, 5000};
+    for (int count : sizes) {
+        const fl::vector<CRGB> leds = make_leds(count);
+        fl::vector<u8> out(count * 3);
+        const int runs = 2000000 / count;
+
+        auto t0 = clock::now();
+        for (int r = 0; r < runs; ++r) {
+            PixelController<GRB> pc(leds.data(), count, make_adjustment(), BINARY_DITHER);
+            PixelIterator it = pc.as_iterator(RgbwInvalid::value());
+            encode_per_pixel(it, out.data());
+        }
+        auto t1 = clock::now();
+        for (int r = 0; r < runs; ++r) {
+            PixelController<GRB> pc(leds.data(), count, make_adjustment(), BINARY_DITHER);
+            PixelIterator it = pc.as_iterator(RgbwInvalid::value());
+            encode_batch(it, out.data());
+        }
+        auto t2 = clock::now();
+
+        auto ns = [&](clock::duration d) {
+            return double(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()) / runs;
+        };
+        const double perPixel = ns(t1 - t0);
+        const double batch = ns(t2 - t1);
+        fl::StrStream line;
+        line << count << " leds: per pixel " << perPixel / 1000.0 << " us ("
+             << perPixel / count << " ns/led), writeRGB " << batch / 1000.0 << " us ("
+             << batch / count << " ns/led), " << perPixel / batch << "x";
+        MESSAGE(line.str());
+    }
+}
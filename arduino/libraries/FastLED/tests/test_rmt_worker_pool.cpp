@@ -0,0 +1,263 @@
+// Unit tests for fl::RmtWorkerPool driven by fake RMT channels
+
+#include "test.h"
+
+#include "platforms/shared/rmt_worker_pool/rmt_worker_pool.h"
+
+using namespace fl;
+
+namespace {
+
+// Simulated time shared by the fake channels. The pool's idle function
+// advances it, as a delay between polls would on a device.
+struct FakeRmtBus {
+    struct Start {
+        u32 timeUs;
+        int channel;
+        int pin;
+        u8 firstByte;
+    };
+    u32 nowUs = 0;
+    int failPin = -1; // configure() fails for this pin
+    fl::vector<Start> starts;
+};
+
+// Takes 30 us per LED, as a WS2812 does.
+class FakeRmtChannel : public IRmtWorkerChannel {
+  public:
+    FakeRmtChannel(FakeRmtBus &bus, int index) : mBus(bus), mIndex(index) {}
+
+    bool configure(const RmtWorkerConfig &config, fl::span<const u8> pixels) override {
+        CHECK(isDone());
+        if (config.pin == mBus.failPin) {
+            return false;
+        }
+        mConfig = config;
+        mPixels = pixels;
+        return true;
+    }
+
+    void transmit() override {
+        CHECK(isDone());
+        CHECK_EQ(mPixels.size(), mConfig.bytes());
+        FakeRmtBus::Start start = {mBus.nowUs, mIndex, mConfig.pin, mPixels[0]};
+        mBus.starts.push_back(start);
+        mDoneAtUs = mBus.nowUs + mConfig.ledCount * 30;
+    }
+
+    bool isDone() override { return mBus.nowUs >= mDoneAtUs; }
+
+  private:
+    FakeRmtBus &mBus;
+    int mIndex;
+    RmtWorkerConfig mConfig;
+    fl::span<const u8> mPixels;
+    u32 mDoneAtUs = 0;
+};
+
+void add_channels(RmtWorkerPool &pool, FakeRmtBus &bus, int count) {
+    for (int i = 0; i < count; ++i) {
+        pool.addChannel(new FakeRmtChannel(bus, i));
+    }
+    pool.setIdle([&bus]() { bus.nowUs += 100; });
+}
+
+RmtWorkerConfig strip_config(int pin, u32 leds) {
+    RmtWorkerConfig config;
+    config.pin = pin;
+    config.ledCount = leds;
+    config.t0h = 4;
+    config.t0l = 8;
+    config.t1h = 8;
+    config.t1l = 4;
+    config.reset = 2800;
+    return config;
+}
+
+// What RmtController5 does for one strip: fill its buffer, then show it.
+void draw(RmtWorkerPool &pool, int strip, const RmtWorkerConfig &config, u8 value) {
+    fl::span<u8> pixels = pool.buffer(strip, config);
+    for (fl::size i = 0; i < pixels.size(); ++i) {
+        pixels[i] = value;
+    }
+    pool.show(strip);
+}
+
+} // namespace
+
+TEST_CASE("RmtWorkerPool - as many strips as channels stay async") {
+    FakeRmtBus bus;
+    RmtWorkerPool pool;
+    add_channels(pool, bus, 4);
+    int strips[4];
+    for (int i = 0; i < 4; ++i) {
+        strips[i] = pool.addStrip();
+    }
+    CHECK_EQ(pool.stripCount(), 4u);
+
+    for (int frame = 0; frame < 5; ++frame) {
+        for (int i = 0; i < 4; ++i) {
+            fl::span<u8> pixels = pool.buffer(strips[i], strip_config(10 + i, 100));
+            pixels[0] = u8(frame);
+            // show() returns without waiting for anything.
+            const u32 shownAt = bus.nowUs;
+            pool.show(strips[i]);
+            CHECK_EQ(bus.nowUs, shownAt);
+            CHECK_EQ(pool.channelOf(strips[i]), i);
+            CHECK(pool.isBusy(strips[i]));
+        }
+        if (frame == 0) {
+            CHECK_EQ(pool.stats().reconfigured, 4u);
+            pool.resetStats();
+        }
+    }
+    // Every strip kept its own channel, so none was rebuilt.
+    CHECK_EQ(pool.stats().sent, 16u);
+    CHECK_EQ(pool.stats().queued, 0u);
+    CHECK_EQ(pool.stats().reconfigured, 0u);
+
+    // The next frame's buffer() waits for the channel to finish reading.
+    const u32 before = bus.nowUs;
+    pool.buffer(strips[0], strip_config(10, 100));
+    CHECK(bus.nowUs > before);
+    CHECK_FALSE(pool.isBusy(strips[0]));
+    pool.flush();
+    for (int i = 0; i < 4; ++i) {
+        CHECK_FALSE(pool.isBusy(strips[i]));
+    }
+}
+
+TEST_CASE("RmtWorkerPool - more strips than channels queue in show order") {
+    FakeRmtBus bus;
+    RmtWorkerPool pool;
+    add_channels(pool, bus, 4);
+    // Strips of different lengths finish at different times.
+    const u32 leds[6] = {300, 100, 200, 400, 50, 60};
+    int strips[6];
+    for (int i = 0; i < 6; ++i) {
+        strips[i] = pool.addStrip();
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        draw(pool, strips[i], strip_config(i, leds[i]), u8(i + 1));
+    }
+    REQUIRE_EQ(bus.starts.size(), 6u);
+    for (int i = 0; i < 6; ++i) {
+        CHECK_EQ(bus.starts[i].pin, i);
+        // Each channel sends its own strip's data, even queued ones.
+        CHECK_EQ(bus.starts[i].firstByte, u8(i + 1));
+    }
+    // The first four start at once; strip 4 takes the channel of strip 1,
+    // the first to finish, and strip 5 that of strip 4 (3 ms + 1.5 ms)
+    // since it finishes before strip 2.
+    for (int i = 0; i < 4; ++i) {
+        CHECK_EQ(bus.starts[i].timeUs, 0u);
+        CHECK_EQ(bus.starts[i].channel, i);
+    }
+    CHECK_EQ(bus.starts[4].channel, 1);
+    CHECK_EQ(bus.starts[4].timeUs, 3000u);
+    CHECK_EQ(bus.starts[5].channel, 1);
+    CHECK_EQ(bus.starts[5].timeUs, 4500u);
+    CHECK_EQ(pool.stats().queued, 2u);
+    CHECK_EQ(pool.stats().reconfigured, 6u);
+
+    // The last strip shown is still sending: show() returned once it started.
+    CHECK(pool.isBusy(strips[5]));
+    pool.flush();
+    CHECK_EQ(bus.nowUs, 12000u); // strip 3, the longest
+}
+
+TEST_CASE("RmtWorkerPool - queued strips start in order as channels free") {
+    FakeRmtBus bus;
+    RmtWorkerPool pool;
+    add_channels(pool, bus, 2);
+    const int a = pool.addStrip();
+    const int b = pool.addStrip();
+    const int c = pool.addStrip();
+    const int d = pool.addStrip();
+    pool.buffer(a, strip_config(1, 100)); // 3 ms
+    pool.buffer(b, strip_config(2, 10));  // 0.3 ms
+    pool.buffer(c, strip_config(3, 10));
+    pool.buffer(d, strip_config(4, 10));
+
+    CHECK(pool.submit(a));
+    CHECK(pool.submit(b));
+    CHECK_FALSE(pool.submit(c));
+    CHECK_FALSE(pool.submit(a)); // again, while its last frame is sending
+    CHECK_FALSE(pool.submit(d));
+    CHECK_FALSE(pool.submit(c)); // already queued: no second entry
+    CHECK(pool.isQueued(c));
+    CHECK_EQ(pool.stats().queued, 3u);
+
+    // b finishes first. a is still sending, so it keeps its place while c
+    // takes b's channel; d follows on the same channel.
+    bus.nowUs = 300;
+    pool.poll();
+    CHECK_EQ(pool.channelOf(c), 1);
+    CHECK(pool.isQueued(a));
+    CHECK(pool.isQueued(d));
+    bus.nowUs = 600;
+    pool.poll();
+    CHECK_EQ(pool.channelOf(d), 1);
+    CHECK(pool.isQueued(a));
+
+    // a goes again on its own channel, without a rebuild.
+    pool.resetStats();
+    bus.nowUs = 3000;
+    pool.poll();
+    CHECK_EQ(pool.channelOf(a), 0);
+    CHECK_EQ(pool.stats().reconfigured, 0u);
+
+    fl::vector<int> order;
+    for (fl::size i = 0; i < bus.starts.size(); ++i) {
+        order.push_back(bus.starts[i].pin);
+    }
+    REQUIRE_EQ(order.size(), 5u);
+    CHECK_EQ(order[0], 1);
+    CHECK_EQ(order[1], 2);
+    CHECK_EQ(order[2], 3);
+    CHECK_EQ(order[3], 4);
+    CHECK_EQ(order[4], 1);
+}
+
+TEST_CASE("RmtWorkerPool - config changes and failures") {
+    FakeRmtBus bus;
+    RmtWorkerPool pool;
+    add_channels(pool, bus, 2);
+    const int a = pool.addStrip();
+    const int b = pool.addStrip();
+
+    draw(pool, a, strip_config(1, 10), 1);
+    draw(pool, a, strip_config(1, 10), 2);
+    CHECK_EQ(pool.stats().reconfigured, 1u);
+    // A new length means a new buffer, so the channel is rebuilt.
+    draw(pool, a, strip_config(1, 20), 3);
+    CHECK_EQ(pool.stats().reconfigured, 2u);
+    CHECK_EQ(pool.buffer(a, strip_config(1, 20)).size(), 60u);
+    RmtWorkerConfig rgbw = strip_config(1, 20);
+    rgbw.isRgbw = true;
+    CHECK_EQ(pool.buffer(a, rgbw).size(), 80u);
+
+    // A channel that cannot be set up drops the frame and stays usable.
+    bus.failPin = 2;
+    draw(pool, b, strip_config(2, 10), 4);
+    CHECK_EQ(pool.stats().failed, 1u);
+    CHECK_FALSE(pool.isBusy(b));
+    bus.failPin = -1;
+    draw(pool, b, strip_config(2, 10), 5);
+    CHECK(pool.isBusy(b));
+
+    // Nothing to send for an empty strip.
+    const u32 sent = pool.stats().sent;
+    const int empty = pool.addStrip();
+    pool.buffer(empty, strip_config(3, 0));
+    pool.show(empty);
+    CHECK_EQ(pool.stats().sent, sent);
+
+    // Removing waits for the strip; its id is reused.
+    pool.removeStrip(b);
+    CHECK_FALSE(pool.isBusy(b));
+    CHECK_EQ(pool.stripCount(), 2u);
+    CHECK_EQ(pool.addStrip(), b);
+    CHECK(pool.buffer(b, strip_config(2, 10)).size() == 30u);
+}
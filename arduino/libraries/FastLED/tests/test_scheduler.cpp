@@ -0,0 +1,234 @@
+// Unit tests for fl::Scheduler ordering, cancellation and timing
+
+#include <chrono> // ok include
+
+#include "fl/async.h"
+#include "fl/engine_events.h"
+#include "fl/task.h"
+#include "fl/time.h"
+#include "fl/vector.h"
+#include "test.h"
+
+using namespace fl;
+
+namespace {
+
+// Routes fl::time() to a mock clock for the lifetime of the object and
+// leaves the scheduler empty on both ends.
+struct SchedulerFixture {
+    MockTimeProvider clock{1000};
+
+    SchedulerFixture() {
+        Scheduler::instance().clear_all_tasks();
+        inject_time_provider([this]() -> u32 { return clock.current_time(); });
+    }
+    ~SchedulerFixture() {
+        Scheduler::instance().clear_all_tasks();
+        clear_time_provider();
+    }
+
+    void advance(u32 ms) {
+        clock.advance(ms);
+        Scheduler::instance().update();
+    }
+};
+
+} // namespace
+
+TEST_CASE("Scheduler - timed tasks run in due order") {
+    SchedulerFixture fx;
+    fl::vector<int> order;
+    // Registered in the reverse of the order they come due.
+    auto slow = task::every_ms(300).then([&order]() { order.push_back(300); });
+    auto mid = task::every_ms(200).then([&order]() { order.push_back(200); });
+    auto fast = task::every_ms(100).then([&order]() { order.push_back(100); });
+
+    // Everything runs once straight away, in registration order.
+    Scheduler::instance().update();
+    REQUIRE_EQ(order.size(), 3u);
+    CHECK_EQ(order[0], 300);
+    CHECK_EQ(order[1], 200);
+    CHECK_EQ(order[2], 100);
+    order.clear();
+
+    fx.advance(99);
+    CHECK(order.empty());
+    fx.advance(1); // t = 100
+    REQUIRE_EQ(order.size(), 1u);
+    CHECK_EQ(order[0], 100);
+
+    // A late update runs every task that came due, earliest first.
+    order.clear();
+    fx.advance(250); // t = 350
+    REQUIRE_EQ(order.size(), 3u);
+    CHECK_EQ(order[0], 200);
+    CHECK_EQ(order[1], 100);
+    CHECK_EQ(order[2], 300);
+}
+
+TEST_CASE("Scheduler - recurring tasks are timed from their last run") {
+    SchedulerFixture fx;
+    int runs = 0;
+    auto t = task::every_ms(100).then([&runs]() { ++runs; });
+    Scheduler::instance().update();
+    CHECK_EQ(runs, 1);
+
+    fx.advance(150); // late: runs at t = 150, next due at 250
+    CHECK_EQ(runs, 2);
+    fx.advance(90);
+    CHECK_EQ(runs, 2);
+    fx.advance(10);
+    CHECK_EQ(runs, 3);
+
+    // Moving the last run time reschedules the task.
+    t.set_last_run_time(fl::time() - 100);
+    Scheduler::instance().update();
+    CHECK_EQ(runs, 4);
+    t.set_last_run_time(fl::time());
+    fx.advance(99);
+    CHECK_EQ(runs, 4);
+
+    // One update runs a task at most once, even far behind schedule.
+    fx.advance(1000);
+    CHECK_EQ(runs, 5);
+
+    // Zero and negative intervals mean "every update".
+    int every = 0;
+    auto busy = task::every_ms(0).then([&every]() { ++every; });
+    Scheduler::instance().update();
+    Scheduler::instance().update();
+    CHECK_EQ(every, 2);
+
+    // at_framerate() is scheduled like every_ms(1000 / fps).
+    int frames = 0;
+    auto fps = task::at_framerate(50).then([&frames]() { ++frames; });
+    Scheduler::instance().update();
+    CHECK_EQ(frames, 1);
+    fx.advance(19);
+    CHECK_EQ(frames, 1);
+    fx.advance(1);
+    CHECK_EQ(frames, 2);
+}
+
+TEST_CASE("Scheduler - cancellation") {
+    SchedulerFixture fx;
+    int a = 0;
+    int b = 0;
+    auto ta = task::every_ms(10).then([&a]() { ++a; });
+    auto tb = task::every_ms(10).then([&b]() { ++b; });
+    CHECK_EQ(Scheduler::instance().task_count(), 2u);
+
+    ta.cancel();
+    CHECK_EQ(Scheduler::instance().task_count(), 1u);
+    Scheduler::instance().update();
+    CHECK_EQ(a, 0);
+    CHECK_EQ(b, 1);
+
+    // Cancelling a task that already ran stops it from coming back.
+    tb.cancel();
+    fx.advance(10);
+    CHECK_EQ(b, 1);
+    CHECK_EQ(Scheduler::instance().task_count(), 0u);
+
+    // Handles of removed tasks stay usable and cancelling them is harmless,
+    // including after their slot has been reused by a new task.
+    int c = 0;
+    auto tc = task::every_ms(10).then([&c]() { ++c; });
+    ta.cancel();
+    tb.cancel();
+    Scheduler::instance().update();
+    CHECK_EQ(c, 1);
+
+    // Frame tasks can be cancelled too.
+    int frame = 0;
+    auto tf = task::after_frame([&frame]() { ++frame; });
+    tf.cancel();
+    Scheduler::instance().update_after_frame_tasks();
+    CHECK_EQ(frame, 0);
+}
+
+TEST_CASE("Scheduler - callbacks may add and cancel tasks") {
+    SchedulerFixture fx;
+    int added = 0;
+    int victim = 0;
+    task child;
+    auto doomed = task::every_ms(50).then([&victim]() { ++victim; });
+    auto parent = task::every_ms(50);
+    parent.then([&]() {
+        doomed.cancel();
+        parent.cancel();
+        child = task::every_ms(50).then([&added]() { ++added; });
+    });
+
+    // `doomed` came first so it ran before being cancelled.
+    Scheduler::instance().update();
+    CHECK_EQ(victim, 1);
+    // Tasks added from a callback start with the next update.
+    CHECK_EQ(added, 0);
+
+    fx.advance(50);
+    CHECK_EQ(victim, 1);
+    CHECK_EQ(added, 1);
+    CHECK_EQ(Scheduler::instance().task_count(), 1u);
+
+    // A frame task queued from a frame task waits for the next frame.
+    int outer = 0;
+    int inner = 0;
+    auto first = task::after_frame([&]() {
+        ++outer;
+        task::after_frame([&inner]() { ++inner; });
+    });
+    Scheduler::instance().update_after_frame_tasks();
+    CHECK_EQ(outer, 1);
+    CHECK_EQ(inner, 0);
+    Scheduler::instance().update_after_frame_tasks();
+    CHECK_EQ(outer, 1);
+    CHECK_EQ(inner, 1);
+}
+
+TEST_CASE("Scheduler - frame tasks only run for their own event") {
+    SchedulerFixture fx;
+    int before = 0;
+    int after = 0;
+    auto tb = task::before_frame().then([&before]() { ++before; });
+    auto ta = task::after_frame([&after]() { ++after; });
+    // Registering the same task again does not make it run twice.
+    Scheduler::instance().add_task(ta);
+
+    Scheduler::instance().update();
+    CHECK_EQ(before, 0);
+    CHECK_EQ(after, 0);
+
+    Scheduler::instance().update_after_frame_tasks();
+    CHECK_EQ(before, 0);
+    CHECK_EQ(after, 1);
+    Scheduler::instance().update_before_frame_tasks();
+    CHECK_EQ(before, 1);
+    CHECK_EQ(after, 1);
+    CHECK_EQ(Scheduler::instance().task_count(), 0u);
+}
+
+// Timing only, so skipped by default; run with --no-skip.
+TEST_CASE("Scheduler - benchmark with 1000 timed tasks" * doctest::skip()) {
+    using clock = std::chrono::steady_clock;
+    SchedulerFixture fx;
+    const int kTasks = 1000;
+    const int kUpdates = 10000;
+    int runs = 0;
+    fl::vector<task> tasks;
+    for (int i = 0; i < kTasks; ++i) {
+        // Intervals between 16 ms and ~1 s, so only a few are due per update.
+        tasks.push_back(task::every_ms(16 + (i * 37) % 1000).then([&runs]() { ++runs; }));
+    }
+    Scheduler::instance().update();
+
+    auto t0 = clock::now();
+    for (int i = 0; i < kUpdates; ++i) {
+        fx.advance(1);
+    }
+    auto t1 = clock::now();
+    CHECK_GT(runs, kTasks);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    MESSAGE(kTasks << " tasks, " << kUpdates << " updates, " << runs
+            << " runs, us: " << us);
+}
@@ -0,0 +1,148 @@
+// Unit tests for fl::spsc_queue, including a two thread stress test
+
+#include "test.h"
+
+#include "fl/spsc_queue.h"
+#include "fl/string.h"
+
+#if FASTLED_MULTITHREADED
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace fl;
+
+namespace {
+
+struct Tracked {
+    static int live;
+    int value = 0;
+    Tracked() { ++live; }
+    explicit Tracked(int v) : value(v) { ++live; }
+    Tracked(const Tracked& other) : value(other.value) { ++live; }
+    Tracked& operator=(const Tracked& other) = default;
+    ~Tracked() { --live; }
+};
+int Tracked::live = 0;
+
+} // namespace
+
+TEST_CASE("spsc_queue - push and pop") {
+    spsc_queue<int, 4> q;
+    CHECK(q.empty());
+    CHECK_EQ(q.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        CHECK(q.push(i));
+    }
+    CHECK_FALSE(q.push(99));
+    CHECK_EQ(q.size(), 4u);
+
+    int v = -1;
+    CHECK(q.pop(v));
+    CHECK_EQ(v, 0);
+    CHECK(q.push(4)); // wraps around
+    for (int expected = 1; expected <= 4; ++expected) {
+        REQUIRE(q.pop(v));
+        CHECK_EQ(v, expected);
+    }
+    CHECK_FALSE(q.pop(v));
+    CHECK(q.empty());
+}
+
+TEST_CASE("spsc_queue - bulk push and pop") {
+    spsc_queue<short, 8> q;
+    const short in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    CHECK_EQ(q.push(in, 5), 5u);
+    CHECK_EQ(q.push(in + 5, 5), 3u); // only three slots left
+    short out[10] = {};
+    CHECK_EQ(q.pop(out, 6), 6u);
+    CHECK_EQ(out[5], 5);
+    CHECK_EQ(q.push(in, 4), 4u);
+    CHECK_EQ(q.pop(out, 10), 6u);
+    CHECK_EQ(out[0], 6);
+    CHECK_EQ(out[1], 7);
+    CHECK_EQ(out[2], 0);
+    CHECK_EQ(out[5], 3);
+}
+
+TEST_CASE("spsc_queue - element lifetime") {
+    Tracked::live = 0;
+    {
+        spsc_queue<Tracked, 4> q;
+        q.emplace(1);
+        q.push(Tracked(2));
+        q.emplace(3);
+        CHECK_EQ(Tracked::live, 3);
+        Tracked out;
+        CHECK(q.pop(out));
+        CHECK_EQ(out.value, 1);
+        CHECK_EQ(Tracked::live, 3); // two queued plus `out`
+    }
+    CHECK_EQ(Tracked::live, 0);
+
+    spsc_queue<fl::string, 2> strings;
+    strings.push(fl::string("a fairly long string that lives on the heap"));
+    fl::string s;
+    CHECK(strings.pop(s));
+    CHECK_EQ(s, "a fairly long string that lives on the heap");
+}
+
+#if FASTLED_MULTITHREADED
+
+namespace {
+
+const u32 kStressItems = 200000;
+
+struct StressState {
+    spsc_queue<u32, 64> queue;
+    bool bulk = false;
+};
+
+void* produce(void* arg) {
+    StressState* state = static_cast<StressState*>(arg);
+    u32 next = 0;
+    while (next < kStressItems) {
+        if (state->bulk) {
+            u32 block[7];
+            fl::size n = 0;
+            for (; n < 7 && next + n < kStressItems; ++n) {
+                block[n] = next + n;
+            }
+            next += static_cast<u32>(state->queue.push(block, n));
+        } else if (state->queue.push(next)) {
+            ++next;
+        }
+        if (next % 1024 == 0) {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("spsc_queue - producer and consumer threads") {
+    for (int bulk = 0; bulk < 2; ++bulk) {
+        StressState state;
+        state.bulk = bulk != 0;
+        pthread_t producer;
+        REQUIRE_EQ(pthread_create(&producer, nullptr, produce, &state), 0);
+
+        u32 expected = 0;
+        bool in_order = true;
+        while (expected < kStressItems) {
+            u32 block[5];
+            const fl::size n = state.bulk ? state.queue.pop(block, 5)
+                                          : (state.queue.pop(block[0]) ? 1 : 0);
+            for (fl::size i = 0; i < n; ++i) {
+                in_order = in_order && block[i] == expected;
+                ++expected;
+            }
+        }
+        pthread_join(producer, nullptr);
+        CHECK(in_order);
+        CHECK(state.queue.empty());
+    }
+}
+
+#endif // FASTLED_MULTITHREADED
@@ -0,0 +1,69 @@
+// Unit tests for Symbol, the interned string handle
+
+#include "test.h"
+
+#include "fl/flat_hash_map.h"
+#include "fl/symbol.h"
+
+using namespace fl;
+
+TEST_CASE("Symbol interning") {
+    Symbol a("brightness");
+    Symbol b(fl::string("brightness"));
+    Symbol c("speed");
+    CHECK(a == b);
+    CHECK(a != c);
+    CHECK_EQ(a.c_str(), b.c_str()); // one shared copy
+    CHECK_EQ(a.size(), 10u);
+    CHECK_EQ(fl::string(a.c_str()), fl::string("brightness"));
+    CHECK_EQ(a.str(), fl::string("brightness"));
+
+    const fl::size pool = Symbol::poolSize();
+    Symbol again("speed");
+    CHECK_EQ(Symbol::poolSize(), pool);
+    CHECK(again == c);
+}
+
+TEST_CASE("Symbol empty and lookup only") {
+    Symbol empty;
+    CHECK(empty.empty());
+    CHECK(empty == Symbol(""));
+    CHECK_EQ(fl::string(empty.c_str()), fl::string(""));
+
+    Symbol known("symbol-test-known");
+    CHECK(Symbol::find("symbol-test-known") == known);
+    const fl::size pool = Symbol::poolSize();
+    CHECK(Symbol::find("symbol-test-never-interned").empty());
+    CHECK_EQ(Symbol::poolSize(), pool);
+}
+
+TEST_CASE("Symbol hash matches the string hash") {
+    Symbol s("hue");
+    CHECK_EQ(s.hash(), Hash<fl::string>()(fl::string("hue")));
+    CHECK_EQ(Hash<Symbol>()(s), s.hash());
+    CHECK_EQ(Symbol().hash(), Hash<fl::string>()(fl::string()));
+}
+
+TEST_CASE("Symbol long strings and many symbols") {
+    fl::string longText;
+    for (int i = 0; i < 50; ++i) {
+        longText += "abcdefgh";
+    }
+    Symbol longSymbol(longText);
+    CHECK_EQ(longSymbol.size(), longText.size());
+    CHECK(Symbol(longText) == longSymbol);
+
+    FlatHashMap<Symbol, int> ids;
+    for (int i = 0; i < 1000; ++i) {
+        fl::string name("component-");
+        name.append(i);
+        ids.insert(Symbol(name), i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        fl::string name("component-");
+        name.append(i);
+        const int *id = ids.find_value(Symbol::find(name.c_str()));
+        REQUIRE(id);
+        CHECK_EQ(*id, i);
+    }
+}
@@ -0,0 +1,93 @@
+// Unit tests for fl::TripleBuffer, including a writer / reader thread test
+
+#include "test.h"
+
+#include "fl/triple_buffer.h"
+
+#if FASTLED_MULTITHREADED
+#include <pthread.h>
+#endif
+
+using namespace fl;
+
+TEST_CASE("TripleBuffer - latest value wins") {
+    TripleBuffer<int> buf;
+    for (fl::size i = 0; i < buf.size(); ++i) {
+        buf.slot(i) = -1;
+    }
+    CHECK_FALSE(buf.update());
+    CHECK_EQ(buf.front(), -1);
+
+    buf.back() = 1;
+    buf.publish();
+    CHECK(buf.update());
+    CHECK_EQ(buf.front(), 1);
+    CHECK_FALSE(buf.update());
+    CHECK_EQ(buf.front(), 1);
+
+    // Values published in between reads are skipped.
+    for (int i = 2; i <= 5; ++i) {
+        buf.back() = i;
+        buf.publish();
+    }
+    CHECK(buf.update());
+    CHECK_EQ(buf.front(), 5);
+
+    // The writer never gets the slot the reader is looking at.
+    for (int i = 6; i <= 10; ++i) {
+        CHECK_NE(&buf.back(), &buf.front());
+        buf.back() = i;
+        buf.publish();
+        CHECK_EQ(buf.front(), 5);
+    }
+    CHECK(buf.update());
+    CHECK_EQ(buf.front(), 10);
+}
+
+#if FASTLED_MULTITHREADED
+
+namespace {
+
+struct Snapshot {
+    u32 a = 0;
+    u32 b = 0;
+};
+
+const u32 kStressValues = 200000;
+
+void* write_pairs(void* arg) {
+    TripleBuffer<Snapshot>* buf = static_cast<TripleBuffer<Snapshot>*>(arg);
+    for (u32 i = 1; i <= kStressValues; ++i) {
+        Snapshot& p = buf->back();
+        p.a = i;
+        p.b = i * 3;
+        buf->publish();
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("TripleBuffer - writer and reader threads") {
+    TripleBuffer<Snapshot> buf;
+    pthread_t writer;
+    REQUIRE_EQ(pthread_create(&writer, nullptr, write_pairs, &buf), 0);
+
+    u32 last = 0;
+    bool consistent = true;
+    bool increasing = true;
+    while (last < kStressValues) {
+        if (!buf.update()) {
+            continue;
+        }
+        const Snapshot& p = buf.front();
+        consistent = consistent && p.b == p.a * 3;
+        increasing = increasing && p.a > last;
+        last = p.a;
+    }
+    pthread_join(writer, nullptr);
+    CHECK(consistent);
+    CHECK(increasing);
+}
+
+#endif // FASTLED_MULTITHREADED
@@ -6,6 +6,7 @@
 #include "fl/ui.h"
 #include "platforms/shared/ui/json/ui.h"
 #include "platforms/shared/ui/json/ui_internal.h"
+#include "platforms/shared/ui/json/ui_manager.h"
 #include "platforms/shared/ui/json/number_field.h"
 #include "platforms/shared/ui/json/dropdown.h"
 #include "platforms/shared/ui/json/title.h"
@@ -802,3 +803,21 @@ TEST_CASE("XYPath slider step serialization bug - C++ verification") {
     // The bug reported in browser output (step values like 0.01 become 0)
     // must be happening in the JavaScript/browser JSON processing pipeline.
 }
+
+TEST_CASE("JsonUiManager finds components by id and by name") {
+    fl::JsonUiManager manager([](const char *) {});
+    auto slider = fl::make_shared<MockJsonUiInternal>("lookup-slider");
+    auto button = fl::make_shared<MockJsonUiInternal>("lookup-button");
+    manager.addComponent(slider);
+    manager.addComponent(button);
+
+    fl::string buttonId;
+    buttonId.append(button->id());
+    CHECK(manager.findUiComponent(buttonId.c_str()) == button);
+    CHECK(manager.findUiComponent("lookup-slider") == slider);
+    CHECK_FALSE(manager.findUiComponent("lookup-missing"));
+    // Only the canonical decimal form of an id matches.
+    fl::string paddedId("0");
+    paddedId.append(button->id());
+    CHECK_FALSE(manager.findUiComponent(paddedId.c_str()));
+}
@@ -9,7 +9,9 @@
 #include "fl/bytestreammemory.h"
 #include "fl/ptr.h"
 #include "fx/video.h"
+#include "fx/video/frame_pool.h"
 #include "fx/video/pixel_stream.h"
+#include "fl/allocator.h"
 #include "lib8tion/intmap.h"
 #include "test.h"
 
@@ -230,3 +232,65 @@ TEST_CASE("video with end frame fadeout") {
     }
     #endif  //
 }
+
+TEST_CASE("FramePool recycles frames") {
+    FramePool pool(LEDS_PER_FRAME, 2);
+    FramePtr a = pool.acquire();
+    FramePtr b = pool.acquire();
+    REQUIRE(a);
+    REQUIRE(b);
+    CHECK_EQ(pool.allocated(), 2);
+    Frame *raw_a = a.get();
+    pool.release(a);
+    // Releasing a frame that is already pooled does not add it twice.
+    pool.release(a);
+    CHECK_EQ(pool.available(), 1);
+    pool.release(b);
+    CHECK_EQ(pool.available(), 2);
+    // Beyond capacity, released frames are dropped.
+    pool.release(fl::make_shared<Frame>(LEDS_PER_FRAME));
+    CHECK_EQ(pool.available(), 2);
+    FramePtr c = pool.acquire();
+    FramePtr d = pool.acquire();
+    CHECK((c.get() == raw_a || d.get() == raw_a));
+    CHECK_EQ(pool.allocated(), 2);
+    // Wrong sized frames are never pooled.
+    pool.release(fl::make_shared<Frame>(LEDS_PER_FRAME + 1));
+    CHECK_EQ(pool.available(), 0);
+}
+
+TEST_CASE("video steady-state playback does not allocate") {
+    const uint32_t kFrames = 4;
+    Video video(LEDS_PER_FRAME, FPS, 2);
+    video.setFade(0, 0);
+    FakeFileHandlePtr fileHandle = fl::make_shared<FakeFileHandle>();
+    CRGB led_frame[LEDS_PER_FRAME];
+    for (uint32_t f = 0; f < kFrames; f++) {
+        for (uint32_t i = 0; i < LEDS_PER_FRAME; i++) {
+            led_frame[i] = CRGB(f * 50, 255 - f * 50, i);
+        }
+        fileHandle->writeCRGB(led_frame, LEDS_PER_FRAME);
+    }
+    video.begin(fileHandle);
+    CRGB leds[LEDS_PER_FRAME];
+    // Prime the frame pool.
+    uint32_t now = 0;
+    for (; now < 2 * FRAME_TIME; now += 5) {
+        REQUIRE(video.draw(now, leds));
+    }
+
+    CountingMallocHook hook;
+    SetMallocFreeHook(&hook);
+    // Play through the end of the video and loop around twice.
+    for (; now < 3 * kFrames * FRAME_TIME; now += 5) {
+        REQUIRE(video.draw(now, leds));
+    }
+    // Rewinding drops the buffered frames back into the pool.
+    REQUIRE(video.rewind());
+    for (uint32_t i = 0; i < 2 * FRAME_TIME; i += 5) {
+        REQUIRE(video.draw(now + i, leds));
+    }
+    ClearMallocFreeHook();
+    CHECK_EQ(hook.mallocs, 0);
+    CHECK_EQ(hook.frees, 0);
+}
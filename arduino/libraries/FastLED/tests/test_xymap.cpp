@@ -2,6 +2,7 @@
 
 #include "test.h"
 #include "FastLED.h"
+#include "fl/xymap_geometry.h"
 
 using namespace fl;
 
@@ -176,3 +177,73 @@ TEST_CASE("XYMap - composing two 4x3 serpentine segments into a 4x6 matrix") {
         }
     }
 }
+
+TEST_CASE("XYMap geometry is built once and shared between layouts") {
+    XYMap map = XYMap::constructSerpentine(6, 4);
+    XYMap copy = map;
+    XYMapGeometryPtr a = map.geometry();
+    XYMapGeometryPtr b = copy.geometry();
+    CHECK(a.get() == b.get());
+    CHECK(map.geometry().get() == a.get());
+    // An independently built map with the same layout shares the tables, a
+    // different layout does not.
+    XYMap same = XYMap::constructSerpentine(6, 4);
+    same.convertToLookUpTable();
+    CHECK(same.geometry().get() == a.get());
+    CHECK(XYMap::constructRectangularGrid(6, 4).geometry().get() != a.get());
+    CHECK(a->memoryUsage() > 0);
+}
+
+TEST_CASE("XYMap polar tables are shared by every layout of a size") {
+    XYMap map = XYMap::constructSerpentine(6, 4);
+    XYMapPolarPtr a = map.polar();
+    CHECK(map.polar().get() == a.get());
+    // Polar tables do not depend on the wiring.
+    CHECK(XYMap::constructRectangularGrid(6, 4).polar().get() == a.get());
+    CHECK(XYMapPolar::get(6, 4, 2.5f, 1.5f).get() == a.get());
+    CHECK(a->memoryUsage() == 6 * 4 * 2 * sizeof(float));
+
+    // Centre of a 6x4 grid is (2.5, 1.5).
+    CHECK(a->centerX() == doctest::Approx(2.5f));
+    CHECK(a->centerY() == doctest::Approx(1.5f));
+    CHECK(a->radius(0, 0) == doctest::Approx(sqrtf(2.5f * 2.5f + 1.5f * 1.5f)));
+    CHECK(a->angle(5, 1) == doctest::Approx(atan2f(-0.5f, 2.5f)));
+
+    // A different origin fetches other polar tables but keeps the layout
+    // tables.
+    XYMapGeometryPtr g = map.geometry();
+    XYMapPolarPtr c = map.polar(0.0f, 0.0f);
+    CHECK(c.get() != a.get());
+    CHECK(c->radius(3, 4 - 1) == doctest::Approx(sqrtf(18.0f)));
+    CHECK(map.geometry().get() == g.get());
+}
+
+TEST_CASE("XYMap geometry neighbours and row spans") {
+    const u16 W = 5;
+    const u16 H = 3;
+    XYMap serp = XYMap::constructSerpentine(W, H);
+    XYMapGeometryPtr g = serp.geometry();
+    for (u16 y = 0; y < H; ++y) {
+        const XYMapGeometry::RowSpan &span = g->rowSpan(y);
+        CHECK_EQ(span.step, (y & 1) ? -1 : 1);
+        for (u16 x = 0; x < W; ++x) {
+            CHECK_EQ(span.start + span.step * x, serp.mapToIndex(x, y));
+        }
+    }
+    CHECK_EQ(g->neighbor(0, 0, XYMapGeometry::kLeft), XYMapGeometry::kNoNeighbor);
+    CHECK_EQ(g->neighbor(0, 0, XYMapGeometry::kUp), XYMapGeometry::kNoNeighbor);
+    CHECK_EQ(g->neighbor(0, 0, XYMapGeometry::kRight), serp.mapToIndex(1, 0));
+    CHECK_EQ(g->neighbor(0, 0, XYMapGeometry::kDown), serp.mapToIndex(0, 1));
+    CHECK_EQ(g->neighbor(W - 1, H - 1, XYMapGeometry::kRight),
+             XYMapGeometry::kNoNeighbor);
+    CHECK_EQ(g->neighbor(W - 1, H - 1, XYMapGeometry::kDown),
+             XYMapGeometry::kNoNeighbor);
+
+    // A scrambled lookup table has no contiguous rows.
+    u16 lut[W * H];
+    for (u16 i = 0; i < W * H; ++i) {
+        lut[i] = (i * 7) % (W * H);
+    }
+    XYMap scrambled = XYMap::constructWithLookUpTable(W, H, lut);
+    CHECK_EQ(scrambled.geometry()->rowSpan(0).step, 0);
+}